@@ -8,6 +8,10 @@
 
 #include "ev3api.h"
 #include "app.h"
+#include "balance.h"
+#include "gyro_calib.h"
+#include "drive_cmd.h"
+#include "fall_sup.h"
 
 #define DEBUG
 
@@ -28,58 +32,31 @@ const int gyro_sensor = EV3_PORT_2, left_motor = EV3_PORT_A, right_motor = EV3_P
 
 /**
  * Constants for the self-balance control algorithm.
+ * (The gains of the balancing equation are in balance.h, the fall detection in fall_sup.h)
  */
-const float KSTEER=-0.25;
-const float EMAOFFSET = 0.0005f, KGYROANGLE = 7.5f, KGYROSPEED = 1.15f, KPOS = 0.07f, KSPEED = 0.1f, KDRIVE = -0.02f;
-const float WHEEL_DIAMETER = 5.6;
-const uint32_t WAIT_TIME_MS = 5;
-const uint32_t FALL_TIME_MS = 1000;
-const float INIT_GYROANGLE = -0.25;
 const float INIT_INTERVAL_TIME = 0.014;
+const uint32_t SAVE_OFFSET_MS = 5000;  // Balancing time before the refined gyro offset is saved at knockout
+const int MAX_CALIB_RESTARTS = 10;
 
 /**
- * Constants for the self-balance control algorithm. (Gyroboy Version)
+ * Steps of the targets changed by one key press of the Bluetooth console.
  */
-//const float EMAOFFSET = 0.0005f, KGYROANGLE = 15.0f, KGYROSPEED = 0.8f, KPOS = 0.12f, KSPEED = 0.08f, KDRIVE = -0.01f;
-//const float WHEEL_DIAMETER = 5.6;
-//const uint32_t WAIT_TIME_MS = 1;
-//const uint32_t FALL_TIME_MS = 1000;
-//const float INIT_GYROANGLE = -0.25;
-//const float INIT_INTERVAL_TIME = 0.014;
+const int SPEED_STEP = 50;     // mm/s
+const int YAW_STEP = 30;       // deg/s
 
 /**
  * Global variables used by the self-balance control algorithm.
  */
-static int motor_diff, motor_diff_target;
-static int loop_count, motor_control_drive, motor_control_steer;
-static float gyro_offset, gyro_speed, gyro_angle, interval_time;
-static float motor_pos, motor_speed;
-
-/**
- * Calculate the initial gyro offset for calibration.
- */
-static ER calibrate_gyro_sensor() {
-    int gMn = 1000, gMx = -100, gSum = 0;
-    for (int i = 0; i < 200; ++i) {
-        int gyro = ev3_gyro_sensor_get_rate(gyro_sensor);
-        gSum += gyro;
-        if (gyro > gMx)
-            gMx = gyro;
-        if (gyro < gMn)
-            gMn = gyro;
-        tslp_tsk(4U * 1000U);
-    }
-    if(!(gMx - gMn < 2)) { // TODO: recheck the condition, '!(gMx - gMn < 2)' or '(gMx - gMn < 2)'
-        gyro_offset = gSum / 200.0f;
-        return E_OK;
-    } else {
-        return E_OBJ;
-    }
-}
+static int loop_count;
+static float gyro_offset, interval_time;
+static balance_t balance;
+static drive_cmd_t drive_cmd;   // Targets set by main_task(), setpoints advanced by balance_task()
+static fall_sup_t fall_sup;
 
 /**
  * Calculate the average interval time of the main loop for the self-balance control algorithm.
  * Units: seconds
+ * Only the floating-point implementation uses it (BALANCE_INTERVAL_TIME), the others run on a constant period.
  */
 static void update_interval_time() {
     static SYSTIM start_time;
@@ -89,7 +66,7 @@ static void update_interval_time() {
         interval_time = INIT_INTERVAL_TIME;
         ER ercd = get_tim(&start_time);
         assert(ercd == E_OK);
-    } else {
+    } else if(BALANCE_INTERVAL_TIME) {
         SYSTIM now;
         ER ercd = get_tim(&now);
         assert(ercd == E_OK);
@@ -98,150 +75,162 @@ static void update_interval_time() {
 }
 
 /**
- * Update data of the gyro sensor.
- * gyro_offset: the offset for calibration.
- * gyro_speed: the speed of the gyro sensor after calibration.
- * gyro_angle: the angle of the robot.
- */
-static void update_gyro_data() {
-    int gyro = ev3_gyro_sensor_get_rate(gyro_sensor);
-    gyro_offset = EMAOFFSET * gyro + (1 - EMAOFFSET) * gyro_offset;
-    gyro_speed = gyro - gyro_offset;
-    gyro_angle += gyro_speed * interval_time;
-}
-
-/**
- * Update data of the motors
+ * Control the power to keep balance.
+ * Return the state of the fall supervisor, the motors are not driven any more once it is FALL_SUP_FALLEN.
  */
-static void update_motor_data() {
-    static int32_t prev_motor_cnt_sum, motor_cnt_deltas[4];
-
-    if(loop_count == 1) { // Reset
-        motor_pos = 0;
-        prev_motor_cnt_sum = 0;
-        motor_cnt_deltas[0] = motor_cnt_deltas[1] = motor_cnt_deltas[2] = motor_cnt_deltas[3] = 0;
+static fall_sup_state_t keep_balance() {
+    balance_input_t in;
+    balance_output_t out;
+
+    in.gyro_rate = ev3_gyro_sensor_get_rate(gyro_sensor);
+    in.left_cnt = ev3_motor_get_counts(left_motor);
+    in.right_cnt = ev3_motor_get_counts(right_motor);
+    drive_cmd_update(&drive_cmd, &in);
+    balance_update(&balance, &in, interval_time, &out);
+
+    // Predict and check a fall
+    fall_sup_state_t state = fall_sup_update(&fall_sup, balance_get_angle(&balance),
+                                             in.gyro_rate - balance_get_offset(&balance), out.power);
+    if(state == FALL_SUP_FALLEN) {
+        if(fall_sup.predictions > 0)
+            _debug(syslog(LOG_NOTICE, "Fall predicted at %d loops.", loop_count));
+        return state;
     }
 
-    int32_t left_cnt = ev3_motor_get_counts(left_motor);
-    int32_t right_cnt = ev3_motor_get_counts(right_motor);
-    int32_t motor_cnt_sum = left_cnt + right_cnt;
-    motor_diff = right_cnt - left_cnt; // TODO: with diff
-    int32_t motor_cnt_delta = motor_cnt_sum - prev_motor_cnt_sum;
+    ev3_motor_set_power(left_motor, out.left_power);
+    ev3_motor_set_power(right_motor, out.right_power);
 
-    prev_motor_cnt_sum = motor_cnt_sum;
-    motor_pos += motor_cnt_delta;
-    motor_cnt_deltas[loop_count % 4] = motor_cnt_delta;
-    motor_speed = (motor_cnt_deltas[0] + motor_cnt_deltas[1] + motor_cnt_deltas[2] + motor_cnt_deltas[3]) / 4.0f / interval_time;
+    return state;
 }
 
 /**
- * Control the power to keep balance.
- * Return false when the robot has fallen.
+ * Sleep until the next period of the main loop.
+ * The wake-up time advances by exactly BALANCE_PERIOD_MS, so the execution time of the loop does not
+ * stretch the period (the fixed-point and state-space implementations rely on it). Missed periods are skipped.
  */
-static bool_t keep_balance() {
-    static SYSTIM ok_time;
-
-    if(loop_count == 1) // Reset ok_time
-        get_tim(&ok_time);
-
-    float ratio_wheel = WHEEL_DIAMETER / 5.6;
-
-    // Apply the drive control value to the motor position to get robot to move.
-    motor_pos -= motor_control_drive * interval_time;
-
-    // This is the main balancing equation
-    int power = (int)((KGYROSPEED * gyro_speed +               // Deg/Sec from Gyro sensor
-                       KGYROANGLE * gyro_angle) / ratio_wheel + // Deg from integral of gyro
-                       KPOS       * motor_pos +                // From MotorRotaionCount of both motors
-                       KDRIVE     * motor_control_drive +       // To improve start/stop performance
-                       KSPEED     * motor_speed);              // Motor speed in Deg/Sec
-
-    // Check fallen
-    SYSTIM time;
-    get_tim(&time);
-    if(power > -100 && power < 100)
-        ok_time = time;
-    else if(time - ok_time >= FALL_TIME_MS * 1000U)
-        return false;
-
-    // Steering control
-    motor_diff_target += motor_control_steer * interval_time;
-
-    int left_power, right_power;
-
-    // TODO: support steering and motor_control_drive
-    int power_steer = (int)(KSTEER * (motor_diff_target - motor_diff));
-    left_power = power + power_steer;
-    right_power = power - power_steer;
-    if(left_power > 100)
-        left_power = 100;
-    if(left_power < -100)
-        left_power = -100;
-    if(right_power > 100)
-        right_power = 100;
-    if(right_power < -100)
-        right_power = -100;
-
-    ev3_motor_set_power(left_motor, (int)left_power);
-    ev3_motor_set_power(right_motor, (int)right_power);
-
-    return true;
+static void wait_next_period(SYSTIM *next) {
+    SYSTIM now;
+
+    get_tim(&now);
+    *next += BALANCE_PERIOD_MS * 1000U;
+    if(*next <= now)
+        *next = now + BALANCE_PERIOD_MS * 1000U;
+    tslp_tsk(*next - now);
 }
 
-void balance_task(intptr_t unused) {
-    ER ercd;
-
-    /**
-     * Reset
-     */
-    loop_count = 0;
-    motor_control_drive = 0;
-    ev3_motor_reset_counts(left_motor);
-    ev3_motor_reset_counts(right_motor);
-    //TODO: reset the gyro sensor
-    ev3_gyro_sensor_reset(gyro_sensor);
-
-    /**
-     * Calibrate the gyro sensor and set the led to green if succeeded.
-     */
-    _debug(syslog(LOG_NOTICE, "Start calibration of the gyro sensor."));
-    for(int i = 10; i > 0; --i) { // Max retries: 10 times.
-        ercd = calibrate_gyro_sensor();
-        if(ercd == E_OK) break;
-        if(i != 1)
+/**
+ * Calibrate the gyro sensor on the period of the main loop (see gyro_calib.h).
+ * Return false when the robot kept moving.
+ */
+static bool_t calibrate_gyro_sensor(gyro_calib_t *calib, SYSTIM *next_time) {
+    float saved_offset = 0;
+    bool_t warm = gyro_calib_load(&saved_offset);
+    int restarts = 0;
+
+    if(warm)
+        _debug(syslog(LOG_INFO, "Saved gyro offset is %de-3.", (int)(saved_offset * 1000)));
+    gyro_calib_init(calib, warm, saved_offset);
+    while(1) {
+        switch(gyro_calib_add(calib, ev3_gyro_sensor_get_rate(gyro_sensor))) {
+        case GYRO_CALIB_DONE:
+            return true;
+        case GYRO_CALIB_MOVED:
+            if(++restarts >= MAX_CALIB_RESTARTS) {
+                syslog(LOG_ERROR, "Max retries for calibration exceeded, exit.");
+                return false;
+            }
             syslog(LOG_ERROR, "Calibration failed, retry.");
-        else {
-            syslog(LOG_ERROR, "Max retries for calibration exceeded, exit.");
-            return;
+            break;
+        default:
+            break;
         }
+        wait_next_period(next_time);
     }
-    _debug(syslog(LOG_INFO, "Calibration succeed, offset is %de-3.", (int)(gyro_offset * 1000)));
-    gyro_angle = INIT_GYROANGLE;
-    ev3_led_set_color(LED_GREEN);
-
-    /**
-     * Main loop for the self-balance control algorithm
-     */
-    while(1) {
-        // Update the interval time
-        update_interval_time();
+}
 
-        // Update data of the gyro sensor
-        update_gyro_data();
+/**
+ * Wait until the fallen robot has been put back upright and kept still (see fall_sup.h).
+ */
+static void wait_upright(SYSTIM *next_time) {
+    float offset = balance_get_offset(&balance);
 
-        // Update data of the motors
-        update_motor_data();
+    ev3_led_set_color(LED_RED);
+    syslog(LOG_NOTICE, "Put the robot back upright to restart.");
+    while(fall_sup_update(&fall_sup, 0, ev3_gyro_sensor_get_rate(gyro_sensor) - offset, 0) != FALL_SUP_READY)
+        wait_next_period(next_time);
+}
 
-        // Keep balance
-        if(!keep_balance()) {
-            ev3_motor_stop(left_motor, false);
-            ev3_motor_stop(right_motor, false);
-            ev3_led_set_color(LED_RED); // TODO: knock out
-            syslog(LOG_NOTICE, "Knock out!");
+void balance_task(intptr_t unused) {
+    SYSTIM task_start_time, start_time, next_time;
+    gyro_calib_t calib;
+    int restarts;
+
+    get_tim(&task_start_time);
+
+    for(restarts = 0; ; restarts++) {
+        /**
+         * Reset
+         */
+        loop_count = 0;
+        drive_cmd_init(&drive_cmd);
+        fall_sup_init(&fall_sup);
+        ev3_motor_reset_counts(left_motor);
+        ev3_motor_reset_counts(right_motor);
+        ev3_gyro_sensor_reset(gyro_sensor);
+
+        /**
+         * Calibrate the gyro sensor and set the led to green if succeeded.
+         */
+        _debug(syslog(LOG_NOTICE, "Start calibration of the gyro sensor."));
+        get_tim(&next_time);
+        if(!calibrate_gyro_sensor(&calib, &next_time))
             return;
+        gyro_offset = gyro_calib_get_offset(&calib);
+        balance_init(&balance, gyro_offset);
+        ev3_led_set_color(LED_GREEN);
+
+        get_tim(&start_time);
+        _debug(syslog(LOG_INFO, "Calibration succeed (%s start, %d samples), offset is %de-3, %dms from start to balance.",
+                      calib.warm_used ? "warm" : "cold", calib.n, (int)(gyro_offset * 1000),
+                      (int)((start_time - task_start_time) / 1000)));
+        if(restarts > 0)
+            syslog(LOG_NOTICE, "Restart %d.", restarts);
+
+        /**
+         * Main loop for the self-balance control algorithm
+         */
+        next_time = start_time;
+        while(1) {
+            // Update the interval time
+            update_interval_time();
+
+            // Update data of the sensors and keep balance
+            if(keep_balance() == FALL_SUP_FALLEN)
+                break;
+
+            wait_next_period(&next_time);
         }
 
-        tslp_tsk(WAIT_TIME_MS * 1000U);
+        ev3_motor_stop(left_motor, false);
+        ev3_motor_stop(right_motor, false);
+        syslog(LOG_NOTICE, "Knock out!");
+        SYSTIM end_time;
+        get_tim(&end_time);
+        float refined_offset = balance_get_offset(&balance);
+        _debug(syslog(LOG_INFO, "%s balancing, %d loops, measured period %dus, gyro offset %de-3 (drift %de-3).",
+                      BALANCE_NAME, loop_count, (int)((end_time - start_time) / loop_count),
+                      (int)(refined_offset * 1000), (int)((refined_offset - gyro_offset) * 1000)));
+
+        // Save the offset for the warm start of the next run: the one refined by the balancing loop if it
+        // ran long enough, otherwise the result of a cold calibration
+        if(end_time - start_time >= SAVE_OFFSET_MS * 1000U)
+            gyro_calib_save(refined_offset);
+        else if(!calib.warm_used)
+            gyro_calib_save(gyro_offset);
+
+        // Calibrate again and restart once the robot is back upright
+        wait_upright(&next_time);
+        get_tim(&task_start_time);
     }
 }
 
@@ -257,6 +246,18 @@ static void button_clicked_handler(intptr_t button) {
 
 static FILE *bt = NULL;
 
+/**
+ * Set the targets of the speed (mm/s) and yaw rate (deg/s), the robot follows them on the ramps of drive_cmd.h.
+ * The targets are read back from drive_cmd, which limits them (and clears them on a restart).
+ */
+#define speed_target    ((int)drive_cmd.speed.target)
+#define yaw_target      ((int)drive_cmd.yaw.target)
+
+static void set_targets(int speed, int yaw) {
+    drive_cmd_set(&drive_cmd, speed, yaw);
+    fprintf(bt, "speed: %d mm/s, yaw rate: %d deg/s\n", speed_target, yaw_target);
+}
+
 void idle_task(intptr_t unused) {
     while(1) {
     	fprintf(bt, "Press 'h' for usage instructions.\n");
@@ -307,35 +308,23 @@ void main_task(intptr_t unused) {
     	sus_tsk(IDLE_TASK);
     	switch(c) {
     	case 'w':
-    		if(motor_control_drive < 0)
-    			motor_control_drive = 0;
-    		else
-    			motor_control_drive += 10;
-    		fprintf(bt, "motor_control_drive: %d\n", motor_control_drive);
+    		set_targets(speed_target < 0 ? 0 : speed_target + SPEED_STEP, yaw_target);
     		break;
 
     	case 's':
-    		if(motor_control_drive > 0)
-    			motor_control_drive = 0;
-    		else
-    			motor_control_drive -= 10;
-    		fprintf(bt, "motor_control_drive: %d\n", motor_control_drive);
+    		set_targets(speed_target > 0 ? 0 : speed_target - SPEED_STEP, yaw_target);
     		break;
 
     	case 'a':
-    		if(motor_control_steer < 0)
-    			motor_control_steer = 0;
-    		else
-    			motor_control_steer += 10;
-    		fprintf(bt, "motor_control_steer: %d\n", motor_control_steer);
+    		set_targets(speed_target, yaw_target < 0 ? 0 : yaw_target + YAW_STEP);
     		break;
 
     	case 'd':
-    		if(motor_control_steer > 0)
-    			motor_control_steer = 0;
-    		else
-    			motor_control_steer -= 10;
-    		fprintf(bt, "motor_control_steer: %d\n", motor_control_steer);
+    		set_targets(speed_target, yaw_target > 0 ? 0 : yaw_target - YAW_STEP);
+    		break;
+
+    	case ' ':
+    		set_targets(0, 0);
     		break;
 
     	case 'h':
@@ -345,6 +334,7 @@ void main_task(intptr_t unused) {
     		fprintf(bt, "Press 's' to speed down\n");
     		fprintf(bt, "Press 'a' to turn left\n");
     		fprintf(bt, "Press 'd' to turn right\n");
+    		fprintf(bt, "Press space to stop\n");
     		fprintf(bt, "Press 'i' for idle task\n");
     		fprintf(bt, "Press 'h' for this message\n");
     		fprintf(bt, "==========================\n");
@@ -0,0 +1,191 @@
+/**
+ * Self-balance control pipeline of Gyroboy.
+ *
+ * The pipeline turns one sample of the gyro sensor and the motor counters into the powers of
+ * both motors: gyro offset tracking (EMA), angle integration, motor speed window, the main
+ * balancing equation and steering.
+ *
+ * Three implementations are provided. BALANCE_LQR and BALANCE_FIXED select the one used by balance_task():
+ *  - balance_float.c (BALANCE_FIXED=0): the original floating-point algorithm.
+ *    The interval time is passed in every loop (averaged over the whole run by the caller).
+ *  - balance_fixed.c (BALANCE_FIXED=1): integer/fixed-point version of the same algorithm.
+ *    The loop must run every BALANCE_PERIOD_MS, and the period is folded into the gains at build time,
+ *    so no division or float operation is left in the loop.
+ *  - balance_lqr.c (BALANCE_LQR=1): state-space controller, an observer and the LQR gains of balance_gain.h
+ *    generated by tools/lqrgain.c from the physical parameters of the robot. Also runs every BALANCE_PERIOD_MS.
+ *
+ * None of the files calls the EV3 API, so all of them can also be linked into the host simulator (sim/pendulum.c).
+ */
+
+#ifndef BALANCE_H
+#define BALANCE_H
+
+#include "ev3api.h"
+
+/**
+ * Select the implementation used by balance_task() (also set from Makefile.inc).
+ */
+#ifndef BALANCE_FIXED
+#define BALANCE_FIXED 1
+#endif
+#ifndef BALANCE_LQR
+#define BALANCE_LQR 0
+#endif
+
+/**
+ * Period of the main loop of balance_task().
+ * It must divide 1000 because balance_fixed.c counts time in loops of 1/BALANCE_FREQ seconds.
+ */
+#define BALANCE_PERIOD_MS   5
+#define BALANCE_FREQ        (1000 / BALANCE_PERIOD_MS)
+
+/**
+ * Constants for the self-balance control algorithm.
+ */
+#define KSTEER          (-0.25f)
+#define KSTEER_FF       (-0.056f)   // x steer, power to turn the wheels at the commanded speed (back EMF)
+#define EMAOFFSET       0.0005f
+#define KGYROANGLE      7.5f
+#define KGYROSPEED      1.15f
+#define KPOS            0.07f
+#define KSPEED          0.1f
+#define KDRIVE          (-0.02f)
+#define WHEEL_DIAMETER  5.6f
+#define INIT_GYROANGLE  (-0.25f)
+
+/**
+ * Constants for the self-balance control algorithm. (Gyroboy Version)
+ */
+//#define EMAOFFSET       0.0005f
+//#define KGYROANGLE      15.0f
+//#define KGYROSPEED      0.8f
+//#define KPOS            0.12f
+//#define KSPEED          0.08f
+//#define KDRIVE          (-0.01f)
+//#define WHEEL_DIAMETER  5.6f
+//#define INIT_GYROANGLE  (-0.25f)
+
+/**
+ * Input of one loop.
+ */
+typedef struct {
+    int     gyro_rate;  // Raw rate of the gyro sensor (deg/s)
+    int32_t left_cnt;   // Counts of the left motor (deg)
+    int32_t right_cnt;  // Counts of the right motor (deg)
+    int     drive;      // Drive control value (deg/s of the motor position reference)
+    int     steer;      // Steer control value (deg/s of the difference between both motors)
+} balance_input_t;
+
+/**
+ * Output of one loop.
+ */
+typedef struct {
+    int power;          // Output of the balancing equation before steering and limiting (for the fall check)
+    int left_power;     // Power of the left motor (-100 to 100)
+    int right_power;    // Power of the right motor (-100 to 100)
+} balance_output_t;
+
+/**
+ * State of the floating-point implementation.
+ */
+typedef struct {
+    float   gyro_offset;            // Offset of the gyro sensor (deg/s)
+    float   gyro_speed;             // Speed of the gyro sensor after calibration (deg/s)
+    float   gyro_angle;             // Angle of the robot (deg)
+    float   motor_pos;              // Sum of the motor counts minus the drive reference (deg)
+    float   motor_speed;            // Sum of the motor speeds (deg/s)
+    float   motor_diff_target;      // Target of the difference between both motors (deg)
+    int32_t prev_motor_cnt_sum;
+    int32_t motor_cnt_deltas[4];
+    int     loop_count;
+} balance_float_t;
+
+/**
+ * State of the fixed-point implementation.
+ * Q16 values have 16 fraction bits. Values marked "x FREQ" are kept divided by the period.
+ */
+typedef struct {
+    int32_t gyro_offset;            // Offset of the gyro sensor (Q16 deg/s)
+    int32_t gyro_speed;             // Speed of the gyro sensor after calibration (Q16 deg/s)
+    int32_t gyro_angle;             // Angle of the robot (Q16 deg x FREQ)
+    int32_t motor_pos;              // Sum of the motor counts minus the drive reference (deg x FREQ)
+    int32_t motor_diff_target;      // Target of the difference between both motors (deg x FREQ)
+    int32_t prev_motor_cnt_sum;
+    int32_t motor_cnt_deltas[4];
+    int32_t motor_cnt_window;       // Sum of motor_cnt_deltas (deg per 4 loops)
+    int     loop_count;
+} balance_fixed_t;
+
+/**
+ * State of the state-space implementation.
+ * The wheel angle is measured against the floor and averaged over both wheels.
+ */
+typedef struct {
+    float   gyro_offset;            // Offset of the gyro sensor (deg/s)
+    float   gyro_speed;             // Speed of the gyro sensor after calibration (deg/s)
+    float   gyro_angle;             // Integral of gyro_speed (deg)
+    float   x[4];                   // Estimated wheel angle, body angle (deg) and their speeds (deg/s)
+    float   u;                      // Average power of both motors applied in the previous loop
+    float   theta_ref;              // Reference of the wheel angle, integral of theta_dot_ref (deg)
+    float   theta_dot_ref;          // Reference of the wheel speed, the drive control value with limited acceleration (deg/s)
+    float   theta_int;              // Integral of the wheel angle error (deg s)
+    float   motor_diff_target;      // Target of the difference between both motors (deg)
+    int     loop_count;
+} balance_lqr_t;
+
+/**
+ * Reset the state with the calibrated gyro offset (deg/s).
+ */
+void balance_float_init(balance_float_t *b, float gyro_offset);
+void balance_fixed_init(balance_fixed_t *b, float gyro_offset);
+void balance_lqr_init(balance_lqr_t *b, float gyro_offset);
+
+/**
+ * Run one loop of the pipeline.
+ * interval_time: time since the previous loop (s), only used by the floating-point implementation.
+ */
+void balance_float_update(balance_float_t *b, const balance_input_t *in, float interval_time, balance_output_t *out);
+void balance_fixed_update(balance_fixed_t *b, const balance_input_t *in, balance_output_t *out);
+void balance_lqr_update(balance_lqr_t *b, const balance_input_t *in, balance_output_t *out);
+
+/**
+ * Angle of the robot (deg) and offset of the gyro sensor (deg/s), for logging.
+ */
+float balance_float_get_angle(const balance_float_t *b);
+float balance_float_get_offset(const balance_float_t *b);
+float balance_fixed_get_angle(const balance_fixed_t *b);
+float balance_fixed_get_offset(const balance_fixed_t *b);
+float balance_lqr_get_angle(const balance_lqr_t *b);
+float balance_lqr_get_offset(const balance_lqr_t *b);
+
+/**
+ * The implementation selected by BALANCE_LQR and BALANCE_FIXED.
+ * BALANCE_INTERVAL_TIME tells whether the caller has to measure the interval time.
+ */
+#if BALANCE_LQR
+typedef balance_lqr_t balance_t;
+#define BALANCE_NAME                        "State-space"
+#define BALANCE_INTERVAL_TIME               0
+#define balance_init(b, offset)             balance_lqr_init(b, offset)
+#define balance_update(b, in, dt, out)      balance_lqr_update(b, in, out)
+#define balance_get_angle(b)                balance_lqr_get_angle(b)
+#define balance_get_offset(b)               balance_lqr_get_offset(b)
+#elif BALANCE_FIXED
+typedef balance_fixed_t balance_t;
+#define BALANCE_NAME                        "Fixed-point"
+#define BALANCE_INTERVAL_TIME               0
+#define balance_init(b, offset)             balance_fixed_init(b, offset)
+#define balance_update(b, in, dt, out)      balance_fixed_update(b, in, out)
+#define balance_get_angle(b)                balance_fixed_get_angle(b)
+#define balance_get_offset(b)               balance_fixed_get_offset(b)
+#else
+typedef balance_float_t balance_t;
+#define BALANCE_NAME                        "Floating-point"
+#define BALANCE_INTERVAL_TIME               1
+#define balance_init(b, offset)             balance_float_init(b, offset)
+#define balance_update(b, in, dt, out)      balance_float_update(b, in, dt, out)
+#define balance_get_angle(b)                balance_float_get_angle(b)
+#define balance_get_offset(b)               balance_float_get_offset(b)
+#endif
+
+#endif
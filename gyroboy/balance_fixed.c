@@ -0,0 +1,124 @@
+/**
+ * Fixed-point implementation of the self-balance control pipeline (see balance.h).
+ *
+ * Same algorithm as balance_float.c, but the interval time is the constant BALANCE_PERIOD_MS.
+ * Every term that was multiplied or divided by the interval time every loop is kept divided by
+ * the period instead (angle, motor position, steering target), and the period is folded into the
+ * gains below at build time. The loop is left with integer additions and 32x32->64 bit multiplies.
+ *
+ * The balancing equation is accumulated in Q32 (32 fraction bits) and truncated toward zero,
+ * like the (int) cast of the floating-point version.
+ */
+
+#include "balance.h"
+
+#define Q16_ONE     65536.0
+#define Q32_ONE     4294967296.0
+#define RATIO_WHEEL (WHEEL_DIAMETER / 5.6)
+#define PERIOD      (BALANCE_PERIOD_MS / 1000.0)
+
+/* The period must be a whole fraction of a second (see balance.h) */
+typedef char balance_period_check[(1000 % BALANCE_PERIOD_MS == 0) ? 1 : -1];
+
+/**
+ * Gains, computed at build time.
+ */
+static const int64_t G_EMA       = (int64_t)(EMAOFFSET * Q32_ONE + 0.5);                            // Q32, per loop
+static const int64_t G_GYROSPEED = (int64_t)(KGYROSPEED / RATIO_WHEEL * Q16_ONE + 0.5);            // Q16, x Q16 deg/s
+static const int64_t G_GYROANGLE = (int64_t)(KGYROANGLE / RATIO_WHEEL * PERIOD * Q32_ONE + 0.5);    // Q32, x Q16 deg x FREQ >> 16
+static const int64_t G_POS       = (int64_t)(KPOS * PERIOD * Q32_ONE + 0.5);                        // Q32, x deg x FREQ
+static const int64_t G_DRIVE     = (int64_t)(KDRIVE * Q32_ONE - 0.5);                               // Q32, x deg/s
+static const int64_t G_SPEED     = (int64_t)(KSPEED / 4 / PERIOD * Q32_ONE + 0.5);                  // Q32, x deg per 4 loops
+static const int64_t G_STEER     = (int64_t)(KSTEER * PERIOD * Q32_ONE - 0.5);                      // Q32, x deg x FREQ
+static const int64_t G_STEER_FF  = (int64_t)(KSTEER_FF * Q32_ONE - 0.5);                            // Q32, x deg/s
+
+/**
+ * Convert Q32 to int, truncating toward zero.
+ */
+static int q32_to_int(int64_t x) {
+    return x >= 0 ? (int)(x >> 32) : -(int)((-x) >> 32);
+}
+
+static int limit_power(int power) {
+    if(power > 100)
+        return 100;
+    if(power < -100)
+        return -100;
+    return power;
+}
+
+void balance_fixed_init(balance_fixed_t *b, float gyro_offset) {
+    b->gyro_offset = (int32_t)(gyro_offset * Q16_ONE);
+    b->gyro_speed = 0;
+    b->gyro_angle = (int32_t)(INIT_GYROANGLE * BALANCE_FREQ * Q16_ONE);
+    b->motor_pos = 0;
+    b->motor_diff_target = 0;
+    b->prev_motor_cnt_sum = 0;
+    b->motor_cnt_deltas[0] = b->motor_cnt_deltas[1] = b->motor_cnt_deltas[2] = b->motor_cnt_deltas[3] = 0;
+    b->motor_cnt_window = 0;
+    b->loop_count = 0;
+}
+
+/**
+ * Update data of the gyro sensor.
+ * The EMA step is rounded to nearest, so the offset settles within 0.5 / EMAOFFSET LSB (about 0.015 deg/s)
+ * of the mean rate instead of drifting to one side.
+ */
+static void update_gyro_data(balance_fixed_t *b, int gyro) {
+    int32_t gyro_q16 = (int32_t)gyro << 16;
+
+    b->gyro_offset += (int32_t)(((gyro_q16 - b->gyro_offset) * G_EMA + ((int64_t)1 << 31)) >> 32);
+    b->gyro_speed = gyro_q16 - b->gyro_offset;
+    b->gyro_angle += b->gyro_speed;                         // angle / period
+}
+
+/**
+ * Update data of the motors.
+ * The speed window is kept as a running sum, so the speed needs no division.
+ */
+static int update_motor_data(balance_fixed_t *b, int32_t left_cnt, int32_t right_cnt) {
+    int32_t motor_cnt_sum = left_cnt + right_cnt;
+    int32_t motor_cnt_delta = motor_cnt_sum - b->prev_motor_cnt_sum;
+    int32_t *slot = &b->motor_cnt_deltas[b->loop_count & 3];
+
+    b->prev_motor_cnt_sum = motor_cnt_sum;
+    b->motor_pos += motor_cnt_delta * BALANCE_FREQ;         // position / period
+    b->motor_cnt_window += motor_cnt_delta - *slot;
+    *slot = motor_cnt_delta;
+
+    return right_cnt - left_cnt;
+}
+
+void balance_fixed_update(balance_fixed_t *b, const balance_input_t *in, balance_output_t *out) {
+    b->loop_count++;
+    update_gyro_data(b, in->gyro_rate);
+    int motor_diff = update_motor_data(b, in->left_cnt, in->right_cnt);
+
+    // Apply the drive control value to the motor position to get robot to move.
+    b->motor_pos -= in->drive;
+
+    // This is the main balancing equation
+    int64_t acc = G_GYROSPEED * b->gyro_speed                   // Deg/Sec from Gyro sensor
+                + ((G_GYROANGLE * b->gyro_angle) >> 16)         // Deg from integral of gyro
+                + G_POS * b->motor_pos                          // From MotorRotaionCount of both motors
+                + G_DRIVE * in->drive                           // To improve start/stop performance
+                + G_SPEED * b->motor_cnt_window;                // Motor speed in Deg/Sec
+    int power = q32_to_int(acc);
+
+    // Steering control
+    b->motor_diff_target += in->steer;
+
+    int power_steer = q32_to_int(G_STEER * (b->motor_diff_target - motor_diff * BALANCE_FREQ) + G_STEER_FF * in->steer);
+
+    out->power = power;
+    out->left_power = limit_power(power + power_steer);
+    out->right_power = limit_power(power - power_steer);
+}
+
+float balance_fixed_get_angle(const balance_fixed_t *b) {
+    return b->gyro_angle / (float)(BALANCE_FREQ * Q16_ONE);
+}
+
+float balance_fixed_get_offset(const balance_fixed_t *b) {
+    return b->gyro_offset / (float)Q16_ONE;
+}
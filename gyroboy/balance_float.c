@@ -0,0 +1,91 @@
+/**
+ * Floating-point implementation of the self-balance control pipeline (see balance.h).
+ *
+ * This is the original algorithm of balance_task() moved out of app.c.
+ */
+
+#include "balance.h"
+
+void balance_float_init(balance_float_t *b, float gyro_offset) {
+    b->gyro_offset = gyro_offset;
+    b->gyro_speed = 0;
+    b->gyro_angle = INIT_GYROANGLE;
+    b->motor_pos = 0;
+    b->motor_speed = 0;
+    b->motor_diff_target = 0;
+    b->prev_motor_cnt_sum = 0;
+    b->motor_cnt_deltas[0] = b->motor_cnt_deltas[1] = b->motor_cnt_deltas[2] = b->motor_cnt_deltas[3] = 0;
+    b->loop_count = 0;
+}
+
+/**
+ * Update data of the gyro sensor.
+ * gyro_offset: the offset for calibration.
+ * gyro_speed: the speed of the gyro sensor after calibration.
+ * gyro_angle: the angle of the robot.
+ */
+static void update_gyro_data(balance_float_t *b, int gyro, float interval_time) {
+    b->gyro_offset = EMAOFFSET * gyro + (1 - EMAOFFSET) * b->gyro_offset;
+    b->gyro_speed = gyro - b->gyro_offset;
+    b->gyro_angle += b->gyro_speed * interval_time;
+}
+
+/**
+ * Update data of the motors
+ */
+static int update_motor_data(balance_float_t *b, int32_t left_cnt, int32_t right_cnt, float interval_time) {
+    int32_t motor_cnt_sum = left_cnt + right_cnt;
+    int32_t motor_cnt_delta = motor_cnt_sum - b->prev_motor_cnt_sum;
+
+    b->prev_motor_cnt_sum = motor_cnt_sum;
+    b->motor_pos += motor_cnt_delta;
+    b->motor_cnt_deltas[b->loop_count % 4] = motor_cnt_delta;
+    b->motor_speed = (b->motor_cnt_deltas[0] + b->motor_cnt_deltas[1] + b->motor_cnt_deltas[2] + b->motor_cnt_deltas[3]) / 4.0f / interval_time;
+
+    return right_cnt - left_cnt;
+}
+
+void balance_float_update(balance_float_t *b, const balance_input_t *in, float interval_time, balance_output_t *out) {
+    const float ratio_wheel = WHEEL_DIAMETER / 5.6;
+
+    b->loop_count++;
+    update_gyro_data(b, in->gyro_rate, interval_time);
+    int motor_diff = update_motor_data(b, in->left_cnt, in->right_cnt, interval_time);
+
+    // Apply the drive control value to the motor position to get robot to move.
+    b->motor_pos -= in->drive * interval_time;
+
+    // This is the main balancing equation
+    int power = (int)((KGYROSPEED * b->gyro_speed +                 // Deg/Sec from Gyro sensor
+                       KGYROANGLE * b->gyro_angle) / ratio_wheel +   // Deg from integral of gyro
+                       KPOS       * b->motor_pos +                   // From MotorRotaionCount of both motors
+                       KDRIVE     * in->drive +                      // To improve start/stop performance
+                       KSPEED     * b->motor_speed);                 // Motor speed in Deg/Sec
+
+    // Steering control (the target is kept in float, an int target never moves for steer * interval_time < 1)
+    b->motor_diff_target += in->steer * interval_time;
+
+    int power_steer = (int)(KSTEER * (b->motor_diff_target - motor_diff) + KSTEER_FF * in->steer);
+    int left_power = power + power_steer;
+    int right_power = power - power_steer;
+    if(left_power > 100)
+        left_power = 100;
+    if(left_power < -100)
+        left_power = -100;
+    if(right_power > 100)
+        right_power = 100;
+    if(right_power < -100)
+        right_power = -100;
+
+    out->power = power;
+    out->left_power = left_power;
+    out->right_power = right_power;
+}
+
+float balance_float_get_angle(const balance_float_t *b) {
+    return b->gyro_angle;
+}
+
+float balance_float_get_offset(const balance_float_t *b) {
+    return b->gyro_offset;
+}
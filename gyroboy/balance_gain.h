@@ -0,0 +1,45 @@
+/**
+ * Gains of the state-space balance controller (balance_lqr.c).
+ *
+ * Generated by tools/lqrgain.c, do not edit by hand:
+ *   lqrgain -d 5.6 -m 0.8 -l 0.12 -b 8 -p 5 -q 1,1000,10,1,1 -r 100 -w 2,2 -v 0.3,0.5,0.6
+ * Spectral radius: regulator 0.99852 (5642 iterations), observer 0.99171 (849 iterations).
+ *
+ * x = [wheel angle against the floor (deg), body angle (deg), their speeds (deg/s)]
+ * y = [average of the motor counts (deg), integral of the gyro rate (deg), gyro rate (deg/s)]
+ * u = average power of both motors
+ */
+
+#ifndef BALANCE_GAIN_H
+#define BALANCE_GAIN_H
+
+#define LQR_PERIOD_MS       5
+
+/* Regulator: power = sum of LQR_K_* x state */
+#define LQR_K_THETA           0.076679f  // x wheel angle error (deg)
+#define LQR_K_PSI            11.347856f  // x body angle (deg)
+#define LQR_K_THETA_DOT       0.252643f  // x wheel speed (deg/s)
+#define LQR_K_PSI_DOT         1.417607f  // x body angular velocity (deg/s)
+#define LQR_K_THETA_INT       0.019573f  // x integral of the wheel angle error (deg s)
+
+/* Feedforward: power to keep the wheel speed of the reference (back EMF and friction) */
+#define LQR_K_DRIVE           0.112231f  // x wheel speed of the reference (deg/s)
+
+/* Model for the prediction of the observer: x = LQR_PHI x + LQR_GAMMA u */
+static const float LQR_PHI[4][4] = {
+    {   1.00000000f,  -0.00520199f,   0.00311545f,   0.00187492f },
+    {   0.00000000f,   1.00162834f,   0.00035358f,   0.00464931f },
+    {   0.00000000f,  -1.67321760f,   0.37981243f,   0.61498558f },
+    {   0.00000000f,   0.57494674f,   0.11637948f,   0.88524886f },
+};
+static const float LQR_GAMMA[4] = { 0.01679171f, -0.00315048f, 5.52599150f, -1.03696375f };
+
+/* Gain of the observer: x = x + LQR_L (y - C x) */
+static const float LQR_L[4][3] = {
+    {   0.02617593f,   0.00505245f,   0.00085616f },
+    {  -0.00413253f,   0.00654016f,   0.00052835f },
+    {   0.08664844f,  -0.00732942f,   0.08609669f },
+    {   0.00131126f,   0.00076082f,   0.92327968f },
+};
+
+#endif
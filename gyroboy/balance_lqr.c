@@ -0,0 +1,127 @@
+/**
+ * State-space implementation of the self-balance control pipeline (see balance.h).
+ *
+ * The gyro offset tracking and steering are the same as balance_float.c. The state of the robot
+ * (wheel angle against the floor, body angle and their speeds) is estimated by an observer (steady-state
+ * Kalman filter) from the motor counts, the integral of the gyro rate and the gyro rate, and fed back
+ * with the LQR gains of balance_gain.h:
+ *   power = K_THETA * (theta - theta_ref) + K_PSI * psi + K_THETA_DOT * (theta_dot - theta_dot_ref) + K_PSI_DOT * psi_dot
+ *         + K_THETA_INT * integral of (theta - theta_ref) + K_DRIVE * theta_dot_ref
+ * The observer replaces the 4-loop window of the motor speed, whose delay makes the LQR gains oscillate.
+ * The drive control value is the reference of the wheel speed, with its acceleration limited so that a step
+ * of it does not kick the motors (the ramps of drive_cmd.c stay below the limit). K_DRIVE is the power that
+ * keeps the reference speed against the back EMF; the integral term removes the remaining steady error and
+ * the lean caused by a residual gyro offset.
+ *
+ * The gains are designed for a constant period, so the loop must run every BALANCE_PERIOD_MS.
+ * Regenerate balance_gain.h with tools/lqrgain.c when the robot or the period changes.
+ */
+
+#include "balance.h"
+#include "balance_gain.h"
+
+#define PERIOD (BALANCE_PERIOD_MS / 1000.0f)
+
+/* Acceleration limit of the reference of the wheel speed (deg/s^2), above the ramps of drive_cmd.h */
+#define MAX_REF_ACC 1200.0f
+
+/* The gains must be designed for the period of the loop */
+typedef char balance_lqr_period_check[(LQR_PERIOD_MS == BALANCE_PERIOD_MS) ? 1 : -1];
+
+void balance_lqr_init(balance_lqr_t *b, float gyro_offset) {
+    b->gyro_offset = gyro_offset;
+    b->gyro_speed = 0;
+    b->gyro_angle = INIT_GYROANGLE;
+    b->x[0] = INIT_GYROANGLE;       // The motor counts start from 0
+    b->x[1] = INIT_GYROANGLE;
+    b->x[2] = b->x[3] = 0;
+    b->u = 0;
+    b->theta_ref = 0;
+    b->theta_dot_ref = 0;
+    b->theta_int = 0;
+    b->motor_diff_target = 0;
+    b->loop_count = 0;
+}
+
+/**
+ * Update data of the gyro sensor.
+ */
+static void update_gyro_data(balance_lqr_t *b, int gyro) {
+    b->gyro_offset = EMAOFFSET * gyro + (1 - EMAOFFSET) * b->gyro_offset;
+    b->gyro_speed = gyro - b->gyro_offset;
+    b->gyro_angle += b->gyro_speed * PERIOD;
+}
+
+/**
+ * Update the estimated state with the power applied in the previous loop and the new measurements.
+ */
+static void update_observer(balance_lqr_t *b, float motor_cnt_avg) {
+    float x[4], e[3];
+    int i;
+
+    for(i = 0; i < 4; i++)
+        x[i] = LQR_PHI[i][0] * b->x[0] + LQR_PHI[i][1] * b->x[1] + LQR_PHI[i][2] * b->x[2] + LQR_PHI[i][3] * b->x[3]
+             + LQR_GAMMA[i] * b->u;
+
+    e[0] = motor_cnt_avg - (x[0] - x[1]);
+    e[1] = b->gyro_angle - x[1];
+    e[2] = b->gyro_speed - x[3];
+    for(i = 0; i < 4; i++)
+        b->x[i] = x[i] + LQR_L[i][0] * e[0] + LQR_L[i][1] * e[1] + LQR_L[i][2] * e[2];
+}
+
+void balance_lqr_update(balance_lqr_t *b, const balance_input_t *in, balance_output_t *out) {
+    b->loop_count++;
+    update_gyro_data(b, in->gyro_rate);
+    update_observer(b, (in->left_cnt + in->right_cnt) / 2.0f);
+
+    // Apply the drive control value (deg/s of the sum of both motors) to the reference of the wheel speed,
+    // limiting its acceleration so that a step of the drive value does not kick the motors
+    float theta_dot_target = in->drive / 2.0f;
+    if(theta_dot_target > b->theta_dot_ref + MAX_REF_ACC * PERIOD)
+        theta_dot_target = b->theta_dot_ref + MAX_REF_ACC * PERIOD;
+    if(theta_dot_target < b->theta_dot_ref - MAX_REF_ACC * PERIOD)
+        theta_dot_target = b->theta_dot_ref - MAX_REF_ACC * PERIOD;
+    b->theta_dot_ref = theta_dot_target;
+    b->theta_ref += b->theta_dot_ref * PERIOD;
+
+    float theta_err = b->x[0] - b->theta_ref;
+    b->theta_int += theta_err * PERIOD;
+
+    // This is the main balancing equation
+    int power = (int)(LQR_K_THETA     * theta_err +
+                      LQR_K_PSI       * b->x[1] +
+                      LQR_K_THETA_DOT * (b->x[2] - b->theta_dot_ref) +
+                      LQR_K_PSI_DOT   * b->x[3] +
+                      LQR_K_THETA_INT * b->theta_int +
+                      LQR_K_DRIVE     * b->theta_dot_ref);
+
+    // Steering control
+    b->motor_diff_target += in->steer * PERIOD;
+
+    int power_steer = (int)(KSTEER * (b->motor_diff_target - (in->right_cnt - in->left_cnt)) + KSTEER_FF * in->steer);
+    int left_power = power + power_steer;
+    int right_power = power - power_steer;
+    if(left_power > 100)
+        left_power = 100;
+    if(left_power < -100)
+        left_power = -100;
+    if(right_power > 100)
+        right_power = 100;
+    if(right_power < -100)
+        right_power = -100;
+
+    b->u = (left_power + right_power) / 2.0f;   // The observer predicts with the power actually applied
+
+    out->power = power;
+    out->left_power = left_power;
+    out->right_power = right_power;
+}
+
+float balance_lqr_get_angle(const balance_lqr_t *b) {
+    return b->x[1];
+}
+
+float balance_lqr_get_offset(const balance_lqr_t *b) {
+    return b->gyro_offset;
+}
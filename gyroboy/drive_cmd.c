@@ -0,0 +1,75 @@
+/**
+ * Velocity and yaw-rate commands of Gyroboy (see drive_cmd.h).
+ */
+
+#include <math.h>
+#include "drive_cmd.h"
+
+#define PERIOD (BALANCE_PERIOD_MS / 1000.0f)
+
+static void ramp_init(drive_cmd_ramp_t *r) {
+    r->target = 0;
+    r->value = 0;
+    r->acc = 0;
+}
+
+/**
+ * Move the setpoint one period toward the target.
+ * The acceleration is the largest one that can still be brought back to 0 at the max jerk when the
+ * setpoint reaches the target, so the setpoint arrives without overshoot.
+ */
+static void ramp_update(drive_cmd_ramp_t *r, float max_acc, float max_jerk) {
+    float error = r->target - r->value;
+    float step = max_jerk * PERIOD;
+    // acc * PERIOD + acc^2 / (2 * max_jerk) = |error|: the step of this period plus the ramp down of acc
+    float acc = fminf(max_jerk * (sqrtf(PERIOD * PERIOD + 2 * fabsf(error) / max_jerk) - PERIOD), max_acc);
+
+    if(error < 0)
+        acc = -acc;
+    if(acc > r->acc + step)
+        acc = r->acc + step;
+    else if(acc < r->acc - step)
+        acc = r->acc - step;
+    r->acc = acc;
+    r->value += acc * PERIOD;
+
+    // Settle on the target instead of dithering around it
+    if(fabsf(r->target - r->value) <= step * PERIOD && fabsf(r->acc) <= step) {
+        r->value = r->target;
+        r->acc = 0;
+    }
+}
+
+static float limit(float value, float max) {
+    return value > max ? max : value < -max ? -max : value;
+}
+
+void drive_cmd_init(drive_cmd_t *c) {
+    ramp_init(&c->speed);
+    ramp_init(&c->yaw);
+}
+
+void drive_cmd_set(drive_cmd_t *c, float speed, float yaw) {
+    float max_yaw;
+
+    speed = limit(speed, DRIVE_CMD_MAX_SPEED);
+    max_yaw = (DRIVE_CMD_MAX_WHEEL - fabsf(speed)) / (TREAD_WIDTH * 5) * 180 / 3.14159265f;
+    c->speed.target = speed;
+    c->yaw.target = limit(yaw, fminf(max_yaw, DRIVE_CMD_MAX_YAW));
+}
+
+void drive_cmd_update(drive_cmd_t *c, balance_input_t *in) {
+    ramp_update(&c->speed, DRIVE_CMD_MAX_ACC, DRIVE_CMD_MAX_JERK);
+    ramp_update(&c->yaw, DRIVE_CMD_MAX_YAW_ACC, DRIVE_CMD_MAX_YAW_JERK);
+
+    in->drive = (int)lroundf(DRIVE_CMD_DRIVE(c->speed.value));
+    in->steer = (int)lroundf(DRIVE_CMD_STEER(c->yaw.value));
+}
+
+float drive_cmd_get_speed(const drive_cmd_t *c) {
+    return c->speed.value;
+}
+
+float drive_cmd_get_yaw(const drive_cmd_t *c) {
+    return c->yaw.value;
+}
@@ -0,0 +1,75 @@
+/**
+ * Velocity and yaw-rate commands of Gyroboy.
+ *
+ * main_task() sets the targets (speed of the robot and yaw rate) with drive_cmd_set, and balance_task()
+ * advances the setpoints by one period with drive_cmd_update, which fills the drive and steer control
+ * values of balance_input_t. So the drive value moves the motor_pos reference and the steer value moves
+ * motor_diff_target of the balancing pipeline (see balance.h).
+ * The setpoints follow the targets on jerk-limited ramps: a step of the target would lean the robot
+ * suddenly (the drive value also feeds the balancing equation) and saturate the motors at speed.
+ *
+ * The file does not call the EV3 API, so it can also be linked into the host simulator (sim/pendulum.c).
+ */
+
+#ifndef DRIVE_CMD_H
+#define DRIVE_CMD_H
+
+#include "ev3api.h"
+#include "balance.h"
+
+/**
+ * Constants for the commands.
+ */
+#define TREAD_WIDTH             12.0f       // Distance between both wheels (cm)
+#define DRIVE_CMD_MAX_WHEEL     380.0f      // Speed of the outer wheel in a turn (mm/s), the motors saturate above it
+#define DRIVE_CMD_MAX_SPEED     250.0f      // Speed of the robot (mm/s)
+#define DRIVE_CMD_MAX_ACC       500.0f      // (mm/s^2)
+#define DRIVE_CMD_MAX_JERK      2500.0f     // (mm/s^3)
+#define DRIVE_CMD_MAX_YAW       180.0f      // Yaw rate, positive turns left (deg/s)
+#define DRIVE_CMD_MAX_YAW_ACC   360.0f      // (deg/s^2)
+#define DRIVE_CMD_MAX_YAW_JERK  1800.0f     // (deg/s^3)
+
+/**
+ * Conversion of the commands to the control values of balance_input_t.
+ * drive: deg/s of the sum of both motors, steer: deg/s of the difference between both motors.
+ */
+#define DRIVE_CMD_DRIVE(speed)  ((speed) * 2 * 180 / (3.14159265f * WHEEL_DIAMETER * 5))
+#define DRIVE_CMD_STEER(yaw)    ((yaw) * TREAD_WIDTH * 2 / WHEEL_DIAMETER)
+
+/**
+ * Setpoint of one axis following the target with limited acceleration and jerk.
+ */
+typedef struct {
+    float   target;
+    float   value;
+    float   acc;
+} drive_cmd_ramp_t;
+
+typedef struct {
+    drive_cmd_ramp_t    speed;      // mm/s
+    drive_cmd_ramp_t    yaw;        // deg/s
+} drive_cmd_t;
+
+/**
+ * Stop at once (the setpoints and targets are reset to 0).
+ */
+void drive_cmd_init(drive_cmd_t *c);
+
+/**
+ * Set the targets, limited to DRIVE_CMD_MAX_SPEED and DRIVE_CMD_MAX_YAW.
+ * The yaw rate is lowered further so that the outer wheel does not exceed DRIVE_CMD_MAX_WHEEL.
+ */
+void drive_cmd_set(drive_cmd_t *c, float speed, float yaw);
+
+/**
+ * Advance the setpoints by BALANCE_PERIOD_MS and set in->drive and in->steer.
+ */
+void drive_cmd_update(drive_cmd_t *c, balance_input_t *in);
+
+/**
+ * Current setpoints (mm/s, deg/s), for logging.
+ */
+float drive_cmd_get_speed(const drive_cmd_t *c);
+float drive_cmd_get_yaw(const drive_cmd_t *c);
+
+#endif
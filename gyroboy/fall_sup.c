@@ -0,0 +1,64 @@
+/**
+ * Fall supervisor of Gyroboy (see fall_sup.h).
+ */
+
+#include <math.h>
+#include "balance.h"
+#include "fall_sup.h"
+
+#define PERIOD      (BALANCE_PERIOD_MS / 1000.0f)
+#define LOOPS(ms)   ((ms) / BALANCE_PERIOD_MS)
+
+void fall_sup_init(fall_sup_t *s) {
+    s->state = FALL_SUP_BALANCING;
+    s->sat_loops = 0;
+    s->ok_loops = 0;
+    s->angle = 0;
+    s->predictions = 0;
+}
+
+static fall_sup_state_t enter(fall_sup_t *s, fall_sup_state_t state, float angle) {
+    s->state = state;
+    s->ok_loops = 0;
+    s->angle = angle;
+    return state;
+}
+
+fall_sup_state_t fall_sup_update(fall_sup_t *s, float angle, float speed, int power) {
+    float predicted = angle + speed * FALL_SUP_HORIZON;
+
+    switch(s->state) {
+    case FALL_SUP_BALANCING:
+        if(power > -100 && power < 100)
+            s->sat_loops = 0;
+        else
+            s->sat_loops++;
+
+        if(fabsf(angle) > FALL_SUP_FALL_ANGLE || s->sat_loops >= LOOPS(FALL_SUP_FALL_TIME_MS))
+            return enter(s, FALL_SUP_FALLEN, angle);
+
+        // Falling to the same side as the lean: the angle and speed have the same sign
+        bool_t diverging = angle * speed > 0 && fabsf(angle) > FALL_SUP_SAT_ANGLE;
+        if(fabsf(predicted) > FALL_SUP_PRED_ANGLE || (diverging && s->sat_loops >= LOOPS(FALL_SUP_SAT_MS))) {
+            s->predictions++;
+            return enter(s, FALL_SUP_FALLEN, angle);
+        }
+        break;
+
+    case FALL_SUP_FALLEN:
+        // Follow the body with the gyro until it is put back upright and kept still
+        s->angle += speed * PERIOD;
+        if(fabsf(s->angle) < FALL_SUP_UPRIGHT_ANGLE && fabsf(speed) < FALL_SUP_STILL_RATE)
+            s->ok_loops++;
+        else
+            s->ok_loops = 0;
+        if(s->ok_loops >= LOOPS(FALL_SUP_STILL_MS))
+            s->state = FALL_SUP_READY;
+        break;
+
+    case FALL_SUP_READY:
+        break;
+    }
+
+    return s->state;
+}
@@ -0,0 +1,63 @@
+/**
+ * Fall supervisor of Gyroboy.
+ *
+ * balance_task() calls fall_sup_update once per loop with the angle and speed of the body and the output
+ * of the balancing equation. The supervisor predicts a fall before the motors have been saturated for
+ * FALL_SUP_FALL_TIME_MS (the only check of the original sample):
+ *  - the angle extrapolated FALL_SUP_HORIZON ahead exceeds FALL_SUP_PRED_ANGLE, or
+ *  - the power has been saturated for FALL_SUP_SAT_MS while the body leans beyond FALL_SUP_SAT_ANGLE
+ *    and keeps falling to the same side.
+ * A predicted fall is reported as FALL_SUP_FALLEN at once, so that balance_task() stops the motors before the
+ * body hits the floor. There is no recovery maneuver: once the power is saturated the motors cannot give more
+ * than the balancing equation already asks for (sim/pendulum holds the same push with and without one).
+ * When the robot has fallen (a prediction, an angle beyond FALL_SUP_FALL_ANGLE, or the original saturation
+ * check), the supervisor integrates the gyro rate to follow the body, and reports FALL_SUP_READY once the
+ * robot has been put back upright and kept still, so that balance_task() can calibrate again and restart.
+ *
+ * The file does not call the EV3 API, so it can also be linked into the host simulator (sim/pendulum.c).
+ */
+
+#ifndef FALL_SUP_H
+#define FALL_SUP_H
+
+#include "ev3api.h"
+
+/**
+ * Constants for the supervisor.
+ */
+#define FALL_SUP_HORIZON            0.1f    // Horizon of the prediction of the angle (s)
+#define FALL_SUP_PRED_ANGLE         20.0f   // Predicted angle of an imminent fall (deg)
+#define FALL_SUP_SAT_ANGLE          10.0f   // Angle of an imminent fall while the power is saturated (deg)
+#define FALL_SUP_SAT_MS             50      // Saturation time of an imminent fall (ms)
+#define FALL_SUP_FALL_ANGLE         45.0f   // Angle of a fallen robot (deg)
+#define FALL_SUP_FALL_TIME_MS       1000    // Saturation time of a fallen robot (ms)
+#define FALL_SUP_UPRIGHT_ANGLE      10.0f   // Angle of a robot put back upright (deg)
+#define FALL_SUP_STILL_RATE         5.0f    // Gyro rate of a robot kept still (deg/s)
+#define FALL_SUP_STILL_MS           1000    // Still time before the restart (ms)
+
+typedef enum {
+    FALL_SUP_BALANCING,     // Normal balancing
+    FALL_SUP_FALLEN,        // Fallen or about to, stop the motors and wait for the robot to be put back upright
+    FALL_SUP_READY,         // Upright and still, calibrate again and restart
+} fall_sup_state_t;
+
+typedef struct {
+    fall_sup_state_t    state;
+    int                 sat_loops;      // Loops with the power saturated
+    int                 ok_loops;       // Loops still (fallen)
+    float               angle;          // Angle of the body while fallen (deg)
+    int                 predictions;    // Number of predicted falls since fall_sup_init
+} fall_sup_t;
+
+/**
+ * Start supervising a robot that starts balancing.
+ */
+void fall_sup_init(fall_sup_t *s);
+
+/**
+ * Update the supervisor with the angle (deg) and speed (deg/s) of the body and the output of the
+ * balancing equation. While fallen, only the speed is used (the balancing loop is stopped).
+ */
+fall_sup_state_t fall_sup_update(fall_sup_t *s, float angle, float speed, int power);
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * Online calibration of the gyro sensor offset (see gyro_calib.h).
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "gyro_calib.h"
+
+void gyro_calib_init(gyro_calib_t *c, bool_t warm, float saved_offset) {
+    c->n = 0;
+    c->mean = 0;
+    c->m2 = 0;
+    c->warm = warm;
+    c->warm_used = false;
+    c->saved_offset = saved_offset;
+    c->offset = 0;
+}
+
+gyro_calib_status_t gyro_calib_add(gyro_calib_t *c, int rate) {
+    // Moved: a sample far from the mean of the previous ones
+    if(c->n >= 2 && fabsf(rate - c->mean) > GYRO_CALIB_MAX_JUMP) {
+        gyro_calib_init(c, c->warm, c->saved_offset);
+        return GYRO_CALIB_MOVED;
+    }
+
+    // Welford's algorithm
+    c->n++;
+    float delta = rate - c->mean;
+    c->mean += delta / c->n;
+    c->m2 += delta * (rate - c->mean);
+
+    if(c->n < GYRO_CALIB_MIN_SAMPLES)
+        return GYRO_CALIB_BUSY;
+
+    float variance = c->m2 / (c->n - 1);
+    if(variance > GYRO_CALIB_MAX_STDDEV * GYRO_CALIB_MAX_STDDEV) {
+        gyro_calib_init(c, c->warm, c->saved_offset);
+        return GYRO_CALIB_MOVED;
+    }
+
+    // The rate is an integer, so the mean is never known better than the quantization noise (1/12 deg^2/s^2)
+    if(variance < 1.0f / 12)
+        variance = 1.0f / 12;
+    float error = sqrtf(variance / c->n);
+
+    if(c->warm && c->n == GYRO_CALIB_MIN_SAMPLES
+       && fabsf(c->mean - c->saved_offset) <= fmaxf(GYRO_CALIB_WARM_TOLERANCE, 3 * error)) {
+        c->warm_used = true;
+        c->offset = c->saved_offset;
+        return GYRO_CALIB_DONE;
+    }
+    if(error <= GYRO_CALIB_MAX_ERROR || c->n >= GYRO_CALIB_MAX_SAMPLES) {
+        c->offset = c->mean;
+        return GYRO_CALIB_DONE;
+    }
+
+    return GYRO_CALIB_BUSY;
+}
+
+float gyro_calib_get_offset(const gyro_calib_t *c) {
+    return c->offset;
+}
+
+bool_t gyro_calib_load(float *offset) {
+    FILE *fp = fopen(GYRO_CALIB_FILE, "r");
+    long value;
+
+    if(fp == NULL)
+        return false;
+    int ok = fscanf(fp, "%ld", &value) == 1;
+    fclose(fp);
+    if(!ok || labs(value) > (long)(GYRO_CALIB_MAX_OFFSET * 1000))
+        return false;
+
+    *offset = value / 1000.0f;
+    return true;
+}
+
+bool_t gyro_calib_save(float offset) {
+    FILE *fp = fopen(GYRO_CALIB_FILE, "w");
+
+    if(fp == NULL)
+        return false;
+    fprintf(fp, "%ld\n", lroundf(offset * 1000));
+    fclose(fp);
+    return true;
+}
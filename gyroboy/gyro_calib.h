@@ -0,0 +1,75 @@
+/**
+ * Online calibration of the gyro sensor offset.
+ *
+ * balance_task() feeds one sample per loop (gyro_calib_add), so the calibration runs on the same
+ * period as the balancing loop instead of blocking the task in a fixed 200-sample loop.
+ * The mean and variance of the samples are updated online (Welford's algorithm), and the calibration
+ * finishes as soon as the offset is statistically stable:
+ *  - cold start: the standard error of the mean is below GYRO_CALIB_MAX_ERROR.
+ *  - warm start: after GYRO_CALIB_MIN_SAMPLES, the mean agrees with the offset saved by the previous run
+ *    (gyro_calib_load/save), which was refined by the balancing loop and is used as is.
+ * The samples are discarded and the calibration restarts when the robot is moved.
+ *
+ * The file does not call the EV3 API, so it can also be linked into the host simulator (sim/pendulum.c).
+ */
+
+#ifndef GYRO_CALIB_H
+#define GYRO_CALIB_H
+
+#include "ev3api.h"
+
+/**
+ * Constants for the calibration.
+ */
+#define GYRO_CALIB_MIN_SAMPLES      20          // Samples before any decision (100 ms at 5 ms)
+#define GYRO_CALIB_MAX_SAMPLES      400         // Accept the mean anyway after this many samples
+#define GYRO_CALIB_MAX_ERROR        0.1f        // Standard error of the mean to finish a cold start (deg/s)
+#define GYRO_CALIB_MAX_STDDEV       1.5f        // Above this standard deviation the robot is moving (deg/s)
+#define GYRO_CALIB_MAX_JUMP         5.0f        // A sample this far from the mean means the robot was moved (deg/s)
+#define GYRO_CALIB_WARM_TOLERANCE   0.5f        // Allowed difference between the saved offset and the mean (deg/s)
+#define GYRO_CALIB_MAX_OFFSET       50.0f       // Saved offsets beyond this are ignored (deg/s)
+
+/**
+ * File on the SD card (in the directory of the application) holding the last good offset, in 1e-3 deg/s.
+ */
+#define GYRO_CALIB_FILE             "gyroboy_offset.txt"
+
+typedef enum {
+    GYRO_CALIB_BUSY,    // Keep feeding samples
+    GYRO_CALIB_DONE,    // The offset is ready (gyro_calib_get_offset)
+    GYRO_CALIB_MOVED,   // The robot was moved, the calibration restarted
+} gyro_calib_status_t;
+
+typedef struct {
+    int     n;                  // Number of samples
+    float   mean;               // Mean of the samples (deg/s)
+    float   m2;                 // Sum of squared differences from the mean (deg/s)^2
+    bool_t  warm;               // A saved offset is available
+    bool_t  warm_used;          // The calibration finished with the saved offset
+    float   saved_offset;       // Saved offset (deg/s)
+    float   offset;             // Result (deg/s)
+} gyro_calib_t;
+
+/**
+ * Start the calibration, with the offset saved by the previous run if warm is true.
+ */
+void gyro_calib_init(gyro_calib_t *c, bool_t warm, float saved_offset);
+
+/**
+ * Add one sample of the gyro rate (deg/s).
+ */
+gyro_calib_status_t gyro_calib_add(gyro_calib_t *c, int rate);
+
+/**
+ * Result of the calibration (deg/s), valid after GYRO_CALIB_DONE.
+ */
+float gyro_calib_get_offset(const gyro_calib_t *c);
+
+/**
+ * Load/save the last good offset (deg/s) from/to GYRO_CALIB_FILE.
+ * gyro_calib_load returns false when there is no valid file.
+ */
+bool_t gyro_calib_load(float *offset);
+bool_t gyro_calib_save(float offset);
+
+#endif
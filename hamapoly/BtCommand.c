@@ -0,0 +1,191 @@
+// Bluetoothのバイナリコマンドを1バイトずつ受け取ってフレームを組み立て、走行パラメータを読み書きする
+// bt_taskから呼ぶ(フレーム形式はBtCommand.hを参照)
+
+#include <string.h>
+#include "BtCommand.h"
+
+/* 受信状態 */
+typedef enum {
+    WAIT_SYNC,
+    WAIT_CMD,
+    WAIT_LEN,
+    WAIT_DATA,
+    WAIT_SUM
+} RX_STATE;
+
+static RX_STATE rx_state = WAIT_SYNC;
+static uint8_t  rx_cmd;
+static uint8_t  rx_len;
+static uint8_t  rx_pos;
+static uint8_t  rx_sum;
+static uint8_t  rx_data[BT_COMMAND_DATA_MAX];
+
+/* リトルエンディアンの4バイトを読む */
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* リトルエンディアンの4バイトを書く */
+static void put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+/* 応答を送信する(Bluetoothへの書き込みはtelemetry_taskが行う) */
+static void reply(uint8_t cmd, const uint8_t *data, uint8_t len)
+{
+    uint8_t frame[BT_COMMAND_DATA_MAX + 4];
+    uint8_t sum;
+    int i;
+
+    frame[0] = BT_COMMAND_SYNC;
+    frame[1] = cmd | 0x80;
+    frame[2] = len;
+    memcpy(&frame[3], data, len);
+
+    sum = 0;
+    for(i = 1; i < len + 3; i++)
+        sum += frame[i];
+    frame[len + 3] = sum;
+
+    Telemetry_queue(frame, len + 4);    // キューに空きが無い場合は送らない(ホスト側のタイムアウトで再送する)
+}
+
+/* 受信したフレームを実行する */
+static void execute()
+{
+    uint8_t out[BT_COMMAND_DATA_MAX];
+    uint8_t len = 2;
+    const char *key;
+    PARAM_TYPE type;
+    uint32_t value;
+    int result;
+
+    out[0] = BT_STATUS_OK;
+    out[1] = rx_data[0];                                        // id
+
+    switch(rx_cmd)
+    {
+        case 'I': // 情報 *********************************************************************
+            if(rx_len != 1)
+                out[0] = BT_STATUS_BAD_CMD;
+            else if(Param_getInfo(rx_data[0], &key, &type) != 0)
+                out[0] = BT_STATUS_BAD_ID;
+            else
+            {
+                out[2] = type;
+                len = 3 + strlen(key);
+                if(len > BT_COMMAND_DATA_MAX)
+                    len = BT_COMMAND_DATA_MAX;
+                memcpy(&out[3], key, len - 3);
+            }
+            break;
+
+        case 'R': // 読み出し *****************************************************************
+            if(rx_len != 1)
+                out[0] = BT_STATUS_BAD_CMD;
+            else if(Param_read(rx_data[0], &value) != 0)
+                out[0] = BT_STATUS_BAD_ID;
+            else
+            {
+                put_u32(&out[2], value);
+                len = 6;
+            }
+            break;
+
+        case 'W': // 書き込み *****************************************************************
+            if(rx_len != 5)
+                out[0] = BT_STATUS_BAD_CMD;
+            else
+            {
+                result = Param_write(rx_data[0], get_u32(&rx_data[1]));
+                if(result == -1)
+                    out[0] = BT_STATUS_BAD_ID;
+                else if(result == -2)
+                    out[0] = BT_STATUS_BAD_VALUE;
+            }
+            break;
+
+        case 'C': // 反映 *********************************************************************
+            if(rx_len != 0)
+                out[0] = BT_STATUS_BAD_CMD;
+            else
+            {
+                put_u32(&out[1], Param_commit());
+                len = 5;
+            }
+            break;
+
+        default: // ****************************************************************************
+            out[0] = BT_STATUS_BAD_CMD;
+            len = 1;
+            break;
+    }
+
+    reply(rx_cmd, out, len);
+}
+
+/* 初期化関数 */
+void BtCommand_init()
+{
+    rx_state = WAIT_SYNC;
+}
+
+/* 受信した1バイトを処理する関数 */
+int BtCommand_put(uint8_t c)
+{
+    uint8_t status;
+
+    switch(rx_state)
+    {
+        case WAIT_SYNC:
+            if(c != BT_COMMAND_SYNC)                // コマンド以外のバイト
+                return 0;
+            rx_state = WAIT_CMD;
+            break;
+
+        case WAIT_CMD:
+            rx_cmd = c;
+            rx_sum = c;
+            rx_state = WAIT_LEN;
+            break;
+
+        case WAIT_LEN:
+            rx_len = c;
+            rx_sum += c;
+            rx_pos = 0;
+            if(rx_len > BT_COMMAND_DATA_MAX)        // 長すぎるフレームは捨てる
+            {
+                status = BT_STATUS_BAD_CMD;
+                reply(rx_cmd, &status, 1);
+                rx_state = WAIT_SYNC;
+            }
+            else
+                rx_state = (rx_len > 0) ? WAIT_DATA : WAIT_SUM;
+            break;
+
+        case WAIT_DATA:
+            rx_data[rx_pos++] = c;
+            rx_sum += c;
+            if(rx_pos == rx_len)
+                rx_state = WAIT_SUM;
+            break;
+
+        case WAIT_SUM:
+            if(c == rx_sum)
+                execute();
+            else
+            {
+                status = BT_STATUS_BAD_SUM;
+                reply(rx_cmd, &status, 1);
+            }
+            rx_state = WAIT_SYNC;
+            break;
+    }
+
+    return 1;
+}
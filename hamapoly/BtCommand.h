@@ -0,0 +1,37 @@
+#ifndef _BTCOMMAND_H_
+#define _BTCOMMAND_H_
+
+#include "ev3api.h"
+#include "Param.h"
+#include "Telemetry.h"
+
+/* Bluetoothのバイナリコマンド(走行中の走行パラメータの読み書き) *******************************************/
+// フレーム : SYNC(0xA5) コマンド 長さ データ[長さ] チェックサム
+//            チェックサムはコマンド・長さ・データの和の下位8bit、多バイトの値はリトルエンディアン
+// 応答     : SYNC (コマンド | 0x80) 長さ データ[長さ] チェックサム、データの先頭は結果(BT_STATUS_*)
+//
+//  コマンド            データ                  応答のデータ
+//  'I' 情報            id                      結果 id 型(0:int32 1:float) キー名(終端無し)
+//  'R' 読み出し        id                      結果 id 値[4]
+//  'W' 書き込み        id 値[4]                結果 id
+//  'C' 反映            無し                    結果 版数[4]
+//
+// 'W'で書き込んだ値は'C'を送るまで反映されず、'C'までの値はまとめて同じ周期に反映される
+// SYNC以外で始まるバイトはコマンドとして扱わない(リモートスタートの'1'などはそのまま使える)
+
+#define BT_COMMAND_SYNC     0xA5
+#define BT_COMMAND_DATA_MAX 32      // データの最大長
+
+#define BT_STATUS_OK        0       // 成功
+#define BT_STATUS_BAD_ID    1       // idが範囲外
+#define BT_STATUS_BAD_VALUE 2       // 値が範囲外
+#define BT_STATUS_BAD_SUM   3       // チェックサムが一致しない
+#define BT_STATUS_BAD_CMD   4       // 不明なコマンド、またはデータの長さが不正
+
+/* 初期化関数 */
+void BtCommand_init();
+
+/* 受信した1バイトを処理する(応答はTelemetry_queueで送信する) 返り値 : 1(コマンドとして処理した)/0(コマンド以外のバイト) */
+int BtCommand_put(uint8_t c);
+
+#endif
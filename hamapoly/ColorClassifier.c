@@ -0,0 +1,62 @@
+// RGB値による色判定をテーブル参照で行う
+// 各色の判定範囲(キャリブレーション値)から、R,G,Bそれぞれの値ごとに「範囲内にある色」のビットを並べたテーブルを作成しておき、
+// 判定時は3つのテーブルのANDを取って、範囲内にある色の組を得る(比較・分岐なし)
+
+#include "ColorClassifier.h"
+
+#define COLOR_TABLE_SIZE 256    // RGB値のテーブルの要素数(これ以上の値は255として扱う)
+
+/* 色の判定範囲(下限,上限を含む) */
+typedef struct {
+    uint16_t    r_min, r_max;
+    uint16_t    g_min, g_max;
+    uint16_t    b_min, b_max;
+} COLOR_RANGE;
+
+/* キャリブレーション値(COLOR_CLASSの順) *各区間の判定式の閾値をそのまま範囲にしたもの */
+static const COLOR_RANGE ranges[TNUM_COLOR_CLASS] = {
+    //  R           G           B
+    {   0,  74,     0,  94,     121, 255 },     // COLOR_CLASS_BLUE         r < 75 && g < 95 && b > 120
+    {   91, 255,    91, 255,    0,   29  },     // COLOR_CLASS_YELLOW       r > 90 && g > 90 && b < 30
+    {   76, 255,    0,  39,     0,   49  },     // COLOR_CLASS_RED          r > 75 && g < 40 && b < 50
+    {   0,  59,     0,  89,     0,   89  },     // COLOR_CLASS_BLACK        r < 60 && g < 90 && b < 90
+    {   0,  59,     0,  59,     0,   59  },     // COLOR_CLASS_BLACK_BLOCK  r < 60 && g < 60 && b < 60
+    {   0,  64,     0,  74,     0,   94  },     // COLOR_CLASS_BLACK_SLALOM r < 65 && g < 75 && b < 95
+};
+
+static uint8_t table_r[COLOR_TABLE_SIZE];   // R値ごとの範囲内の色のビット
+static uint8_t table_g[COLOR_TABLE_SIZE];   // G値ごとの範囲内の色のビット
+static uint8_t table_b[COLOR_TABLE_SIZE];   // B値ごとの範囲内の色のビット
+
+/* 初期化関数 */
+void ColorClassifier_init() {
+    unsigned int i, j;
+
+    for(i = 0; i < COLOR_TABLE_SIZE; i++)
+    {
+        table_r[i] = table_g[i] = table_b[i] = 0;
+        for(j = 0; j < TNUM_COLOR_CLASS; j++)
+        {
+            if(ranges[j].r_min <= i && i <= ranges[j].r_max) table_r[i] |= 1 << j;
+            if(ranges[j].g_min <= i && i <= ranges[j].g_max) table_g[i] |= 1 << j;
+            if(ranges[j].b_min <= i && i <= ranges[j].b_max) table_b[i] |= 1 << j;
+        }
+    }
+}
+
+/* RGB値が判定範囲に入る色の組を取得する */
+COLOR_SET ColorClassifier_get(const rgb_raw_t *rgb) {
+    uint16_t r = rgb->r < COLOR_TABLE_SIZE ? rgb->r : COLOR_TABLE_SIZE - 1;
+    uint16_t g = rgb->g < COLOR_TABLE_SIZE ? rgb->g : COLOR_TABLE_SIZE - 1;
+    uint16_t b = rgb->b < COLOR_TABLE_SIZE ? rgb->b : COLOR_TABLE_SIZE - 1;
+
+    return table_r[r] & table_g[g] & table_b[b];
+}
+
+/* 複数のRGB値の色をまとめて判定する */
+void ColorClassifier_getBatch(const rgb_raw_t *rgb, COLOR_SET *set, int num) {
+    int i;
+
+    for(i = 0; i < num; i++)
+        set[i] = ColorClassifier_get(&rgb[i]);
+}
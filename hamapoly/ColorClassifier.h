@@ -0,0 +1,32 @@
+#ifndef _COLORCLASSIFIER_H_
+#define _COLORCLASSIFIER_H_
+
+#include "ev3api.h"
+
+/* 判定する色(ColorClassifier.cの判定範囲の表の行) *黒は検知する箇所ごとに閾値が異なるため、箇所ごとに分ける */
+typedef enum {
+    COLOR_CLASS_BLUE = 0,       // 青
+    COLOR_CLASS_YELLOW,         // 黄
+    COLOR_CLASS_RED,            // 赤
+    COLOR_CLASS_BLACK,          // 黒(ラインへの復帰 : Run_setStop_Line, スクリプトのuntil_color)
+    COLOR_CLASS_BLACK_BLOCK,    // 黒(ブロック区間)
+    COLOR_CLASS_BLACK_SLALOM,   // 黒(スラローム区間の終わり)
+    TNUM_COLOR_CLASS            // 8色まで
+} COLOR_CLASS;
+
+/* 判定範囲に入った色の組(ビットiがCOLOR_CLASSのiに対応) */
+typedef uint8_t COLOR_SET;
+
+/* 色の組にcが含まれるか */
+#define COLOR_IN(set, c)    (((set) >> (c)) & 1)
+
+/* 初期化関数(判定用テーブルを作成する) */
+void ColorClassifier_init();
+
+/* RGB値が判定範囲に入る色の組を取得する */
+COLOR_SET ColorClassifier_get(const rgb_raw_t *rgb);
+
+/* 複数のRGB値の色をまとめて判定する(ログ解析用) */
+void ColorClassifier_getBatch(const rgb_raw_t *rgb, COLOR_SET *set, int num);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef _COURSE_H_
+#define _COURSE_H_
+
+// コースごとの設定
+// ビルド時に COURSE_R / COURSE_L / COURSE_LL のいずれかを定義して選択する(Makefile.incの COURSE で指定)
+// 全てコンパイル時の定数なので、符号の反転や分岐は最適化で畳み込まれ、実行時の判定は残らない
+//
+// COURSE_NAME               : コース名(チューニングファイル名などに使う)
+// COURSE_TURN_SIGN          : motor_ctrlのturnに掛ける符号(走行体の左右モーターの取り付けに合わせる)
+// COURSE_KP/KI/KD           : ライントレースのPIDゲイン(power100での値)
+// COURSE_LINE_TARGET        : ライントレース区間のrgb.rの目標値
+// COURSE_LINE_BLUE_DISTANCE : ライントレース区間で青ラインの検知を有効にする走行距離
+// COURSE_LINE_EIGHT         : 1 で青ライン検知後にEIGHT状態(8の字走行)へ移る、0 で減速して区間を終える
+// COURSE_SLALOM             : 1 でライントレース区間の後にスラローム区間を走る、0 で終了する
+// COURSE_SLALOM_MIRROR      : 1 でスラローム区間の旋回方向とトレースするラインの側を左右反転する
+// COURSE_SLALOM_TALE        : 1 で段差を上る際に尻尾を使う
+// COURSE_SONIC_THRESHOLD    : sampling_sonicでパターンAと判別する検知回数(100回中)
+// COURSE_TURN_WINDOW        : sampling_turnで平均をとる旋回量の個数
+// COURSE_TURN_STRAIGHT      : sampling_turnで直進と判定する旋回量の平均値
+
+#if defined(COURSE_R)
+#define COURSE_NAME                 "R"
+#define COURSE_TURN_SIGN            -1
+#define COURSE_KP                   0.30
+#define COURSE_KI                   0.20
+#define COURSE_KD                   0.00
+#define COURSE_LINE_TARGET          64
+#define COURSE_LINE_BLUE_DISTANCE   10000
+#define COURSE_LINE_EIGHT           0
+#define COURSE_SLALOM               1
+#define COURSE_SLALOM_MIRROR        0
+#define COURSE_SLALOM_TALE          1
+#define COURSE_SONIC_THRESHOLD      50
+#define COURSE_TURN_WINDOW          30
+#define COURSE_TURN_STRAIGHT        10
+
+#elif defined(COURSE_L)
+#define COURSE_NAME                 "L"
+#define COURSE_TURN_SIGN            1
+#define COURSE_KP                   1.50
+#define COURSE_KI                   0.51
+#define COURSE_KD                   0.30
+#define COURSE_LINE_TARGET          60
+#define COURSE_LINE_BLUE_DISTANCE   1
+#define COURSE_LINE_EIGHT           1
+#define COURSE_SLALOM               0
+#define COURSE_SLALOM_MIRROR        0
+#define COURSE_SLALOM_TALE          1
+#define COURSE_SONIC_THRESHOLD      80
+#define COURSE_TURN_WINDOW          100
+#define COURSE_TURN_STRAIGHT        7
+
+#elif defined(COURSE_LL)
+#define COURSE_NAME                 "LL"
+#define COURSE_TURN_SIGN            -1
+#define COURSE_KP                   0.88
+#define COURSE_KI                   0.16
+#define COURSE_KD                   0.53
+#define COURSE_LINE_TARGET          64
+#define COURSE_LINE_BLUE_DISTANCE   1500
+#define COURSE_LINE_EIGHT           0
+#define COURSE_SLALOM               1
+#define COURSE_SLALOM_MIRROR        1
+#define COURSE_SLALOM_TALE          0
+#define COURSE_SONIC_THRESHOLD      50
+#define COURSE_TURN_WINDOW          30
+#define COURSE_TURN_STRAIGHT        10
+
+#else
+#error "COURSE_R / COURSE_L / COURSE_LL のいずれかを定義してください"
+#endif
+
+#endif
@@ -4,6 +4,9 @@
 // #include "parameter.h"
 #include "Distance.h"
 
+/* 車体トレッド幅[mm](約140.0mm *ETロボコンシミュレータの取扱説明書参照) -> (150.0mm *2020年ADVクラスのDENSOチームのモデル図に記載) */
+#define TREAD 150.0
+
 /* 初期化 */
 void Direction_init();
 
@@ -3,8 +3,6 @@
 
 #include "Distance.h"
 
-#define TIRE_DIAMETER 90.0  //タイヤ直径(約90mm *ETロボコンシミュレータの取扱説明書参照) -> (90.0mm *2020年ADVクラスのDENSOチームのモデル図に記載)
-
 static float distance = 0.0;     //走行距離
 static float distance4msL = 0.0; //左タイヤの4ms間の距離
 static float distance4msR = 0.0; //右タイヤの4ms間の距離
@@ -15,21 +13,28 @@ static float angle4msR = 0.0; //右タイヤの4ms間の角度
 
 /* 初期化関数 */
 void Distance_init() {
+    SENSOR_SNAPSHOT sensor;
+
     //各変数の値の初期化
     distance = 0.0;
     distance4msR = 0.0;
     distance4msL = 0.0;
-    //モータ角度の過去値に現在値を代入
-    pre_angleL = ev3_motor_get_counts(EV3_PORT_C);
-    pre_angleR = ev3_motor_get_counts(EV3_PORT_B);
+    //モータ角度の過去値に現在値を代入(Distance_updateと同じくSensorHubのスナップショットを使用)
+    SensorHub_get(&sensor);
+    pre_angleL = sensor.count_left;
+    pre_angleR = sensor.count_right;
 }
 
 /* 距離更新（4ms間の移動距離を毎回加算している） */
 void Distance_update(){
-    float cur_angleL = ev3_motor_get_counts(EV3_PORT_C); //左モータ回転角度の現在値
-    float cur_angleR = ev3_motor_get_counts(EV3_PORT_B);//右モータ回転角度の現在値
+    SENSOR_SNAPSHOT sensor;
+    float cur_angleL, cur_angleR;
     float distance4ms = 0.0;        //4msの距離
 
+    SensorHub_get(&sensor);
+    cur_angleL = sensor.count_left;     //左モータ回転角度の現在値
+    cur_angleR = sensor.count_right;    //右モータ回転角度の現在値
+
     // 4ms間の走行距離 = ((円周率 * タイヤの直径) / 360) * (モータ角度過去値　- モータ角度現在値)
     distance4msL = ((PI * TIRE_DIAMETER) / 360.0) * (cur_angleL - pre_angleL);  // 4ms間の左モータ距離
     distance4msR = ((PI * TIRE_DIAMETER) / 360.0) * (cur_angleR - pre_angleR);  // 4ms間の右モータ距離
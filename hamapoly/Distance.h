@@ -2,11 +2,15 @@
 #define _DISTANCE_H_
 
 #include "ev3api.h"
+#include "SensorHub.h"
 // #include "parameter.h"
 
 /* 円周率 */
 #define PI 3.14159265358
 
+/* タイヤ直径[mm](約90mm *ETロボコンシミュレータの取扱説明書参照) -> (90.0mm *2020年ADVクラスのDENSOチームのモデル図に記載) */
+#define TIRE_DIAMETER 90.0
+
 /* 初期化関数 */
 void Distance_init();
 
@@ -0,0 +1,116 @@
+// 表駆動の状態機械(動作はFsm.hを参照)
+// 各区間の状態の処理はswitch文ではなく表の関数ポインタで呼び出すため、毎周期の分岐は状態の数によらない
+
+#include "Run.h"
+
+/* 遷移の履歴 */
+typedef struct {
+    uint32_t    time;       // 開始からの時刻[ms]
+    uint32_t    ticks;      // 遷移元に留まった周期数
+    uint8_t     from;
+    uint8_t     to;
+} FSM_HISTORY;
+
+static const FSM_TABLE *last_table = NULL;          // 直前に実行した表
+static FSM_HISTORY history[FSM_HISTORY_SIZE];
+static uint32_t history_count = 0;                  // 記録した遷移の総数
+
+/* 関数ポインタがNULLでなければ呼ぶ */
+static void call(FSM_ACTION action)
+{
+    if(action != NULL)
+        action();
+}
+
+/* 無条件の遷移に使う条件 */
+bool_t Fsm_always(void)
+{
+    return true;
+}
+
+/* 表の状態機械を実行する関数 */
+void Fsm_run(const FSM_TABLE *table)
+{
+    const FSM_STATE *s;
+    const FSM_TRANSITION *t;
+    FSM_HISTORY *h;
+    HRTCNT start = fch_hrt();
+    uint32_t ticks = 0;         // 現在の状態に留まった周期数
+    uint8_t state = table->initial;
+    int i;
+
+    last_table = table;
+    history_count = 0;
+
+    LoopTiming_start(table->timing);    // 処理時間の計測を開始
+    call(table->state[state].entry);
+
+    while(1)
+    {
+        call(table->update);            // 今周期の値を更新
+
+        Telemetry_setState(table->section, state);  // テレメトリ用に状態を記録
+        LoopTiming_setState(table->timing, state);  // 処理時間の計測用に状態を記録
+
+        s = &table->state[state];
+        call(s->tick);
+        ++ticks;
+
+        for(i = 0; i < FSM_TRANSITION_MAX && (t = &s->transition[i])->guard != NULL; i++)
+        {
+            if(!t->guard())
+                continue;
+
+            h = &history[history_count++ % FSM_HISTORY_SIZE];   // 履歴を記録
+            h->time  = (fch_hrt() - start) / 1000;
+            h->ticks = ticks;
+            h->from  = state;
+            h->to    = t->next;
+            log_stamp((char *)(t->stamp != NULL ? t->stamp : table->state[t->next].name));
+
+            call(s->exit);
+            state = t->next;
+            ticks = 0;
+            call(table->state[state].entry);
+            break;
+        }
+
+        if(state == table->final)       // 終了する状態に遷移した場合
+            return;
+
+        LoopTiming_sleep(table->timing, RUN_PERIOD);    /* 4msec周期起動(本来の起床時刻まで待機し、実行時間と起床の遅れを記録) */
+    }
+}
+
+/* 遷移の履歴をファイルに追記する関数 */
+void Fsm_save(const char *filename)
+{
+    FILE *fp;
+    const FSM_HISTORY *h;
+    uint32_t i, first;
+
+    if(last_table == NULL)
+        return;
+
+    fp = fopen(filename, "a");
+    if(fp == NULL)                      // オープンに失敗した場合は書き出さない(走行は続ける)
+    {
+        printf("cannot open %s\n", filename);
+        return;
+    }
+
+    first = (history_count > FSM_HISTORY_SIZE) ? history_count - FSM_HISTORY_SIZE : 0;
+    fprintf(fp, "# %s の状態遷移 : 時刻[ms] 遷移元 -> 遷移先 (遷移元に留まった周期数)", last_table->name);
+    if(first > 0)
+        fprintf(fp, "、古い%lu件は省略", (unsigned long)first);
+    fprintf(fp, "\n");
+
+    for(i = first; i < history_count; i++)
+    {
+        h = &history[i % FSM_HISTORY_SIZE];
+        fprintf(fp, "%8lu  %s -> %s (%lu)\n", (unsigned long)h->time,
+                last_table->state[h->from].name, last_table->state[h->to].name, (unsigned long)h->ticks);
+    }
+
+    fclose(fp);
+}
@@ -0,0 +1,59 @@
+#ifndef _FSM_H_
+#define _FSM_H_
+
+#include "ev3api.h"
+
+/* 表駆動の状態機械(各区間のメインループ) *******************************************************************/
+// 各区間は状態の表(const、フラッシュに置く)を定義してFsm_runを呼ぶ。Fsm_runはRUN_PERIOD周期で以下を繰り返す
+//  1. 表のupdateを呼ぶ(今周期のセンサー値などを取得)
+//  2. 現在の状態のtickを呼ぶ
+//  3. 現在の状態の遷移を先頭から評価し、最初に条件(guard)が成立した遷移を行う
+//     (現在の状態のexit -> 次の状態のentry の順に呼ぶ、次の状態のtickは次の周期から)
+//  4. 表のfinalの状態に遷移したら、そのentryを呼んで終了する
+// 遷移のたびにログに文字列を添付し(log_stamp)、遷移の履歴(時刻、状態に留まった周期数)を記録する
+// テレメトリの状態と処理時間の計測(LoopTiming)の状態は、表の状態番号で自動的に設定する
+
+#define FSM_TRANSITION_MAX  3       // 1つの状態から出る遷移の最大数
+#define FSM_HISTORY_SIZE    32      // 記録する遷移の履歴の数(超えた分は古い方から捨てる)
+
+typedef void   (*FSM_ACTION)(void);
+typedef bool_t (*FSM_GUARD)(void);
+
+/* 遷移(guardがNULLの要素で終端) */
+typedef struct {
+    FSM_GUARD   guard;      // 遷移の条件(無条件の場合はFsm_always)
+    uint8_t     next;       // 遷移先の状態
+    const char *stamp;      // ログに添付する文字列(NULLの場合は遷移先の状態名、文字列リテラルを指定すること)
+} FSM_TRANSITION;
+
+/* 状態(entry, tick, exitはNULLで何もしない) */
+typedef struct {
+    const char     *name;       // 状態名(ログ・履歴用)
+    FSM_ACTION      entry;      // 状態に入った時に1回呼ぶ
+    FSM_ACTION      tick;       // 状態に留まっている間、毎周期呼ぶ
+    FSM_ACTION      exit;       // 状態から出る時に1回呼ぶ
+    FSM_TRANSITION  transition[FSM_TRANSITION_MAX];
+} FSM_STATE;
+
+/* 状態機械の表 */
+typedef struct {
+    const char      *name;      // 区間名(履歴用)
+    const FSM_STATE *state;     // 状態の表(添字が状態番号)
+    uint8_t         state_num;
+    uint8_t         initial;    // 最初の状態
+    uint8_t         final;      // 終了する状態
+    uint8_t         section;    // テレメトリの区間(TELEMETRY_SECTION_*)
+    uint8_t         timing;     // 処理時間の計測対象(LOOP_TIMING_*)
+    FSM_ACTION      update;     // 毎周期最初に呼ぶ(NULLで何もしない)
+} FSM_TABLE;
+
+/* 無条件の遷移に使う条件 */
+bool_t Fsm_always(void);
+
+/* 表の状態機械を最初の状態から終了する状態まで実行する(main_taskから呼ぶ) */
+void Fsm_run(const FSM_TABLE *table);
+
+/* 直前に実行した状態機械の遷移の履歴をファイルに追記する(区間の終了後にmain_taskから呼ぶ) */
+void Fsm_save(const char *filename);
+
+#endif
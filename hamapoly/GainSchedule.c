@@ -0,0 +1,130 @@
+// 走行出力と走行路の曲率に応じたPIDゲインのスケジューリング
+// テーブルは基準ゲイン(走行パラメータのline.kp, line.ki, line.kd 既定値はCourse.hのCOURSE_KP等)に対する倍率で、出力と曲率の2軸で線形補間する
+
+#include "GainSchedule.h"
+
+#define POWER_NUM       5
+#define CURVATURE_NUM   4
+
+#define CURVATURE_FILTER    0.1     // 曲率推定のローパスフィルタ係数
+#define CURVATURE_MIN_MOVE  0.5     // 曲率を推定する最小移動距離[mm](停止中は更新しない)
+
+/* テーブルの軸 */
+static const int16_t power_axis[POWER_NUM] = { 0, 40, 60, 80, 100 };    // 走行出力
+static const int16_t curvature_axis[CURVATURE_NUM] = { 0, 10, 20, 40 }; // 曲率[deg/100mm] (半径約570mm, 290mm, 140mm)
+
+/* 基準ゲインに対する倍率 [出力][曲率]
+ * 出力80以下は基準ゲインのままとし、出力100ではKPを上げてKIを下げる
+ * シミュレータ(sim/のmake bench、line.power = 100)で調整した値で、基準ゲインのままではRコースが制限時間内に完走できない
+ *      (出力100 KP倍率 / KI倍率)   1.0/1.0 : R 時間切れ, LL 25.65s   2.0/0.75 : R 34.74s, LL 24.98s  (電池電圧90%, 80%でも完走)
+ * シミュレータのコースはカーブが半径1200mm(曲率約5)だけのため、曲率の軸は未調整(全て同じ値) */
+static const float kp_table[POWER_NUM][CURVATURE_NUM] = {
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 2.00, 2.00, 2.00, 2.00 },
+};
+static const float ki_table[POWER_NUM][CURVATURE_NUM] = {
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 0.75, 0.75, 0.75, 0.75 },
+};
+static const float kd_table[POWER_NUM][CURVATURE_NUM] = {
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+    { 1.00, 1.00, 1.00, 1.00 },
+};
+
+static q16_t kp_gain[POWER_NUM][CURVATURE_NUM];     // 倍率を掛けたゲイン(初期化時に計算)
+static q16_t ki_gain[POWER_NUM][CURVATURE_NUM];
+static q16_t kd_gain[POWER_NUM][CURVATURE_NUM];     // 微分ゲイン / 処理周期
+
+static float curvature = 0.0;       // 推定曲率[deg/100mm]
+static float pre_distance = 0.0;    // 前回の走行距離
+static float pre_direction = 0.0;   // 前回の方位
+
+/* 軸の値xが入る区間の番号と、区間内の位置(Q16, 0 ~ 1)を求める */
+static int find_cell(const int16_t *axis, int num, int32_t x, q16_t *t) {
+    int i;
+
+    if(x <= axis[0])
+    {
+        *t = 0;
+        return 0;
+    }
+    for(i = 0; i < num - 2 && x > axis[i + 1]; i++)
+        ;
+    if(x >= axis[i + 1])
+    {
+        *t = Q16_ONE;
+        return i;
+    }
+    *t = (q16_t)(((int64_t)(x - axis[i]) << 16) / (axis[i + 1] - axis[i]));
+    return i;
+}
+
+/* 2軸の線形補間 */
+static q16_t interpolate(q16_t table[POWER_NUM][CURVATURE_NUM], int pi, q16_t pt, int ci, q16_t ct) {
+    q16_t low  = table[pi][ci]     + Q16_MUL(ct, table[pi][ci + 1]     - table[pi][ci]);
+    q16_t high = table[pi + 1][ci] + Q16_MUL(ct, table[pi + 1][ci + 1] - table[pi + 1][ci]);
+
+    return low + Q16_MUL(pt, high - low);
+}
+
+/* 初期化関数 */
+void GainSchedule_init(const PID_CTRL *pid) {
+    GainSchedule_setBase(pid);
+
+    curvature = 0.0;
+    pre_distance = Distance_getDistance();
+    pre_direction = Direction_getDirection();
+}
+
+/* 基準ゲインを変更する(曲率の推定値は保持する) */
+void GainSchedule_setBase(const PID_CTRL *pid) {
+    int i, j;
+
+    for(i = 0; i < POWER_NUM; i++)
+    {
+        for(j = 0; j < CURVATURE_NUM; j++)
+        {
+            kp_gain[i][j] = Q16_MUL(pid->kp, Q16_FROM_FLOAT(kp_table[i][j]));
+            ki_gain[i][j] = Q16_MUL(pid->ki, Q16_FROM_FLOAT(ki_table[i][j]));
+            kd_gain[i][j] = Q16_MUL(pid->kd_dt, Q16_FROM_FLOAT(kd_table[i][j]));
+        }
+    }
+}
+
+/* 走行中の出力と推定曲率からゲインを補間してPIDに設定する */
+void GainSchedule_update(PID_CTRL *pid, int8_t power) {
+    float distance = Distance_getDistance();
+    float direction = Direction_getDirection();
+    float move = fabsf(distance - pre_distance);
+    q16_t pt, ct;
+    int pi, ci;
+
+    if(move >= CURVATURE_MIN_MOVE)          // 曲率 = 方位の変化量 / 移動距離 をローパスフィルタに通す
+    {
+        curvature += CURVATURE_FILTER * (fabsf(direction - pre_direction) * 100.0f / move - curvature);
+        pre_distance = distance;
+        pre_direction = direction;
+    }
+
+    pi = find_cell(power_axis, POWER_NUM, power < 0 ? -power : power, &pt);
+    ci = find_cell(curvature_axis, CURVATURE_NUM, (int32_t)curvature, &ct);
+
+    PID_setGainQ16(pid,
+                   interpolate(kp_gain, pi, pt, ci, ct),
+                   interpolate(ki_gain, pi, pt, ci, ct),
+                   interpolate(kd_gain, pi, pt, ci, ct));
+}
+
+/* 推定曲率[deg/100mm]を取得 */
+float GainSchedule_getCurvature() {
+    return curvature;
+}
@@ -0,0 +1,19 @@
+#ifndef _GAINSCHEDULE_H_
+#define _GAINSCHEDULE_H_
+
+#include "PID.h"
+#include "Direction.h"
+
+/* 初期化関数(現在のPIDゲインを基準ゲインとして記憶し、曲率の推定値をリセットする) */
+void GainSchedule_init(const PID_CTRL *pid);
+
+/* 現在のPIDゲインを新しい基準ゲインとして記憶する(走行中のゲイン変更用、曲率の推定値は保持する) */
+void GainSchedule_setBase(const PID_CTRL *pid);
+
+/* 走行中の出力と推定曲率からゲインを補間してPIDに設定する(毎周期呼ぶ) */
+void GainSchedule_update(PID_CTRL *pid, int8_t power);
+
+/* 推定曲率[deg/100mm]を取得 */
+float GainSchedule_getCurvature();
+
+#endif
@@ -0,0 +1,68 @@
+// 単一書き込み/単一読み出し(SPSC)のロックフリーリングバッファ
+// measure_task(周期ハンドラ,最高優先度)が書き込み、logfile_task(低優先度)が読み出してファイルに出力する
+// headは書き込み側だけが、tailは読み出し側だけが更新するため、排他制御(ロック)は不要
+
+#include <string.h>
+#include "LogBuffer.h"
+
+/* EV3はシングルコアのため、メモリバリアはコンパイラの並べ替え防止のみで十分 */
+#define LOG_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+#define LOG_BUFFER_MASK (LOG_BUFFER_SIZE - 1)
+
+static LOG_RECORD buffer[LOG_BUFFER_SIZE];
+
+static volatile uint32_t head = 0;      // 次に書き込む位置(書き込み側のみ更新)
+static volatile uint32_t tail = 0;      // 次に読み出す位置(読み出し側のみ更新)
+static volatile uint32_t overflow = 0;  // 満杯で破棄したレコード数
+
+/* 初期化関数 *読み書きの両タスクが停止している状態で呼ぶこと */
+void LogBuffer_init() {
+    head = 0;
+    tail = 0;
+    overflow = 0;
+}
+
+/* レコードを書き込む */
+bool_t LogBuffer_push(const LOG_RECORD *record) {
+    uint32_t h = head;
+
+    if(h - tail >= LOG_BUFFER_SIZE)         // バッファが満杯の場合
+    {
+        ++overflow;                             // 破棄したレコード数を加算して
+        return false;                           // 書き込まずに終了(書き込み側を待たせない)
+    }
+
+    memcpy(&buffer[h & LOG_BUFFER_MASK], record, sizeof(LOG_RECORD));
+    LOG_BARRIER();                          // レコードの書き込み完了後にheadを進める
+    head = h + 1;
+
+    return true;
+}
+
+/* 最も古いレコードを取得する */
+const LOG_RECORD *LogBuffer_front() {
+    uint32_t t = tail;
+
+    if(t == head)                           // バッファが空の場合
+        return NULL;
+
+    LOG_BARRIER();                          // headの確認後にレコードを読み出す
+    return &buffer[t & LOG_BUFFER_MASK];
+}
+
+/* LogBuffer_frontで取得したレコードを解放する *レコードの使用が終わってから呼ぶこと */
+void LogBuffer_release() {
+    LOG_BARRIER();
+    tail = tail + 1;
+}
+
+/* バッファが空かどうかを取得 */
+bool_t LogBuffer_isEmpty() {
+    return head == tail;
+}
+
+/* バッファが満杯で書き込めなかったレコード数を取得 */
+uint32_t LogBuffer_getOverflow() {
+    return overflow;
+}
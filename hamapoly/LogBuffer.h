@@ -0,0 +1,39 @@
+#ifndef _LOGBUFFER_H_
+#define _LOGBUFFER_H_
+
+#include "ev3api.h"
+
+/* リングバッファの要素数(2のべき乗にすること) */
+#define LOG_BUFFER_SIZE 512
+
+/* 1周期分の計測値(固定長バイナリレコード) */
+typedef struct {
+    float       distance;   // 走行距離
+    float       direction;  // 方位
+    uint32_t    time;       // 走行時間(5ms単位)
+    uint16_t    r, g, b;    // RGB値
+    int16_t     angle;      // 位置角(傾き)
+    int16_t     turn;       // 旋回値
+    int8_t      power;      // モーター出力
+    const char  *stamp;     // log_stampで指定された文字列(無い場合はNULL)
+} LOG_RECORD;
+
+/* 初期化関数 */
+void LogBuffer_init();
+
+/* レコードを書き込む(書き込み側はmeasure_taskのみ) 返り値 : true(成功)/false(バッファが満杯) */
+bool_t LogBuffer_push(const LOG_RECORD *record);
+
+/* 最も古いレコードを取得する(読み出し側はlogfile_taskのみ) 返り値 : レコードへのポインタ/NULL(バッファが空) */
+const LOG_RECORD *LogBuffer_front();
+
+/* LogBuffer_frontで取得したレコードを解放する */
+void LogBuffer_release();
+
+/* バッファが空かどうかを取得 */
+bool_t LogBuffer_isEmpty();
+
+/* バッファが満杯で書き込めなかったレコード数を取得 */
+uint32_t LogBuffer_getOverflow();
+
+#endif
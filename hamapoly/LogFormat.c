@@ -0,0 +1,130 @@
+// 計測値ログの差分 + zigzag + varint 符号化
+// 1周期あたり約60byteのテキスト(fprintf)を約10byteのバイナリに圧縮し、書式化の処理も整数演算のみにする
+
+#include <string.h>
+#include "LogFormat.h"
+
+#define LOG_FIELD_NUM 9
+
+/* 項目の定義(テキストログと同じ列の順) */
+typedef struct {
+    const char  *name;      // 項目名
+    uint8_t     decimals;   // 小数桁数
+    uint8_t     scale;      // 倍率
+} LOG_FIELD;
+
+static const LOG_FIELD fields[LOG_FIELD_NUM] = {
+    { "R",          0, 1 },
+    { "G",          0, 1 },
+    { "B",          0, 1 },
+    { "Distance",   3, 1 },     // 0.001mm単位
+    { "Direction",  1, 1 },     // 0.1度単位
+    { "Angle",      0, 1 },
+    { "Power",      0, 1 },
+    { "Turn",       0, 1 },
+    { "Time",       0, 5 },     // 5ms単位 -> ms
+};
+
+static int32_t prev[LOG_FIELD_NUM];    // 前回の格納値(差分の基準)
+
+/* varintを書き込む 返り値 : バイト数 */
+static size_t put_varint(uint8_t *data, uint32_t value)
+{
+    size_t size = 0;
+
+    while(value >= 0x80)
+    {
+        data[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    data[size++] = (uint8_t)value;
+
+    return size;
+}
+
+/* 符号付きの値をzigzag符号化する(0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) */
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/* ヘッダを作成し、差分の基準値を初期化する */
+size_t LogFormat_header(uint8_t *data)
+{
+    size_t size = 0;
+    size_t len;
+    int i;
+
+    memcpy(data, "HLOG", 4);
+    size += 4;
+    data[size++] = LOG_FORMAT_VERSION;
+    data[size++] = LOG_FIELD_NUM;
+
+    for(i = 0; i < LOG_FIELD_NUM; i++)
+    {
+        len = strlen(fields[i].name) + 1;
+        memcpy(&data[size], fields[i].name, len);
+        size += len;
+        data[size++] = fields[i].decimals;
+        data[size++] = fields[i].scale;
+
+        prev[i] = 0;
+    }
+
+    return size;
+}
+
+/* レコードを符号化する */
+size_t LogFormat_encode(const LOG_RECORD *record, uint8_t *data)
+{
+    int32_t value[LOG_FIELD_NUM];
+    int32_t delta;
+    size_t size = 0;
+    size_t len = 0;
+    int i;
+
+    value[0] = record->r;
+    value[1] = record->g;
+    value[2] = record->b;
+    value[3] = (int32_t)lrint(record->distance * 1000.0);   // 積はdoubleで求め(floatでは距離が伸びると最下位桁が丸まる)、printfと同じく偶数丸めにする
+    value[4] = (int32_t)lrint(record->direction * 10.0);
+    value[5] = record->angle;
+    value[6] = record->power;
+    value[7] = record->turn;
+    value[8] = (int32_t)record->time;
+
+    for(i = 0; i < LOG_FIELD_NUM; i++)
+    {
+        delta = (int32_t)((uint32_t)value[i] - (uint32_t)prev[i]);
+        prev[i] = value[i];
+
+        if(i == 0)                                      // 先頭項目にはレコード種別を付加
+            size += put_varint(&data[size], (zigzag(delta) << 2) | (record->stamp != NULL ? LOG_KIND_STAMP : LOG_KIND_SAMPLE));
+        else
+            size += put_varint(&data[size], zigzag(delta));
+    }
+
+    if(record->stamp != NULL)
+    {
+        len = strlen(record->stamp);
+        if(len > LOG_FORMAT_STAMP_MAX)
+            len = LOG_FORMAT_STAMP_MAX;
+
+        size += put_varint(&data[size], len);
+        memcpy(&data[size], record->stamp, len);
+        size += len;
+    }
+
+    return size;
+}
+
+/* ファイル終端を符号化する */
+size_t LogFormat_end(uint32_t overflow, uint8_t *data)
+{
+    size_t size = 0;
+
+    data[size++] = LOG_KIND_END;
+    size += put_varint(&data[size], overflow);
+
+    return size;
+}
@@ -0,0 +1,34 @@
+#ifndef _LOGFORMAT_H_
+#define _LOGFORMAT_H_
+
+#include "LogBuffer.h"
+
+/* バイナリログ形式 *************************************************************************************/
+// ヘッダ   : "HLOG", バージョン(1byte), 項目数(1byte), 項目ごとに [項目名(NUL終端), 小数桁数(1byte), 倍率(1byte)]
+// レコード : 項目ごとに前回値との差分をzigzag符号化し、varint(7bit単位の可変長)で格納する
+//            先頭項目のvarintのみ下位2bitにレコード種別(LOG_KIND_*)を持つ
+//            LOG_KIND_STAMP の場合は項目の後に [文字列長(varint), 文字列] が続く
+//            LOG_KIND_END   の場合は項目を持たず、[オーバーフロー数(varint)] のみが続く
+// 表示値   : 格納値 * 倍率 / 10^小数桁数
+// デコードはホスト側の tools/logdecode.c を使用する
+/*******************************************************************************************************/
+#define LOG_FORMAT_VERSION  1
+
+#define LOG_KIND_SAMPLE     0   // 計測値のみ
+#define LOG_KIND_STAMP      1   // 計測値 + log_stampの文字列
+#define LOG_KIND_END        2   // ファイル終端
+
+#define LOG_FORMAT_HEADER_MAX   128                     // ヘッダの最大バイト数
+#define LOG_FORMAT_STAMP_MAX    255                     // 文字列の最大バイト数
+#define LOG_FORMAT_RECORD_MAX   (9 * 5 + 2 + LOG_FORMAT_STAMP_MAX)  // 1レコードの最大バイト数
+
+/* ヘッダを作成し、差分の基準値を初期化する 返り値 : バイト数 */
+size_t LogFormat_header(uint8_t *data);
+
+/* レコードを符号化する 返り値 : バイト数 */
+size_t LogFormat_encode(const LOG_RECORD *record, uint8_t *data);
+
+/* ファイル終端を符号化する 返り値 : バイト数 */
+size_t LogFormat_end(uint32_t overflow, uint8_t *data);
+
+#endif
@@ -0,0 +1,236 @@
+// 制御ループの実行時間と起床の遅れのヒストグラム(計測方法はLoopTiming.hを参照)
+// 各タスクのヒストグラムはそのタスクだけが更新する。measure_taskのヒストグラムを空にする場合は
+// main_taskが要求フラグを立て、measure_taskが次の起動時に空にする
+
+#include <string.h>
+#include "LoopTiming.h"
+
+/* ヒストグラムの区切り[us] (最後の区間は20000以上) */
+static const uint32_t bucket_edge[LOOP_TIMING_BUCKET_NUM - 1] = {
+    50, 100, 200, 500, 1000, 2000, 3000, 4000, 5000, 10000, 20000
+};
+
+/* 1種類の計測値のヒストグラム */
+typedef struct {
+    uint32_t bucket[LOOP_TIMING_BUCKET_NUM];
+    uint32_t count;
+    uint32_t sum;       // [us]
+    uint32_t max;       // [us]
+} TIMING_HIST;
+
+/* 1タスク分の計測値 */
+typedef struct {
+    TIMING_HIST exec[LOOP_TIMING_STATE_MAX];    // 実行時間
+    TIMING_HIST late[LOOP_TIMING_STATE_MAX];    // 起床の遅れ
+    uint32_t    overrun[LOOP_TIMING_STATE_MAX]; // 超過の回数
+    uint8_t     state;          // 今周期の状態
+    HRTCNT      begin;          // 今周期の起床時刻
+    HRTCNT      expected;       // 次の本来の起床時刻
+    bool_t      started;        // expectedが有効
+    uint32_t    dt;             // 前回の起床から今回の起床まで[us]
+} TIMING_TASK;
+
+static TIMING_TASK timing[LOOP_TIMING_TASK_NUM];
+static uint8_t section = LOOP_TIMING_LINE;          // 実行中の区間(LoopTiming_startで設定)
+static volatile bool_t measure_reset_req = false;   // measure_taskのヒストグラムを空にする要求
+
+static const char *task_name[LOOP_TIMING_TASK_NUM] = { "measure", "line", "slalom", "block" };
+
+/* ヒストグラムに1回分の値を積む */
+static void hist_add(TIMING_HIST *hist, uint32_t value)
+{
+    int i = 0;
+
+    while(i < LOOP_TIMING_BUCKET_NUM - 1 && value >= bucket_edge[i])
+        i++;
+
+    ++hist->bucket[i];
+    ++hist->count;
+    hist->sum += value;
+    if(value > hist->max)
+        hist->max = value;
+}
+
+/* 1タスク分を空にする */
+static void task_reset(TIMING_TASK *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->begin = fch_hrt();
+}
+
+/* ヒストグラムを1行書き出す */
+static void hist_print(FILE *fp, const char *name, int state, const char *kind, const TIMING_HIST *hist)
+{
+    int i;
+
+    if(hist->count == 0)
+        return;
+
+    fprintf(fp, "%-8s %5d %-4s %7lu %7lu %7lu", name, state, kind,
+            (unsigned long)hist->count, (unsigned long)(hist->sum / hist->count), (unsigned long)hist->max);
+    for(i = 0; i < LOOP_TIMING_BUCKET_NUM; i++)
+        fprintf(fp, " %6lu", (unsigned long)hist->bucket[i]);
+    fprintf(fp, "\n");
+}
+
+/* 1タスク分を書き出す 返り値 : 全ての状態の実行時間の最大値[us] (overrunに全ての状態の超過の回数を返す) */
+static uint32_t task_print(FILE *fp, uint8_t task, uint32_t *overrun)
+{
+    const TIMING_TASK *t = &timing[task];
+    uint32_t max = 0;
+    int state;
+
+    *overrun = 0;
+    for(state = 0; state < LOOP_TIMING_STATE_MAX; state++)
+    {
+        hist_print(fp, task_name[task], state, "exec", &t->exec[state]);
+        hist_print(fp, task_name[task], state, "late", &t->late[state]);
+        if(t->overrun[state] > 0)
+            fprintf(fp, "%-8s %5d %-4s %7lu\n", task_name[task], state, "ovr", (unsigned long)t->overrun[state]);
+        if(t->exec[state].max > max)
+            max = t->exec[state].max;
+        *overrun += t->overrun[state];
+    }
+
+    return max;
+}
+
+/* 初期化関数 */
+void LoopTiming_init()
+{
+    int task;
+
+    for(task = 0; task < LOOP_TIMING_TASK_NUM; task++)
+        task_reset(&timing[task]);
+    measure_reset_req = false;
+}
+
+/* 区間のメインループの計測を開始する関数 */
+void LoopTiming_start(uint8_t task)
+{
+    task_reset(&timing[task]);
+    section = task;
+}
+
+/* 今周期の状態を設定する関数 */
+void LoopTiming_setState(uint8_t task, uint8_t state)
+{
+    timing[task].state = (state < LOOP_TIMING_STATE_MAX) ? state : LOOP_TIMING_STATE_MAX - 1;
+}
+
+/* 次の本来の起床時刻を求める(nowが既に過ぎていた場合は超過を数え、過ぎた周期を飛ばす) */
+static void advance(TIMING_TASK *t, HRTCNT now, uint32_t period)
+{
+    if(!t->started)                         // 最初の周期を基準にする
+    {
+        t->started = true;
+        t->expected = t->begin;
+    }
+
+    t->expected += period;
+    if((int32_t)(now - t->expected) >= 0)
+    {
+        t->expected += ((now - t->expected) / period + 1) * period;    // 起床時刻の位相は保つ
+        ++t->overrun[t->state];
+    }
+}
+
+/* 実行時間を記録して待機し、起床の遅れを記録する関数 */
+void LoopTiming_sleep(uint8_t task, uint32_t period)
+{
+    TIMING_TASK *t = &timing[task];
+    HRTCNT sleep, wake;
+
+    sleep = fch_hrt();
+    hist_add(&t->exec[t->state], (uint32_t)(sleep - t->begin));
+
+    advance(t, sleep, period);
+    tslp_tsk(t->expected - sleep);          // 次の本来の起床時刻まで待機
+
+    wake = fch_hrt();
+    hist_add(&t->late[t->state], ((int32_t)(wake - t->expected) > 0) ? (uint32_t)(wake - t->expected) : 0);
+    t->dt = wake - t->begin;
+    t->begin = wake;
+}
+
+/* 実行中の区間のメインループの実測周期を取得する関数 */
+uint32_t LoopTiming_getSectionDt()
+{
+    return timing[section].dt;
+}
+
+/* 周期起動されるタスクの先頭で呼ぶ関数 */
+void LoopTiming_cycleBegin(uint8_t task, uint32_t period)
+{
+    TIMING_TASK *t = &timing[task];
+    HRTCNT now;
+    int32_t late;
+
+    if(task == LOOP_TIMING_MEASURE && measure_reset_req)
+    {
+        task_reset(t);
+        measure_reset_req = false;
+    }
+
+    now = fch_hrt();
+    if(!t->started)                         // 最初の起動を基準にする
+    {
+        t->started = true;
+        t->expected = now + period;
+        t->begin = now;
+        return;
+    }
+    t->dt = now - t->begin;
+    t->begin = now;
+
+    late = (int32_t)(now - t->expected);
+    if(late < 0)
+        late = 0;
+    hist_add(&t->late[t->state], late);
+
+    if((uint32_t)late >= period)            // 1周期以上遅れた場合は(起動が飛ばされたとみなして)超過を数え、基準を取り直す
+    {
+        ++t->overrun[t->state];
+        t->expected = now + period;
+    }
+    else
+        t->expected += period;
+}
+
+/* 周期起動されるタスクの末尾で呼ぶ関数 */
+void LoopTiming_cycleEnd(uint8_t task)
+{
+    TIMING_TASK *t = &timing[task];
+
+    hist_add(&t->exec[t->state], (uint32_t)(fch_hrt() - t->begin));
+}
+
+/* ヒストグラムをファイルに書き出す関数 */
+void LoopTiming_save(const char *filename, uint8_t task)
+{
+    FILE *fp;
+    uint32_t section_max, measure_max, section_overrun, measure_overrun;
+    int i;
+
+    fp = fopen(filename, "w");
+    if(fp == NULL)                          // オープンに失敗した場合は書き出さない(走行は続ける)
+    {
+        printf("cannot open %s\n", filename);
+        return;
+    }
+
+    fprintf(fp, "# exec:1周期の実行時間 late:起床の遅れ 単位[us]、列はcount mean max と各区切り未満の回数 / ovr:超過の回数\n");
+    fprintf(fp, "%-8s %5s %-4s %7s %7s %7s", "task", "state", "kind", "count", "mean", "max");
+    for(i = 0; i < LOOP_TIMING_BUCKET_NUM - 1; i++)
+        fprintf(fp, " %6lu", (unsigned long)bucket_edge[i]);
+    fprintf(fp, " %6s\n", "over");
+
+    section_max = task_print(fp, task, &section_overrun);
+    measure_max = task_print(fp, LOOP_TIMING_MEASURE, &measure_overrun);   // measure_taskは動作中なので、途中の値が混ざることがある
+    measure_reset_req = true;               // 次の区間のために空にする
+
+    fclose(fp);
+
+    printf("%s: %s exec max %lu us overrun %lu, measure exec max %lu us overrun %lu\n", filename, task_name[task],
+           (unsigned long)section_max, (unsigned long)section_overrun, (unsigned long)measure_max, (unsigned long)measure_overrun);
+}
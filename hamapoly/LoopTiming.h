@@ -0,0 +1,51 @@
+#ifndef _LOOPTIMING_H_
+#define _LOOPTIMING_H_
+
+#include "ev3api.h"
+
+/* 制御ループの処理時間の計測 *******************************************************************************/
+// 各区間のメインループ(RUN_PERIOD周期)とmeasure_task(5ms周期)について、1周期の実行時間と起床の遅れを
+// 高分解能タイマ(fch_hrt)で計測し、タスク・状態(各区間のr_state)ごとの固定区切りのヒストグラムに積む
+//  実行時間   : 起床してから次にLoopTiming_sleepで待機するまで(区間のループは状態内の待機も含む)
+//  起床の遅れ : 起床(起動)した時刻 - 本来の起床時刻(最初の周期から周期ごとの絶対時刻)
+//  超過       : 実行時間が周期を超えて本来の起床時刻を過ぎた回数(過ぎた周期は飛ばし、位相は保つ)
+// 区間の終了時にLoopTiming_saveでテキストファイルに書き出す
+//
+// 区間のメインループはLoopTiming_sleepで次の本来の起床時刻まで待機するため、
+// 周期は実行時間に関係なく一定になる(tslp_tskで一定時間待つと 周期 + 実行時間 になる)
+
+/* 計測対象のタスク */
+#define LOOP_TIMING_MEASURE     0       // measure_task
+#define LOOP_TIMING_LINE        1       // ライントレース区間のメインループ
+#define LOOP_TIMING_SLALOM      2       // スラローム区間のメインループ
+#define LOOP_TIMING_BLOCK       3       // ブロック搬入区間のメインループ
+#define LOOP_TIMING_TASK_NUM    4
+
+#define LOOP_TIMING_STATE_MAX   16      // 状態の数(これ以上の状態は最後の状態にまとめる)
+#define LOOP_TIMING_BUCKET_NUM  12      // ヒストグラムの区切りの数(区切りはLoopTiming.cを参照)
+
+/* 初期化関数 *measure_taskが停止している状態で呼ぶこと */
+void LoopTiming_init();
+
+/* 区間のメインループの計測を開始する(区間の初期化処理で呼ぶ、そのタスクのヒストグラムを空にする) */
+void LoopTiming_start(uint8_t task);
+
+/* 今周期の状態を設定する(区間のメインループで毎周期、switch(r_state)の前に呼ぶ) */
+void LoopTiming_setState(uint8_t task, uint8_t state);
+
+/* 実行時間を記録して次の本来の起床時刻(period[us]周期)まで待機し、起床の遅れを記録する(区間のメインループの最後で呼ぶ) */
+void LoopTiming_sleep(uint8_t task, uint32_t period);
+
+/* 実行中の区間のメインループの、前回の起床から今回の起床までの実測時間[us]を取得(最初の周期は0) */
+uint32_t LoopTiming_getSectionDt();
+
+/* 周期起動されるタスクの先頭で呼ぶ(period[us]は起動周期、起動の遅れを記録する) */
+void LoopTiming_cycleBegin(uint8_t task, uint32_t period);
+
+/* 周期起動されるタスクの末尾で呼ぶ(実行時間を記録する) */
+void LoopTiming_cycleEnd(uint8_t task);
+
+/* 区間のタスクとmeasure_taskのヒストグラムをファイルに書き出し、measure_taskのヒストグラムを空にする(区間の終了後にmain_taskから呼ぶ) */
+void LoopTiming_save(const char *filename, uint8_t task);
+
+#endif
@@ -0,0 +1,422 @@
+// 走行・アーム・テールの動作をキューに積み、measure_taskから1周期ずつ進める
+// 呼び出し側は動作を積んだ後も処理を続けられ、完了はMOTION_CALLBACKまたはMotion_waitで知る
+// キューは呼び出し側のタスクが書き込み、measure_taskだけが読み出す(単一生産者・単一消費者)
+// 加減速の状態はMotionが持ち、区間のタスクの変数(Run_getPower_changeの状態・計測用の出力)は書き換えない
+
+#include <math.h>
+#include "Run.h"
+
+/* マクロ定義 */
+#define PROFILE_DT          (WHEEL_SPEED_PERIOD / 1000.0)   // 速度プロファイルの追従周期[s] (measure_taskの周期)
+#define PROFILE_KP          4.0     // 位置偏差[mm]に対する速度の補正[1/s]
+#define PROFILE_TOLERANCE   2.0     // 終点に到達したとみなす位置偏差[mm]
+#define PROFILE_TIMEOUT     0.5     // プロファイルの終了後に終点への到達を待つ最大時間[s]
+#define MM_TO_DEG           (360.0 / (PI * TIRE_DIAMETER))  // 走行距離[mm]をタイヤの回転角度[deg]に換算
+#define DRIVE_RAMP          (0.1f * WHEEL_SPEED_PERIOD / 4)     // 走行出力の1周期あたりの増減量(区間のループのmotor_ctrl_alt(..., 0.1)と同じく4msあたり0.1)
+#define ATTACHMENT_RAMP     (1.0f * WHEEL_SPEED_PERIOD / 4)     // アーム・テールの出力の1周期あたりの増減量(arm_up等のループと同じく4msあたり1)
+
+/* 動作の種類 */
+enum {
+    MOTION_DISTANCE,    // 距離指定の走行
+    MOTION_DIRECTION,   // 方位指定の旋回
+    MOTION_DETECTION,   // 障害物検知までの走行
+    MOTION_PROFILE,     // 速度プロファイルに沿った距離指定の走行
+    MOTION_ARM,         // アーム
+    MOTION_TALE         // テール
+};
+
+/* 1つの動作 */
+typedef struct {
+    uint8_t         type;       // 動作の種類
+    int8_t          power;      // 出力
+    int16_t         turn;       // 旋回値
+    float           target;     // 距離・方位(動作開始時点からの相対値)、アタッチメントの場合は角度
+    int16_t         detection;  // 障害物を検知する距離
+    bool_t          blend;      // 次の動作に停止せずに移るかどうか
+    MOTION_CALLBACK callback;   // 完了時に呼ぶ関数
+    intptr_t        arg;        // 完了時に呼ぶ関数の引数
+    float           speed;      // 速度プロファイルの最高速度[mm/s]
+    float           accel;      // 速度プロファイルの最大加速度[mm/s^2]
+    float           jerk;       // 速度プロファイルの加加速度[mm/s^3]
+} MOTION_CMD;
+
+/* 動作のキューと実行状態 */
+typedef struct {
+    MOTION_CMD          cmd[MOTION_QUEUE_SIZE];
+    volatile uint32_t   head;       // 実行中の動作の位置(measure_taskだけが進める)
+    volatile uint32_t   tail;       // 次に書き込む位置(呼び出し側だけが進める)
+    bool_t              active;     // 先頭の動作を開始済みかどうか
+    bool_t              stopping;   // 終了条件を満たし、停止中かどうか
+    float               ref;        // 動作開始時点の距離・方位
+    int8_t              sign;       // アタッチメントの回転方向
+    float               power;      // 加減速中の出力(小数点以下も保持し、1周期ごとに*_RAMPずつ増減する)
+} MOTION_QUEUE;
+
+/* グローバル変数 */
+static const motor_port_t
+    arm_motor       = EV3_PORT_A,
+    tale_motor      = EV3_PORT_D;
+
+static MOTION_QUEUE drive;                      // 走行動作
+static MOTION_QUEUE attachment;                 // アーム・テール動作
+static volatile bool_t cancel_request = false;  // Motion_cancelの要求
+static bool_t in_callback = false;              // 完了時の関数の実行中かどうか(measure_taskだけが読み書きする)
+static int8_t drive_power = 0;                  // 走行動作で設定したモーター出力(Motion_getPower)
+static int16_t drive_turn = 0;                  // 走行動作で設定した旋回値(Motion_getTurn)
+
+static PROFILE profile;                         // 実行中の速度プロファイル(動作開始時に計算)
+static uint32_t profile_ticks = 0;              // 速度プロファイルの開始からの周期数
+
+/* キューに動作を書き込む */
+static bool_t push(MOTION_QUEUE *queue, const MOTION_CMD *cmd) {
+    uint32_t tail = queue->tail;
+
+    if(tail - queue->head >= MOTION_QUEUE_SIZE)     // キューが一杯
+        return false;
+
+    queue->cmd[tail % MOTION_QUEUE_SIZE] = *cmd;
+    __asm__ __volatile__("" ::: "memory");          // 書き込み完了後に位置を進める
+    queue->tail = tail + 1;
+    return true;
+}
+
+/* 先頭の動作を完了させ、完了時の関数を呼ぶ */
+static void finish(MOTION_QUEUE *queue) {
+    MOTION_CMD *cmd = &queue->cmd[queue->head % MOTION_QUEUE_SIZE];
+
+    if(cmd->callback != NULL)
+    {
+        in_callback = true;
+        cmd->callback(cmd->arg);
+        in_callback = false;
+    }
+
+    queue->active = false;
+    queue->stopping = false;
+    __asm__ __volatile__("" ::: "memory");
+    queue->head = queue->head + 1;
+}
+
+/* キューを空にする */
+static void clear(MOTION_QUEUE *queue) {
+    queue->head = queue->tail;
+    queue->active = false;
+    queue->stopping = false;
+}
+
+/* 出力を目標値に向けてstepだけ増減する(Run_getPower_changeと同じく、増加中は切り捨て・減少中は切り上げた値を返す) */
+static int8_t ramp(float *power, int8_t target, float step) {
+    if(*power < target)
+    {
+        *power = *power + step < target ? *power + step : target;
+        return floorf(*power);
+    }
+    else if(*power > target)
+    {
+        *power = *power - step > target ? *power - step : target;
+        return ceilf(*power);
+    }
+    return target;
+}
+
+/* 走行モーターの出力を設定する(計測用の変数は区間のタスクのものを使わず、Motion_getPower・Motion_getTurnで参照する) */
+static void drive_output(int8_t power, int16_t turn) {
+    drive_power = power;
+    drive_turn = turn * COURSE_TURN_SIGN;
+    motor_ctrl_output(power, turn);
+}
+
+/* 走行動作の開始時点の値を記録する(blendで前の動作から移った場合は、前の動作の出力から加減速を続ける) */
+static void drive_start(MOTION_CMD *cmd, bool_t blended) {
+    if(!blended)                                    // 停止中または区間のタスクが走行させていた出力から加減速する
+        drive.power = Run_getPower();
+
+    if(cmd->type == MOTION_DIRECTION)
+        drive.ref = Direction_getDirection();
+    else
+        drive.ref = Distance_getDistance();
+
+    if(cmd->type == MOTION_DETECTION)
+        Sonar_setThreshold(cmd->detection);         // 障害物検知の閾値を設定
+
+    if(cmd->type == MOTION_PROFILE)                 // 加減速を含めた目標位置・速度をここで1回だけ計算する
+    {
+        Profile_init(&profile, cmd->target, cmd->speed, cmd->accel, cmd->jerk);
+        profile_ticks = 0;
+    }
+}
+
+/* 速度プロファイルに沿って1周期分走行する */
+// 目標速度をフィードフォワードとし、目標位置との偏差で補正した速度をWheelSpeedの速度制御に渡す
+static void profile_track() {
+    float pos, vel;
+
+    Profile_get(&profile, profile_ticks * PROFILE_DT, &pos, &vel);
+    vel += PROFILE_KP * (pos - (Distance_getDistance() - drive.ref));
+    vel = math_limit(vel * MM_TO_DEG, -WHEEL_SPEED_MAX, WHEEL_SPEED_MAX);
+
+    drive.power = vel * 100 / WHEEL_SPEED_MAX;      // 終了後の減速は出力相当の値から始める
+    drive_power = drive.power;
+    drive_turn = 0;
+    WheelSpeed_setTarget(vel, vel);                 // motor_ctrl_speed(vel, 0)と同じ(計測用の変数は書き換えない)
+    ++profile_ticks;
+}
+
+/* 走行動作の終了条件を満たしたかどうか */
+static bool_t drive_reached(MOTION_CMD *cmd) {
+    switch(cmd->type)
+    {
+        case MOTION_DISTANCE:
+            if(cmd->power > 0)                                          // 前進の場合
+                return Distance_getDistance() >= drive.ref + cmd->target;
+            else                                                        // 後退の場合
+                return Distance_getDistance() <= drive.ref + cmd->target;
+
+        case MOTION_DIRECTION:
+            if(cmd->target < 0)                                         // 方位が減る向きの場合
+                return Direction_getDirection() <= drive.ref + cmd->target;
+            else                                                        // 方位が増える向きの場合
+                return Direction_getDirection() >= drive.ref + cmd->target;
+
+        case MOTION_DETECTION:
+            return Sonar_isDetected() || (cmd->target > 0 && Distance_getDistance() >= drive.ref + cmd->target);
+
+        case MOTION_PROFILE:                                            // プロファイルが終了し、終点に到達した場合
+            if(profile_ticks * PROFILE_DT < Profile_getTime(&profile))
+                return false;
+            return fabsf(Distance_getDistance() - drive.ref - cmd->target) < PROFILE_TOLERANCE
+                || profile_ticks * PROFILE_DT >= Profile_getTime(&profile) + PROFILE_TIMEOUT;
+
+        default:
+            return true;
+    }
+}
+
+/* 走行動作を1周期分進める */
+static void drive_update() {
+    MOTION_CMD *cmd;
+    bool_t blended = false;
+    int8_t power;
+
+    while(drive.head != drive.tail && !cancel_request)  // 完了時の関数でMotion_cancelが呼ばれた場合は次の動作に移らない
+    {
+        cmd = &drive.cmd[drive.head % MOTION_QUEUE_SIZE];
+        if(!drive.active)                           // 動作の開始
+        {
+            drive_start(cmd, blended);
+            drive.active = true;
+        }
+
+        if(!drive.stopping && drive_reached(cmd))   // 終了条件を満たした場合
+        {
+            if(cmd->blend && drive.tail - drive.head > 1)   // 次の動作があれば停止せずに移る
+            {
+                finish(&drive);
+                blended = true;
+                continue;
+            }
+            drive.stopping = true;
+        }
+
+        if(drive.stopping)
+        {
+            power = ramp(&drive.power, 0, DRIVE_RAMP);  // モーターが停止するまで減速
+            drive_output(power, cmd->turn);
+            if(power == 0)                          // モーターが完全に停止した場合
+                finish(&drive);
+        }
+        else if(cmd->type == MOTION_PROFILE)
+        {
+            profile_track();                        // 速度プロファイルの目標に追従して走行
+        }
+        else
+        {
+            drive_output(ramp(&drive.power, cmd->power, DRIVE_RAMP), cmd->turn);  // 指定出力になるまで加速して走行
+        }
+        return;                                     // モーターへの指示は1周期に1回だけ
+    }
+}
+
+/* アタッチメント動作を1周期分進める */
+static void attachment_update() {
+    MOTION_CMD *cmd;
+    motor_port_t port;
+    int32_t cur_angle;
+    int8_t cur_power;
+
+    if(attachment.head == attachment.tail)
+        return;
+
+    cmd = &attachment.cmd[attachment.head % MOTION_QUEUE_SIZE];
+    port = cmd->type == MOTION_ARM ? arm_motor : tale_motor;
+    cur_angle = ev3_motor_get_counts(port);         // 現在のモーター角度
+
+    if(!attachment.active)                          // 動作の開始(回転方向を決め、現在のモーター出力から加減速する)
+    {
+        attachment.sign = cmd->target > cur_angle ? 1 : -1;
+        attachment.power = ev3_motor_get_power(port);
+        attachment.active = true;
+    }
+
+    if(!attachment.stopping && (attachment.sign > 0 ? cur_angle >= cmd->target : cur_angle <= cmd->target))
+        attachment.stopping = true;                 // 指定角度に到達した場合
+
+    if(attachment.stopping)
+    {
+        if(attachment.power == 0)                   // モーター出力が0となった場合
+        {
+            ev3_motor_stop(port, true);                 // モーターを停止
+            finish(&attachment);
+            return;
+        }
+        cur_power = ramp(&attachment.power, 0, ATTACHMENT_RAMP);                        // 出力減少
+    }
+    else
+    {
+        cur_power = ramp(&attachment.power, cmd->power * attachment.sign, ATTACHMENT_RAMP); // 指定出力になるまで出力増加
+    }
+    ev3_motor_set_power(port, cur_power);
+}
+
+/* 初期化関数 */
+void Motion_init() {
+    drive.head = drive.tail = 0;
+    drive.active = drive.stopping = false;
+    attachment.head = attachment.tail = 0;
+    attachment.active = attachment.stopping = false;
+    cancel_request = false;
+    in_callback = false;
+    drive_power = 0;
+    drive_turn = 0;
+}
+
+/* 実行中の動作を1周期分進める */
+void Motion_update() {
+    if(!cancel_request)
+        drive_update();
+    if(!cancel_request)
+        attachment_update();
+
+    if(cancel_request)                              // Motion_cancelの要求を反映(キューの先頭はこの関数だけで進める)
+    {                                               // 完了時の関数から要求された場合も、この周期のうちに反映する
+        if(drive.head != drive.tail)
+        {
+            drive.power = 0;
+            drive_output(0, 0);
+        }
+        if(attachment.head != attachment.tail)
+        {
+            ev3_motor_stop(arm_motor, true);
+            ev3_motor_stop(tale_motor, true);
+        }
+        clear(&drive);
+        clear(&attachment);
+        cancel_request = false;
+    }
+}
+
+/* 指定した距離を移動するまで走行する */
+bool_t Motion_driveDistance(int8_t power, int16_t turn, float distance, bool_t blend, MOTION_CALLBACK callback, intptr_t arg) {
+    MOTION_CMD cmd = { .type = MOTION_DISTANCE, .power = power, .turn = turn, .target = distance,
+                       .blend = blend, .callback = callback, .arg = arg };
+
+    if(!((power > 0 && distance > 0) || (power < 0 && distance < 0)))   // 正しい引数が得られなかった場合
+    {
+        printf("argument out of range @ Motion_driveDistance()\n");     // エラーメッセージを出して
+        exit(1);                                                        // 異常終了
+    }
+    return push(&drive, &cmd);
+}
+
+/* 指定した方位だけ旋回するまで走行する */
+bool_t Motion_turnDirection(int8_t power, int16_t turn, float direction, bool_t blend, MOTION_CALLBACK callback, intptr_t arg) {
+    MOTION_CMD cmd = { .type = MOTION_DIRECTION, .power = power, .turn = turn, .target = direction * MOTION_DIRECTION_SIGN,
+                       .blend = blend, .callback = callback, .arg = arg };
+
+    if(!(power != 0 && ((turn > 0 && direction > 0) || (turn < 0 && direction < 0))))
+    {                                                                   // 正しい引数が得られなかった場合
+        printf("argument out of range @ Motion_turnDirection()\n");     // エラーメッセージを出して
+        exit(1);                                                        // 異常終了
+    }
+    return push(&drive, &cmd);
+}
+
+/* 障害物を検知するまで走行する */
+bool_t Motion_driveDetection(int8_t power, int16_t turn, int16_t detection, float distance, bool_t blend, MOTION_CALLBACK callback, intptr_t arg) {
+    MOTION_CMD cmd = { .type = MOTION_DETECTION, .power = power, .turn = turn, .target = distance, .detection = detection,
+                       .blend = blend, .callback = callback, .arg = arg };
+
+    if(!(power > 0 && distance >= 0))                                   // 正しい引数が得られなかった場合
+    {
+        printf("argument out of range @ Motion_driveDetection()\n");    // エラーメッセージを出して
+        exit(1);                                                        // 異常終了
+    }
+    return push(&drive, &cmd);
+}
+
+/* 速度プロファイルに沿って指定した距離を移動する */
+bool_t Motion_driveProfile(float distance, float speed, float accel, float jerk, bool_t blend, MOTION_CALLBACK callback, intptr_t arg) {
+    MOTION_CMD cmd = { .type = MOTION_PROFILE, .power = distance > 0 ? 1 : -1, .target = distance,
+                       .blend = blend, .callback = callback, .arg = arg, .speed = speed, .accel = accel, .jerk = jerk };
+
+    if(!(distance != 0 && speed > 0 && speed * MM_TO_DEG <= WHEEL_SPEED_MAX && accel > 0 && jerk >= 0))
+    {                                                                   // 正しい引数が得られなかった場合
+        printf("argument out of range @ Motion_driveProfile()\n");      // エラーメッセージを出して
+        exit(1);                                                        // 異常終了
+    }
+    return push(&drive, &cmd);
+}
+
+/* アームを指定角度まで動かす */
+bool_t Motion_moveArm(uint8_t power, int32_t angle, MOTION_CALLBACK callback, intptr_t arg) {
+    MOTION_CMD cmd = { .type = MOTION_ARM, .power = power, .target = angle, .callback = callback, .arg = arg };
+
+    return push(&attachment, &cmd);
+}
+
+/* テールを指定角度まで動かす */
+bool_t Motion_moveTale(uint8_t power, int32_t angle, MOTION_CALLBACK callback, intptr_t arg) {
+    MOTION_CMD cmd = { .type = MOTION_TALE, .power = power, .target = angle, .callback = callback, .arg = arg };
+
+    return push(&attachment, &cmd);
+}
+
+/* 走行動作が残っているかどうか */
+bool_t Motion_isDriveBusy() {
+    return drive.head != drive.tail;
+}
+
+/* アタッチメント動作が残っているかどうか */
+bool_t Motion_isAttachmentBusy() {
+    return attachment.head != attachment.tail;
+}
+
+/* 積んだ全ての動作が完了するまで待機する */
+void Motion_wait() {
+    while(Motion_isDriveBusy() || Motion_isAttachmentBusy())
+        tslp_tsk(4 * 1000U); /* 4msec周期起動 */
+}
+
+/* モーター出力を取得 */
+int8_t Motion_getPower() {
+    return Motion_isDriveBusy() ? drive_power : Run_getPower();
+}
+
+/* 旋回値を取得 */
+int16_t Motion_getTurn() {
+    return Motion_isDriveBusy() ? drive_turn : Run_getTurn();
+}
+
+/* 積んだ全ての動作を取り消す */
+void Motion_cancel() {
+    bool_t driving = Motion_isDriveBusy();
+
+    cancel_request = true;
+    if(in_callback)                                 // 完了時の関数(measure_task)から呼ばれた場合は、Motion_updateがこの周期のうちに反映する
+        return;                                     // (measure_taskで待機すると反映されないため待たない)
+
+    while(cancel_request)                           // measure_taskで反映されるまで待機
+        tslp_tsk(4 * 1000U);
+    if(driving)
+        motor_ctrl(0, 0);                           // 計測用の変数も停止した状態にする(呼び出し側のタスクで書き込む)
+}
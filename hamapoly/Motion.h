@@ -0,0 +1,77 @@
+#ifndef _MOTION_H_
+#define _MOTION_H_
+
+#include "ev3api.h"
+#include "Course.h"
+#include "Profile.h"
+
+/* キューに積める動作の数(走行・アタッチメントそれぞれ) */
+#define MOTION_QUEUE_SIZE   16
+
+/* motor_ctrlのturnが正の場合に方位が変化する向き(右旋回で方位が増えるため、turnの符号を反転する場合は-1) */
+#define MOTION_DIRECTION_SIGN   COURSE_TURN_SIGN
+
+/* 動作完了時に呼ばれる関数(measure_taskから呼ばれるため、短い処理にすること) */
+typedef void (*MOTION_CALLBACK)(intptr_t arg);
+
+/* 初期化関数 */
+void Motion_init();
+
+/* 実行中の動作を1周期分進める(measure_taskで距離・方位の更新後に1周期に1回呼ぶ) */
+void Motion_update();
+
+/* 走行動作 ********************************************************************************************
+ * 走行モーターの動作は積んだ順に1つずつ実行する
+ * blendがtrueで次の動作が積まれている場合は、終了条件を満たした時点で停止せずに次の動作に移る
+ * キューが一杯の場合はfalseを返す
+ *******************************************************************************************************/
+
+/* 指定した距離を移動するまで、指定出力で走行する(Run_setDistanceと同じ引数) */
+bool_t Motion_driveDistance(int8_t power, int16_t turn, float distance, bool_t blend, MOTION_CALLBACK callback, intptr_t arg);
+
+/* 指定した方位だけ旋回するまで、指定出力で走行する(Run_setDirectionと同じ引数) */
+bool_t Motion_turnDirection(int8_t power, int16_t turn, float direction, bool_t blend, MOTION_CALLBACK callback, intptr_t arg);
+
+/* 障害物を検知する(または指定距離を移動する)まで、指定出力で走行する(Run_setDetectionと同じ引数) */
+bool_t Motion_driveDetection(int8_t power, int16_t turn, int16_t detection, float distance, bool_t blend, MOTION_CALLBACK callback, intptr_t arg);
+
+/* 速度プロファイル(台形・S字、Profile.hを参照)に沿って指定した距離を移動し、終点で停止する */
+// 減速は終点の手前から始め、目標位置との偏差を走行距離でフィードバックする(WheelSpeedの速度制御で走行する)
+// distance : 移動距離[mm](マイナスの値は後退)
+// speed    : 最高速度[mm/s](タイヤの最高回転速度WHEEL_SPEED_MAXまで)
+// accel    : 最大加速度[mm/s^2]
+// jerk     : 加加速度[mm/s^3](0で台形)
+bool_t Motion_driveProfile(float distance, float speed, float accel, float jerk, bool_t blend, MOTION_CALLBACK callback, intptr_t arg);
+
+/* アタッチメント動作 *************************************************************************************
+ * アーム・テールの動作は走行動作とは別のキューで積んだ順に実行するため、走行中に動かすことができる
+ *******************************************************************************************************/
+
+/* アームを指定角度まで動かす */
+bool_t Motion_moveArm(uint8_t power, int32_t angle, MOTION_CALLBACK callback, intptr_t arg);
+
+/* テールを指定角度まで動かす */
+bool_t Motion_moveTale(uint8_t power, int32_t angle, MOTION_CALLBACK callback, intptr_t arg);
+
+/* 状態取得・待機 ****************************************************************************************/
+
+/* 走行動作が残っているかどうか */
+bool_t Motion_isDriveBusy();
+
+/* アタッチメント動作が残っているかどうか */
+bool_t Motion_isAttachmentBusy();
+
+/* モーター出力を取得(走行動作の実行中はMotionが設定した出力、それ以外はRun_getPowerの値) */
+int8_t Motion_getPower();
+
+/* 旋回値を取得(走行動作の実行中はMotionが設定した旋回値、それ以外はRun_getTurnの値) */
+int16_t Motion_getTurn();
+
+/* 積んだ全ての動作が完了するまで待機する */
+void Motion_wait();
+
+/* 積んだ全ての動作を取り消し、モーターを停止する(完了時の関数は呼ばれない) */
+// 完了時の関数(measure_task)から呼んだ場合は待機せずに戻り、その周期のMotion_updateの最後で取り消す
+void Motion_cancel();
+
+#endif
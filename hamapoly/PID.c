@@ -0,0 +1,115 @@
+// Q16.16固定小数点によるPID制御器
+// 浮動小数点演算と毎周期の割り算(DELTA_T)を無くし(実測の経過時間を使う場合を除く)、複数の制御器を同時に使えるように状態を構造体に持たせる
+
+#include "PID.h"
+
+#define Q16_SAT_MAX (INT32_MAX / 4)     // 途中計算の飽和値(各項を足しても溢れない値)
+
+/* 64bitの途中計算結果を飽和させてq16_tに戻す */
+static q16_t saturate(int64_t value) {
+    if(value > Q16_SAT_MAX)
+        return Q16_SAT_MAX;
+    else if(value < -Q16_SAT_MAX)
+        return -Q16_SAT_MAX;
+    return (q16_t)value;
+}
+
+/* 出力範囲と積分ゲインから積分値の上限を求める */
+static void update_integral_max(PID_CTRL *pid) {
+    q16_t out_abs = pid->out_max > -pid->out_min ? pid->out_max : -pid->out_min;
+
+    if(pid->ki > 0)                                 // 積分項だけで出力範囲を超えない値に制限
+        pid->integral_max = saturate(((int64_t)out_abs << 16) / pid->ki);
+    else
+        pid->integral_max = 0;
+}
+
+/* 初期化関数 */
+void PID_init(PID_CTRL *pid, float kp, float ki, float kd, float dt) {
+    pid->dt = Q16_FROM_FLOAT(dt);
+    pid->out_min = Q16_FROM_INT(-200);
+    pid->out_max = Q16_FROM_INT(200);
+    pid->d_alpha = Q16_ONE;
+
+    PID_setGain(pid, kp, ki, kd);
+    PID_reset(pid);
+}
+
+/* ゲインを変更する */
+void PID_setGain(PID_CTRL *pid, float kp, float ki, float kd) {
+    pid->kp = Q16_FROM_FLOAT(kp);
+    pid->ki = Q16_FROM_FLOAT(ki);
+    pid->kd_dt = Q16_FROM_FLOAT(kd * Q16_ONE / pid->dt);
+    update_integral_max(pid);
+}
+
+/* ゲインを固定小数点で直接設定する */
+void PID_setGainQ16(PID_CTRL *pid, q16_t kp, q16_t ki, q16_t kd_dt) {
+    pid->kp = kp;
+    pid->kd_dt = kd_dt;
+    if(pid->ki != ki)                               // 積分ゲインが変わった場合のみ上限を再計算
+    {
+        pid->ki = ki;
+        update_integral_max(pid);
+    }
+}
+
+/* 出力の範囲を設定する */
+void PID_setLimit(PID_CTRL *pid, int32_t out_min, int32_t out_max) {
+    pid->out_min = Q16_FROM_INT(out_min);
+    pid->out_max = Q16_FROM_INT(out_max);
+    update_integral_max(pid);
+}
+
+/* 微分項のローパスフィルタ係数を設定する */
+void PID_setFilter(PID_CTRL *pid, float alpha) {
+    pid->d_alpha = Q16_FROM_FLOAT(alpha);
+}
+
+/* 状態をリセットする */
+void PID_reset(PID_CTRL *pid) {
+    pid->prev_error = 0;
+    pid->integral = 0;
+    pid->d_filtered = 0;
+}
+
+/* 経過時間と 微分ゲイン / 経過時間 を指定して操作量を計算する */
+static int32_t update(PID_CTRL *pid, int32_t error, q16_t dt, q16_t kd_dt) {
+    q16_t p, i, d, out;
+
+    // 積分(台形近似) : integral += (偏差 + 前回の偏差) / 2 * dt
+    pid->integral = saturate((int64_t)pid->integral + (((int64_t)(error + pid->prev_error) * dt) >> 1));
+    if(pid->integral > pid->integral_max)           // アンチワインドアップ
+        pid->integral = pid->integral_max;
+    else if(pid->integral < -pid->integral_max)
+        pid->integral = -pid->integral_max;
+
+    // 微分 : (偏差 - 前回の偏差) / dt を一次遅れフィルタに通す
+    d = saturate((int64_t)(error - pid->prev_error) * kd_dt);
+    pid->d_filtered += Q16_MUL(pid->d_alpha, d - pid->d_filtered);
+    pid->prev_error = error;
+
+    p = saturate((int64_t)error * pid->kp);
+    i = Q16_MUL(pid->ki, pid->integral);
+
+    out = p + i + pid->d_filtered;
+    if(out > pid->out_max)                          // 出力の飽和
+        out = pid->out_max;
+    else if(out < pid->out_min)
+        out = pid->out_min;
+
+    return Q16_TO_INT(out);
+}
+
+/* 偏差から操作量を計算する */
+int32_t PID_update(PID_CTRL *pid, int32_t error) {
+    return update(pid, error, pid->dt, pid->kd_dt);
+}
+
+/* 実測の経過時間で偏差から操作量を計算する */
+int32_t PID_updateDt(PID_CTRL *pid, int32_t error, q16_t dt) {
+    if(dt <= 0 || dt == pid->dt)                    // 処理周期どおりの場合は割り算をしない
+        return PID_update(pid, error);
+
+    return update(pid, error, dt, (q16_t)(((int64_t)pid->kd_dt * pid->dt) / dt));  // kd / dt = (kd / 処理周期) * 処理周期 / dt
+}
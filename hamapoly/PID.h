@@ -0,0 +1,57 @@
+#ifndef _PID_H_
+#define _PID_H_
+
+#include "ev3api.h"
+
+/* Q16.16固定小数点数(上位16bitが整数部、下位16bitが小数部) */
+typedef int32_t q16_t;
+
+#define Q16_ONE         65536
+#define Q16_FROM_INT(n) ((q16_t)(n) * Q16_ONE)
+#define Q16_FROM_FLOAT(x) ((q16_t)roundf((x) * (float)Q16_ONE))
+#define Q16_TO_INT(q)   ((q) >= 0 ? (int32_t)(((q) + Q16_ONE / 2) >> 16) : -(int32_t)((Q16_ONE / 2 - (q)) >> 16))  // 四捨五入して整数に変換(roundfと同じく0.5は0から遠い方へ)
+#define Q16_MUL(a, b)   ((q16_t)(((int64_t)(a) * (b)) >> 16))
+
+/* PID制御器(インスタンスごとにゲイン・状態を持つ) */
+typedef struct {
+    /* 設定値 */
+    q16_t   kp;             // 比例ゲイン
+    q16_t   ki;             // 積分ゲイン
+    q16_t   kd_dt;          // 微分ゲイン / 処理周期(毎回の割り算を避けるため初期化時に計算)
+    q16_t   dt;             // 処理周期[s]
+    q16_t   integral_max;   // 積分値の上限(アンチワインドアップ)
+    q16_t   out_min;        // 出力の最小値
+    q16_t   out_max;        // 出力の最大値
+    q16_t   d_alpha;        // 微分項のローパスフィルタ係数(Q16_ONEでフィルタ無し)
+
+    /* 状態 */
+    int32_t prev_error;     // 前回の偏差
+    q16_t   integral;       // 偏差の積分値[偏差*s]
+    q16_t   d_filtered;     // フィルタ後の微分項
+} PID_CTRL;
+
+/* 初期化関数(ゲインと処理周期[s]を設定し、状態をリセットする) */
+void PID_init(PID_CTRL *pid, float kp, float ki, float kd, float dt);
+
+/* ゲインを変更する(状態は保持する) */
+void PID_setGain(PID_CTRL *pid, float kp, float ki, float kd);
+
+/* ゲインを固定小数点で直接設定する(毎周期のゲイン変更用、kd_dtは 微分ゲイン / 処理周期) */
+void PID_setGainQ16(PID_CTRL *pid, q16_t kp, q16_t ki, q16_t kd_dt);
+
+/* 出力の範囲を設定する(積分値の上限も出力範囲に合わせて再計算する) */
+void PID_setLimit(PID_CTRL *pid, int32_t out_min, int32_t out_max);
+
+/* 微分項のローパスフィルタ係数を設定する(0.0 ~ 1.0, 1.0でフィルタ無し) */
+void PID_setFilter(PID_CTRL *pid, float alpha);
+
+/* 状態をリセットする */
+void PID_reset(PID_CTRL *pid);
+
+/* 偏差から操作量を計算する 返り値 : 出力範囲に制限し、四捨五入した操作量 */
+int32_t PID_update(PID_CTRL *pid, int32_t error);
+
+/* 前回からの実測の経過時間dt[s]を使って偏差から操作量を計算する(dtが処理周期と同じ場合はPID_updateと同じ結果) */
+int32_t PID_updateDt(PID_CTRL *pid, int32_t error, q16_t dt);
+
+#endif
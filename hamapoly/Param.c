@@ -0,0 +1,409 @@
+// 走行パラメータ(ゲイン・閾値・出力・距離)をSDカードのチューニングファイルから読み込む
+// ファイルを書き換えれば、再ビルド・転送なしで次の走行から値を変えられる
+//
+// ファイル形式(テキスト、1行に1つ、#以降はコメント)
+//      line.power = 80
+//      line.kp    = 0.30
+//      checksum   = 0x1a2b
+// checksum行にはそれより前の全バイトのFletcher-16を書く(tools/paramsum.cで付けられる)
+// checksumが無い・一致しない場合はファイル全体を使わず、範囲外・不明なキーはその行だけ無視する
+// 読み込みは起動時に1回だけ、静的バッファに1回のfreadで行い、動的なメモリ確保はしない
+//
+// 走行中の変更(Bluetooth、BtCommand.cを参照)はロックを使わずに反映する
+// bt_taskは書き込み用のpendingだけを書き換え、measure_taskがParam_updateでダブルバッファの裏側にコピーして表裏を切り替える
+// measure_taskはbt_taskより優先度が高いため、pendingの書き込み途中(pending_seqが奇数)でなければコピー中に書き換えられることはない
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "Param.h"
+
+#define PARAM_CHECKSUM_KEY  "checksum"
+#define PARAM_COMMIT_WAIT   20  // 反映を待つ時間[ms](過ぎた場合はmeasure_taskが動いていない走行開始前とみなす)
+
+/* キーと構造体メンバの対応(許容範囲の下限,上限を含む) */
+typedef struct {
+    const char  *key;
+    PARAM_TYPE  type;
+    size_t      offset;
+    float       min, max;
+} PARAM_ENTRY;
+
+static const PARAM_ENTRY entries[] = {
+    //  キー                    型              メンバ                                      下限    上限
+    { "line.power",             PARAM_INT,      offsetof(PARAM, line_power),                0,      100     },
+    { "line.power_curve",       PARAM_INT,      offsetof(PARAM, line_power_curve),          0,      100     },
+    { "line.target",            PARAM_INT,      offsetof(PARAM, line_target),               0,      255     },
+    { "line.kp",                PARAM_FLOAT,    offsetof(PARAM, line_kp),                   0,      10      },
+    { "line.ki",                PARAM_FLOAT,    offsetof(PARAM, line_ki),                   0,      10      },
+    { "line.kd",                PARAM_FLOAT,    offsetof(PARAM, line_kd),                   0,      10      },
+    { "line.blue_distance",     PARAM_INT,      offsetof(PARAM, line_blue_distance),        0,      100000  },
+    { "line.end_distance",      PARAM_INT,      offsetof(PARAM, line_end_distance),         0,      5000    },
+    { "line.end_power",         PARAM_INT,      offsetof(PARAM, line_end_power),            0,      100     },
+    { "slalom.target",          PARAM_INT,      offsetof(PARAM, slalom_target),             0,      255     },
+    { "slalom.approach",        PARAM_INT,      offsetof(PARAM, slalom_approach),           0,      1000    },
+    { "slalom.shift",           PARAM_INT,      offsetof(PARAM, slalom_shift),              0,      1000    },
+    { "slalom.cross",           PARAM_INT,      offsetof(PARAM, slalom_cross),              0,      1000    },
+    { "block.target",           PARAM_INT,      offsetof(PARAM, block_target),              0,      255     },
+    { "block.move",             PARAM_INT,      offsetof(PARAM, block_move),                0,      10000   },
+    { "block.return",           PARAM_INT,      offsetof(PARAM, block_return),              0,      10000   },
+    { "motion.accel",           PARAM_FLOAT,    offsetof(PARAM, motion_accel),              1,      5000    },
+    { "motion.jerk",            PARAM_FLOAT,    offsetof(PARAM, motion_jerk),               0,      100000  },
+    { "telemetry.decimation",   PARAM_INT,      offsetof(PARAM, telemetry_decimation),      0,      200     },
+};
+
+#define PARAM_ENTRY_NUM (sizeof(entries) / sizeof(entries[0]))
+
+/* 既定値(チューニングファイルが無い場合の値) */
+static const PARAM param_default = {
+    100,                        // line.power (出力100のゲインはGainSchedule.cで調整)
+    70,                         // line.power_curve
+    COURSE_LINE_TARGET,         // line.target
+    COURSE_KP,                  // line.kp
+    COURSE_KI,                  // line.ki
+    COURSE_KD,                  // line.kd
+    COURSE_LINE_BLUE_DISTANCE,  // line.blue_distance
+    250,                        // line.end_distance
+    30,                         // line.end_power
+    64,                         // slalom.target
+    125,                        // slalom.approach
+    105,                        // slalom.shift
+    175,                        // slalom.cross
+    64,                         // block.target
+    1000,                       // block.move
+    2500,                       // block.return
+    800,                        // motion.accel
+    8000,                       // motion.jerk
+    10,                         // telemetry.decimation (50ms周期)
+};
+
+static PARAM param[2];                          // 走行中に参照する値(ダブルバッファ、param[active]が最新)
+static volatile uint32_t active = 0;
+static volatile uint32_t version = 0;           // 反映した回数
+
+static PARAM pending;                           // bt_taskが書き込む値
+static volatile uint32_t pending_seq = 0;       // pendingの書き込み回数*2(奇数の間は書き込み途中)
+static volatile uint32_t commit_req = 0;        // 反映の要求回数
+static volatile uint32_t commit_done = 0;       // 反映した要求回数
+
+static char param_buf[PARAM_FILE_MAX + 1];      // ファイルの内容(終端の'\0'の分を含む)
+
+/* Fletcher-16チェックサム */
+static uint16_t param_checksum(const char *data, size_t size)
+{
+    uint16_t a = 0, b = 0;
+    size_t i;
+
+    for(i = 0; i < size; i++)
+    {
+        a = (a + (uint8_t)data[i]) % 255;
+        b = (b + a) % 255;
+    }
+
+    return (b << 8) | a;
+}
+
+/* checksum行か(キーが完全に一致し、空白の後に'='が続く行) */
+static bool_t param_is_checksum(const char *line)
+{
+    size_t n = strlen(PARAM_CHECKSUM_KEY);
+
+    if(strncmp(line, PARAM_CHECKSUM_KEY, n) != 0)
+        return false;
+    for(line += n; *line == ' ' || *line == '\t'; line++)
+        ;
+
+    return *line == '=';
+}
+
+/* 前後の空白を取り除く */
+static char *param_trim(char *s)
+{
+    char *end;
+
+    while(*s == ' ' || *s == '\t')
+        s++;
+
+    end = s + strlen(s);
+    while(end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+        end--;
+    *end = '\0';
+
+    return s;
+}
+
+/* キーから対応表の要素を探す */
+static const PARAM_ENTRY *param_find(const char *key)
+{
+    unsigned int i;
+
+    for(i = 0; i < PARAM_ENTRY_NUM; i++)
+    {
+        if(strcmp(entries[i].key, key) == 0)
+            return &entries[i];
+    }
+
+    return NULL;
+}
+
+/* 1つの値(int32_tかfloatのビット列)を検証して書き込む 返り値 : 0(成功)/-1(範囲外) */
+static int param_store(PARAM *dst, const PARAM_ENTRY *entry, uint32_t value)
+{
+    int32_t i_value;
+    float   f_value;
+
+    if(entry->type == PARAM_INT)
+    {
+        memcpy(&i_value, &value, sizeof(i_value));
+        if(i_value < entry->min || i_value > entry->max)
+            return -1;
+    }
+    else
+    {
+        memcpy(&f_value, &value, sizeof(f_value));
+        if(!(entry->min <= f_value && f_value <= entry->max))  // NaNも範囲外とする
+            return -1;
+    }
+    memcpy((char *)dst + entry->offset, &value, sizeof(value));
+
+    return 0;
+}
+
+/* 1つの値を文字列から変換・検証して書き込む 返り値 : 0(成功)/-1(不正な値) */
+static int param_set(PARAM *dst, const PARAM_ENTRY *entry, const char *text)
+{
+    char    *end;
+    long    l_value;
+    int32_t i_value;
+    float   f_value;
+    uint32_t value;
+
+    if(entry->type == PARAM_INT)
+    {
+        l_value = strtol(text, &end, 0);
+        if(end == text || *end != '\0' || l_value < entry->min || l_value > entry->max)
+            return -1;
+        i_value = (int32_t)l_value;
+        memcpy(&value, &i_value, sizeof(value));
+    }
+    else
+    {
+        f_value = strtof(text, &end);
+        if(end == text || *end != '\0')
+            return -1;
+        memcpy(&value, &f_value, sizeof(value));
+    }
+
+    return param_store(dst, entry, value);
+}
+
+/* pendingを裏側のバッファにコピーして表裏を切り替える */
+static void param_apply(uint32_t req)
+{
+    uint32_t next = active ^ 1;
+
+    param[next] = pending;                          // 読み出し側が参照していない方のバッファにコピー
+    __asm__ __volatile__("" ::: "memory");          // コピー完了後に表裏を切り替える
+    active = next;
+    version++;
+    commit_done = req;
+}
+
+/* 初期化関数 */
+void Param_init()
+{
+    param[0] = param[1] = pending = param_default;
+    active = 0;
+    version = 0;
+    pending_seq = commit_req = commit_done = 0;
+}
+
+/* チューニングファイルを読み込む関数 */
+int Param_load(const char *filename)
+{
+    FILE    *fp;
+    PARAM   loaded = param_default;
+    size_t  size;
+    char    *line, *next, *key, *value;
+    const PARAM_ENTRY *entry;
+    int     line_no = 0;
+    int     count = 0;
+    long    expected = -1;
+    size_t  body = 0;
+
+    fp = fopen(filename, "rb");
+    if(fp == NULL)                                      // ファイルが無い場合は既定値のまま
+    {
+        printf("%s not found, using defaults\n", filename);
+        return -1;
+    }
+    size = fread(param_buf, 1, sizeof(param_buf), fp);  // 1回で全体を読む
+    fclose(fp);
+
+    if(size > PARAM_FILE_MAX)
+    {
+        printf("%s is too large (max %d bytes), using defaults\n", filename, PARAM_FILE_MAX);
+        return -1;
+    }
+    param_buf[size] = '\0';
+
+    /* checksum行を探して検証する(行の先頭までの全バイトが対象) */
+    for(line = param_buf; *line != '\0'; line = next)
+    {
+        next = strchr(line, '\n');
+        next = (next != NULL) ? next + 1 : line + strlen(line);
+
+        if(param_is_checksum(line))
+        {
+            expected = strtol(strchr(line, '=') + 1, NULL, 16);
+            body = line - param_buf;
+            break;
+        }
+    }
+    if(expected < 0 || param_checksum(param_buf, body) != expected)
+    {
+        printf("%s: checksum mismatch, using defaults\n", filename);
+        return -1;
+    }
+    param_buf[body] = '\0';                             // checksum行以降は読まない
+
+    /* キー = 値 を読む */
+    for(line = param_buf; *line != '\0'; line = next)
+    {
+        line_no++;
+        next = strchr(line, '\n');
+        if(next != NULL)
+            *next++ = '\0';
+        else
+            next = line + strlen(line);
+
+        if((value = strchr(line, '#')) != NULL)         // コメントを取り除く
+            *value = '\0';
+        key = param_trim(line);
+        if(*key == '\0')                                // 空行
+            continue;
+
+        value = strchr(key, '=');
+        if(value == NULL)
+        {
+            printf("%s:%d: missing '='\n", filename, line_no);
+            continue;
+        }
+        *value++ = '\0';
+        key = param_trim(key);
+        value = param_trim(value);
+
+        entry = param_find(key);
+        if(entry == NULL)
+            printf("%s:%d: unknown key %s\n", filename, line_no, key);
+        else if(param_set(&loaded, entry, value) != 0)
+            printf("%s:%d: invalid value %s = %s\n", filename, line_no, key, value);
+        else
+            count++;
+    }
+
+    param[0] = param[1] = pending = loaded;
+    printf("%s: %d values loaded\n", filename, count);
+
+    return count;
+}
+
+/* 走行パラメータを参照する関数 */
+const PARAM *Param_get()
+{
+    return &param[active];
+}
+
+/* パラメータの数を取得する関数 */
+int Param_getNum()
+{
+    return PARAM_ENTRY_NUM;
+}
+
+/* パラメータのキー名と型を取得する関数 */
+int Param_getInfo(int id, const char **key, PARAM_TYPE *type)
+{
+    if(id < 0 || id >= (int)PARAM_ENTRY_NUM)
+        return -1;
+
+    *key = entries[id].key;
+    *type = entries[id].type;
+    return 0;
+}
+
+/* パラメータの値のPARAM構造体内の位置を取得する関数 */
+int Param_getOffset(int id, size_t *offset)
+{
+    if(id < 0 || id >= (int)PARAM_ENTRY_NUM)
+        return -1;
+
+    *offset = entries[id].offset;
+    return 0;
+}
+
+/* パラメータの値を取得する関数(bt_taskから呼ぶ、反映前の書き込みも含む) */
+int Param_read(int id, uint32_t *value)
+{
+    if(id < 0 || id >= (int)PARAM_ENTRY_NUM)
+        return -1;
+
+    memcpy(value, (char *)&pending + entries[id].offset, sizeof(*value));
+    return 0;
+}
+
+/* パラメータの値を書き込む関数(bt_taskから呼ぶ) */
+int Param_write(int id, uint32_t value)
+{
+    int result;
+
+    if(id < 0 || id >= (int)PARAM_ENTRY_NUM)
+        return -1;
+
+    pending_seq++;                                  // 書き込み開始(奇数)
+    __asm__ __volatile__("" ::: "memory");
+    result = param_store(&pending, &entries[id], value);
+    __asm__ __volatile__("" ::: "memory");
+    pending_seq++;                                  // 書き込み完了(偶数)
+
+    return (result == 0) ? 0 : -2;
+}
+
+/* 書き込んだ値の反映を要求する関数(bt_taskから呼ぶ) */
+uint32_t Param_commit()
+{
+    uint32_t req = commit_req + 1;
+    int i;
+
+    commit_req = req;
+    for(i = 0; i < PARAM_COMMIT_WAIT && commit_done != req; i++)   // measure_taskが反映するまで待つ
+        tslp_tsk(1 * 1000U);
+
+    if(commit_done != req)                          // measure_taskが動いていない場合は自分で反映する
+    {
+        pending_seq++;                              // 反映中にmeasure_taskが反映しないよう、書き込み途中にしておく
+        __asm__ __volatile__("" ::: "memory");
+        if(commit_done != req)
+            param_apply(req);
+        __asm__ __volatile__("" ::: "memory");
+        pending_seq++;
+    }
+
+    return version;
+}
+
+/* 反映を要求された値を反映する関数 */
+void Param_update()
+{
+    uint32_t req = commit_req;
+
+    if(req == commit_done || (pending_seq & 1))     // 要求が無い、またはbt_taskが書き込み途中の場合は次の周期に持ち越す
+        return;
+
+    param_apply(req);
+}
+
+/* 反映済みの版数を取得する関数 */
+uint32_t Param_getVersion()
+{
+    return version;
+}
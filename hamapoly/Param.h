@@ -0,0 +1,90 @@
+#ifndef _PARAM_H_
+#define _PARAM_H_
+
+#include "ev3api.h"
+#include "Course.h"
+
+/* チューニングファイル名(コースごとに分ける) */
+#define PARAM_FILE      "Param_" COURSE_NAME ".txt"
+
+/* チューニングファイルの最大サイズ[byte] */
+#define PARAM_FILE_MAX  2048
+
+/* 値の型 */
+typedef enum {
+    PARAM_INT,      // int32_t
+    PARAM_FLOAT     // float
+} PARAM_TYPE;
+
+/* 走行パラメータ(各区間のゲイン・閾値・出力・距離) */
+// 括弧内はチューニングファイルのキー名、既定値はParam.cを参照
+typedef struct {
+    // ライントレース区間
+    int32_t line_power;         // 通常走行の出力値(line.power)
+    int32_t line_power_curve;   // 旋回量が多い場合の出力値(line.power_curve)
+    int32_t line_target;        // rgb.rの目標値(line.target)
+    float   line_kp;            // PIDゲイン(line.kp)
+    float   line_ki;            // (line.ki)
+    float   line_kd;            // (line.kd)
+    int32_t line_blue_distance; // 青ラインの検知を有効にする走行距離[mm](line.blue_distance)
+    int32_t line_end_distance;  // 青ライン検知後に減速する距離[mm](line.end_distance)
+    int32_t line_end_power;     // 減速後の出力値(line.end_power)
+
+    // スラローム区間
+    int32_t slalom_target;      // rgb.rの目標値(slalom.target)
+    int32_t slalom_approach;    // 段差の手前までライントレースする距離[mm](slalom.approach)
+    int32_t slalom_shift;       // 2つ目のペットボトルを避けて横に移動する距離[mm](slalom.shift)
+    int32_t slalom_cross;       // 3つ目のペットボトルへ横に移動する距離[mm](slalom.cross)
+
+    // ブロック搬入区間
+    int32_t block_target;       // rgb.rの目標値(block.target)
+    int32_t block_move;         // 黄色を検知できない場合に曲がり始める距離[mm](block.move)
+    int32_t block_return;       // 赤色検知後に戻る距離[mm](block.return)
+
+    // 走行動作(Run_setProfileの速度プロファイル)
+    float   motion_accel;       // 最大加速度[mm/s^2](motion.accel)
+    float   motion_jerk;        // 加加速度[mm/s^3](motion.jerk、0で台形)
+
+    // テレメトリ
+    int32_t telemetry_decimation;   // サンプルを送信する間隔[measure_taskの周期数](telemetry.decimation、0で送信しない)
+} PARAM;
+
+/* 既定値で初期化する */
+void Param_init();
+
+/* チューニングファイルを読み込む 返り値 : 読み込んだ値の数(ファイルが無い・不正な場合は-1で、全て既定値のまま) */
+// 起動時にmain_taskで1回だけ呼ぶ(走行中に呼ばないこと)
+int Param_load(const char *filename);
+
+/* 走行パラメータを参照する(走行中に値が変わることがあるため、ポインタは1周期の間だけ使うこと) */
+const PARAM *Param_get();
+
+/* パラメータの値のPARAM構造体内の位置を取得(Param_get()の値をidで参照する場合に使う) 返り値 : 0(成功)/-1(idが範囲外) */
+int Param_getOffset(int id, size_t *offset);
+
+/* 走行中の変更(Bluetoothからの変更用) ***************************************************************/
+// Param_writeで書き込んだ値はParam_commitを呼ぶまで反映されず、Param_commitまでの値はまとめて同じ周期に反映される
+// Param_write, Param_commitを呼べるのは1つのタスク(bt_task)だけで、反映はmeasure_taskのParam_updateで行う
+
+/* パラメータの数 */
+int Param_getNum();
+
+/* パラメータのキー名と型を取得 返り値 : 0(成功)/-1(idが範囲外) */
+int Param_getInfo(int id, const char **key, PARAM_TYPE *type);
+
+/* パラメータの値(int32_tかfloatのビット列)を取得(bt_task用、反映前の書き込みも含む) 返り値 : 0(成功)/-1(idが範囲外) */
+int Param_read(int id, uint32_t *value);
+
+/* パラメータの値を書き込む(反映はParam_commitの後) 返り値 : 0(成功)/-1(idが範囲外)/-2(値が範囲外) */
+int Param_write(int id, uint32_t value);
+
+/* 書き込んだ値の反映を要求し、反映されるまで待つ 返り値 : 反映後の版数 */
+uint32_t Param_commit();
+
+/* 反映を要求された値を反映する(measure_taskで1周期に1回呼ぶ) */
+void Param_update();
+
+/* 反映済みの版数を取得(値が変わるたびに増える、ゲインなど変更時に再計算が必要な値の確認用) */
+uint32_t Param_getVersion();
+
+#endif
@@ -0,0 +1,184 @@
+// エンコーダのオドメトリとジャイロセンサーの角速度を融合して、2次元の自己位置(x, y, 方位)を推定する
+// 方位の変化量はエンコーダとジャイロの重み付き平均(分散の逆数で重み付け)で求める
+// タイヤが滑ると左右の回転量の差がジャイロと食い違うため、その差が大きいほどエンコーダの分散を大きくしてジャイロを優先する
+// 停止中はジャイロの値をバイアスとして学習し、走行中の角速度から差し引く
+
+#include <math.h>
+#include <string.h>
+#include "Pose.h"
+#include "Direction.h"
+#include "WheelSpeed.h"
+
+/* マクロ定義 */
+#define DELTA_T         (WHEEL_SPEED_PERIOD / 1000.0)   // 処理周期[s] (measure_taskの周期)
+#define DEG_TO_RAD      (PI / 180.0)
+
+#define VAR_ENC         0.0004      // エンコーダによる方位変化量の分散[deg^2/周期]
+#define VAR_ENC_SLIP    4.0         // エンコーダとジャイロの差の2乗に掛けてエンコーダの分散に加える係数
+#define VAR_GYRO        0.0025      // ジャイロによる方位変化量の分散[deg^2/周期] (1deg/sの量子化誤差相当)
+#define VAR_DIST        0.01        // 移動距離1mmあたりの位置の分散[mm^2/mm]
+#define BIAS_GAIN       0.01        // 停止中のバイアス学習の係数
+
+/* グローバル変数 */
+static POSE pose[2];                        // 自己位置(ダブルバッファ)
+static volatile uint32_t sequence = 0;      // 更新回数(pose[sequence & 1]が最新)
+
+static volatile bool_t reset_request = false;   // Pose_resetの要求
+static float reset_x, reset_y, reset_heading;   // Pose_resetで指定した値
+
+/* 角度を-180 ~ +180に収める */
+static float wrap(float deg) {
+    while(deg > 180.0)
+        deg -= 360.0;
+    while(deg <= -180.0)
+        deg += 360.0;
+    return deg;
+}
+
+/* 自己位置と共分散を指定した値にする */
+static void set_pose(POSE *p, float x, float y, float heading) {
+    memset(p->cov, 0, sizeof(p->cov));
+    p->x = x;
+    p->y = y;
+    p->heading = heading;
+}
+
+/* 初期化関数 */
+void Pose_init() {
+    set_pose(&pose[0], 0.0, 0.0, 0.0);
+    pose[0].gyro_bias = 0.0;
+    pose[1] = pose[0];
+    reset_request = false;
+    sequence = 0;
+}
+
+/* 自己位置を更新 */
+void Pose_update() {
+    SENSOR_SNAPSHOT sensor;
+    uint32_t next = sequence + 1;
+    POSE *cur = &pose[sequence & 1];
+    POSE *p = &pose[next & 1];
+    float dl, dr, ds;                       // 左右タイヤと車体の移動距離[mm]
+    float dth_enc, dth_gyro, dth;           // エンコーダ・ジャイロ・融合後の方位変化量[deg]
+    float rate;                             // ジャイロの角速度[deg/s]
+    float var_enc, var_th, w;
+    float c, s, jx, jy, q;
+    float pxx, pxy, pyy, pxt, pyt, ptt;
+
+    *p = *cur;
+    if(reset_request)                       // Pose_resetの要求を反映(書き込みはこの関数だけで行う)
+    {
+        set_pose(p, reset_x, reset_y, reset_heading);
+        reset_request = false;
+    }
+
+    SensorHub_get(&sensor);
+    dl = Distance_getDistance4msLeft();
+    dr = Distance_getDistance4msRight();
+    ds = (dl + dr) / 2.0;
+    rate = sensor.gyro_rate * POSE_GYRO_SIGN;
+
+    if(dl == 0.0 && dr == 0.0)              // 停止中はバイアスを学習し、方位は変化させない
+    {
+        p->gyro_bias += (rate - p->gyro_bias) * BIAS_GAIN;
+        dth = 0.0;
+        var_th = 0.0;
+    }
+    else
+    {
+        dth_enc = (180.0 / (PI * TREAD)) * (dl - dr);   // Direction_updateと同じ式
+        dth_gyro = (rate - p->gyro_bias) * DELTA_T;
+
+        var_enc = VAR_ENC + VAR_ENC_SLIP * (dth_enc - dth_gyro) * (dth_enc - dth_gyro);
+        w = VAR_GYRO / (var_enc + VAR_GYRO);            // エンコーダの重み
+        dth = w * dth_enc + (1.0 - w) * dth_gyro;
+        var_th = var_enc * VAR_GYRO / (var_enc + VAR_GYRO);
+    }
+
+    /* 移動の中間の方位で位置を積分 */
+    c = cosf((p->heading + dth / 2.0) * DEG_TO_RAD);
+    s = sinf((p->heading + dth / 2.0) * DEG_TO_RAD);
+    p->x += ds * c;
+    p->y += ds * s;
+    p->heading = wrap(p->heading + dth);
+
+    /* 共分散の更新 P = F P F^T + Q (F : 方位の誤差が位置の誤差に伝わる分のヤコビアン) */
+    jx = -ds * s * DEG_TO_RAD;              // dx/d方位
+    jy = ds * c * DEG_TO_RAD;               // dy/d方位
+    q = VAR_DIST * fabsf(ds);
+    pxx = p->cov[0][0]; pxy = p->cov[0][1]; pyy = p->cov[1][1];
+    pxt = p->cov[0][2]; pyt = p->cov[1][2]; ptt = p->cov[2][2];
+
+    p->cov[0][0] = pxx + 2.0 * jx * pxt + jx * jx * ptt + q;
+    p->cov[1][1] = pyy + 2.0 * jy * pyt + jy * jy * ptt + q;
+    p->cov[0][1] = p->cov[1][0] = pxy + jx * pyt + jy * pxt + jx * jy * ptt;
+    p->cov[0][2] = p->cov[2][0] = pxt + jx * ptt;
+    p->cov[1][2] = p->cov[2][1] = pyt + jy * ptt;
+    p->cov[2][2] = ptt + var_th;
+
+    __asm__ __volatile__("" ::: "memory");  // バッファの書き込み完了後に表裏を切り替える
+    sequence = next;
+}
+
+/* 自己位置を指定した値に設定し直す */
+void Pose_reset(float x, float y, float heading) {
+    reset_x = x;
+    reset_y = y;
+    reset_heading = wrap(heading);
+    __asm__ __volatile__("" ::: "memory");
+    reset_request = true;
+}
+
+/* 最新の自己位置を取得(更新中に読んだ場合は読み直す) */
+void Pose_get(POSE *out) {
+    uint32_t seq;
+
+    do
+    {
+        seq = sequence;
+        __asm__ __volatile__("" ::: "memory");
+        memcpy(out, &pose[seq & 1], sizeof(POSE));
+        __asm__ __volatile__("" ::: "memory");
+    }
+    while(seq + 1 < sequence);
+}
+
+/* x座標を取得 */
+float Pose_getX() {
+    POSE p;
+
+    Pose_get(&p);
+    return p.x;
+}
+
+/* y座標を取得 */
+float Pose_getY() {
+    POSE p;
+
+    Pose_get(&p);
+    return p.y;
+}
+
+/* 方位を取得 */
+float Pose_getHeading() {
+    POSE p;
+
+    Pose_get(&p);
+    return p.heading;
+}
+
+/* 指定座標までの距離を取得 */
+float Pose_getRange(float x, float y) {
+    POSE p;
+
+    Pose_get(&p);
+    return sqrtf((x - p.x) * (x - p.x) + (y - p.y) * (y - p.y));
+}
+
+/* 指定座標の向きを取得 */
+float Pose_getBearing(float x, float y) {
+    POSE p;
+
+    Pose_get(&p);
+    return wrap(atan2f(y - p.y, x - p.x) / DEG_TO_RAD - p.heading);
+}
@@ -0,0 +1,53 @@
+#ifndef _POSE_H_
+#define _POSE_H_
+
+#include "ev3api.h"
+#include "Distance.h"
+#include "SensorHub.h"
+
+/* 座標系
+ *   原点 : Pose_init/Pose_resetで指定した位置
+ *   x軸  : 方位0度の向き(前方), y軸 : 方位90度の向き(右方)
+ *   方位 : Directionと同じく右旋回が正[deg]
+ */
+
+/* ジャイロセンサーの角速度の符号(右旋回で正の値になる取り付け向きの場合は1, 逆向きの場合は-1) */
+#define POSE_GYRO_SIGN  1
+
+/* 自己位置(推定値と誤差共分散) */
+typedef struct {
+    float   x;              // x座標[mm]
+    float   y;              // y座標[mm]
+    float   heading;        // 方位[deg](右旋回が正)
+    float   cov[3][3];      // (x, y, 方位)の誤差共分散[mm^2, mm*deg, deg^2]
+    float   gyro_bias;      // 推定したジャイロセンサーのバイアス[deg/s]
+} POSE;
+
+/* 初期化関数(原点・方位0から推定を開始する) */
+void Pose_init();
+
+/* エンコーダとジャイロセンサーの値から自己位置を更新(measure_taskでDistance_updateの後に1周期に1回呼ぶ) */
+void Pose_update();
+
+/* 自己位置を指定した値に設定し直す(次のPose_updateで反映される) */
+void Pose_reset(float x, float y, float heading);
+
+/* 最新の自己位置を取得 */
+void Pose_get(POSE *pose);
+
+/* x座標[mm]を取得 */
+float Pose_getX();
+
+/* y座標[mm]を取得 */
+float Pose_getY();
+
+/* 方位[deg]を取得 */
+float Pose_getHeading();
+
+/* 現在位置から指定座標までの距離[mm]を取得 */
+float Pose_getRange(float x, float y);
+
+/* 現在の方位から見た指定座標の向き[deg](-180 ~ +180, 右が正)を取得 */
+float Pose_getBearing(float x, float y);
+
+#endif
@@ -0,0 +1,113 @@
+// 2点間の移動の速度プロファイル(台形・S字)
+// 動作開始時に各区間の開始時刻と開始時点の位置・速度・加速度を1回だけ計算し、毎周期は区間内の3次式を評価するだけにする
+//
+// S字の加速部分は 加加速(時間tj) -> 等加速(時間ta) -> 減加速(時間tj) で、加速にかかる距離は 速度 * (2tj + ta) / 2
+// 加速と減速は対称なので、加速と減速にかかる距離の合計は V * (V / A + tj)  (V : 最高速度、A : 最大加速度、tj = A / J)
+
+#include <math.h>
+#include "Profile.h"
+
+/* 速度プロファイルを計算する関数 */
+void Profile_init(PROFILE *profile, float distance, float speed, float accel, float jerk)
+{
+    float d = fabsf(distance);
+    float v = speed;
+    float a = accel;
+    float tj = 0.0, ta, tv;
+    float duration[PROFILE_SEGMENT_NUM];
+    float dt;
+    int i;
+
+    profile->sign = distance < 0 ? -1 : 1;
+
+    if(d <= 0 || v <= 0 || a <= 0)                  // 移動しない場合は全ての区間を0秒にする
+    {
+        for(i = 0; i <= PROFILE_SEGMENT_NUM; i++)
+        {
+            profile->time[i] = profile->pos[i] = profile->vel[i] = profile->acc[i] = 0.0;
+            if(i < PROFILE_SEGMENT_NUM)
+                profile->jerk[i] = 0.0;
+        }
+        return;
+    }
+
+    if(jerk > 0)
+    {
+        if(v * jerk < a * a)                        // 最大加速度に届く前に最高速度に達する場合は最大加速度を下げる
+            a = sqrtf(v * jerk);
+        tj = a / jerk;
+    }
+
+    if(v * (v / a + tj) > d)                        // 最高速度に届く前に減速を始める必要がある場合は最高速度を下げる
+    {
+        v = 0.5 * a * (-tj + sqrtf(tj * tj + 4 * d / a));   // v^2 / a + v * tj = d の正の解
+        if(jerk > 0 && v * jerk < a * a)            // 等加速の区間が無くなる場合は最大加速度も下げる(2 * v * sqrt(v / jerk) = d)
+        {
+            v = powf(0.5 * d * sqrtf(jerk), 2.0 / 3.0);
+            a = sqrtf(v * jerk);
+            tj = a / jerk;
+        }
+        tv = 0.0;
+    }
+    else
+    {
+        tv = (d - v * (v / a + tj)) / v;            // 等速の時間
+    }
+    ta = v / a - tj;
+    if(ta < 0)
+        ta = 0.0;
+
+    /* 各区間の時間と、区間の開始時点の加速度 */
+    duration[0] = tj;   profile->acc[0] = 0.0;
+    duration[1] = ta;   profile->acc[1] = a;
+    duration[2] = tj;   profile->acc[2] = a;
+    duration[3] = tv;   profile->acc[3] = 0.0;
+    duration[4] = tj;   profile->acc[4] = 0.0;
+    duration[5] = ta;   profile->acc[5] = -a;
+    duration[6] = tj;   profile->acc[6] = -a;
+    profile->acc[7] = 0.0;
+
+    /* 区間ごとに積分して開始時点の位置・速度を求める */
+    profile->time[0] = profile->pos[0] = profile->vel[0] = 0.0;
+    for(i = 0; i < PROFILE_SEGMENT_NUM; i++)
+    {
+        dt = duration[i];
+        profile->jerk[i] = dt > 0 ? (profile->acc[i + 1] - profile->acc[i]) / dt : 0.0;    // 台形の場合は加速度が不連続
+        profile->time[i + 1] = profile->time[i] + dt;
+        profile->vel[i + 1] = profile->vel[i] + profile->acc[i] * dt + profile->jerk[i] * dt * dt / 2;
+        profile->pos[i + 1] = profile->pos[i] + profile->vel[i] * dt + profile->acc[i] * dt * dt / 2
+                            + profile->jerk[i] * dt * dt * dt / 6;
+    }
+    profile->vel[PROFILE_SEGMENT_NUM] = 0.0;        // 丸め誤差を除いて終点に合わせる
+    profile->pos[PROFILE_SEGMENT_NUM] = d;
+}
+
+/* 時刻tの目標位置と目標速度を取得する関数 */
+void Profile_get(const PROFILE *profile, float t, float *pos, float *vel)
+{
+    float dt;
+    int i;
+
+    if(t >= profile->time[PROFILE_SEGMENT_NUM])     // 終了後
+    {
+        *pos = profile->sign * profile->pos[PROFILE_SEGMENT_NUM];
+        *vel = 0.0;
+        return;
+    }
+    if(t < 0)
+        t = 0.0;
+
+    for(i = PROFILE_SEGMENT_NUM - 1; i > 0 && t < profile->time[i]; i--)    // tを含む区間を探す
+        ;
+    dt = t - profile->time[i];
+
+    *pos = profile->sign * (profile->pos[i] + profile->vel[i] * dt + profile->acc[i] * dt * dt / 2
+                            + profile->jerk[i] * dt * dt * dt / 6);
+    *vel = profile->sign * (profile->vel[i] + profile->acc[i] * dt + profile->jerk[i] * dt * dt / 2);
+}
+
+/* 移動にかかる時間を取得する関数 */
+float Profile_getTime(const PROFILE *profile)
+{
+    return profile->time[PROFILE_SEGMENT_NUM];
+}
@@ -0,0 +1,37 @@
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include "ev3api.h"
+
+/* 速度プロファイル(2点間の移動の目標位置・速度) *****************************************************
+ * 移動距離・最高速度・最大加速度・加加速度(ジャーク)から、加速 -> 等速 -> 減速 の目標を動作開始時に計算する
+ * ジャークが0の場合は台形(加速度が不連続)、正の場合はS字(加速度も連続)になる
+ * 距離が短く最高速度(最大加速度)に届かない場合は、最高速度(最大加速度)を下げて距離ちょうどで止まるようにする
+ *******************************************************************************************************/
+
+#define PROFILE_SEGMENT_NUM 7       // 区間の数(加加速・等加速・減加速・等速・加減速・等減速・減減速)
+
+/* 速度プロファイル */
+typedef struct {
+    float   time[PROFILE_SEGMENT_NUM + 1];  // 各区間の開始時刻[s](time[PROFILE_SEGMENT_NUM]が終了時刻)
+    float   pos[PROFILE_SEGMENT_NUM + 1];   // 各区間の開始時点の位置[mm]
+    float   vel[PROFILE_SEGMENT_NUM + 1];   // 各区間の開始時点の速度[mm/s]
+    float   acc[PROFILE_SEGMENT_NUM + 1];   // 各区間の開始時点の加速度[mm/s^2]
+    float   jerk[PROFILE_SEGMENT_NUM];      // 各区間の加加速度[mm/s^3](台形の場合は0)
+    int8_t  sign;                           // 移動の向き(後退の場合は-1)
+} PROFILE;
+
+/* 速度プロファイルを計算する */
+// distance : 移動距離[mm](マイナスの値は後退)
+// speed    : 最高速度[mm/s](正の値)
+// accel    : 最大加速度[mm/s^2](正の値)
+// jerk     : 加加速度[mm/s^3](0で台形)
+void Profile_init(PROFILE *profile, float distance, float speed, float accel, float jerk);
+
+/* 開始からの時刻t[s]の目標位置[mm]と目標速度[mm/s]を取得する(終了後は終点で停止) */
+void Profile_get(const PROFILE *profile, float t, float *pos, float *vel);
+
+/* 移動にかかる時間[s]を取得 */
+float Profile_getTime(const PROFILE *profile);
+
+#endif
@@ -1,19 +1,17 @@
-#include <stdlib.h>
 #include "Run.h"
 
 /* マクロ定義 */
-#define DELTA_T 0.004   // 処理周期(4msの場合)
+#define DELTA_T (RUN_PERIOD / 1000000.0f)  // 処理周期[s] (PIDの基準、実際の経過時間はRun_getDtで実測する)
+#define DT_MIN  (RUN_PERIOD / 2)            // 実測周期として使う範囲[us] (範囲外はRUN_PERIODとして扱う)
+#define DT_MAX  (RUN_PERIOD * 2)
 // 下記のPID値が走行に与える影響については次のサイトが参考になります https://www.tsone.co.jp/blog/archives/889
-#define KP      0.88    // power100_1.68
-#define KI      0.16     // power100_0.47?
-#define KD      0.53    // power100_0.50
+#define ARM_UP_ANGLE        -20     // アームを上げる角度
+#define ARM_DOWN_ANGLE      -47     // アームを下げる角度
+#define TALE_OPEN_ANGLE     3800    // テールを開く角度
+#define TALE_CLOSE_ANGLE    200     // テールを閉じる角度
+#define TREAD_RATIO (TREAD / TIRE_DIAMETER)    // 車体トレッド幅 / タイヤ直径
 
 /* グローバル変数 */    // static宣言されたグローバル変数の範囲(スコープ)は、宣言した.cファイル内に限定される
-static const sensor_port_t
-    color_sensor    = EV3_PORT_2,
-    sonar_sensor    = EV3_PORT_3,
-    gyro_sensor     = EV3_PORT_4;
-
 static const motor_port_t
     left_motor      = EV3_PORT_C,
     right_motor     = EV3_PORT_B,
@@ -26,8 +24,8 @@ static int16_t  run_turn = 0;
 static int16_t  run_angle = 0;
 static uint32_t run_time = 0;
 
-static int32_t diff[2] = {0, 0};    // PID制御用(カラーセンサー)
-static float integral = 0.0;
+static PID_CTRL line_pid;           // PID制御用(カラーセンサー)
+static uint32_t line_pid_version;   // line_pidのゲインに反映した走行パラメータの版数
 
 /* 関数 */
 
@@ -38,9 +36,12 @@ void Run_init(void)
 
 void Run_update(void)
 {
+    SENSOR_SNAPSHOT sensor;
+
+    SensorHub_get(&sensor);                             // 今周期のセンサー値を取得
     ++run_time;                                         // 走行時間を加算
-    ev3_color_sensor_get_rgb_raw(color_sensor, &rgb);   // RGB値を更新
-    run_angle = ev3_gyro_sensor_get_angle(gyro_sensor); // 位置角(傾き)を更新
+    rgb = sensor.rgb;                                   // RGB値を更新
+    run_angle = sensor.gyro_angle;                      // 位置角(傾き)を更新
 }
 
 uint16_t getRGB_R(void){    // カラーセンサーのR値を取得
@@ -106,10 +107,19 @@ float math_limit(float n, float min, float max)
 /******************************************************************************************************************************************/
 void motor_ctrl(int8_t power, int16_t turn)
 {
-    turn = turn * -1;
+    run_power = power;                      // 計測用の変数を更新
+    run_turn = turn * COURSE_TURN_SIGN;     // 計測用の変数を更新
+    motor_ctrl_output(power, turn);
+}
 
-    run_power = power;  // 計測用の変数を更新
-    run_turn = turn;    // 計測用の変数を更新
+/* モーター出力設定関数 *********************************************************************************************************************/
+// motor_ctrlと同じ引数でモーターの出力だけを設定し、計測用の変数(Run_getPower, Run_getTurn)は更新しない
+// 計測用の変数は区間のタスクだけが書き込むため、measure_taskから走行するMotionはこの関数を使う
+/******************************************************************************************************************************************/
+void motor_ctrl_output(int8_t power, int16_t turn)
+{
+    WheelSpeed_disable();   // 速度制御中であれば終了し、出力を直接設定する
+    turn = turn * COURSE_TURN_SIGN;
 
     if(power < -100 || power > 100 || turn < -200 || turn > 200)    // 引数が許容範囲に収まっていない場合
     {
@@ -139,6 +149,33 @@ void motor_ctrl(int8_t power, int16_t turn)
     }
 }
 
+/* 速度指定モーター制御関数 *****************************************************************************************************************/
+// 左右タイヤの回転速度を指定して走行する(実際の速度はWheelSpeedの速度制御で目標値に追従させる)
+// バッテリー電圧や負荷が変わってもmotor_ctrlのように速度が変化しない
+//
+// v        : 前進速度(左右タイヤの平均回転速度[deg/s])．マイナスの値は後退．
+// omega    : 旋回速度(車体の旋回速度[deg/s])．プラスの値は右旋回(方位が増える方向)，マイナスの値は左旋回．
+//
+// 例       : motor_ctrl_speed(360, 0)の場合 タイヤが1秒に1回転する速度で直進する
+//            motor_ctrl_speed(0, 90)の場合  その場で1秒に90度右旋回する
+/******************************************************************************************************************************************/
+void motor_ctrl_speed(int16_t v, int16_t omega)
+{
+    int16_t diff = omega * TREAD_RATIO;     // 車体の旋回速度を左右タイヤの回転速度の差に換算
+
+    run_power = math_limit(v * 100 / WHEEL_SPEED_MAX, -100, 100);       // 計測用の変数を出力相当の値で更新
+    run_turn = math_limit(diff * 100 / WHEEL_SPEED_MAX, -200, 200);
+
+    WheelSpeed_setTarget(v + diff, v - diff);
+}
+
+/* 積まれたアーム・テール動作が完了するまで待機する */
+static void wait_attachment(void)
+{
+    while(Motion_isAttachmentBusy())
+        tslp_tsk(4 * 1000U); /* 4msec周期起動 */
+}
+
 //*****************************************************************************
 // 関数名 : arm_up, arm_down
 // 引数 : 無し
@@ -152,10 +189,18 @@ void arm_up(uint8_t power, bool_t loop)
     int32_t cur_angle = ev3_motor_get_counts(arm_motor);    // 現在のモーター角度
     int8_t cur_power = ev3_motor_get_power(arm_motor);      // 現在のモーター出力
 
+    if(loop)                                                // loopがtrueの場合はMotionで動かし、完了まで待機する
+    {
+        wait_attachment();
+        Motion_moveArm(power, ARM_UP_ANGLE, NULL, 0);
+        wait_attachment();
+        return;
+    }
+
     do
     {
         // printf("%d ", cur_angle);
-        if(cur_angle < -20)                                     // 指定角度に到達していない場合
+        if(cur_angle < ARM_UP_ANGLE)                            // 指定角度に到達していない場合
         {
             if(cur_power < power)                                   // 指定出力に到達していない場合
                 ++cur_power;                                            // 出力増加
@@ -190,10 +235,18 @@ void arm_down(uint8_t power, bool_t loop)
     int32_t cur_angle = ev3_motor_get_counts(arm_motor);    // 現在のモーター角度
     int8_t cur_power = ev3_motor_get_power(arm_motor);      // 現在のモーター出力
 
+    if(loop)                                                // loopがtrueの場合はMotionで動かし、完了まで待機する
+    {
+        wait_attachment();
+        Motion_moveArm(power, ARM_DOWN_ANGLE, NULL, 0);
+        wait_attachment();
+        return;
+    }
+
     do
     {
         // printf("%d ", cur_angle);
-        if(cur_angle > -47)                                             // 指定角度に到達していない場合
+        if(cur_angle > ARM_DOWN_ANGLE)                                  // 指定角度に到達していない場合
         {
             if(cur_power > power * -1)                                      // 指定出力に到達していない場合
                 --cur_power;                                                    // 出力増加
@@ -235,10 +288,18 @@ void tale_open(uint8_t power, bool_t loop)
     int32_t cur_angle = ev3_motor_get_counts(tale_motor);   // 現在のモーター角度
     int8_t cur_power = ev3_motor_get_power(tale_motor);     // 現在のモーター出力
 
+    if(loop)                                                // loopがtrueの場合はMotionで動かし、完了まで待機する
+    {
+        wait_attachment();
+        Motion_moveTale(power, TALE_OPEN_ANGLE, NULL, 0);
+        wait_attachment();
+        return;
+    }
+
     do
     {
         // printf("%d ", cur_angle);
-        if(cur_angle < 3800)                                    // 指定角度に到達していない場合
+        if(cur_angle < TALE_OPEN_ANGLE)                         // 指定角度に到達していない場合
         {
             if(cur_power < power)                                   // 指定出力に到達していない場合
                 ++cur_power;                                            // 出力増加
@@ -273,10 +334,18 @@ void tale_close(uint8_t power, bool_t loop)
     int32_t cur_angle = ev3_motor_get_counts(tale_motor);   // 現在のモーター角度
     int8_t cur_power = ev3_motor_get_power(tale_motor);     // 現在のモーター出力
 
+    if(loop)                                                // loopがtrueの場合はMotionで動かし、完了まで待機する
+    {
+        wait_attachment();
+        Motion_moveTale(power, TALE_CLOSE_ANGLE, NULL, 0);
+        wait_attachment();
+        return;
+    }
+
     do
     {
         // printf("%d ", cur_angle);
-        if(cur_angle > 200)                                             // 指定角度に到達していない場合
+        if(cur_angle > TALE_CLOSE_ANGLE)                                // 指定角度に到達していない場合
         {
             if(cur_power > power * -1)                                      // 指定出力に到達していない場合
                 --cur_power;                                                    // 出力増加
@@ -313,10 +382,12 @@ void tale_close(uint8_t power, bool_t loop)
 /*********************************************************************************/
 void Run_setStop_Line(bool_t loop)
 {
+    SENSOR_SNAPSHOT sensor;
+
     do
     {
-        ev3_color_sensor_get_rgb_raw(color_sensor, &rgb);
-        if(rgb.r < 60 && rgb.g < 90 && rgb.b < 90)  // 黒ラインを検知した場合
+        SensorHub_get(&sensor);
+        if(COLOR_IN(ColorClassifier_get(&sensor.rgb), COLOR_CLASS_BLACK))  // 黒ラインを検知した場合
         {
             motor_ctrl(0, 0);                           // 左右モーター停止
             return;                                     // 関数を終了
@@ -328,6 +399,20 @@ void Run_setStop_Line(bool_t loop)
     while(loop);
 }
 
+/* 積まれた走行動作が完了するまで待機する */
+static void wait_drive(void)
+{
+    while(Motion_isDriveBusy())
+        tslp_tsk(4 * 1000U); /* 4msec周期起動 */
+}
+
+/* Motionが停止させた状態を計測用の変数に反映する(Motionは区間のタスクの変数を書き換えないため、待機後に区間のタスクで行う) */
+static void drive_stopped(int16_t turn)
+{
+    run_power = 0;
+    run_turn = turn * COURSE_TURN_SIGN;
+}
+
 /* 指定した距離に到達するまで、指定出力で移動または旋回する関数 *********************************/
 // power        : motor_ctrl関数のpower値(-100 ~ +100)
 // turn         : motor_ctrl関数のturn値(-200 ~ +200)
@@ -335,50 +420,29 @@ void Run_setStop_Line(bool_t loop)
 /******************************************************************************************/
 void Run_setDistance(int8_t power, int16_t turn, float distance)
 {
-    Distance_update();                                          // 距離を更新
-    float ref_distance = Distance_getDistance();                // 処理開始時点での距離を取得
+    // 距離はmeasure_taskが周期ごとに更新し、走行はMotion_updateが行う
+    wait_drive();                                               // 先に積まれた走行動作の完了を待つ
+    Motion_driveDistance(power, turn, distance, false, NULL, 0);
+    wait_drive();                                               // モーターが停止するまで待機
+    drive_stopped(turn);
+}
 
-    if(power > 0 && distance > 0)                               // 前進の場合
-    {
-        while(1)                                                    // モーターが停止するまでループ
-        {
-            Distance_update();                                          // 距離を更新
-            if(Distance_getDistance() >= (ref_distance + distance))     // 指定距離に到達した場合
-            {
-                motor_ctrl_alt(0, turn, 0.1);                               // モーターが停止するまで減速
-                if(run_power == 0)                                          // モーターが完全に停止した場合
-                    return;                                                     // 関数を終了
-            }
-            else                                                        // 指定距離に到達していない場合
-            {
-                motor_ctrl_alt(power, turn, 0.1);                           // 指定出力になるまで加速して走行
-            }
-            tslp_tsk(4 * 1000U); /* 4msec周期起動 */
-        }
-    }
-    else if(power < 0 && distance < 0)                          // 後退の場合
-    {
-        while(1)                                                    // モーターが停止するまでループ
-        {
-            Distance_update();                                          // 距離を更新
-            if(Distance_getDistance() <= (ref_distance + distance))     // 指定距離に到達した場合
-            {
-                motor_ctrl_alt(0, turn, 0.1);                               // モーターが停止するまで減速
-                if(run_power == 0)                                          // モーターが完全に停止した場合
-                    return;                                                     // 関数を終了
-            }
-            else                                                        // 指定距離に到達していない場合
-            {
-                motor_ctrl_alt(power, turn, 0.1);                               // 指定出力になるまで加速して走行
-            }
-            tslp_tsk(4 * 1000U); /* 4msec周期起動 */
-        }
-    }
-    else                                                        // 正しい引数が得られなかった場合
-    {
-        printf("argument out of range @ Run_setDistance()\n");  // エラーメッセージを出して
-        exit(1);                                                // 異常終了
-    }
+/* 速度プロファイルに沿って加減速し、指定した距離で停止する関数 *****************************/
+// Run_setDistanceと違い終点の手前から減速するため、速い速度でも行き過ぎずに停止できる
+//
+// distance     : 移動する距離[mm](マイナスの値は後退)
+// speed        : 最高速度[mm/s]
+// 加速度・加加速度は走行パラメータ(motion.accel, motion.jerk)を使う
+/******************************************************************************************/
+void Run_setProfile(float distance, float speed)
+{
+    // プロファイルは動作開始時にmeasure_taskで計算し、追従はMotion_updateが行う
+    if(distance == 0)                                           // 距離0はMotion_driveProfileが受け付けないので、移動しない
+        return;                                                 // (slalom.shift等のパラメータは0を許す)
+    wait_drive();                                               // 先に積まれた走行動作の完了を待つ
+    Motion_driveProfile(distance, speed, Param_get()->motion_accel, Param_get()->motion_jerk, false, NULL, 0);
+    wait_drive();                                               // 停止するまで待機
+    drive_stopped(0);
 }
 
 /* 指定した方位に到達するまで、指定出力で旋回または移動する関数 *********************************/
@@ -388,56 +452,11 @@ void Run_setDistance(int8_t power, int16_t turn, float distance)
 /******************************************************************************************/
 void Run_setDirection(int8_t power, int16_t turn, float direction)
 {
-    Distance_update();                                              // 距離を更新
-    Direction_update();                                             // 方位を更新
-
-    float ref_direction = Direction_getDirection();                 // 処理開始時点での方位を取得
-
-    direction = direction * -1;
-    
-    if(power != 0 && turn > 0 && direction < 0)                     // 右旋回の場合
-    {
-        while(1)                                                        // モーターが停止するまでループ
-        {
-            Distance_update();                                              // 距離を更新
-            Direction_update();                                             // 方位を更新
-            if(Direction_getDirection() <= (ref_direction + direction))     // 指定方位に到達した場合
-            {
-                motor_ctrl_alt(0, turn, 0.1);                                   // モーターが停止するまで減速
-                if(run_power == 0)                                              // モーターが完全に停止した場合
-                    return;                                                         // 関数を終了
-            }
-            else                                                            // 指定方位に到達していない場合
-            {
-                motor_ctrl_alt(power, turn, 0.1);                               // 指定出力になるまで加速して旋回
-            }
-            tslp_tsk(4 * 1000U); /* 4msec周期起動 */
-        }
-    }
-    else if(power != 0 && turn < 0 && direction > 0)                // 左旋回の場合
-    {
-        while(1)                                                        // モーターが停止するまでループ
-        {
-            Distance_update();                                              // 距離を更新
-            Direction_update();                                             // 方位を更新
-            if(Direction_getDirection() >= (ref_direction + direction))     // 指定方位に到達した場合
-            {
-                motor_ctrl_alt(0, turn, 0.1);                                   // モーターが停止するまで減速
-                if(run_power == 0)                                              // モーターが完全に停止した場合
-                    return;                                                         // 関数を終了
-            }
-            else                                                            // 指定方位に到達していない場合
-            {
-                motor_ctrl_alt(power, turn, 0.1);                               // 指定出力になるまで加速して旋回
-            }
-            tslp_tsk(4 * 1000U); /* 4msec周期起動 */
-        }
-    }
-    else                                                        // 正しい引数が得られなかった場合
-    {
-        printf("argument out of range @ Run_setDirection()\n"); // エラーメッセージを出して
-        exit(1);                                                // 異常終了
-    }
+    // 方位はmeasure_taskが周期ごとに更新し、旋回はMotion_updateが行う
+    wait_drive();                                               // 先に積まれた走行動作の完了を待つ
+    Motion_turnDirection(power, turn, direction, false, NULL, 0);
+    wait_drive();                                               // モーターが停止するまで待機
+    drive_stopped(turn);
 }
 
 /* 指定した距離に障害物を検知するまで、指定出力で前進または旋回する関数 ***********************/
@@ -448,49 +467,11 @@ void Run_setDirection(int8_t power, int16_t turn, float direction)
 /****************************************************************************************/
 void Run_setDetection(int8_t power, int16_t turn, int16_t detection, float distance)
 {
-    Distance_update();                                                  // 距離を更新
-    float ref_distance = Distance_getDistance();                        // 処理開始時点での距離を取得
-    
-    if(power > 0 && distance == 0)                                      // 距離の指定がない場合
-    {
-        while(1)                                                            // モーターが停止するまでループ
-        {
-            if(ev3_ultrasonic_sensor_get_distance(sonar_sensor) <= detection)   // 障害物を検知した場合
-            {
-                motor_ctrl_alt(0, turn, 0.1);                                       // モーターが停止するまで減速
-                if(run_power == 0)                                                  // モーターが完全に停止した場合
-                    return;                                                             // 関数を終了
-            }
-            else                                                                // 障害物を検知していない場合
-            {
-                motor_ctrl_alt(power, turn, 0.1);                                   // 指定出力になるまで加速して走行
-            }
-            tslp_tsk(4 * 1000U); /* 4msec周期起動 */
-        }
-    }
-    else if(power > 0 && distance > 0)                                  // 距離の指定がある場合
-    {        
-        while(1)                                                            // モーターが停止するまでループ
-        {
-            Distance_update();                                                  // 距離を更新
-            if(ev3_ultrasonic_sensor_get_distance(sonar_sensor) <= detection || Distance_getDistance() >= (ref_distance + distance))
-            {                                                                   // 障害物を検知した場合、または指定距離に到達した場合
-                motor_ctrl_alt(0, turn, 0.1);                                       // モーターが停止するまで減速
-                if(run_power == 0)                                                  // モーターが完全に停止した場合
-                    return;                                                             // 関数を終了
-            }
-            else                                                                // 障害物を未検知、かつ指定距離に到達していない場合
-            {
-                motor_ctrl_alt(power, turn, 0.1);                                   // 指定出力になるまで加速して走行
-            }
-            tslp_tsk(4 * 1000U); /* 4msec周期起動 */
-        }
-    }
-    else                                                        // 正しい引数が得られなかった場合
-    {
-        printf("argument out of range @ Run_setDetection()\n"); // エラーメッセージを出して
-        exit(1);                                                // 異常終了
-    }
+    // 障害物検知・距離はmeasure_taskが周期ごとに更新し、走行はMotion_updateが行う
+    wait_drive();                                               // 先に積まれた走行動作の完了を待つ
+    Motion_driveDetection(power, turn, detection, distance, false, NULL, 0);
+    wait_drive();                                               // モーターが停止するまで待機
+    drive_stopped(turn);
 }
 
 
@@ -499,8 +480,62 @@ void Run_setDetection(int8_t power, int16_t turn, int16_t detection, float dista
 /************************************************************************/
 void Run_PID_init()
 {
-    diff[0] = 0;
-    integral = 0.0;
+    line_pid_version = Param_getVersion();
+    PID_init(&line_pid, Param_get()->line_kp, Param_get()->line_ki, Param_get()->line_kd, DELTA_T);    // ゲインを設定して状態をリセット(Param.cを参照)
+    PID_setLimit(&line_pid, -200, 200);         // motor_ctrl関数のturn値の範囲
+    GainSchedule_init(&line_pid);               // 上記のゲインをゲインスケジューリングの基準にする
+}
+
+/* ゲインスケジューリング関数 ***************************************************************************/
+// 走行出力と推定した走行路の曲率からPIDゲインを補間して切り替える(テーブルはGainSchedule.cを参照)
+// Run_getTurn_sensorPIDの前に毎周期呼ぶ(Bluetoothで変更されたゲインもここで反映する)
+//
+// power        : 現在のモーター出力値
+/*******************************************************************************************************/
+void Run_PID_schedule(int8_t power)
+{
+    const PARAM *param;
+
+    if(line_pid_version != Param_getVersion())  // 走行中に走行パラメータが変更された場合は基準ゲインを変更する
+    {
+        line_pid_version = Param_getVersion();
+        param = Param_get();
+        PID_setGain(&line_pid, param->line_kp, param->line_ki, param->line_kd);
+        GainSchedule_setBase(&line_pid);
+    }
+    GainSchedule_update(&line_pid, power);
+}
+
+/* PIDの内部状態取得関数 *******************************************************************************/
+// テレメトリ用(measure_taskから呼ぶため、main_taskの更新途中の値が混ざることがある)
+//
+// error        : 前回の偏差
+// p, i, d      : 前回の比例項・積分項・微分項(Q16.16)
+/*******************************************************************************************************/
+void Run_PID_getTerms(int32_t *error, q16_t *p, q16_t *i, q16_t *d)
+{
+    *error = line_pid.prev_error;
+    *p = (q16_t)(line_pid.prev_error * line_pid.kp);
+    *i = Q16_MUL(line_pid.ki, line_pid.integral);
+    *d = line_pid.d_filtered;
+}
+
+/* 実測周期取得関数 **************************************************************************************/
+// 各区間のメインループの前回の起床から今回の起床までの時間(LoopTiming.hを参照)
+// 区間の最初の周期や、状態の中で待機した直後(周期の2倍を超える)はPIDの状態が古いため、1周期分として扱う
+// 区間のタスク以外(measure_task等)から呼ぶと他のタスクの周期になるため、区間のループの中でのみ使用する
+//
+// 返り値       : 実測周期[us]
+/*******************************************************************************************************/
+uint32_t Run_getDt(void)
+{
+    uint32_t dt = LoopTiming_getSectionDt();
+
+    if(dt == 0 || dt > DT_MAX)
+        return RUN_PERIOD;
+    else if(dt < DT_MIN)
+        return DT_MIN;
+    return dt;
 }
 
 /* PID制御関数(定数) * (センサー入力値 - 目標値) **********************************************************/
@@ -513,17 +548,9 @@ void Run_PID_init()
 /*******************************************************************************************************/
 int16_t Run_getTurn_sensorPID(uint16_t sensor_val, uint16_t target_val)    // センサー値, センサーの目標値
 {
-    float p, i, d;
+    q16_t dt = (q16_t)(((int64_t)Run_getDt() << 16) / 1000000);          // 実測周期[s]
 
-    diff[0] = diff[1];
-    diff[1] = sensor_val - target_val;  // 偏差を取得
-    integral += (diff[1] + diff[0]) / 2.0 * DELTA_T;
-
-    p = KP * diff[1];
-    i = KI * integral;
-    d = KD * (diff[1] - diff[0]) / DELTA_T;
-
-    return roundf(math_limit(p + i + d, -200.0, 200.0));    // 最大・最小値を制限し、四捨五入した値を返す
+    return PID_updateDt(&line_pid, (int32_t)sensor_val - target_val, dt);  // 最大・最小値を制限し、四捨五入した値を返す(PID.cを参照)
 }
 
 
@@ -533,13 +560,17 @@ int16_t Run_getTurn_sensorPID(uint16_t sensor_val, uint16_t target_val)    // 
 // current_power : 現在の出力値
 // target_power  : 目標の出力値
 // change_rate   : 増減の変化量 *例として0.2とした場合、4ms(1周期)で出力値が0.2ずつ変化し、20ms経過すると出力値が 1 変化することになる
+// dt            : 呼び出し側のループの周期[us] *区間のループではRun_getDt()の実測周期を渡す
+//                 (実際の変化量はdtに比例させるため、周期が変わっても時間あたりの変化量は変わらない)
 //
 // 返り値        : 指定量の加減速を行ったモーターの出力値(小数点以下の値はモーターが対応していないため切り捨て)
 /*******************************************************************************************************************************************/
-int8_t Run_getPower_change(int8_t current_power, int8_t target_power, float change_rate)
+int8_t Run_getPower_change(int8_t current_power, int8_t target_power, float change_rate, uint32_t dt)
 {
     static float power = 0;                 // 出力値を保持する変数
 
+    change_rate = change_rate * dt / (4 * 1000.0f);     // 4msあたりの変化量を今周期の変化量に換算
+
     if(current_power < target_power)        // 現在値 < 目標値 の時
     {
         if(floorf(power) != current_power)      // 現在値が指定した変化量を超えて増減した場合の対策
@@ -561,10 +592,12 @@ int8_t Run_getPower_change(int8_t current_power, int8_t target_power, float chan
 }
 
 /* 目標の出力値に到達するまで、指定量の出力値の増減を行い、その結果を返す関数 *********************************************************************/
-int8_t Run_getTurn_change(int8_t current_turn, int8_t target_turn, float change_rate)
+int8_t Run_getTurn_change(int8_t current_turn, int8_t target_turn, float change_rate, uint32_t dt)
 {
     static float turn = 0;                 // 出力値を保持する変数
 
+    change_rate = change_rate * dt / (4 * 1000.0f);     // 4msあたりの変化量を今周期の変化量に換算
+
     if(current_turn < target_turn)        // 現在値 < 目標値 の時
     {
         if(floorf(turn) != current_turn)      // 現在値が指定した変化量を超えて増減した場合の対策
@@ -590,41 +623,14 @@ int8_t Run_getTurn_change(int8_t current_turn, int8_t target_turn, float change_
 // 使用方法に制限あり
 // 悪い例：motor_ctrl_alt(50, 0, 1);   ←のように１度の処理周期内に連続で記述すると動作に問題が生じる為,if文などで実行タイミングを別々にする必要がある
 //        motor_ctrl_alt(0, 0, 1);
+// dtには呼び出し側のループの周期[us]を渡す(Run_getPower_changeを参照)
 /******************************************************************************************************************************************/
-void motor_ctrl_alt(int8_t power, int16_t turn, float change_rate)
+void motor_ctrl_alt(int8_t power, int16_t turn, float change_rate, uint32_t dt)
 {
-    turn = turn * -1;
-
-    power = Run_getPower_change(run_power, power, change_rate); // 出力調整
-    run_power = power;  // 計測用の変数を更新
-    run_turn = turn;    // 計測用の変数を更新
-
-    if(power < -100 || power > 100 || turn < -200 || turn > 200)    // 引数が許容範囲に収まっていない場合
-    {
-        power   = math_limit(power, -100, 100);                         // math_limit関数を利用して
-        turn    = math_limit(turn, -200, 200);                          // 値を許容範囲に収めてから走行処理を行う
-    }
-    
-    if(power != 0 && turn == 0)                                     // 前後進
-    {
-        ev3_motor_set_power(left_motor, power);
-        ev3_motor_set_power(right_motor, power);
-    }
-    else if(turn > 0)                                               // 右旋回
-    {
-        ev3_motor_set_power(left_motor, power);
-        ev3_motor_set_power(right_motor, power - (turn * power / 100)); // turnをpowerの比率に合わせる
-    }
-    else if(turn < 0)                                               // 左旋回
-    {
-        ev3_motor_set_power(left_motor, power + (turn * power / 100));  // turnをpowerの比率に合わせる
-        ev3_motor_set_power(right_motor, power);
-    }
-    else                                                            // 引数(0, 0)で左右モーター停止
-    {
-        ev3_motor_stop(left_motor, true);
-        ev3_motor_stop(right_motor, true);
-    }
+    power = Run_getPower_change(run_power, power, change_rate, dt); // 出力調整
+    run_power = power;                      // 計測用の変数を更新
+    run_turn = turn * COURSE_TURN_SIGN;     // 計測用の変数を更新
+    motor_ctrl_output(power, turn);
 }
 
 /* サンプリングを用いたパターン判別関数*******************************************************************************************************/
@@ -633,18 +639,20 @@ void motor_ctrl_alt(int8_t power, int16_t turn, float change_rate)
 /******************************************************************************************************************************************/
 int8_t sampling_sonic(void)
 {
+    SENSOR_SNAPSHOT sensor;
     int loop;
     int sampling_cnt = 0;
     int8_t pattern;
 
     for(loop=0;loop<100;loop++)                                                 // サンプリングを１００回行う
     {
-        if(ev3_ultrasonic_sensor_get_distance(sonar_sensor) <= 25)
+        SensorHub_get(&sensor);
+        if(sensor.sonar <= 25)
             sampling_cnt++;
         tslp_tsk(4 * 1000U); /* 4msec周期起動 */
     }
 
-    if(sampling_cnt >= 50)                                                      // サンプリングを基にパターン判別を行う
+    if(sampling_cnt >= COURSE_SONIC_THRESHOLD)                                      // サンプリングを基にパターン判別を行う
         pattern = 1;
     else
         pattern = 0;
@@ -657,12 +665,12 @@ int8_t sampling_turn(int16_t turn)
 {
     static uint8_t flag = 0;
     static uint8_t cnt = 0;
-    static int16_t sampling_data[30] = {0};
+    static int16_t sampling_data[COURSE_TURN_WINDOW] = {0};
 
     uint8_t i = 0;
     int16_t avg = 0;
 
-    if(cnt < 30)
+    if(cnt < COURSE_TURN_WINDOW)
     {
         if(turn < 0)
             sampling_data[cnt] = turn * (-1);
@@ -671,20 +679,20 @@ int8_t sampling_turn(int16_t turn)
 
         cnt++;
 
-        if(cnt == 29)
+        if(cnt == COURSE_TURN_WINDOW - 1)
         {
             cnt = 0;
             flag = 1;
         }
     }
 
-    for(i = 0; i < 30; i++)
+    for(i = 0; i < COURSE_TURN_WINDOW; i++)
     {
         avg += sampling_data[i];
     }
-    avg = avg / 30;
+    avg = avg / COURSE_TURN_WINDOW;
 
-    if(flag == 1 && avg < 10)
+    if(flag == 1 && avg < COURSE_TURN_STRAIGHT)
         return 1;
     else
         return 0;
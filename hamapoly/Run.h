@@ -3,8 +3,22 @@
 
 // #include "math.h"        Grid.hで記述
 // #include "Distance"      Direction.hで記述
+#include "Course.h"
+#include "Param.h"
 #include "Direction.h"
 #include "Grid.h"
+#include "ColorClassifier.h"
+#include "GainSchedule.h"
+#include "WheelSpeed.h"
+#include "Pose.h"
+#include "Motion.h"
+#include "Telemetry.h"
+#include "LoopTiming.h"
+#include "Fsm.h"
+#include "Script.h"
+
+/* マクロ定義 */
+#define RUN_PERIOD  (4 * 1000U)     // 各区間のメインループの周期[us] (LoopTiming_sleepで一定に保つ)
 
 /* 関数プロトタイプ宣言 */
 
@@ -30,6 +44,12 @@ float   math_limit(float n, float min, float max);
 // モーターの制御を行う関数(ev3_motor_steerの代替)
 void    motor_ctrl(int8_t power, int16_t turn);
 
+// motor_ctrlと同じ引数でモーターの出力だけを設定する関数(Run_getPower, Run_getTurnの値は更新しない)
+void    motor_ctrl_output(int8_t power, int16_t turn);
+
+// 左右タイヤの回転速度を指定してモーターの制御を行う関数(前進速度・旋回速度[deg/s])
+void    motor_ctrl_speed(int16_t v, int16_t omega);
+
 // アームの上下を制御する関数
 void    arm_up(uint8_t power, bool_t loop);
 void    arm_down(uint8_t power, bool_t loop);
@@ -45,6 +65,9 @@ void    Run_setStop_Line(bool_t loop);
 // 指定した距離に到達するまで、指定出力で移動または旋回する関数
 void    Run_setDistance(int8_t power, int16_t turn, float distance);
 
+// 速度プロファイルに沿って加減速し、指定した距離で停止する関数(加速度・加加速度は走行パラメータを使う)
+void    Run_setProfile(float distance, float speed);
+
 // 指定した方位に到達するまで、指定出力で旋回または移動する関数
 void    Run_setDirection(int8_t power, int16_t turn, float direction);
 
@@ -55,18 +78,27 @@ void    Run_setDetection(int8_t power, int16_t turn, int16_t detection, float di
 // PID初期化関数
 void    Run_PID_init();
 
+// 走行出力と曲率に応じてPIDゲインを切り替える関数
+void    Run_PID_schedule(int8_t power);
+
+// PIDの偏差と各項を取得する関数(テレメトリ用)
+void    Run_PID_getTerms(int32_t *error, q16_t *p, q16_t *i, q16_t *d);
+
+// 区間のメインループの実測周期を取得する関数(区間のループの中でのみ使用する)
+uint32_t Run_getDt(void);
+
 // PID制御関数(定数) * (センサ入力値 - 目標値)
 int16_t Run_getTurn_sensorPID(uint16_t sensor_val, uint16_t target_val);
 
 
 // 目標の出力値に到達するまで、指定量の出力値の増減を行い、その結果を返す関数
-int8_t  Run_getPower_change(int8_t current_power, int8_t target_power, float change_rate);
+int8_t  Run_getPower_change(int8_t current_power, int8_t target_power, float change_rate, uint32_t dt);
 
 // 目標の出力値に到達するまで、指定量の出力値の増減を行い、その結果を返す関数
-int8_t  Run_getTurn_change(int8_t current_turn, int8_t target_turn, float change_rate);
+int8_t  Run_getTurn_change(int8_t current_turn, int8_t target_turn, float change_rate, uint32_t dt);
 
 // モーターの制御を加減速を伴って行う関数
-void    motor_ctrl_alt(int8_t power, int16_t turn, float change_rate);
+void    motor_ctrl_alt(int8_t power, int16_t turn, float change_rate, uint32_t dt);
 
 
 //パターン判別のためにサンプリングを行う関数
@@ -0,0 +1,389 @@
+// コーススクリプトの読み込みと実行(ファイル形式はScript.hを参照)
+// 命令・オペランド・分岐先・パラメータ名の検証は読み込み時に1回だけ行い、実行時は検証済みのコードをそのまま解釈する
+
+#include <string.h>
+#include "Script.h"
+#include "Run.h"
+
+/* 読み込んだスクリプト */
+typedef struct {
+    const uint8_t   *routine;       // ルーチン表
+    uint8_t         routine_num;
+    const uint8_t   *code;
+    uint16_t        code_size;
+    size_t          param_offset[SCRIPT_PARAM_REF_MAX]; // パラメータ表の番号 -> 走行パラメータのPARAM構造体内の位置
+    PARAM_TYPE      param_type[SCRIPT_PARAM_REF_MAX];
+    bool_t          valid;
+} SCRIPT;
+
+#define ROUTINE_ENTRY_SIZE  (SCRIPT_NAME_MAX + 2)
+
+/* 命令ごとのオペランドの数(Script.hの命令の順) */
+static const uint8_t operand_num[SCRIPT_OP_NUM] = {
+    1, 1, 2, 3, 3, 4, 4, 1, 1, 3, 1, 1, 1, 1, 0, 1, 1, 2
+};
+
+/* until_colorの色(colorid_t) -> 判定する色(ColorClassifier.h) 黒はRun_setStop_Lineと同じ閾値、判定範囲の無い色は-1 */
+static const int8_t until_color_class[TNUM_COLOR] = {
+    -1, COLOR_CLASS_BLACK, COLOR_CLASS_BLUE, -1, COLOR_CLASS_YELLOW, COLOR_CLASS_RED, -1, -1
+};
+
+extern const uint8_t script_default[];          // 組み込みのスクリプト(ScriptDefault.c)
+extern const uint32_t script_default_size;
+
+static SCRIPT builtin;                          // 組み込みのスクリプト
+static SCRIPT loaded;                           // ファイルから読み込んだスクリプト
+static uint8_t script_buf[SCRIPT_FILE_MAX];     // ファイルの内容
+static uint8_t boundary[SCRIPT_FILE_MAX / 8];   // 検証用 : 命令の先頭の位置のビット列
+
+/* リトルエンディアンの2バイトを読む */
+static uint16_t get_u16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+/* CRC-16/CCITT(Telemetry.cと同じ) */
+static uint16_t crc16(const uint8_t *data, uint32_t size)
+{
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+    int bit;
+
+    for(i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+static bool_t is_boundary(uint32_t pc)
+{
+    return (boundary[pc >> 3] >> (pc & 7)) & 1;
+}
+
+/* 走行パラメータのキー名からPARAM構造体内の位置を探す 返り値 : 0(成功)/-1(見つからない) */
+static int find_param(const char *key, size_t *offset, PARAM_TYPE *type)
+{
+    const char *name;
+    int id;
+
+    for(id = 0; id < Param_getNum(); id++)
+    {
+        if(Param_getInfo(id, &name, type) == 0 && strcmp(name, key) == 0)
+            return Param_getOffset(id, offset);
+    }
+
+    return -1;
+}
+
+/* バイト列を検証してスクリプトとして設定する 返り値 : 0(成功)/-1(不正) */
+static int parse(SCRIPT *s, const char *source, const uint8_t *data, uint32_t size)
+{
+    const uint8_t *params;
+    char key[SCRIPT_PARAM_NAME_MAX + 1];
+    uint32_t pc, next, offset;
+    uint8_t op = SCRIPT_OP_NUM, mask, n, param_num;
+    int i;
+
+    s->valid = false;
+
+    if(size < SCRIPT_HEADER_SIZE || size > SCRIPT_FILE_MAX || data[0] != 'C' || data[1] != 'S' || data[2] != SCRIPT_VERSION)
+    {
+        printf("%s: not a script (version %d)\n", source, SCRIPT_VERSION);
+        return -1;
+    }
+    if(get_u16(&data[8]) != crc16(&data[SCRIPT_HEADER_SIZE], size - SCRIPT_HEADER_SIZE))
+    {
+        printf("%s: checksum mismatch\n", source);
+        return -1;
+    }
+
+    s->routine_num = data[3];
+    param_num = data[4];
+    s->code_size = get_u16(&data[6]);
+    offset = SCRIPT_HEADER_SIZE + s->routine_num * ROUTINE_ENTRY_SIZE + param_num * SCRIPT_PARAM_NAME_MAX;   // コードの先頭の位置
+
+    if(param_num > SCRIPT_PARAM_REF_MAX || s->code_size == 0 || offset + s->code_size != size)  // 表の位置はサイズを確かめてから求める
+    {
+        printf("%s: bad size\n", source);
+        return -1;
+    }
+    s->routine = &data[SCRIPT_HEADER_SIZE];
+    params = s->routine + s->routine_num * ROUTINE_ENTRY_SIZE;
+    s->code = &data[offset];
+
+    /* パラメータ名をPARAM構造体内の位置に変換 */
+    for(i = 0; i < param_num; i++)
+    {
+        memcpy(key, &params[i * SCRIPT_PARAM_NAME_MAX], SCRIPT_PARAM_NAME_MAX);
+        key[SCRIPT_PARAM_NAME_MAX] = '\0';
+        if(find_param(key, &s->param_offset[i], &s->param_type[i]) < 0)
+        {
+            printf("%s: unknown parameter %s\n", source, key);
+            return -1;
+        }
+    }
+
+    /* 命令を先頭から順に検証し、命令の先頭の位置を記録 */
+    memset(boundary, 0, sizeof(boundary));
+    for(pc = 0; pc < s->code_size; pc = next)
+    {
+        op = s->code[pc];
+        if(op >= SCRIPT_OP_NUM || pc + 2 > s->code_size)
+        {
+            printf("%s: bad instruction at %lu\n", source, (unsigned long)pc);
+            return -1;
+        }
+        mask = s->code[pc + 1];
+        n = operand_num[op];
+        next = pc + 2 + 2 * n;
+        if(next > s->code_size || (mask >> n) != 0
+           || ((op == SCRIPT_OP_JUMP || op == SCRIPT_OP_JUMP_IF) && mask != 0))
+        {
+            printf("%s: bad operand at %lu\n", source, (unsigned long)pc);
+            return -1;
+        }
+        for(i = 0; i < n; i++)
+        {
+            if(((mask >> i) & 1) && get_u16(&s->code[pc + 2 + 2 * i]) >= param_num)
+            {
+                printf("%s: bad parameter reference at %lu\n", source, (unsigned long)pc);
+                return -1;
+            }
+        }
+        boundary[pc >> 3] |= 1 << (pc & 7);
+    }
+    if(op != SCRIPT_OP_END && op != SCRIPT_OP_END_SIDE && op != SCRIPT_OP_JUMP)    // 最後の命令の後ろに実行が進まないこと
+    {
+        printf("%s: code does not end with end/jump\n", source);
+        return -1;
+    }
+
+    /* 分岐先とルーチンの開始位置が命令の先頭であること */
+    for(pc = 0; pc < s->code_size; pc += 2 + 2 * operand_num[s->code[pc]])
+    {
+        op = s->code[pc];
+        if((op == SCRIPT_OP_JUMP || op == SCRIPT_OP_JUMP_IF)
+           && ((offset = get_u16(&s->code[pc + 2])) >= s->code_size || !is_boundary(offset)))
+        {
+            printf("%s: bad jump at %lu\n", source, (unsigned long)pc);
+            return -1;
+        }
+    }
+    for(i = 0; i < s->routine_num; i++)
+    {
+        offset = get_u16(&s->routine[i * ROUTINE_ENTRY_SIZE + SCRIPT_NAME_MAX]);
+        if(offset >= s->code_size || !is_boundary(offset))
+        {
+            printf("%s: bad routine offset\n", source);
+            return -1;
+        }
+    }
+
+    s->valid = true;
+    return 0;
+}
+
+/* ルーチンの開始位置を探す 返り値 : 開始位置/-1(見つからない) */
+static int32_t find_routine(const SCRIPT *s, const char *name)
+{
+    const uint8_t *entry;
+    int i;
+
+    if(!s->valid)
+        return -1;
+
+    for(i = 0; i < s->routine_num; i++)
+    {
+        entry = &s->routine[i * ROUTINE_ENTRY_SIZE];
+        if(strncmp((const char *)entry, name, SCRIPT_NAME_MAX) == 0)
+            return get_u16(&entry[SCRIPT_NAME_MAX]);
+    }
+
+    return -1;
+}
+
+/* パラメータ表の番号から走行パラメータの現在の値を取得する */
+static int32_t param_value(const SCRIPT *s, uint16_t index)
+{
+    uint32_t bits;
+    float value;
+
+    memcpy(&bits, (const char *)Param_get() + s->param_offset[index], sizeof(bits));    // 反映済みの値(bt_taskの反映前の書き込みは含まない)
+    if(s->param_type[index] == PARAM_FLOAT)
+    {
+        memcpy(&value, &bits, sizeof(value));
+        return (int32_t)value;
+    }
+
+    return (int32_t)bits;
+}
+
+/* ルーチンを実行する */
+static int16_t execute(const SCRIPT *s, uint32_t pc)
+{
+    SENSOR_SNAPSHOT sensor;
+    const uint8_t *p;
+    int32_t v[SCRIPT_OPERAND_MAX];
+    bool_t flag = false;    // 条件フラグ
+    int color;              // until_colorで判定する色
+    uint8_t op, mask;
+    int i;
+
+    while(1)
+    {
+        p = &s->code[pc];
+        op = p[0];
+        mask = p[1];
+        for(i = 0; i < operand_num[op]; i++)
+        {
+            v[i] = (int16_t)get_u16(&p[2 + 2 * i]);
+            if((mask >> i) & 1)
+                v[i] = param_value(s, v[i]);
+        }
+        pc += 2 + 2 * operand_num[op];
+
+        switch(op)
+        {
+            case SCRIPT_OP_END:
+                return v[0];
+
+            case SCRIPT_OP_END_SIDE:
+                return COURSE_SLALOM_MIRROR ? -v[0] : v[0];
+
+            case SCRIPT_OP_DRIVE:
+                motor_ctrl(v[0], v[1]);
+                break;
+
+            case SCRIPT_OP_MOVE:
+                Run_setDistance(v[0], v[1], v[2]);
+                break;
+
+            case SCRIPT_OP_TURN:
+                Run_setDirection(v[0], v[1], v[2]);
+                break;
+
+            case SCRIPT_OP_SIDE_TURN:   // 左右反転するコースでは左右を入れ替える
+                if((v[0] != 0) != COURSE_SLALOM_MIRROR)
+                    Run_setDirection(v[1], 200, v[2]);      // 右旋回
+                else
+                    Run_setDirection(v[1], -200, v[3]);     // 左旋回
+                break;
+
+            case SCRIPT_OP_DETECT:
+                Run_setDetection(v[0], v[1], v[2], v[3]);
+                break;
+
+            case SCRIPT_OP_WAIT:
+                tslp_tsk(v[0] * 1000U);
+                break;
+
+            case SCRIPT_OP_UNTIL_COLOR:
+                color = (0 <= v[0] && v[0] < TNUM_COLOR) ? until_color_class[v[0]] : -1;
+                while(1)
+                {
+                    SensorHub_get(&sensor);
+                    if(color >= 0 && COLOR_IN(ColorClassifier_get(&sensor.rgb), color))    // 指定の色を検知した場合
+                        break;
+                    tslp_tsk(4 * 1000U);    /* 4msec周期起動 */
+                }
+                motor_ctrl(0, 0);           // 左右モーター停止
+                break;
+
+            case SCRIPT_OP_UNTIL_TILT:
+                SensorHub_resetGyro();                  // ジャイロセンサーの初期化
+                SensorHub_get(&sensor);
+                while(-v[2] < sensor.gyro_angle * 10 && sensor.gyro_angle * 10 < v[2])
+                {                                       // 傾きを検知するまでループ
+                    motor_ctrl(v[0], v[1]);
+                    tslp_tsk(4 * 1000U);                /* 4msec周期起動 */
+                    SensorHub_get(&sensor);
+                }
+                break;
+
+            case SCRIPT_OP_ARM_UP:
+                arm_up(v[0], true);
+                break;
+
+            case SCRIPT_OP_ARM_DOWN:
+                arm_down(v[0], true);
+                break;
+
+            case SCRIPT_OP_TAIL_OPEN:
+                tale_open(v[0], true);
+                break;
+
+            case SCRIPT_OP_TAIL_CLOSE:
+                tale_close(v[0], true);
+                break;
+
+            case SCRIPT_OP_SAMPLE_SONIC:
+                flag = sampling_sonic();
+                break;
+
+            case SCRIPT_OP_JUMP_IF:
+                if(flag)
+                    pc = v[0];
+                break;
+
+            case SCRIPT_OP_JUMP:
+                pc = v[0];
+                break;
+
+            case SCRIPT_OP_PROFILE:
+                Run_setProfile(v[0], v[1]);
+                break;
+        }
+    }
+}
+
+/* 初期化関数 */
+void Script_init()
+{
+    if(parse(&builtin, "ScriptDefault.c", script_default, script_default_size) != 0)   // 組み込みのスクリプトが不正な場合は続行できない
+        exit(1);
+    loaded.valid = false;
+}
+
+/* スクリプトファイルを読み込む関数 */
+int Script_load(const char *filename)
+{
+    FILE *fp;
+    uint32_t size;
+
+    fp = fopen(filename, "rb");
+    if(fp == NULL)                                          // ファイルが無い場合は組み込みのスクリプトのまま
+    {
+        printf("%s not found, using built-in script\n", filename);
+        return -1;
+    }
+    size = fread(script_buf, 1, sizeof(script_buf), fp);
+    if(size == sizeof(script_buf) && fgetc(fp) != EOF)      // 大きすぎるファイル
+        size = 0;
+    fclose(fp);
+
+    if(parse(&loaded, filename, script_buf, size) != 0)
+    {
+        printf("%s is invalid, using built-in script\n", filename);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* ルーチンを実行する関数 */
+int16_t Script_run(const char *name)
+{
+    int32_t pc;
+
+    if((pc = find_routine(&loaded, name)) >= 0)             // ファイルのルーチンを優先する
+        return execute(&loaded, pc);
+    if((pc = find_routine(&builtin, name)) >= 0)
+        return execute(&builtin, pc);
+
+    printf("script: routine %s not found\n", name);
+    return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef _SCRIPT_H_
+#define _SCRIPT_H_
+
+#include "ev3api.h"
+#include "Course.h"
+
+/* コーススクリプト(走行動作の列を名前付きのルーチンとして実行する) ***************************************/
+// ホスト(PC)でテキストのスクリプトをtools/coursec.cでバイトコードに変換し、SDカードに置いたファイルを起動時に読み込む
+// ファイルが無い・不正な場合、またはファイルにルーチンが無い場合は組み込みのスクリプト(ScriptDefault.c)を使う
+// スクリプトの書式と命令の一覧はtools/coursec.cを参照
+//
+// ファイル : ヘッダ ルーチン表 パラメータ表 コード の順に並べる(多バイトの値はリトルエンディアン)
+//  ヘッダ       'C' 'S' 版数(SCRIPT_VERSION) ルーチン数 パラメータ数 0 コード長[2] CRC[2]
+//               CRCはヘッダ以降の全バイトのCRC-16/CCITT(初期値0xFFFF)
+//  ルーチン表   名前[SCRIPT_NAME_MAX](残りは'\0') 開始位置[2](コードの先頭からのバイト数) をルーチン数だけ
+//  パラメータ表 走行パラメータのキー名[SCRIPT_PARAM_NAME_MAX](残りは'\0') をパラメータ数だけ
+//  コード       命令 参照ビット オペランド[2]*n を並べる(nは命令ごとに決まる)
+//               参照ビットのbit iが1のオペランドiはパラメータ表の番号で、実行時に走行パラメータの値に置き換える
+
+/* スクリプトファイル名(コースごとに分ける) */
+#define SCRIPT_FILE             "Script_" COURSE_NAME ".bin"
+
+#define SCRIPT_VERSION          1
+#define SCRIPT_FILE_MAX         2048    // ファイルの最大サイズ[byte]
+#define SCRIPT_HEADER_SIZE      10
+#define SCRIPT_NAME_MAX         12      // ルーチン名の最大長(終端の'\0'を含まない)
+#define SCRIPT_PARAM_NAME_MAX   24      // パラメータのキー名の最大長(終端の'\0'を含まない)
+#define SCRIPT_PARAM_REF_MAX    16      // パラメータ表の最大数
+#define SCRIPT_OPERAND_MAX      4       // 1命令のオペランドの最大数
+
+/* 命令(括弧内はオペランド、coursec.cと合わせる) */
+#define SCRIPT_OP_END           0x00    // ルーチンを終了して値を返す(値)
+#define SCRIPT_OP_END_SIDE      0x01    // ルーチンを終了して値を返す、左右反転するコースでは符号を反転する(値)
+#define SCRIPT_OP_DRIVE         0x02    // motor_ctrl(出力 旋回量)
+#define SCRIPT_OP_MOVE          0x03    // Run_setDistance(出力 旋回量 距離)
+#define SCRIPT_OP_TURN          0x04    // Run_setDirection(出力 旋回量 方位)
+#define SCRIPT_OP_SIDE_TURN     0x05    // Rコース基準の左右を指定して旋回する(右:1/左:0 出力 右旋回の方位 左旋回の方位)
+#define SCRIPT_OP_DETECT        0x06    // Run_setDetection(出力 旋回量 検知距離 距離)
+#define SCRIPT_OP_WAIT          0x07    // 待機(時間[ms])
+#define SCRIPT_OP_UNTIL_COLOR   0x08    // 指定の色を検知するまで現在の走行を続け、検知したら停止する(色)
+#define SCRIPT_OP_UNTIL_TILT    0x09    // ジャイロをリセットし、傾きが閾値以上になるまで走行する(出力 旋回量 閾値[0.1deg])
+#define SCRIPT_OP_ARM_UP        0x0A    // arm_up(出力)
+#define SCRIPT_OP_ARM_DOWN      0x0B    // arm_down(出力)
+#define SCRIPT_OP_TAIL_OPEN     0x0C    // tale_open(出力)
+#define SCRIPT_OP_TAIL_CLOSE    0x0D    // tale_close(出力)
+#define SCRIPT_OP_SAMPLE_SONIC  0x0E    // sampling_sonicの結果を条件フラグに設定する(無し)
+#define SCRIPT_OP_JUMP_IF       0x0F    // 条件フラグが立っていれば分岐する(分岐先)
+#define SCRIPT_OP_JUMP          0x10    // 分岐する(分岐先)
+#define SCRIPT_OP_PROFILE       0x11    // Run_setProfile(距離 最高速度[mm/s])
+#define SCRIPT_OP_NUM           0x12
+
+/* 初期化関数(組み込みのスクリプトを使うようにする) */
+void Script_init();
+
+/* スクリプトファイルを読み込む 返り値 : 0(成功)/-1(ファイルが無い・不正、組み込みのスクリプトのまま) */
+// 起動時にmain_taskで1回だけ呼ぶ(Param_loadの後、走行中に呼ばないこと)
+int Script_load(const char *filename);
+
+/* ルーチンを実行する(走行動作が終わるまで戻らない) 返り値 : ルーチンが返した値 */
+int16_t Script_run(const char *name);
+
+#endif
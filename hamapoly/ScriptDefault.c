@@ -0,0 +1,34 @@
+// 組み込みのコーススクリプト(ScriptDefault.txt から tools/coursec -c で生成、直接編集しないこと)
+
+#include "Script.h"
+
+const uint8_t script_default[] = {
+    0x43, 0x53, 0x01, 0x05, 0x02, 0x00, 0x14, 0x01, 0x6F, 0x11, 0x73, 0x68, 0x69, 0x66, 0x74, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6D, 0x6F, 0x76, 0x65, 0x5F, 0x32, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x28, 0x00, 0x62, 0x72, 0x61, 0x6E, 0x63, 0x68, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x50, 0x00, 0x70, 0x61, 0x74, 0x74, 0x65, 0x72, 0x6E, 0x5F, 0x61, 0x00, 0x00, 0x00,
+    0x80, 0x00, 0x70, 0x61, 0x74, 0x74, 0x65, 0x72, 0x6E, 0x5F, 0x62, 0x00, 0x00, 0x00, 0xBE, 0x00,
+    0x73, 0x6C, 0x61, 0x6C, 0x6F, 0x6D, 0x2E, 0x73, 0x68, 0x69, 0x66, 0x74, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x73, 0x6C, 0x61, 0x6C, 0x6F, 0x6D, 0x2E, 0x63,
+    0x72, 0x6F, 0x73, 0x73, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x01, 0x00, 0x05, 0x00, 0x28, 0x00, 0xD8, 0xFF, 0x11, 0x01, 0x00, 0x00, 0x46, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x28, 0x00, 0xD8, 0xFF, 0x06, 0x00, 0x0A, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x28, 0x00,
+    0xD8, 0xFF, 0x11, 0x01, 0x01, 0x00, 0x46, 0x00, 0x05, 0x00, 0x01, 0x00, 0x05, 0x00, 0x28, 0x00,
+    0xD8, 0xFF, 0x06, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x03, 0x00, 0x9B, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x01, 0x00, 0x05, 0x00, 0x23, 0x00, 0xDF, 0xFF, 0x06, 0x00, 0x0A, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x23, 0x00, 0xDF, 0xFF, 0x07, 0x00,
+    0xC8, 0x00, 0x0E, 0x00, 0x0F, 0x00, 0x7C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+    0x06, 0x00, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0xD2, 0x00, 0x05, 0x00, 0x01, 0x00, 0x05, 0x00,
+    0x2D, 0x00, 0xD3, 0xFF, 0x0A, 0x00, 0x1E, 0x00, 0x09, 0x00, 0x1E, 0x00, 0x0F, 0x00, 0x23, 0x00,
+    0x07, 0x00, 0xC8, 0x00, 0x0B, 0x00, 0x1E, 0x00, 0x02, 0x00, 0x14, 0x00, 0x32, 0x00, 0x08, 0x00,
+    0x01, 0x00, 0x04, 0x00, 0x0A, 0x00, 0x38, 0xFF, 0xE2, 0xFF, 0x01, 0x00, 0x01, 0x00, 0x06, 0x00,
+    0x12, 0x00, 0x0C, 0x00, 0x05, 0x00, 0xE6, 0x00, 0x04, 0x00, 0x05, 0x00, 0xC8, 0x00, 0x3C, 0x00,
+    0x06, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x04, 0x00, 0x05, 0x00, 0xC8, 0x00,
+    0x23, 0x00, 0x0A, 0x00, 0x1E, 0x00, 0x03, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x64, 0x00, 0x09, 0x00,
+    0x19, 0x00, 0xE2, 0xFF, 0x23, 0x00, 0x07, 0x00, 0xC8, 0x00, 0x0B, 0x00, 0x1E, 0x00, 0x02, 0x00,
+    0x14, 0x00, 0xCE, 0xFF, 0x08, 0x00, 0x01, 0x00, 0x04, 0x00, 0x0A, 0x00, 0xC8, 0x00, 0x32, 0x00,
+    0x00, 0x00, 0xFF, 0xFF,
+};
+
+const uint32_t script_default_size = sizeof(script_default);
@@ -0,0 +1,69 @@
+// センサー値の取得を1周期に1回にまとめ、全てのタスクが同じ周期の値を参照できるようにする
+// 書き込み側(measure_task)は裏側のバッファに書き込んでから表裏を切り替えるため、読み出し側が書き込み途中の値を読むことはない
+
+#include <string.h>
+#include "SensorHub.h"
+
+/* グローバル変数 */
+static const sensor_port_t
+    color_sensor    = EV3_PORT_2,
+    gyro_sensor     = EV3_PORT_4;
+
+static const motor_port_t
+    left_motor      = EV3_PORT_C,
+    right_motor     = EV3_PORT_B;
+
+static SENSOR_SNAPSHOT snapshot[2];         // ダブルバッファ
+static volatile uint32_t sequence = 0;      // 更新回数(snapshot[sequence & 1]が最新)
+
+/* 初期化関数 */
+void SensorHub_init() {
+    memset(snapshot, 0, sizeof(snapshot));
+    sequence = 0;
+    Sonar_init();
+}
+
+/* 全センサーを1回ずつ読んでスナップショットを更新 */
+void SensorHub_update() {
+    uint32_t next = sequence + 1;
+    SENSOR_SNAPSHOT *back = &snapshot[next & 1];    // 読み出し側が参照していない方のバッファ
+
+    get_tim(&back->time);
+    back->tick          = next;
+    ev3_color_sensor_get_rgb_raw(color_sensor, &back->rgb);
+    Sonar_update(back->time);                       // 超音波センサーは測定周期ごとにしか読まない
+    back->sonar         = Sonar_getDistance();
+    back->sonar_age     = (back->time - Sonar_getTime()) / 1000U;
+    back->gyro_angle    = ev3_gyro_sensor_get_angle(gyro_sensor);
+    back->gyro_rate     = ev3_gyro_sensor_get_rate(gyro_sensor);
+    back->count_left    = ev3_motor_get_counts(left_motor);
+    back->count_right   = ev3_motor_get_counts(right_motor);
+
+    __asm__ __volatile__("" ::: "memory");          // バッファの書き込み完了後に表裏を切り替える
+    sequence = next;
+}
+
+/* 最新のスナップショットを取得 */
+void SensorHub_get(SENSOR_SNAPSHOT *out) {
+    uint32_t seq;
+
+    do                                              // コピー中に2回以上更新された場合はやり直す
+    {
+        seq = sequence;
+        __asm__ __volatile__("" ::: "memory");
+        memcpy(out, &snapshot[seq & 1], sizeof(SENSOR_SNAPSHOT));
+        __asm__ __volatile__("" ::: "memory");
+    }
+    while(seq + 1 < sequence);
+}
+
+/* ジャイロセンサーをリセットし、リセット後のスナップショットが更新されるまで待機 */
+void SensorHub_resetGyro() {
+    uint32_t seq;
+
+    ev3_gyro_sensor_reset(gyro_sensor);
+
+    seq = sequence;
+    while(sequence == seq)
+        tslp_tsk(1 * 1000U);
+}
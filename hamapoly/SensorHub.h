@@ -0,0 +1,32 @@
+#ifndef _SENSORHUB_H_
+#define _SENSORHUB_H_
+
+#include "ev3api.h"
+#include "Sonar.h"
+
+/* 1周期分のセンサー値 */
+typedef struct {
+    SYSTIM      time;           // 取得時刻[us]
+    uint32_t    tick;           // 更新回数
+    rgb_raw_t   rgb;            // カラーセンサーのRGB値
+    int16_t     sonar;          // 超音波センサーの距離[cm](メディアンフィルタ後)
+    uint16_t    sonar_age;      // 超音波センサーの距離を取得してからの経過時間[ms]
+    int16_t     gyro_angle;     // ジャイロセンサーの角度[deg]
+    int16_t     gyro_rate;      // ジャイロセンサーの角速度[deg/s]
+    int32_t     count_left;     // 左モーターの回転角度[deg]
+    int32_t     count_right;    // 右モーターの回転角度[deg]
+} SENSOR_SNAPSHOT;
+
+/* 初期化関数 */
+void SensorHub_init();
+
+/* 全センサーを1回ずつ読んでスナップショットを更新(measure_taskから1周期に1回呼ぶ) */
+void SensorHub_update();
+
+/* 最新のスナップショットを取得 */
+void SensorHub_get(SENSOR_SNAPSHOT *snapshot);
+
+/* ジャイロセンサーをリセットし、リセット後のスナップショットが更新されるまで待機 */
+void SensorHub_resetGyro();
+
+#endif
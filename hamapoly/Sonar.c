@@ -0,0 +1,86 @@
+// 超音波センサーの値を測定周期(SONAR_PERIOD)ごとに1回だけ取得し、メディアンフィルタで外れ値を除去する
+// 制御ループからはフィルタ後の値と取得時刻、閾値を下回ったかどうかを参照する
+
+#include "Sonar.h"
+
+/* グローバル変数 */
+static const sensor_port_t
+    sonar_sensor    = EV3_PORT_3;
+
+static int16_t samples[SONAR_FILTER_SIZE];  // 直近の取得値
+static uint8_t sample_cnt = 0;              // 取得値の数(SONAR_FILTER_SIZEまで)
+static uint8_t sample_pos = 0;              // 次に書き込む位置
+
+static volatile int16_t distance = 255;     // フィルタ後の距離
+static volatile SYSTIM  distance_time = 0;  // 距離を取得した時刻
+static SYSTIM           poll_time = 0;      // 最後にセンサーを読んだ時刻
+
+static volatile int16_t threshold = -1;     // 障害物検知の閾値(負の値で無効)
+static volatile bool_t  detected = false;   // 閾値以下の距離を検知したかどうか
+
+/* 直近の取得値の中央値を求める */
+static int16_t median() {
+    int16_t sorted[SONAR_FILTER_SIZE];
+    int16_t value;
+    int i, j;
+
+    for(i = 0; i < sample_cnt; i++)         // 挿入ソート
+    {
+        value = samples[i];
+        for(j = i; j > 0 && sorted[j - 1] > value; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = value;
+    }
+
+    return sorted[sample_cnt / 2];
+}
+
+/* 初期化関数 */
+void Sonar_init() {
+    sample_cnt = 0;
+    sample_pos = 0;
+    distance = 255;
+    distance_time = 0;
+    poll_time = 0;
+    threshold = -1;
+    detected = false;
+}
+
+/* 測定周期が経過していれば距離を取得する */
+void Sonar_update(SYSTIM now) {
+    if(sample_cnt > 0 && now - poll_time < SONAR_PERIOD * 1000U)  // 測定周期が経過していない場合
+        return;                                                     // 前回の値をそのまま使う
+
+    poll_time = now;
+    samples[sample_pos] = ev3_ultrasonic_sensor_get_distance(sonar_sensor);
+    sample_pos = (sample_pos + 1) % SONAR_FILTER_SIZE;
+    if(sample_cnt < SONAR_FILTER_SIZE)
+        ++sample_cnt;
+
+    distance = median();
+    distance_time = now;
+
+    if(threshold >= 0 && distance <= threshold)     // 閾値以下になった場合
+        detected = true;                                // 検知状態を保持
+}
+
+/* フィルタ後の最新の距離[cm]を取得 */
+int16_t Sonar_getDistance() {
+    return distance;
+}
+
+/* 最新の距離を取得した時刻[us]を取得 */
+SYSTIM Sonar_getTime() {
+    return distance_time;
+}
+
+/* 障害物検知の閾値[cm]を設定する */
+void Sonar_setThreshold(int16_t value) {
+    threshold = value;
+    detected = (value >= 0 && distance <= value);   // 現在の値で判定し直す
+}
+
+/* 設定後に閾値以下の距離を検知したかどうかを取得 */
+bool_t Sonar_isDetected() {
+    return detected;
+}
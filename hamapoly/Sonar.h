@@ -0,0 +1,30 @@
+#ifndef _SONAR_H_
+#define _SONAR_H_
+
+#include "ev3api.h"
+
+/* 超音波センサーの測定周期[ms] *超音波の減衰特性により、これより短い周期では新しい値が得られない */
+#define SONAR_PERIOD        40
+
+/* メディアンフィルタのサンプル数(奇数) */
+#define SONAR_FILTER_SIZE   3
+
+/* 初期化関数 */
+void Sonar_init();
+
+/* 測定周期が経過していれば距離を取得する(SensorHub_updateから1周期に1回呼ばれる) */
+void Sonar_update(SYSTIM now);
+
+/* フィルタ後の最新の距離[cm]を取得 */
+int16_t Sonar_getDistance();
+
+/* 最新の距離を取得した時刻[us]を取得 */
+SYSTIM Sonar_getTime();
+
+/* 障害物検知の閾値[cm]を設定する(検知状態はクリアされる) */
+void Sonar_setThreshold(int16_t threshold);
+
+/* 設定後に閾値以下の距離を検知したかどうかを取得 */
+bool_t Sonar_isDetected();
+
+#endif
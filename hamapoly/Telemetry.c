@@ -0,0 +1,233 @@
+// Bluetoothによるテレメトリ(フレーム形式はTelemetry.hを参照)
+// サンプルのリングバッファはLogBufferと同じ単一書き込み/単一読み出し(SPSC)のロックフリー構造で、
+// measure_taskが書き込み、telemetry_taskが読み出す。送信キューはbt_taskが書き込み、telemetry_taskが読み出す
+
+#include <string.h>
+#include "Telemetry.h"
+#include "Run.h"
+
+/* EV3はシングルコアのため、メモリバリアはコンパイラの並べ替え防止のみで十分 */
+#define TELEMETRY_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+#define TELEMETRY_BUFFER_MASK   (TELEMETRY_BUFFER_SIZE - 1)
+#define TELEMETRY_QUEUE_MASK    (TELEMETRY_QUEUE_SIZE - 1)
+#define TELEMETRY_SYNC          0xA5
+#define TELEMETRY_BATCH_SIZE    8       // 1回の送信で符号化するサンプルの最大数
+
+/* 1回分のサンプル */
+typedef struct {
+    SENSOR_SNAPSHOT sensor;
+    float       x, y, heading;  // 自己位置
+    int32_t     error;          // ライントレースのPIDの偏差
+    q16_t       p, i, d;        // ライントレースのPIDの各項
+    int16_t     turn;           // 旋回量
+    int8_t      power;          // 出力
+    uint8_t     section;        // 区間
+    uint8_t     state;          // 区間の状態
+    uint32_t    dropped;        // 破棄したサンプル数
+} TELEMETRY_SAMPLE;
+
+static TELEMETRY_SAMPLE buffer[TELEMETRY_BUFFER_SIZE];
+static volatile uint32_t head = 0;      // 次に書き込む位置(measure_taskのみ更新)
+static volatile uint32_t tail = 0;      // 次に読み出す位置(telemetry_taskのみ更新)
+static volatile uint32_t dropped = 0;   // 満杯で破棄したサンプル数
+static uint32_t decimation_cnt = 0;     // 間引きのカウンタ
+
+static uint8_t queue[TELEMETRY_QUEUE_SIZE];
+static volatile uint32_t queue_head = 0;    // 次に書き込む位置(bt_taskのみ更新)
+static volatile uint32_t queue_tail = 0;    // 次に読み出す位置(telemetry_taskのみ更新)
+
+static volatile uint8_t cur_section = TELEMETRY_SECTION_NONE;
+static volatile uint8_t cur_state = 0;
+
+/* CRC-16/CCITT */
+static uint16_t crc16(const uint8_t *data, uint32_t size)
+{
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+    int bit;
+
+    for(i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+/* リトルエンディアンで書き込んで次の位置を返す */
+static uint8_t *put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+    return p + 4;
+}
+
+static uint8_t *put_float(uint8_t *p, float value)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return put_u32(p, bits);
+}
+
+/* サンプルをフレームに符号化する 返り値 : フレームの長さ */
+static uint32_t encode(const TELEMETRY_SAMPLE *s, uint8_t *frame)
+{
+    uint8_t *p = &frame[3];
+    uint16_t crc;
+    uint32_t len;
+
+    *p++ = TELEMETRY_VERSION;
+    p = put_u32(p, s->sensor.tick);
+    p = put_u32(p, (uint32_t)s->sensor.time);
+    p = put_u16(p, s->sensor.rgb.r);
+    p = put_u16(p, s->sensor.rgb.g);
+    p = put_u16(p, s->sensor.rgb.b);
+    p = put_u16(p, s->sensor.sonar);
+    p = put_u16(p, s->sensor.gyro_angle);
+    p = put_u16(p, s->sensor.gyro_rate);
+    p = put_u32(p, s->sensor.count_left);
+    p = put_u32(p, s->sensor.count_right);
+    p = put_float(p, s->x);
+    p = put_float(p, s->y);
+    p = put_float(p, s->heading);
+    p = put_u32(p, s->error);
+    p = put_u32(p, s->p);
+    p = put_u32(p, s->i);
+    p = put_u32(p, s->d);
+    *p++ = s->power;
+    p = put_u16(p, s->turn);
+    *p++ = s->section;
+    *p++ = s->state;
+    p = put_u32(p, s->dropped);
+
+    len = p - &frame[3];
+    frame[0] = TELEMETRY_SYNC;
+    frame[1] = TELEMETRY_FRAME_TYPE;
+    frame[2] = len;
+    crc = crc16(&frame[1], len + 2);
+    p = put_u16(p, crc);
+
+    return p - frame;
+}
+
+/* 初期化関数 */
+void Telemetry_init()
+{
+    head = tail = 0;
+    dropped = 0;
+    decimation_cnt = 0;
+    queue_head = queue_tail = 0;
+    cur_section = TELEMETRY_SECTION_NONE;
+    cur_state = 0;
+}
+
+/* 走行中の区間と状態を設定する関数 */
+void Telemetry_setState(uint8_t section, uint8_t state)
+{
+    cur_section = section;
+    cur_state = state;
+}
+
+/* サンプルを積む関数 */
+void Telemetry_update()
+{
+    int32_t decimation = Param_get()->telemetry_decimation;
+    uint32_t h = head;
+    TELEMETRY_SAMPLE *s;
+
+    if(decimation <= 0 || ++decimation_cnt < (uint32_t)decimation)  // 0で送信しない
+        return;
+    decimation_cnt = 0;
+
+    if(h - tail >= TELEMETRY_BUFFER_SIZE)   // バッファが満杯の場合は破棄する(measure_taskを待たせない)
+    {
+        ++dropped;
+        return;
+    }
+
+    s = &buffer[h & TELEMETRY_BUFFER_MASK];
+    SensorHub_get(&s->sensor);
+    s->x        = Pose_getX();
+    s->y        = Pose_getY();
+    s->heading  = Pose_getHeading();
+    Run_PID_getTerms(&s->error, &s->p, &s->i, &s->d);
+    s->power    = Motion_getPower();
+    s->turn     = Motion_getTurn();
+    s->section  = cur_section;
+    s->state    = cur_state;
+    s->dropped  = dropped;
+
+    TELEMETRY_BARRIER();                    // サンプルの書き込み完了後にheadを進める
+    head = h + 1;
+}
+
+/* 送信するバイト列を依頼する関数 */
+bool_t Telemetry_queue(const uint8_t *data, uint32_t size)
+{
+    uint32_t h = queue_head;
+    uint32_t i;
+
+    if(TELEMETRY_QUEUE_SIZE - (h - queue_tail) < size)  // 途中までしか入らない場合は何も送らない(フレームを壊さない)
+        return false;
+
+    for(i = 0; i < size; i++)
+        queue[(h + i) & TELEMETRY_QUEUE_MASK] = data[i];
+
+    TELEMETRY_BARRIER();
+    queue_head = h + size;
+
+    return true;
+}
+
+/* 依頼されたバイト列と積まれたサンプルを送信する関数 */
+void Telemetry_send(FILE *bt)
+{
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    uint32_t t, n;
+    int count = 0;
+
+    /* コマンドの応答・エコーを先に送る */
+    while((t = queue_tail) != queue_head)
+    {
+        TELEMETRY_BARRIER();
+        n = queue_head - t;
+        if(n > TELEMETRY_QUEUE_SIZE - (t & TELEMETRY_QUEUE_MASK))   // キューの終端で折り返す場合は2回に分ける
+            n = TELEMETRY_QUEUE_SIZE - (t & TELEMETRY_QUEUE_MASK);
+        fwrite(&queue[t & TELEMETRY_QUEUE_MASK], 1, n, bt);
+        TELEMETRY_BARRIER();
+        queue_tail = t + n;
+    }
+
+    /* サンプル */
+    while(count < TELEMETRY_BATCH_SIZE && (t = tail) != head)
+    {
+        TELEMETRY_BARRIER();                // headの確認後にサンプルを読み出す
+        n = encode(&buffer[t & TELEMETRY_BUFFER_MASK], frame);
+        TELEMETRY_BARRIER();
+        tail = t + 1;                       // 符号化が終わったサンプルを解放(送信の完了を待たずにmeasure_taskに返す)
+
+        fwrite(frame, 1, n, bt);
+        ++count;
+    }
+
+    fflush(bt);
+}
+
+/* バッファが満杯で破棄したサンプル数を取得する関数 */
+uint32_t Telemetry_getDropped()
+{
+    return dropped;
+}
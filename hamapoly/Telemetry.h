@@ -0,0 +1,50 @@
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include "ev3api.h"
+
+/* Bluetoothによるテレメトリ(走行中の状態の送信) ***********************************************************/
+// measure_taskが間引いた周期でサンプルをリングバッファに積み、telemetry_taskが符号化してBluetoothに送信する
+// 通信が遅い場合はtelemetry_taskの書き込みが待たされるだけで、バッファが満杯になった分のサンプルは破棄する(制御周期は遅らせない)
+// Bluetoothへの書き込みはtelemetry_taskだけが行う(bt_taskのコマンドの応答・エコーもTelemetry_queueで送信を依頼する)
+//
+// フレーム : SYNC(0xA5) TELEMETRY_FRAME_TYPE 長さ データ[長さ] CRC[2]
+//            CRCは種類・長さ・データのCRC-16/CCITT(初期値0xFFFF)、多バイトの値はリトルエンディアン
+// データ   : 版数(TELEMETRY_VERSION)に続けて、以下の順に並べる(括弧内はバイト数)
+//            tick(4) 時刻[us](4) r g b(各2) 超音波[cm](2) ジャイロ角度(2) ジャイロ角速度(2)
+//            左右エンコーダ(各4) x y 方位(各float 4) 偏差(4) PIDのP I D項(各Q16.16 4)
+//            出力(1) 旋回量(2) 区間(1) 状態(1) 破棄したサンプル数(4)
+
+#define TELEMETRY_FRAME_TYPE    ('T' | 0x80)
+#define TELEMETRY_VERSION       1
+#define TELEMETRY_FRAME_MAX     72      // フレームの最大長[byte]
+
+#define TELEMETRY_BUFFER_SIZE   64      // サンプルのリングバッファの要素数(2のべき乗にすること)
+#define TELEMETRY_QUEUE_SIZE    256     // 応答・エコーの送信キュー[byte](2のべき乗にすること)
+#define TELEMETRY_PERIOD        (10 * 1000U)    // telemetry_taskの送信周期[us]
+
+/* 区間(Telemetry_setStateで指定する) */
+#define TELEMETRY_SECTION_NONE      0
+#define TELEMETRY_SECTION_LINE      1
+#define TELEMETRY_SECTION_SLALOM    2
+#define TELEMETRY_SECTION_BLOCK     3
+
+/* 初期化関数 *measure_task, telemetry_taskが停止している状態で呼ぶこと */
+void Telemetry_init();
+
+/* 走行中の区間と状態(各区間のr_state)を設定する(各区間のメインループで毎周期呼ぶ) */
+void Telemetry_setState(uint8_t section, uint8_t state);
+
+/* サンプルを積む(measure_taskで1周期に1回呼ぶ、走行パラメータtelemetry.decimationの周期ごとに1回積む) */
+void Telemetry_update();
+
+/* 送信するバイト列を依頼する(bt_taskから呼ぶ) 返り値 : true(成功)/false(キューに空きが無い、何も送らない) */
+bool_t Telemetry_queue(const uint8_t *data, uint32_t size);
+
+/* 依頼されたバイト列と積まれたサンプルを送信する(telemetry_taskから呼ぶ) */
+void Telemetry_send(FILE *bt);
+
+/* バッファが満杯で破棄したサンプル数を取得 */
+uint32_t Telemetry_getDropped();
+
+#endif
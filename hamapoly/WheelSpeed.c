@@ -0,0 +1,170 @@
+// エンコーダの回転角度から左右タイヤの回転速度を求め、目標速度[deg/s]に追従するようにモーター出力を調整する
+// 出力 = フィードフォワード(目標速度を出力に換算) + PI制御(速度偏差)
+// バッテリー電圧や負荷によって同じ出力でも速度が変わるため、速度を指定して走行したい場合に使う
+// 目標速度は区間のタスクが書き込み、measure_taskが読み出す 左右の組はSensorHubと同じく裏側のバッファに書き込んでから
+// 更新回数を進めるため、measure_taskが左だけ更新された組を読むことはない
+
+#include <string.h>
+#include "WheelSpeed.h"
+
+/* マクロ定義 */
+#define KP          0.05    // 速度偏差[deg/s]に対する出力
+#define KI          0.60    // 速度偏差の積分[deg]に対する出力
+#define FF_STATIC   3       // 静止摩擦分の出力(目標速度が0でない場合に加算)
+
+/* グローバル変数 */
+static const motor_port_t
+    left_motor      = EV3_PORT_C,
+    right_motor     = EV3_PORT_B;
+
+static int16_t window_left[WHEEL_SPEED_WINDOW];     // 直近の左タイヤの回転角度[deg/周期]
+static int16_t window_right[WHEEL_SPEED_WINDOW];    // 直近の右タイヤの回転角度[deg/周期]
+static uint8_t window_pos = 0;                      // 次に書き込む位置
+static int32_t sum_left = 0;                        // 直近の左タイヤの回転角度の合計
+static int32_t sum_right = 0;                       // 直近の右タイヤの回転角度の合計
+
+static int16_t speed_left = 0;                      // 左タイヤの回転速度[deg/s]
+static int16_t speed_right = 0;                     // 右タイヤの回転速度[deg/s]
+
+/* 左右タイヤの目標回転速度の組 */
+typedef struct {
+    int16_t left;                                   // 左タイヤの目標回転速度[deg/s]
+    int16_t right;                                  // 右タイヤの目標回転速度[deg/s]
+} WHEEL_TARGET;
+
+static WHEEL_TARGET target_pair[2];                 // ダブルバッファ
+static volatile uint32_t target_seq = 0;            // 目標速度の更新回数(target_pair[target_seq & 1]が最新)
+static volatile bool_t  enabled = false;            // 速度制御中かどうか
+static bool_t           running = false;            // 前周期に速度制御を行ったかどうか
+
+static PID_CTRL pid_left;                           // 左モーターのPI制御器
+static PID_CTRL pid_right;                          // 右モーターのPI制御器
+
+/* 目標速度と計測速度からモーター出力を求める */
+static int32_t control(PID_CTRL *pid, int16_t target, int16_t speed) {
+    int32_t power;
+
+    if(target == 0)                                 // 停止指示
+        return 0;
+
+    power = (int32_t)target * 100 / WHEEL_SPEED_MAX;    // フィードフォワード項
+    power += target > 0 ? FF_STATIC : -FF_STATIC;
+    power += PID_update(pid, target - speed);           // フィードバック項
+
+    if(power > 100)
+        power = 100;
+    else if(power < -100)
+        power = -100;
+    return power;
+}
+
+/* 最新の目標回転速度の組を取得 */
+static void get_target(WHEEL_TARGET *out) {
+    uint32_t seq;
+
+    do                                              // コピー中に2回以上更新された場合はやり直す
+    {
+        seq = target_seq;
+        __asm__ __volatile__("" ::: "memory");
+        *out = target_pair[seq & 1];
+        __asm__ __volatile__("" ::: "memory");
+    }
+    while(seq + 1 < target_seq);
+}
+
+/* 初期化関数 */
+void WheelSpeed_init() {
+    int i;
+
+    for(i = 0; i < WHEEL_SPEED_WINDOW; i++)
+    {
+        window_left[i] = 0;
+        window_right[i] = 0;
+    }
+    window_pos = 0;
+    sum_left = 0;
+    sum_right = 0;
+    speed_left = 0;
+    speed_right = 0;
+
+    enabled = false;
+    running = false;
+    memset(target_pair, 0, sizeof(target_pair));
+    target_seq = 0;
+
+    PID_init(&pid_left, KP, KI, 0.0, WHEEL_SPEED_PERIOD / 1000.0);
+    PID_init(&pid_right, KP, KI, 0.0, WHEEL_SPEED_PERIOD / 1000.0);
+    PID_setLimit(&pid_left, -100, 100);             // 補正量の範囲はモーター出力の範囲
+    PID_setLimit(&pid_right, -100, 100);
+}
+
+/* 回転速度を計測し、速度制御を行う */
+void WheelSpeed_update() {
+    WHEEL_TARGET now;
+    int16_t angle_left = Distance_getAngle4msLeft();    // Distance_updateで求めた1周期分の回転角度
+    int16_t angle_right = Distance_getAngle4msRight();
+
+    sum_left += angle_left - window_left[window_pos];   // 移動和を更新
+    sum_right += angle_right - window_right[window_pos];
+    window_left[window_pos] = angle_left;
+    window_right[window_pos] = angle_right;
+    window_pos = (window_pos + 1) % WHEEL_SPEED_WINDOW;
+
+    speed_left = sum_left * 1000 / (WHEEL_SPEED_WINDOW * WHEEL_SPEED_PERIOD);
+    speed_right = sum_right * 1000 / (WHEEL_SPEED_WINDOW * WHEEL_SPEED_PERIOD);
+
+    if(!enabled)
+    {
+        running = false;
+        return;
+    }
+
+    get_target(&now);
+
+    if(!running)                                    // 速度制御の開始時は前回の積分値を持ち越さない
+    {
+        PID_reset(&pid_left);
+        PID_reset(&pid_right);
+        running = true;
+    }
+
+    if(now.left == 0 && now.right == 0)             // 停止指示
+    {
+        PID_reset(&pid_left);
+        PID_reset(&pid_right);
+        ev3_motor_stop(left_motor, true);
+        ev3_motor_stop(right_motor, true);
+        return;
+    }
+
+    ev3_motor_set_power(left_motor, control(&pid_left, now.left, speed_left));
+    ev3_motor_set_power(right_motor, control(&pid_right, now.right, speed_right));
+}
+
+/* 目標回転速度を設定し、速度制御を開始する */
+void WheelSpeed_setTarget(int16_t left, int16_t right) {
+    uint32_t next = target_seq + 1;
+    WHEEL_TARGET *back = &target_pair[next & 1];    // measure_taskが参照していない方のバッファ
+
+    back->left = left;
+    back->right = right;
+    __asm__ __volatile__("" ::: "memory");          // 組の書き込み完了後に表裏を切り替える
+    target_seq = next;
+    __asm__ __volatile__("" ::: "memory");
+    enabled = true;
+}
+
+/* 速度制御を終了する */
+void WheelSpeed_disable() {
+    enabled = false;
+}
+
+/* 左タイヤの回転速度を取得 */
+int16_t WheelSpeed_getLeft() {
+    return speed_left;
+}
+
+/* 右タイヤの回転速度を取得 */
+int16_t WheelSpeed_getRight() {
+    return speed_right;
+}
@@ -0,0 +1,35 @@
+#ifndef _WHEEL_SPEED_H_
+#define _WHEEL_SPEED_H_
+
+#include "ev3api.h"
+#include "Distance.h"
+#include "PID.h"
+
+/* 速度制御の周期[ms] *measure_taskの周期ハンドラ(app.cfg)と合わせる */
+#define WHEEL_SPEED_PERIOD  5
+
+/* 速度計測に使う周期数(エンコーダの1deg分解能を平均化する) */
+#define WHEEL_SPEED_WINDOW  4
+
+/* 出力100のときの無負荷回転速度[deg/s] *フィードフォワード項の換算に使う */
+#define WHEEL_SPEED_MAX     900
+
+/* 初期化関数 */
+void WheelSpeed_init();
+
+/* 左右タイヤの回転速度を計測し、速度制御中であればモーター出力を更新する(measure_taskから1周期に1回呼ばれる) */
+void WheelSpeed_update();
+
+/* 左右タイヤの目標回転速度[deg/s]を設定し、速度制御を開始する */
+void WheelSpeed_setTarget(int16_t left, int16_t right);
+
+/* 速度制御を終了する(以降はmotor_ctrl等で直接出力を設定する) */
+void WheelSpeed_disable();
+
+/* 左タイヤの回転速度[deg/s]を取得 */
+int16_t WheelSpeed_getLeft();
+
+/* 右タイヤの回転速度[deg/s]を取得 */
+int16_t WheelSpeed_getRight();
+
+#endif
@@ -19,6 +19,10 @@
 #include "app_Line.h"
 #include "app_Block.h"
 #include "app_Slalom.h"
+#include "LogFormat.h"
+#include "BtCommand.h"
+#include "Telemetry.h"
+#include "LoopTiming.h"
 /*************************************************************************************************************************************************/
 
 /* APIについて */
@@ -90,11 +94,19 @@ static FILE     *bt = NULL;     /* Bluetoothファイルハンドル */
 
 /* 追加：グローバル変数,構造体 */
 /*************************************************************************************************************************************************/
-static FILE *outputfile;    // 出力ストリーム
+static FILE *outputfile = NULL; // 出力ストリーム
+static char log_iobuf[4096];    // 出力ストリームのバッファ(SDカードへの書き込みをまとめて行う)
 
 static rgb_raw_t rgb;
 
-static int8_t logflag = 0;
+static volatile int8_t logflag = 0;
+
+#define LOG_STAMP_QUEUE_SIZE 8                          // 添付を待つlog_stampの文字列の最大数(2のべき乗にすること)
+static const char *log_stamps[LOG_STAMP_QUEUE_SIZE];    // 次のレコードから順に添付するlog_stampの文字列(区間のタスクが積み、measure_taskが取り出す)
+static volatile uint32_t log_stamp_head = 0;            // 次に積む位置(区間のタスクのみ更新)
+static volatile uint32_t log_stamp_tail = 0;            // 次に取り出す位置(measure_taskのみ更新)
+static uint32_t log_stamp_dropped = 0;                  // 満杯で捨てた文字列の数
+static uint32_t log_overflow_base = 0;                  // ファイルオープン時点のオーバーフロー数
 
 typedef enum {
     LINE,   // ライントレース区間
@@ -116,6 +128,9 @@ static TASK_STATE t_state = LINE;
 //#define DEVICE_NAME     "ET0"  /* Bluetooth名 sdcard:\ev3rt\etc\rc.conf.ini LocalNameで設定 */
 //#define PASS_KEY        "1234" /* パスキー    sdcard:\ev3rt\etc\rc.conf.ini PinCodeで設定 */
 #define CMD_START         '1'    /* リモートスタートコマンド */
+/* ログ出力マクロ */
+#define LOG_BATCH_SIZE    32     /* logfile_taskが1度に書き込むレコード数 */
+#define LOG_DRAIN_PERIOD  (20 * 1000U) /* logfile_taskの起動周期 */
 
 /* LCDフォントサイズ */
 #define CALIB_FONT (EV3_FONT_SMALL)
@@ -132,6 +147,7 @@ static void _log(char* text);
 /* 追加：関数プロトタイプ宣言 */
 /*************************************************************************************************************************************************/
 static void log_open(char* filename);
+static void log_close(void);
 
 // void log_stamp(char *stamp);     // Run.hでextern宣言
 // extern宣言の記述について：https://www.khstasaba.com/?p=849
@@ -173,6 +189,16 @@ void main_task(intptr_t unused)
     ev3_motor_config(tale_motor, MEDIUM_MOTOR);     // 後部の尻尾
     /********************************************************************************************************/
 
+    /* 追加：走行パラメータの読み込み(スタート待機の前に行い、走行開始を遅らせない) ************************/
+    Param_init();               // 既定値で初期化
+    Param_load(PARAM_FILE);     // SDカードのチューニングファイルで上書き(Param.cを参照)
+    Script_init();              // 組み込みのコーススクリプトを検証(ScriptDefault.txtを参照)
+    Script_load(SCRIPT_FILE);   // SDカードのスクリプトがあれば優先する(パラメータ名の解決のためParam_loadの後に行う)
+    BtCommand_init();           // Bluetoothからの変更はbt_taskの起動後に受け付ける
+    Telemetry_init();           // テレメトリのバッファを空にする(bt_taskの応答もここから送信する)
+    LoopTiming_init();          // 制御ループの処理時間のヒストグラムを空にする
+    /********************************************************************************************************/
+
     if (_bt_enabled)
     {
         /* Open Bluetooth file */
@@ -181,6 +207,7 @@ void main_task(intptr_t unused)
 
         /* Bluetooth通信タスクの起動 */
         act_tsk(BT_TASK);
+        act_tsk(TELEMETRY_TASK);    // Bluetoothへの送信はこのタスクだけが行う
     }
 
     ev3_led_set_color(LED_ORANGE); /* 初期化完了通知 */
@@ -221,11 +248,18 @@ void main_task(intptr_t unused)
 
     /* 追加：初期化 ******************************************************************************************/
     ev3_gyro_sensor_reset(gyro_sensor);     // ジャイロセンサーの初期化
+    SensorHub_init();                       // センサー値のスナップショットを初期化
+    ColorClassifier_init();                 // 色判定テーブルを作成
+    SensorHub_update();                     // 周期ハンドラの起動前に1回取得しておく
     Run_init();                             // 走行時間を初期化
     Run_PID_init();
+    WheelSpeed_init();                      // 速度制御の状態を初期化
+    Pose_init();                            // 自己位置を原点に初期化
+    Motion_init();                          // 動作キューを空にする
 
     /* 追加：タスク・周期ハンドラの起動 ************************************************************************/
-    // act_tsk(LOGFILE_TASK);   // タスク
+    LogBuffer_init();           // ログ用リングバッファを初期化
+    act_tsk(LOGFILE_TASK);      // タスク
     sta_cyc(CYC_MEASURE_TSK);   // 周期ハンドラ
     /********************************************************************************************************/
 
@@ -242,25 +276,34 @@ void main_task(intptr_t unused)
         switch(t_state)
         {
             case LINE:
-                log_open("Log_Line.txt");    // txtファイル出力処理
+                log_open("Log_Line.bin");    // ログファイル出力処理
 
                 Line_task();                // スタート直後からタスク開始 -> スラローム手前の青ラインを検知してタスク終了
+                LoopTiming_save("Timing_Line.txt", LOOP_TIMING_LINE);       // 制御ループの処理時間を出力
+                Fsm_save("Timing_Line.txt");                                // 状態遷移の履歴を追記
 
-                t_state = GOAL;           // スラローム区間へ移行
+                if(COURSE_SLALOM)           // スラローム区間があるコースの場合
+                    t_state = SLALOM;           // スラローム区間へ移行
+                else
+                    t_state = GOAL;             // 終了処理へ移行
                 break;
 
             case SLALOM:
-                log_open("Log_Slalom.txt");  // txtファイル出力処理
+                log_open("Log_Slalom.bin");  // ログファイル出力処理
 
                 Slalom_task();              // ライントレース区間終了直後からタスク開始 -> スラローム板を降りた後、ラインに復帰してタスク終了
+                LoopTiming_save("Timing_Slalom.txt", LOOP_TIMING_SLALOM);   // 制御ループの処理時間を出力
+                Fsm_save("Timing_Slalom.txt");                              // 状態遷移の履歴を追記
 
                 t_state = GOAL;            // ブロック搬入区間へ移行
                 break;
 
             case BLOCK:
-                log_open("Log_Block.txt");   // txtファイル出力処理
+                log_open("Log_Block.bin");   // ログファイル出力処理
 
                 Block_task();               // スラローム区間終了直後からタスク開始 -> ブロックを運搬しつつ、ガレージに停車してタスク終了
+                LoopTiming_save("Timing_Block.txt", LOOP_TIMING_BLOCK);     // 制御ループの処理時間を出力
+                Fsm_save("Timing_Block.txt");                               // 状態遷移の履歴を追記
 
                 t_state = GOAL;             // 終了処理へ移行
                 break;
@@ -276,16 +319,15 @@ void main_task(intptr_t unused)
         }
         tslp_tsk(4 * 1000U); /* 4msec周期起動 */
 
-        logflag = 0;        // ファイル書き込み停止フラグ(周期ハンドラ用)
-        fclose(outputfile); // txtファイル出力終了
+        log_close();        // ログファイル出力終了
     }
     /**
     * Main loop END ***********************************************************************************************************************************
     */
 
     /* 追加：タスク・周期ハンドラの終了 ************************************************************************/
-    // ter_tsk(LOGFILE_TASK);   // タスク
     stp_cyc(CYC_MEASURE_TSK);   // 周期ハンドラ
+    ter_tsk(LOGFILE_TASK);      // タスク
     /********************************************************************************************************/
 
     ev3_motor_stop(left_motor, false);
@@ -294,6 +336,7 @@ void main_task(intptr_t unused)
     if (_bt_enabled)
     {
         ter_tsk(BT_TASK);
+        ter_tsk(TELEMETRY_TASK);
         fclose(bt);
     }
 
@@ -349,6 +392,10 @@ void bt_task(intptr_t unused)
         if (_bt_enabled)
         {
             uint8_t c = fgetc(bt); /* 受信 */
+            if (BtCommand_put(c))
+            {
+                continue; /* 走行パラメータの読み書きコマンド(BtCommand.hを参照) */
+            }
             switch(c)
             {
             case '1':
@@ -357,7 +404,7 @@ void bt_task(intptr_t unused)
             default:
                 break;
             }
-            fputc(c, bt); /* エコーバック */
+            Telemetry_queue(&c, 1); /* エコーバック(telemetry_taskが送信する) */
         }
     }
 }
@@ -402,41 +449,100 @@ static void _log(char *text){
     // vscode左側フォルダ欄の"hrp3"から探して右クリック→"Reveal in Explorer"または"ダウンロード"(メモ帳推奨)
 static void log_open(char *filename)
 {
-    outputfile = fopen(filename, "w");  // ファイルを書き込み用にオープン
+    uint8_t header[LOG_FORMAT_HEADER_MAX];
+
+    outputfile = fopen(filename, "wb"); // ファイルを書き込み用にオープン
     if(outputfile == NULL)              // オープンに失敗した場合
     {
         printf("cannot open\n");            // エラーメッセージを出して
         exit(1);                            // 異常終了
     }
-    fprintf(outputfile, "R\tG\tB\tDistance\tDirection\tAngle\tPower\tTurn\tTime\n");     // データの項目名をファイルに書き込み
+    setvbuf(outputfile, log_iobuf, _IOFBF, sizeof(log_iobuf));  // 書き込みをバッファリング
+    log_overflow_base = LogBuffer_getOverflow();
+    log_stamp_head = log_stamp_tail;    // 前の区間で添付されなかった文字列を捨てる
+    log_stamp_dropped = 0;
+
+    fwrite(header, 1, LogFormat_header(header), outputfile);    // データの項目名をファイルに書き込み(バイナリログ形式はLogFormat.hを参照)
 
     logflag = 1;    // ファイル書き込みフラグ
 }
 
+// ファイル書き込みを終了してクローズする関数 *リングバッファに残ったレコードを書き込んでからクローズする
+static void log_close(void)
+{
+    uint8_t data[LOG_FORMAT_RECORD_MAX];
+
+    if(outputfile == NULL)              // オープンしていない場合
+        return;
+
+    logflag = 0;                        // ファイル書き込み停止フラグ(周期ハンドラ用)
+    while(!LogBuffer_isEmpty())         // logfile_taskが残りのレコードを書き込むまで
+        tslp_tsk(LOG_DRAIN_PERIOD);         // 待機
+
+    // 書き込めなかったレコード数をファイル終端に記録
+    fwrite(data, 1, LogFormat_end(LogBuffer_getOverflow() - log_overflow_base, data), outputfile);
+
+    fclose(outputfile);
+    outputfile = NULL;
+
+    if(log_stamp_dropped > 0)           // 1周期に積まれすぎて捨てたlog_stampの文字列の数
+        printf("log_stamp: %u stamps dropped\n", (unsigned int)log_stamp_dropped);
+    log_stamp_head = log_stamp_tail;    // 添付されなかった文字列を次のファイルに持ち越さない
+}
+
 // 引数stampに入力した文字列をログに出力する関数
+    // 文字列は周期ハンドラの次のレコードに添付され、logfile_taskによって書き込まれる(文字列リテラルを渡すこと)
+    // 1周期(5ms)内に複数回呼ばれた場合は呼んだ順に1つずつ後のレコードに添付され、
+    // LOG_STAMP_QUEUE_SIZEを超えた分は捨てて数だけ記録する(log_closeで表示)
+    // 呼べるのは区間のタスク(Fsm_run)だけで、ファイルに書き込んでいない間は何もしない
 void log_stamp(char *stamp)
 {
-    fprintf(outputfile, stamp);
+    uint32_t h = log_stamp_head;
+
+    if(logflag != 1)
+        return;
+    if(h - log_stamp_tail >= LOG_STAMP_QUEUE_SIZE)  // measure_taskを待たずに捨てる
+    {
+        ++log_stamp_dropped;
+        return;
+    }
+
+    log_stamps[h & (LOG_STAMP_QUEUE_SIZE - 1)] = stamp;
+    __asm__ __volatile__("" ::: "memory");          // 文字列を書いてからheadを進める
+    log_stamp_head = h + 1;
 }
 
-// Mainタスクのスリープ(tslp_tsk)中に実行される測定値書き込み関数 *現状main_task内のtslp_tskにしか反応していないと思われるため停止中
+// リングバッファのレコードをまとめてファイルに書き込む低優先度タスク
     // tslp_tsk等、サービスコールについて：https://monozukuri-c.com/itron-servicecall/
 void logfile_task(intptr_t unused)
 {
-    if(logflag == 1)    // ファイル書き込みフラグを確認
+    const LOG_RECORD *record;
+    uint8_t data[LOG_FORMAT_RECORD_MAX];
+    int count;
+
+    while(1)
+    {
+        count = 0;
+        while(count < LOG_BATCH_SIZE && (record = LogBuffer_front()) != NULL)
+        {
+            fwrite(data, 1, LogFormat_encode(record, data), outputfile);  // 差分 + varintで符号化して書き込み
+
+            LogBuffer_release();    // 書き込みが終わったレコードを解放
+            ++count;
+        }
+
+        if(count < LOG_BATCH_SIZE)  // 書き込み待ちのレコードが無くなった場合
+            tslp_tsk(LOG_DRAIN_PERIOD); // 待機
+    }
+}
+
+// テレメトリのサンプルと応答をBluetoothで送信する低優先度タスク
+void telemetry_task(intptr_t unused)
+{
+    while(1)
     {
-        fprintf(outputfile, "%d\t%d\t%d\t%8.3f\t%9.1f\t%4d\t%4d\t%4d\t%6dms\n", // txtファイル書き込み処理
-         getRGB_R(),
-         getRGB_G(),
-         getRGB_B(),
-         Distance_getDistance(),    // 走行距離を取得
-         Direction_getDirection(),  // 方位を取得(右旋回が正転)
-         Run_getAngle(),
-         Run_getPower(),
-         Run_getTurn(),
-        Run_getTime() * 5);
-
-        logflag = 0;    // ファイル書き込み停止フラグ
+        Telemetry_send(bt);             // 応答・エコーとサンプルを送信(通信が遅い場合はここで待たされる)
+        tslp_tsk(TELEMETRY_PERIOD);     // 待機
     }
 }
 
@@ -447,23 +553,42 @@ void logfile_task(intptr_t unused)
     // CRE_CYCの記述については workspace > periodic-task を参考
 void measure_task(intptr_t unused)
 {
+    LOG_RECORD record;
+    uint32_t t;
+
+    LoopTiming_cycleBegin(LOOP_TIMING_MEASURE, MEASURE_PERIOD);    // 起動の遅れを記録
+
+    Param_update();     // Bluetoothで変更された走行パラメータを反映
+    SensorHub_update(); // 全センサーの値を1回ずつ取得
     Run_update();       // 時間、RGB値、位置角度を更新
     Distance_update();  // 距離を更新
     Direction_update(); // 方位を更新
-
-    // logflag = 1;        // ファイル書き込みフラグ
+    Pose_update();      // 自己位置を更新
+    WheelSpeed_update();// タイヤの回転速度を計測し、速度制御を行う
+    Motion_update();    // 積まれた動作を1周期分進める
+    Telemetry_update(); // テレメトリのサンプルを間引いて積む(送信はtelemetry_task)
 
     if(logflag == 1)    // ファイル書き込みフラグを確認
     {
-        fprintf(outputfile, "%d\t%d\t%d\t%8.3f\t%9.1f\t%4d\t%4d\t%4d\t%6dms\n", // txtファイル書き込み処理
-         getRGB_R(),
-         getRGB_G(),
-         getRGB_B(),
-         Distance_getDistance(),    // 走行距離を取得
-         Direction_getDirection(),  // 方位を取得(右旋回が正転)
-         Run_getAngle(),
-         Run_getPower(),
-         Run_getTurn(),
-        Run_getTime() * 5);
+        record.r            = getRGB_R();
+        record.g            = getRGB_G();
+        record.b            = getRGB_B();
+        record.distance     = Distance_getDistance();   // 走行距離を取得
+        record.direction    = Direction_getDirection(); // 方位を取得(右旋回が正転)
+        record.angle        = Run_getAngle();
+        record.power        = Motion_getPower();   // Motionで走行中はMotionの出力
+        record.turn         = Motion_getTurn();
+        record.time         = Run_getTime();
+        record.stamp        = NULL;
+        if((t = log_stamp_tail) != log_stamp_head)  // log_stampの文字列を1つ添付
+        {
+            __asm__ __volatile__("" ::: "memory");
+            record.stamp    = log_stamps[t & (LOG_STAMP_QUEUE_SIZE - 1)];
+            log_stamp_tail  = t + 1;
+        }
+
+        LogBuffer_push(&record);    // リングバッファに書き込むだけで、書式化とファイル出力はlogfile_taskで行う
     }
-}
\ No newline at end of file
+
+    LoopTiming_cycleEnd(LOOP_TIMING_MEASURE);   // 実行時間を記録
+}
@@ -76,6 +76,8 @@ extern "C" {
 #define STACK_SIZE      4096        /* タスクのスタックサイズ */
 #endif /* STACK_SIZE */
 
+#define MEASURE_PERIOD  (5 * 1000U) /* measure_taskの起動周期[us] */
+
 /*
  *  関数のプロトタイプ宣言
  */
@@ -89,6 +91,8 @@ extern void bt_task(intptr_t exinf);
 extern void logfile_task(intptr_t exinf);    // Mainタスクに並行して(=Mainタスクのスリープ中に)実行される測定値書き込み関数
 
 extern void measure_task(intptr_t);         // 周期ハンドラによって5msごとに計測値の更新を行う関数
+
+extern void telemetry_task(intptr_t exinf); // Bluetoothでテレメトリ・コマンドの応答を送信する関数(Telemetry.hを参照)
 /*************************************************************************************************************************************************/
 
 #endif /* TOPPERS_MACRO_ONLY */
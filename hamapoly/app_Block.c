@@ -0,0 +1,205 @@
+#include "app_Block.h"
+
+/* マクロ定義 */
+
+/* 構造体 */
+typedef enum {
+    PRE,
+    START,
+    MOVE,
+    CURVE,
+    LINE,
+    LINE_2,
+    RETURN,
+    END,
+    DONE,       // 区間終了
+    STATE_NUM
+    } RUN_STATE;
+
+/* グローバル変数 */    // 状態の処理の間で共有する値(Block_taskで初期化する)
+static SENSOR_SNAPSHOT sensor;
+static rgb_raw_t rgb;
+static COLOR_SET color;
+
+static float temp = 0.0;        // 走行距離、方位の一時保存用
+
+static float distance = 0.0;    // 走行距離
+static float direction = 0.0;   // 方位
+
+static int16_t turn = 0;        // モーターによる旋回量を格納する変数(-200 ~ +200)
+
+/* 値の更新 *********************************************************************************************/
+// センサー値と走行距離・方位は周期ハンドラ(measure_task)が1周期に1回更新する
+static void update(void)
+{
+    SensorHub_get(&sensor);                 // 今周期のセンサー値を取得
+
+    distance = Distance_getDistance();      // 走行距離を取得
+    direction = Direction_getDirection();   // 方位を取得
+
+    rgb = sensor.rgb;                       //カラーセンサーの値を 構造体"rgb" に格納
+    color = ColorClassifier_get(&rgb);      // 色を判定
+}
+
+/* 色の判定 */
+static bool_t is_black(void)  { return COLOR_IN(color, COLOR_CLASS_BLACK_BLOCK); }
+static bool_t is_blue(void)   { return COLOR_IN(color, COLOR_CLASS_BLUE); }
+static bool_t is_yellow(void) { return COLOR_IN(color, COLOR_CLASS_YELLOW); }
+static bool_t is_red(void)    { return COLOR_IN(color, COLOR_CLASS_RED); }
+
+/* PRE : 区間単体での練習用 *****************************************************************************/
+static void pre_tick(void)
+{
+    turn = Run_getTurn_sensorPID(rgb.r, Param_get()->block_target);    // PID制御を用いて旋回値を取得
+    motor_ctrl(20, turn);                       // 指定出力で走行
+}
+
+static void pre_exit(void)                      // 青色検知
+{
+    temp = Distance_getDistance();
+    turn = 0;
+}
+
+/* START *************************************************************************************************/
+static void start_tick(void)
+{
+    if(direction < 40)
+    {
+        turn = Run_getTurn_change(turn, 100, 1, Run_getDt());
+        motor_ctrl_alt(80, turn, 0.5, Run_getDt());
+    }
+    else
+    {
+        turn = Run_getTurn_change(turn, 0, 1, Run_getDt());
+        motor_ctrl(50, turn);
+    }
+}
+
+static bool_t start_straight(void)
+{
+    return turn == 0;
+}
+
+/* MOVE **************************************************************************************************/
+static bool_t move_reached(void)                // 指定距離に到達した場合
+{
+    return distance > temp + Param_get()->block_move;
+}
+
+/* CURVE *************************************************************************************************/
+static void curve_tick(void)
+{
+    motor_ctrl_alt(40, 30, 0.1, Run_getDt());   // 指定速度まで減速しつつ右曲がりに前進
+}
+
+static void curve_exit(void)                    // 黒色検知
+{
+    motor_ctrl(0, 0);                           // モーター停止
+    tslp_tsk(300 * 1000U);                      // 待機
+    Run_setDirection(20, 200, 30);              // 右旋回
+}
+
+/* LINE **************************************************************************************************/
+static void line_tick(void)
+{
+    turn = Run_getTurn_sensorPID(rgb.r, Param_get()->block_target);    // PID制御を用いて旋回値を取得
+    motor_ctrl_alt(20, turn * -1, 0.5, Run_getDt()); // 加速しつつライントレース走行
+}
+
+static void line_exit(void)                     // 赤色検知
+{
+    turn = 0;
+}
+
+/* RETURN ************************************************************************************************/
+static void return_tick(void)
+{
+    if(distance < temp + Param_get()->block_return)
+    {
+        if(direction < 260)
+        {
+            turn = Run_getTurn_change(turn, 50, 0.5, Run_getDt());
+            motor_ctrl_alt(50, turn, 0.7, Run_getDt());
+        }
+        else
+        {
+            turn = Run_getTurn_change(turn, 0, 0.5, Run_getDt());
+            motor_ctrl(50, turn);
+        }
+    }
+    else                                        // 指定距離に到達した場合
+        motor_ctrl_alt(10, 10, 0.2, Run_getDt());   // 減速して右曲がりに走行
+}
+
+static bool_t return_line(void)                 // 指定距離に到達した後、黒色または青色検知
+{
+    return distance >= temp + Param_get()->block_return && (is_black() || is_blue());
+}
+
+static void return_exit(void)
+{
+    motor_ctrl(0,0);
+    tslp_tsk(300 * 1000U);  // 待機
+    Run_setDirection(20, 200, 40);
+}
+
+/* END ***************************************************************************************************/
+static void end_tick(void)
+{
+    motor_ctrl(20, 0);
+}
+
+static bool_t end_wall(void)                    // ガレージの壁を検知
+{
+    return sensor.sonar <= 5;
+}
+
+static void done_entry(void)
+{
+    motor_ctrl(0, 0);                           // 停車
+}
+
+/* 状態の表 *********************************************************************************************/
+// initialをPREにすると区間単体で練習できる(青色を検知してからSTARTへ遷移する)
+static const FSM_STATE states[STATE_NUM] = {
+    [PRE]    = { "Block PRE",    NULL,       pre_tick,       pre_exit,
+                 { { is_blue,        START } } },
+    [START]  = { "Block START",  NULL,       start_tick,     NULL,
+                 { { start_straight, MOVE } } },
+    [MOVE]   = { "Block MOVE",   NULL,       NULL,           NULL,
+                 { { is_yellow,      CURVE, "\n\n\tYellow detected\n\n\n" }, { move_reached, CURVE, "\n\n\tReached ditance\n\n\n" } } },
+    [CURVE]  = { "Block CURVE",  NULL,       curve_tick,     curve_exit,
+                 { { is_black,       LINE } } },
+    [LINE]   = { "Block LINE",   NULL,       line_tick,      line_exit,
+                 { { is_red,         RETURN, "\n\n\tRed detected\n\n\n" } } },
+    [LINE_2] = { "Block LINE_2", NULL,       NULL,           NULL,
+                 { { NULL } } },
+    [RETURN] = { "Block RETURN", NULL,       return_tick,    return_exit,
+                 { { return_line,    END } } },
+    [END]    = { "Block END",    NULL,       end_tick,       NULL,
+                 { { end_wall,       DONE } } },
+    [DONE]   = { "Block DONE",   done_entry, NULL,           NULL,
+                 { { NULL } } },
+};
+
+static const FSM_TABLE table = {
+    "Block", states, STATE_NUM, START, DONE, TELEMETRY_SECTION_BLOCK, LOOP_TIMING_BLOCK, update
+};
+
+/* 関数 */
+void Block_task()
+{
+    /* 初期化処理 ********************************************************************************************/
+    // 別ソースコード内の計測用static変数を初期化する(初期化を行わないことで、以前の区間から値を引き継ぐことができる)
+    Distance_init();    // 距離を初期化
+    Direction_init();   // 方位を初期化
+
+    Run_init();         // 走行時間を初期化
+    Run_PID_init();     // PIDの値を初期化
+
+    temp = 0.0;
+    turn = 0;
+
+    /* Main loop *********************************************************************************************/
+    Fsm_run(&table);    // 状態の表に従って4ms周期で走行し、DONEに遷移したら終了(Fsm.hを参照)
+}
@@ -0,0 +1,119 @@
+#include "app_Line.h"
+
+/* マクロ定義 */
+#define MOTOR_POWER     (Param_get()->line_power)   // モーターの出力値(-100 ~ +100)
+#define PID_TARGET_VAL  (Param_get()->line_target)  // PID制御におけるセンサrgb.rの目標値 *参考 : https://qiita.com/pulmaster2/items/fba5899a24912517d0c5
+
+/* 構造体 */
+typedef enum {
+    START,
+    MOVE,
+    EIGHT,
+    END,
+    DONE,           // 区間終了
+    STATE_NUM
+    } RUN_STATE;
+
+/* グローバル変数 */    // 状態の処理の間で共有する値(Line_taskで初期化する)
+static SENSOR_SNAPSHOT sensor;
+static rgb_raw_t rgb;
+static COLOR_SET color;
+
+static float temp = 0.0;    // 距離、方位の一時保存用
+
+static int8_t power = 0;    // END区間で減速中の出力値(MOVEの終了時の出力から減速する)
+static int16_t turn = 0;
+
+/* 値の更新 *********************************************************************************************/
+// センサー値は周期ハンドラ(measure_task)が1周期に1回取得したスナップショットを参照する
+static void update(void)
+{
+    SensorHub_get(&sensor);                             // 今周期のセンサー値を取得
+    rgb = sensor.rgb;                                   // RGB値を更新
+    color = ColorClassifier_get(&rgb);                  // 色を判定
+}
+
+/* MOVE : 通常走行 **************************************************************************************/
+// 出力値は走行中にBluetoothから変更されることがあるため、毎周期Param_getから読む(加速はmotor_ctrl_altで行う)
+static void move_tick(void)
+{
+    Run_PID_schedule(Run_getPower());                       // 出力と曲率に応じてPIDゲインを切り替え
+    turn = Run_getTurn_sensorPID(rgb.r, PID_TARGET_VAL);    // PID制御で旋回量を算出
+
+    if(-50 < turn && turn < 50)             // 旋回量が少ない場合
+        motor_ctrl_alt(MOTOR_POWER, turn, 0.5, Run_getDt()); // 加速して走行
+    else                                    // 旋回量が多い場合
+        motor_ctrl_alt(Param_get()->line_power_curve, turn, 0.5, Run_getDt()); // 減速して走行
+}
+
+static bool_t move_blue(void)               // 2つ目の青ラインを検知
+{
+    return Distance_getDistance() > Param_get()->line_blue_distance && COLOR_IN(color, COLOR_CLASS_BLUE);
+}
+
+static void move_exit(void)
+{
+    temp = Distance_getDistance();          // 検知時点でのdistanceを仮置き
+    power = Run_getPower();                 // 検知時点の出力から減速する
+}
+
+/* EIGHT : 8の字走行 ************************************************************************************/
+static void eight_entry(void)
+{
+    motor_ctrl(30, 30);
+    tslp_tsk(100 * 1000U);
+}
+
+static void eight_tick(void)
+{
+    turn = Run_getTurn_sensorPID(rgb.r, PID_TARGET_VAL);
+}
+
+/* END : 青ラインを検知したら減速 ***********************************************************************/
+static void end_tick(void)
+{
+    if(Distance_getDistance() < temp + Param_get()->line_end_distance)   // 指定距離進むまで
+        power = Run_getPower_change(power, Param_get()->line_end_power, 1, Run_getDt()); // 指定出力になるように減速
+
+    Run_PID_schedule(power);
+    turn = Run_getTurn_sensorPID(rgb.r, PID_TARGET_VAL);
+    motor_ctrl(power, turn);    // PID制御で走行
+}
+
+static bool_t end_reached(void)             // 減速が終了
+{
+    return Distance_getDistance() >= temp + Param_get()->line_end_distance;
+}
+
+/* 状態の表 *********************************************************************************************/
+// 8の字走行を行うコース(COURSE_LINE_EIGHT)では、青ラインの検知後にENDではなくEIGHTへ遷移する
+static const FSM_STATE states[STATE_NUM] = {
+    [START] = { "Line START", NULL,         NULL,       NULL,       { { Fsm_always,  MOVE } } },
+    [MOVE]  = { "Line MOVE",  NULL,         move_tick,  move_exit,  { { move_blue,   COURSE_LINE_EIGHT ? EIGHT : END, "\n\n\tBlue detected\n\n\n" } } },
+    [EIGHT] = { "Line EIGHT", eight_entry,  eight_tick, NULL,       { { NULL } } },
+    [END]   = { "Line END",   NULL,         end_tick,   NULL,       { { end_reached, DONE } } },
+    [DONE]  = { "Line DONE",  NULL,         NULL,       NULL,       { { NULL } } },
+};
+
+static const FSM_TABLE table = {
+    "Line", states, STATE_NUM, START, DONE, TELEMETRY_SECTION_LINE, LOOP_TIMING_LINE, update
+};
+
+/* メイン関数 */
+void Line_task()
+{
+    /* 初期化処理 ********************************************************************************************/
+    // 別ソースコード内の計測用static変数を初期化する(初期化を行わないことで、以前の区間から値を引き継ぐことができる)
+    Distance_init();    // 距離を初期化
+    Direction_init();   // 方位を初期化
+
+    Run_init();         // 走行時間を初期化
+    Run_PID_init();     // PIDの値を初期化
+
+    temp = 0.0;
+    power = 0;
+    turn = 0;
+
+    /* Main loop *********************************************************************************************/
+    Fsm_run(&table);    // 状態の表に従って4ms周期で走行し、DONEに遷移したら終了(Fsm.hを参照)
+}
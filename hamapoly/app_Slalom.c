@@ -0,0 +1,252 @@
+﻿#include "app_Slalom.h"
+
+/* 構造体 */
+typedef enum {
+    START,          // 段差の手前で段差を上る準備
+    UP_STAIRS,      // 段差を上る
+    MOVE_1,         // 2つ目のペットボトル手前までライントレース
+    STOP_1,         // 減速して停止し、2つ目のペットボトル手前まで移動
+    MOVE_2,         // 3つ目のペットボトル手前まで移動
+    BRANCH,         // 4つ目のペットボトル手前まで移動して配置パターンを判断する
+    PATTERN_A,      // 配置パターンAの場合の移動処理
+    PATTERN_B,      // 配置パターンBの場合の移動処理
+    LINETRACE,      // ラインに復帰する
+    END,            // ガレージの壁まで前進
+    DONE,           // 次のタスクへ移行
+    STATE_NUM
+    } RUN_STATE;
+
+/* グローバル変数 */    // 状態の処理の間で共有する値(Slalom_taskで初期化する)
+static SENSOR_SNAPSHOT sensor;
+static rgb_raw_t rgb;
+static COLOR_SET color;
+
+static float temp = 0.0;        // 距離、方位の一時保存用
+static float distance = 0.0;    // 走行距離
+
+static bool_t blue_seen = false;    // LINETRACEで青ラインを検知した
+static bool_t pattern_a = false;    // BRANCHで判断した配置パターン
+static bool_t straight = false;     // LINETRACEで直進を検知した
+
+static int8_t edge = 0;         // 1 でラインの左側をトレース、-1 で右側をトレース
+static int16_t turn = 0;        // モーターによる旋回量を格納する変数(-200 ~ +200)
+
+/* 値の更新 *********************************************************************************************/
+// センサー値と走行距離は周期ハンドラ(measure_task)が1周期に1回更新する
+static void update(void)
+{
+    SensorHub_get(&sensor);                 // 今周期のセンサー値を取得
+    distance = Distance_getDistance();      // 走行距離を取得
+
+    rgb = sensor.rgb;                       // RGBを取得
+    color = ColorClassifier_get(&rgb);      // 色を判定
+}
+
+/* START : 壁にアームを押し付けて方位を調整、後退してアームを上げる *************************************/
+static void start_tick(void)
+{
+    if(distance < Param_get()->slalom_approach)                 // 指定距離に到達していない場合
+    {
+        turn = Run_getTurn_sensorPID(rgb.r, Param_get()->slalom_target);    // PID制御で旋回量を算出
+        motor_ctrl(15, turn);                                   // 指定出力とPIDでライントレース走行
+    }
+}
+
+static bool_t start_reached(void)           // 指定距離に到達した場合
+{
+    return distance >= Param_get()->slalom_approach;
+}
+
+/* UP_STAIRS : 尻尾を利用して段差を上る *****************************************************************/
+static void up_stairs_entry(void)
+{
+    motor_ctrl(0, 0);           // モーター停止
+    tslp_tsk(200 * 1000U);      // 待機
+
+    motor_ctrl(-10, 0);         // 指定出力で後退
+    tslp_tsk(400 * 1000U);      // 待機
+
+    motor_ctrl(0, 0);           // モーター停止
+    arm_up(30, true);           // アームを上げる
+}
+
+static void up_stairs_tick(void)
+{
+    motor_ctrl(15, 0);          // 指定出力で前進
+}
+
+static bool_t up_stairs_tilt(void)          // 傾きを検知した場合
+{
+    return !(-3 < sensor.gyro_angle && sensor.gyro_angle < 3);
+}
+
+static void up_stairs_exit(void)
+{
+    if(COURSE_SLALOM_TALE)
+        tale_open(100, true);   // 尻尾で走行体を押し上げる
+
+    motor_ctrl(15, 0);      // 指定出力で前進
+    tslp_tsk(400 * 1000U);  // 待機
+
+    motor_ctrl(0, 0);
+    if(COURSE_SLALOM_TALE)
+        tale_close(100, true);  // 尻尾をもとに戻す
+    arm_down(30, true);     // アームをおろす
+
+    temp = Distance_getDistance();  // 指定距離ライントレースのため、処理開始時点の距離を取り置き
+}
+
+/* MOVE_1 : 2つ目のペットボトル手前までライントレース ***************************************************/
+static bool_t move_1_tracing(void)          // 指定距離内に障害物を検知するか、指定距離を走りきるまで
+{
+    return sensor.sonar <= 16 || Distance_getDistance() < temp + 100;
+}
+
+static void move_1_tick(void)
+{
+    if(move_1_tracing())
+    {
+        turn = Run_getTurn_sensorPID(rgb.r, 55);      // PID制御で旋回量を算出
+        motor_ctrl(15, turn);                         // ライントレース
+    }
+}
+
+static bool_t move_1_done(void)
+{
+    return !move_1_tracing();
+}
+
+/* STOP_1 : 減速して停止し、2つ目のペットボトル手前まで移動 *********************************************/
+static void stop_1_tick(void)
+{
+    if(Run_getPower() != 0)                 // モーターが停止していない場合
+        motor_ctrl_alt(0, 0, 0.1, Run_getDt()); // 減速してモーター停止
+}
+
+static bool_t stop_1_stopped(void)          // モーターが停止した場合
+{
+    return Run_getPower() == 0;
+}
+
+static void stop_1_exit(void)
+{
+    Script_run("shift");                    // 横に移動し、障害物を検知するまで前進(ScriptDefault.txtを参照)
+}
+
+/* MOVE_2 : 3つ目のペットボトル手前まで移動 *************************************************************/
+static void move_2_tick(void)
+{
+    Script_run("move_2");                   // 横に移動し、障害物を検知するまで前進
+}
+
+/* BRANCH : 4つ目のペットボトル手前まで移動して配置パターンを判断する ***********************************/
+static void branch_tick(void)
+{
+    pattern_a = Script_run("branch") != 0;  // 4つ目のペットボトル手前まで移動し、正面の障害物の有無を検知
+}
+
+static bool_t branch_pattern_a(void)        // 正面にペットボトルがあればPATTERN_Aへ分岐(なければPATTERN_B)
+{
+    return pattern_a;
+}
+
+/* PATTERN_A *********************************************************************************************/
+static void pattern_a_tick(void)
+{
+    edge = Script_run("pattern_a");         // ペットボトルを避けてラインに戻り、トレースするエッジを受け取る
+}
+
+/* PATTERN_B *********************************************************************************************/
+static void pattern_b_tick(void)
+{
+    edge = Script_run("pattern_b");         // ペットボトルを避けてラインに戻り、トレースするエッジを受け取る
+}
+
+/* LINETRACE : ラインに復帰する *************************************************************************/
+static void linetrace_tick(void)
+{
+    turn = Run_getTurn_sensorPID(rgb.r, Param_get()->slalom_target);    // PID制御で旋回量を算出(Line.cを参照)
+    motor_ctrl(20, turn * edge);                // ライントレース
+
+    straight = sampling_turn(turn);             // 直進の検知(毎周期サンプリングする)
+}
+
+static bool_t linetrace_black(void)             // 青ラインの後に黒ラインを検知
+{
+    if(COLOR_IN(color, COLOR_CLASS_BLUE))       // 青ラインを検知
+        blue_seen = true;                           // 以降は黒ラインの検知で遷移する
+
+    return blue_seen && COLOR_IN(color, COLOR_CLASS_BLACK_SLALOM);
+}
+
+static bool_t linetrace_straight(void)
+{
+    return straight;
+}
+
+/* END : ガレージの壁まで前進 ***************************************************************************/
+static void end_entry(void)
+{
+    motor_ctrl(20, 0);                          // 前進
+}
+
+static bool_t end_wall(void)                    // ガレージの壁を検知
+{
+    return sensor.sonar < 6;
+}
+
+static void done_entry(void)
+{
+    motor_ctrl(0, 0);                           // 停車
+}
+
+/* 状態の表 *********************************************************************************************/
+static const FSM_STATE states[STATE_NUM] = {
+    [START]     = { "Slalom START",     NULL,               start_tick,     NULL,
+                    { { start_reached,      UP_STAIRS } } },
+    [UP_STAIRS] = { "Slalom UP_STAIRS", up_stairs_entry,    up_stairs_tick, up_stairs_exit,
+                    { { up_stairs_tilt,     MOVE_1 } } },
+    [MOVE_1]    = { "Slalom MOVE_1",    NULL,               move_1_tick,    NULL,
+                    { { move_1_done,        STOP_1 } } },
+    [STOP_1]    = { "Slalom STOP_1",    NULL,               stop_1_tick,    stop_1_exit,
+                    { { stop_1_stopped,     MOVE_2 } } },
+    [MOVE_2]    = { "Slalom MOVE_2",    NULL,               move_2_tick,    NULL,
+                    { { Fsm_always,         BRANCH } } },
+    [BRANCH]    = { "Slalom BRANCH",    NULL,               branch_tick,    NULL,
+                    { { branch_pattern_a,   PATTERN_A }, { Fsm_always, PATTERN_B } } },
+    [PATTERN_A] = { "Slalom PATTERN_A", NULL,               pattern_a_tick, NULL,
+                    { { Fsm_always,         LINETRACE } } },
+    [PATTERN_B] = { "Slalom PATTERN_B", NULL,               pattern_b_tick, NULL,
+                    { { Fsm_always,         LINETRACE } } },
+    [LINETRACE] = { "Slalom LINETRACE", NULL,               linetrace_tick, NULL,
+                    { { linetrace_black,    END }, { linetrace_straight, END } } },
+    [END]       = { "Slalom END",       end_entry,          NULL,           NULL,
+                    { { end_wall,           DONE } } },
+    [DONE]      = { "Slalom DONE",      done_entry,         NULL,           NULL,
+                    { { NULL } } },
+};
+
+static const FSM_TABLE table = {
+    "Slalom", states, STATE_NUM, START, DONE, TELEMETRY_SECTION_SLALOM, LOOP_TIMING_SLALOM, update
+};
+
+/* メイン関数 */
+void Slalom_task()
+{
+    /* 初期化処理 ********************************************************************************************/
+    // 別ソースコード内の計測用static変数を初期化する(初期化を行わないことで、以前の区間から値を引き継ぐことができる)
+    Distance_init();    // 距離を初期化
+    Direction_init();   // 方位を初期化
+
+    // Run_init();         // 走行時間を初期化
+
+    temp = 0.0;
+    blue_seen = false;
+    pattern_a = false;
+    straight = false;
+    edge = 0;
+    turn = 0;
+
+    /* Main loop *********************************************************************************************/
+    Fsm_run(&table);    // 状態の表に従って4ms周期で走行し、DONEに遷移したら終了(Fsm.hを参照)
+}
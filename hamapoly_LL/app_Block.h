@@ -1,9 +0,0 @@
-#ifndef INCLUDED_Block_h_
-#define INCLUDED_Block_h_
-
-#include "Run.h"
-
-/* 関数プロトタイプ宣言 */
-void Block_task();
-
-#endif
\ No newline at end of file
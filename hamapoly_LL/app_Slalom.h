@@ -1,9 +0,0 @@
-﻿#ifndef INCLUDED_Slalom_h_
-#define INCLUDED_Slalom_h_
-
-#include "Run.h"
-
-/* 関数プロトタイプ宣言 */
-void Slalom_task();
-
-#endif
\ No newline at end of file
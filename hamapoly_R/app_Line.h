@@ -1,9 +0,0 @@
-#ifndef INCLUDED_Line_h_
-#define INCLUDED_Line_h_
-
-#include "Run.h"
-
-/* 関数プロトタイプ宣言 */
-void Line_task();
-
-#endif
\ No newline at end of file
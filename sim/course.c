@@ -0,0 +1,160 @@
+// コースのビットマップ(PPM形式)の読み書きと、カラーセンサー用の色の取得
+//
+// 付加情報はPPMヘッダのコメント行に「# キーワード 値...」の形式で記述する
+//   # scale 4                      1画素の大きさ[mm]
+//   # start 1000 2000 0            スタート時の車軸中心のx, y[mm]と方位[deg]
+//   # goal 3000 400 100 2          ゴールの中心x, y[mm]と半径[mm]、完走とする通過回数
+//   # obstacle 2500 400 50         障害物の中心x, y[mm]と半径[mm](複数可)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "course.h"
+
+/* コメント行の付加情報を読み取る */
+static void parse_comment(COURSE *course, const char *line) {
+    COURSE_OBSTACLE *obstacle;
+
+    if(sscanf(line, "# scale %f", &course->scale) == 1)
+        return;
+    if(sscanf(line, "# start %f %f %f", &course->start_x, &course->start_y, &course->start_heading) == 3)
+        return;
+    if(sscanf(line, "# goal %f %f %f %d", &course->goal_x, &course->goal_y, &course->goal_radius, &course->goal_count) == 4)
+        return;
+    if(course->obstacle_num < COURSE_OBSTACLE_MAX)
+    {
+        obstacle = &course->obstacle[course->obstacle_num];
+        if(sscanf(line, "# obstacle %f %f %f", &obstacle->x, &obstacle->y, &obstacle->radius) == 3)
+            course->obstacle_num++;
+    }
+}
+
+/* ヘッダの次の数値を読む(途中のコメント行は付加情報として解釈する) */
+static int read_header_value(COURSE *course, FILE *fp, int *value) {
+    char line[256];
+    int c;
+
+    while((c = fgetc(fp)) != EOF)
+    {
+        if(c == '#')                                    // コメント行
+        {
+            line[0] = '#';
+            if(fgets(line + 1, sizeof(line) - 1, fp) == NULL)
+                return -1;
+            parse_comment(course, line);
+        }
+        else if(isdigit(c))
+        {
+            ungetc(c, fp);
+            return fscanf(fp, "%d", value) == 1 ? 0 : -1;
+        }
+        else if(!isspace(c))
+        {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/* PPM形式のコースを読み込む */
+int Course_load(COURSE *course, const char *path) {
+    FILE *fp;
+    int maxval;
+    size_t size;
+
+    memset(course, 0, sizeof(COURSE));
+    course->scale = 1.0;
+    course->goal_count = 1;
+
+    fp = fopen(path, "rb");
+    if(fp == NULL)
+    {
+        printf("cannot open %s\n", path);
+        return -1;
+    }
+
+    if(fgetc(fp) != 'P' || fgetc(fp) != '6'
+        || read_header_value(course, fp, &course->width) != 0
+        || read_header_value(course, fp, &course->height) != 0
+        || read_header_value(course, fp, &maxval) != 0 || maxval != 255)
+    {
+        printf("%s is not a binary PPM (P6, maxval 255)\n", path);
+        fclose(fp);
+        return -1;
+    }
+    fgetc(fp);                                          // ヘッダ末尾の空白1文字
+
+    size = (size_t)course->width * course->height * 3;
+    course->pixels = malloc(size);
+    if(course->pixels == NULL || fread(course->pixels, 1, size, fp) != size)
+    {
+        printf("%s is truncated\n", path);
+        fclose(fp);
+        Course_free(course);
+        return -1;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/* PPM形式でコースを書き出す */
+int Course_save(const COURSE *course, const char *path) {
+    FILE *fp;
+    int i;
+
+    fp = fopen(path, "wb");
+    if(fp == NULL)
+    {
+        printf("cannot open %s\n", path);
+        return -1;
+    }
+
+    fprintf(fp, "P6\n");
+    fprintf(fp, "# scale %g\n", course->scale);
+    fprintf(fp, "# start %g %g %g\n", course->start_x, course->start_y, course->start_heading);
+    if(course->goal_radius > 0)
+        fprintf(fp, "# goal %g %g %g %d\n", course->goal_x, course->goal_y, course->goal_radius, course->goal_count);
+    for(i = 0; i < course->obstacle_num; i++)
+        fprintf(fp, "# obstacle %g %g %g\n", course->obstacle[i].x, course->obstacle[i].y, course->obstacle[i].radius);
+    fprintf(fp, "%d %d\n255\n", course->width, course->height);
+    fwrite(course->pixels, 1, (size_t)course->width * course->height * 3, fp);
+
+    fclose(fp);
+    return 0;
+}
+
+/* 画素の色を取得(コース外は白) */
+static const uint8_t *pixel(const COURSE *course, int px, int py) {
+    static const uint8_t white[3] = { 255, 255, 255 };
+
+    if(px < 0 || py < 0 || px >= course->width || py >= course->height)
+        return white;
+    return &course->pixels[((size_t)py * course->width + px) * 3];
+}
+
+/* 指定座標の色を双線形補間で取得する */
+void Course_sample(const COURSE *course, float x, float y, float rgb[3]) {
+    float fx = x / course->scale - 0.5;     // 画素の中心を基準にした位置
+    float fy = y / course->scale - 0.5;
+    int px = (int)floorf(fx);
+    int py = (int)floorf(fy);
+    float ax = fx - px;
+    float ay = fy - py;
+    const uint8_t *p00 = pixel(course, px, py);
+    const uint8_t *p10 = pixel(course, px + 1, py);
+    const uint8_t *p01 = pixel(course, px, py + 1);
+    const uint8_t *p11 = pixel(course, px + 1, py + 1);
+    int i;
+
+    for(i = 0; i < 3; i++)
+        rgb[i] = (p00[i] * (1 - ax) + p10[i] * ax) * (1 - ay) + (p01[i] * (1 - ax) + p11[i] * ax) * ay;
+}
+
+/* コースを解放する */
+void Course_free(COURSE *course) {
+    free(course->pixels);
+    course->pixels = NULL;
+}
@@ -0,0 +1,48 @@
+#ifndef _COURSE_H_
+#define _COURSE_H_
+
+#include <stdint.h>
+
+/* 障害物の最大数 */
+#define COURSE_OBSTACLE_MAX 16
+
+/* 障害物(超音波センサーで検知する円柱) */
+typedef struct {
+    float   x;          // 中心のx座標[mm]
+    float   y;          // 中心のy座標[mm]
+    float   radius;     // 半径[mm]
+} COURSE_OBSTACLE;
+
+/* コース(ビットマップと付加情報)
+ *   座標系 : 画像の左上が原点、x軸は右向き、y軸は下向き[mm]
+ *   方位   : x軸の向きが0度、時計回り(右旋回)が正[deg]
+ */
+typedef struct {
+    int             width;          // 画像の幅[px]
+    int             height;         // 画像の高さ[px]
+    uint8_t         *pixels;        // RGB各8bitの画素(width * height * 3)
+    float           scale;          // 1画素の大きさ[mm]
+    float           start_x;        // スタート時の車軸中心のx座標[mm]
+    float           start_y;        // スタート時の車軸中心のy座標[mm]
+    float           start_heading;  // スタート時の方位[deg]
+    float           goal_x;         // ゴールの中心のx座標[mm]
+    float           goal_y;         // ゴールの中心のy座標[mm]
+    float           goal_radius;    // ゴールの半径[mm](0でゴール無し)
+    int             goal_count;     // 何回目にゴールに入ったら完走とするか
+    int             obstacle_num;   // 障害物の数
+    COURSE_OBSTACLE obstacle[COURSE_OBSTACLE_MAX];
+} COURSE;
+
+/* PPM(P6)形式のコースを読み込む(付加情報はヘッダのコメント行に記述する) 返り値 : 成功で0 */
+int Course_load(COURSE *course, const char *path);
+
+/* PPM(P6)形式でコースを書き出す 返り値 : 成功で0 */
+int Course_save(const COURSE *course, const char *path);
+
+/* 指定座標の色を双線形補間で取得する(コース外は白) */
+void Course_sample(const COURSE *course, float x, float y, float rgb[3]);
+
+/* コースを解放する */
+void Course_free(COURSE *course);
+
+#endif
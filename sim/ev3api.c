@@ -0,0 +1,152 @@
+// ev3apiのデバイス関数(モーター・センサー・本体)のホスト用の実装
+// モーター・センサーはplant.cの物理モデルに、LCD・LED・syslogは標準出力につなぐ
+
+#include <stdarg.h>
+#include "sim.h"
+#include "kernel.h"
+#include "plant.h"
+
+/* センサー ******************************************************************************/
+
+ER ev3_sensor_config(sensor_port_t port, sensor_type_t type) {
+    return E_OK;
+}
+
+uint8_t ev3_color_sensor_get_reflect(sensor_port_t port) {
+    rgb_raw_t rgb;
+
+    Plant_getRGB(&rgb);
+    return (uint8_t)((rgb.r + rgb.g + rgb.b) * 100 / (3 * 128));
+}
+
+void ev3_color_sensor_get_rgb_raw(sensor_port_t port, rgb_raw_t *val) {
+    Plant_getRGB(val);
+}
+
+int16_t ev3_gyro_sensor_get_angle(sensor_port_t port) {
+    return Plant_getGyroAngle();
+}
+
+int16_t ev3_gyro_sensor_get_rate(sensor_port_t port) {
+    return Plant_getGyroRate();
+}
+
+ER ev3_gyro_sensor_reset(sensor_port_t port) {
+    Plant_resetGyro();
+    return E_OK;
+}
+
+int16_t ev3_ultrasonic_sensor_get_distance(sensor_port_t port) {
+    return Plant_getSonar();
+}
+
+bool_t ev3_touch_sensor_is_pressed(sensor_port_t port) {
+    if(Kernel_getTime() < SIM_TOUCH_DELAY)
+        return false;
+    Sim_notifyStart();
+    return true;
+}
+
+/* モーター ******************************************************************************/
+
+ER ev3_motor_config(motor_port_t port, motor_type_t type) {
+    Plant_setMotorType(port, type);
+    return E_OK;
+}
+
+int32_t ev3_motor_get_counts(motor_port_t port) {
+    return Plant_getMotorCounts(port);
+}
+
+ER ev3_motor_reset_counts(motor_port_t port) {
+    Plant_resetMotorCounts(port);
+    return E_OK;
+}
+
+ER ev3_motor_set_power(motor_port_t port, int power) {
+    Plant_setMotorPower(port, power);
+    return E_OK;
+}
+
+int ev3_motor_get_power(motor_port_t port) {
+    return Plant_getMotorPower(port);
+}
+
+ER ev3_motor_stop(motor_port_t port, bool_t brake) {
+    Plant_stopMotor(port, brake);
+    return E_OK;
+}
+
+ER ev3_motor_steer(motor_port_t left_motor, motor_port_t right_motor, int power, int turn_ratio) {
+    int left = power, right = power;
+
+    if(turn_ratio > 0)                      // EV3RTのev3_motor_steerと同じ配分
+        right = power * (100 - turn_ratio) / 100;
+    else if(turn_ratio < 0)
+        left = power * (100 + turn_ratio) / 100;
+    Plant_setMotorPower(left_motor, left);
+    Plant_setMotorPower(right_motor, right);
+    return E_OK;
+}
+
+/* 本体 **********************************************************************************/
+
+bool_t ev3_button_is_pressed(button_t button) {
+    return false;
+}
+
+ER ev3_button_set_on_clicked(button_t button, ISR handler, intptr_t exinf) {
+    return E_OK;                            // ボタンは押されないため呼ばれることは無い
+}
+
+ER ev3_led_set_color(ledcolor_t color) {
+    static const char *name[] = { "OFF", "RED", "GREEN", "ORANGE" };
+
+    if(Sim_isVerbose())
+        printf("[%8.3f] LED %s\n", Kernel_getTime() / 1000000.0, name[color & 3]);
+    return E_OK;
+}
+
+ER ev3_lcd_set_font(lcdfont_t font) {
+    return E_OK;
+}
+
+ER ev3_font_get_size(lcdfont_t font, int32_t *p_width, int32_t *p_height) {
+    *p_width = font == EV3_FONT_SMALL ? 6 : 10;
+    *p_height = font == EV3_FONT_SMALL ? 8 : 16;
+    return E_OK;
+}
+
+ER ev3_lcd_draw_string(const char *str, int32_t x, int32_t y) {
+    if(Sim_isVerbose())
+        printf("[%8.3f] LCD %s\n", Kernel_getTime() / 1000000.0, str);
+    return E_OK;
+}
+
+ER ev3_lcd_fill_rect(int32_t x, int32_t y, int32_t w, int32_t h, lcdcolor_t color) {
+    return E_OK;
+}
+
+int ev3_battery_voltage_mV(void) {
+    return 8000;
+}
+
+FILE* ev3_serial_open_file(serial_port_t port) {
+    return fopen("/dev/null", "r+");        // 通信相手はいない
+}
+
+bool_t ev3_bluetooth_is_connected(void) {
+    return false;
+}
+
+void syslog(unsigned int prio, const char *format, ...) {
+    va_list ap;
+
+    if(!Sim_isVerbose())
+        return;
+    printf("[%8.3f] ", Kernel_getTime() / 1000000.0);
+    va_start(ap, format);
+    vprintf(format, ap);
+    va_end(ap);
+    printf("\n");
+}
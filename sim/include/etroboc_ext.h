@@ -0,0 +1,7 @@
+/*
+ *  ホスト用 etroboc_ext.h の代替ヘッダ(ETロボコンシミュレータ拡張は使用しない)
+ */
+#ifndef _ETROBOC_EXT_H_
+#define _ETROBOC_EXT_H_
+
+#endif
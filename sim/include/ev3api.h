@@ -0,0 +1,196 @@
+/*
+ *  ホスト(Linux)用 ev3api の代替ヘッダ
+ *
+ *  EV3RT/HRP3のev3api.h・kernel.hのうち、このリポジトリのアプリが使う型と関数だけを定義する
+ *  関数の実体は sim/ev3api.c(デバイス) と sim/kernel.c(タスク・周期ハンドラ) にあり、
+ *  モーター・センサーの値は sim/plant.c の走行体モデルから得る
+ */
+#ifndef _EV3API_H_
+#define _EV3API_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+/* kernel.h相当 *************************************************************/
+typedef int             bool_t;
+typedef int             ER;
+typedef int             ID;
+typedef int             PRI;
+typedef uint32_t        RELTIM;
+typedef int32_t         TMO;
+typedef uint64_t        SYSTIM;     // [us]
+typedef uint32_t        HRTCNT;     // [us]
+typedef intptr_t        EXINF;
+
+#ifndef true
+#define true    1
+#endif
+#ifndef false
+#define false   0
+#endif
+
+#define E_OK        0
+#define E_ILUSE     (-28)
+#define E_OBJ       (-41)
+#define E_QOVR      (-43)
+#define E_TMOUT     (-50)
+#define E_ID        (-18)
+
+#define TSK_SELF    0
+#define TMO_FEVR    (-1)
+#define TMIN_APP_TPRI   1
+
+#define LOG_EMERG   0
+#define LOG_ALERT   1
+#define LOG_CRIT    2
+#define LOG_ERROR   3
+#define LOG_WARNING 4
+#define LOG_NOTICE  5
+#define LOG_INFO    6
+#define LOG_DEBUG   7
+
+ER      act_tsk(ID tskid);
+ER      ter_tsk(ID tskid);
+void    ext_tsk(void);
+ER      sus_tsk(ID tskid);
+ER      rsm_tsk(ID tskid);
+ER      slp_tsk(void);
+ER      tslp_tsk(TMO tmout);
+ER      wup_tsk(ID tskid);
+ER      dly_tsk(RELTIM dlytim);
+ER      sta_cyc(ID cycid);
+ER      stp_cyc(ID cycid);
+ER      get_tim(SYSTIM *p_systim);
+HRTCNT  fch_hrt(void);
+void    syslog(unsigned int prio, const char *format, ...);
+
+/* ポート ******************************************************************/
+typedef enum {
+    EV3_PORT_1 = 0,
+    EV3_PORT_2,
+    EV3_PORT_3,
+    EV3_PORT_4,
+    TNUM_SENSOR_PORT
+} sensor_port_t;
+
+typedef enum {
+    EV3_PORT_A = 0,
+    EV3_PORT_B,
+    EV3_PORT_C,
+    EV3_PORT_D,
+    TNUM_MOTOR_PORT
+} motor_port_t;
+
+typedef enum {
+    NONE_SENSOR = 0,
+    ULTRASONIC_SENSOR,
+    GYRO_SENSOR,
+    TOUCH_SENSOR,
+    COLOR_SENSOR,
+    INFRARED_SENSOR,
+    HT_NXT_ACCEL_SENSOR,
+    NXT_TEMP_SENSOR,
+    TNUM_SENSOR_TYPE
+} sensor_type_t;
+
+typedef enum {
+    NONE_MOTOR = 0,
+    MEDIUM_MOTOR,
+    LARGE_MOTOR,
+    UNREGULATED_MOTOR,
+    TNUM_MOTOR_TYPE
+} motor_type_t;
+
+/* センサー ****************************************************************/
+typedef enum {
+    COLOR_NONE = 0,
+    COLOR_BLACK,
+    COLOR_BLUE,
+    COLOR_GREEN,
+    COLOR_YELLOW,
+    COLOR_RED,
+    COLOR_WHITE,
+    COLOR_BROWN,
+    TNUM_COLOR
+} colorid_t;
+
+typedef struct {
+    uint16_t r;
+    uint16_t g;
+    uint16_t b;
+} rgb_raw_t;
+
+ER          ev3_sensor_config(sensor_port_t port, sensor_type_t type);
+uint8_t     ev3_color_sensor_get_reflect(sensor_port_t port);
+void        ev3_color_sensor_get_rgb_raw(sensor_port_t port, rgb_raw_t *val);
+int16_t     ev3_gyro_sensor_get_angle(sensor_port_t port);
+int16_t     ev3_gyro_sensor_get_rate(sensor_port_t port);
+ER          ev3_gyro_sensor_reset(sensor_port_t port);
+int16_t     ev3_ultrasonic_sensor_get_distance(sensor_port_t port);
+bool_t      ev3_touch_sensor_is_pressed(sensor_port_t port);
+
+/* モーター ****************************************************************/
+ER          ev3_motor_config(motor_port_t port, motor_type_t type);
+int32_t     ev3_motor_get_counts(motor_port_t port);
+ER          ev3_motor_reset_counts(motor_port_t port);
+ER          ev3_motor_set_power(motor_port_t port, int power);
+int         ev3_motor_get_power(motor_port_t port);
+ER          ev3_motor_stop(motor_port_t port, bool_t brake);
+ER          ev3_motor_steer(motor_port_t left_motor, motor_port_t right_motor, int power, int turn_ratio);
+
+/* 本体 ********************************************************************/
+typedef enum {
+    LEFT_BUTTON = 0,
+    RIGHT_BUTTON,
+    UP_BUTTON,
+    DOWN_BUTTON,
+    ENTER_BUTTON,
+    BACK_BUTTON,
+    TNUM_BUTTON
+} button_t;
+
+typedef void (*ISR)(intptr_t);
+
+typedef enum {
+    LED_OFF     = 0,
+    LED_RED     = 1,
+    LED_GREEN   = 2,
+    LED_ORANGE  = LED_RED | LED_GREEN
+} ledcolor_t;
+
+typedef enum {
+    EV3_FONT_SMALL,
+    EV3_FONT_MEDIUM
+} lcdfont_t;
+
+typedef enum {
+    EV3_LCD_WHITE = 0,
+    EV3_LCD_BLACK = 1
+} lcdcolor_t;
+
+#define EV3_LCD_WIDTH   178
+#define EV3_LCD_HEIGHT  128
+
+typedef enum {
+    EV3_SERIAL_DEFAULT = 0,
+    EV3_SERIAL_UART = 1,
+    EV3_SERIAL_BT = 2
+} serial_port_t;
+
+bool_t      ev3_button_is_pressed(button_t button);
+ER          ev3_button_set_on_clicked(button_t button, ISR handler, intptr_t exinf);
+ER          ev3_led_set_color(ledcolor_t color);
+ER          ev3_lcd_set_font(lcdfont_t font);
+ER          ev3_font_get_size(lcdfont_t font, int32_t *p_width, int32_t *p_height);
+ER          ev3_lcd_draw_string(const char *str, int32_t x, int32_t y);
+ER          ev3_lcd_fill_rect(int32_t x, int32_t y, int32_t w, int32_t h, lcdcolor_t color);
+int         ev3_battery_voltage_mV(void);
+FILE*       ev3_serial_open_file(serial_port_t port);
+bool_t      ev3_bluetooth_is_connected(void);
+
+#endif
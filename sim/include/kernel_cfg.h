@@ -0,0 +1,22 @@
+/*
+ *  ホスト用 kernel_cfg.h の代替ヘッダ
+ *
+ *  app.cfgのコンフィギュレータが生成するオブジェクトIDを定義する
+ *  タスク・周期ハンドラの属性(優先度・周期)は sim/sim_cfg.c にapp.cfgと同じ内容で記述する
+ */
+#ifndef _KERNEL_CFG_H_
+#define _KERNEL_CFG_H_
+
+#define TNUM_TSKID      5
+
+#define MAIN_TASK       1
+#define BT_TASK         2
+#define LOGFILE_TASK    3
+#define MEASURE_TSK     4
+#define TELEMETRY_TASK  5
+
+#define TNUM_CYCID      1
+
+#define CYC_MEASURE_TSK 1
+
+#endif
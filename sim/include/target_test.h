@@ -0,0 +1,9 @@
+/*
+ *  ホスト用 target_test.h の代替ヘッダ(ターゲット依存の定義は無し)
+ */
+#ifndef _TARGET_TEST_H_
+#define _TARGET_TEST_H_
+
+#define STACK_SIZE      4096    // app.hの既定値(ホストではsim/kernel.cが十分なスタックを割り当てる)
+
+#endif
@@ -0,0 +1,391 @@
+// TOPPERS/HRP3のタスク管理・周期ハンドラを仮想時間上で再現する簡易カーネル
+//
+// 各タスクはucontextのコルーチンとして実行し、サービスコールで待ちに入るまで実行を続ける
+// 実行可能なタスクが無くなると次の起床時刻まで仮想時間を進め、その間の物理モデルの計算をKERNEL_ADVANCEに任せる
+// タスクの処理自体は仮想時間を消費しないため、実機より速く、かつ毎回同じ結果でシミュレーションできる
+// 処理コストはタスクごとにホストのCPU時間で計測する
+
+#include <ucontext.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdarg.h>
+#include <sys/time.h>
+#include "kernel.h"
+
+/* マクロ定義 */
+#define TASK_STACK_SIZE     (256 * 1024)    // ホスト上のタスクのスタックサイズ
+#define WATCHDOG_PERIOD     5               // タスクが待ちに入らないまま経過したら異常終了する時間[s]
+#define TIME_INFINITE       UINT64_MAX
+
+/* タスクの状態 */
+typedef enum {
+    DORMANT,    // 休止状態
+    READY,      // 実行可能状態
+    WAITING     // 待ち状態
+} TASK_STATE;
+
+/* タスク管理ブロック */
+typedef struct {
+    TASK_STATE      state;
+    bool_t          suspended;  // 強制待ち状態かどうか
+    bool_t          wakeable;   // wup_tskで待ちが解除されるかどうか(dly_tskはfalse)
+    ucontext_t      ctx;
+    char            *stack;
+    SYSTIM          wake;       // 起床時刻(TIME_INFINITEで時間指定無し)
+    ER              result;     // 待ち解除の理由
+    int             actcnt;     // 起動要求キューイング数
+    int             wupcnt;     // 起床要求キューイング数
+    int64_t         order;      // 同じ優先度での実行順(小さいほど先)
+    uint64_t        cur_ns;     // 今回の起動での実行時間[ns]
+    KERNEL_STATS    stats;
+} TCB;
+
+/* 周期ハンドラ管理ブロック */
+typedef struct {
+    bool_t  started;
+    SYSTIM  next;               // 次の起動時刻
+} CYCCB;
+
+/* グローバル変数 */
+static TCB tcb[TNUM_TSKID + 1];
+static CYCCB cyccb[TNUM_CYCID + 1];
+static ucontext_t scheduler;                // スケジューラ(Kernel_run)のコンテキスト
+static ID running = 0;                      // 実行中のタスク(0でスケジューラ)
+static SYSTIM now = 0;                      // 仮想時間[us]
+static int64_t order_count = 0;
+static volatile uint32_t dispatch_count = 0;
+
+/* ホストのCPU時間[ns]を取得 */
+static uint64_t cpu_ns() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* タスクが待ちに入らないまま一定時間経過した場合に異常終了する */
+static void watchdog(int sig) {
+    static uint32_t last = 0;
+    static const char message[] = "sim: a task kept running without entering a wait state\n";
+
+    if(running != 0 && dispatch_count == last)
+    {
+        write(2, message, sizeof(message) - 1);
+        _exit(3);
+    }
+    last = dispatch_count;
+}
+
+/* タスクのエントリ(タスク関数から戻った場合はext_tskと同じ) */
+static void trampoline() {
+    const KERNEL_TSK_CFG *cfg = &kernel_tsk_cfg[running];
+
+    cfg->task(cfg->exinf);
+    ext_tsk();
+}
+
+/* 実行可能状態にする(同じ優先度では後ろに並ぶ) */
+static void make_ready(ID id) {
+    tcb[id].state = READY;
+    tcb[id].order = ++order_count;
+}
+
+/* 休止状態から起動する */
+static void start(ID id) {
+    TCB *t = &tcb[id];
+
+    getcontext(&t->ctx);
+    t->ctx.uc_stack.ss_sp = t->stack;
+    t->ctx.uc_stack.ss_size = TASK_STACK_SIZE;
+    t->ctx.uc_link = NULL;
+    makecontext(&t->ctx, trampoline, 0);
+    t->wupcnt = 0;
+    t->suspended = false;
+    make_ready(id);
+}
+
+/* 起動1回分の実行統計を確定する */
+static void close_activation(TCB *t) {
+    t->stats.activations++;
+    if(t->cur_ns > t->stats.max_ns)
+        t->stats.max_ns = t->cur_ns;
+    t->cur_ns = 0;
+}
+
+/* スケジューラに戻る(実行中のタスクの状態は呼び出し側で変更しておく) */
+static void dispatch() {
+    swapcontext(&tcb[running].ctx, &scheduler);
+}
+
+/* より優先度の高いタスクが実行可能になった場合は実行中のタスクを切り替える */
+static void preempt(ID id) {
+    if(running != 0 && tcb[id].state == READY && !tcb[id].suspended
+        && kernel_tsk_cfg[id].pri < kernel_tsk_cfg[running].pri)
+    {
+        tcb[running].order = -(++order_count);  // 同じ優先度の先頭に戻る
+        dispatch();
+    }
+}
+
+/* 待ち状態を解除する */
+static void release(ID id, ER result) {
+    tcb[id].result = result;
+    make_ready(id);
+}
+
+/* 実行中のタスクを待ち状態にする */
+static ER wait_task(SYSTIM wake, bool_t wakeable) {
+    TCB *t = &tcb[running];
+
+    t->state = WAITING;
+    t->wake = wake;
+    t->wakeable = wakeable;
+    dispatch();
+    return t->result;
+}
+
+/* 最も優先度の高い実行可能なタスクを選ぶ */
+static ID pick() {
+    ID id, best = 0;
+
+    for(id = 1; id <= TNUM_TSKID; id++)
+    {
+        if(tcb[id].state != READY || tcb[id].suspended)
+            continue;
+        if(best == 0 || kernel_tsk_cfg[id].pri < kernel_tsk_cfg[best].pri
+            || (kernel_tsk_cfg[id].pri == kernel_tsk_cfg[best].pri && tcb[id].order < tcb[best].order))
+            best = id;
+    }
+    return best;
+}
+
+/* 次に仮想時間上の事象(起床・周期ハンドラ)が起こる時刻 */
+static SYSTIM next_event() {
+    SYSTIM next = TIME_INFINITE;
+    ID id;
+
+    for(id = 1; id <= TNUM_TSKID; id++)
+        if(tcb[id].state == WAITING && tcb[id].wake < next)
+            next = tcb[id].wake;
+    for(id = 1; id <= TNUM_CYCID; id++)
+        if(cyccb[id].started && cyccb[id].next < next)
+            next = cyccb[id].next;
+    return next;
+}
+
+/* 現在時刻までの事象を処理する */
+static void fire() {
+    ID id;
+
+    for(id = 1; id <= TNUM_CYCID; id++)
+    {
+        while(cyccb[id].started && cyccb[id].next <= now)
+        {
+            act_tsk(kernel_cyc_cfg[id].tskid);
+            cyccb[id].next += kernel_cyc_cfg[id].period;
+        }
+    }
+    for(id = 1; id <= TNUM_TSKID; id++)
+        if(tcb[id].state == WAITING && tcb[id].wake <= now)
+            release(id, E_TMOUT);
+}
+
+/* タスクを実行し、仮想時間を進める */
+void Kernel_run(SYSTIM limit, KERNEL_ADVANCE advance) {
+    struct itimerval timer = { { WATCHDOG_PERIOD, 0 }, { WATCHDOG_PERIOD, 0 } };
+    SYSTIM next;
+    uint64_t begin, elapsed;
+    ID id;
+
+    for(id = 1; id <= TNUM_TSKID; id++)
+    {
+        memset(&tcb[id], 0, sizeof(TCB));
+        tcb[id].stack = malloc(TASK_STACK_SIZE);
+        if(kernel_tsk_cfg[id].act)
+            start(id);
+    }
+    memset(cyccb, 0, sizeof(cyccb));
+    now = 0;
+
+    signal(SIGALRM, watchdog);
+    setitimer(ITIMER_REAL, &timer, NULL);
+
+    while(1)
+    {
+        id = pick();
+        if(id != 0)                             // 実行可能なタスクを待ちに入るまで実行
+        {
+            running = id;
+            dispatch_count++;
+            begin = cpu_ns();
+            swapcontext(&scheduler, &tcb[id].ctx);
+            elapsed = cpu_ns() - begin;
+            tcb[id].cur_ns += elapsed;
+            tcb[id].stats.total_ns += elapsed;
+            running = 0;
+            continue;
+        }
+
+        next = next_event();                    // 実行可能なタスクが無ければ仮想時間を進める
+        if(next > limit)
+            next = limit;
+        if(!advance(now, next) || next >= limit)
+        {
+            now = next;
+            break;
+        }
+        now = next;
+        fire();
+    }
+
+    timer.it_value.tv_sec = 0;
+    timer.it_interval.tv_sec = 0;
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+/* 現在の仮想時間を取得 */
+SYSTIM Kernel_getTime() {
+    return now;
+}
+
+/* タスクの実行統計を取得 */
+void Kernel_getStats(ID id, KERNEL_STATS *stats) {
+    *stats = tcb[id].stats;
+}
+
+/* サービスコール *************************************************************************/
+
+ER act_tsk(ID id) {
+    if(id == TSK_SELF)
+        id = running;
+    if(id < 1 || id > TNUM_TSKID)
+        return E_ID;
+
+    if(tcb[id].state == DORMANT)
+    {
+        start(id);
+        preempt(id);
+        return E_OK;
+    }
+    if(tcb[id].actcnt > 0)
+        return E_QOVR;
+    tcb[id].actcnt++;
+    return E_OK;
+}
+
+ER ter_tsk(ID id) {
+    if(id < 1 || id > TNUM_TSKID)
+        return E_ID;
+    if(id == running)
+        return E_ILUSE;
+    if(tcb[id].state == DORMANT)
+        return E_OBJ;
+
+    close_activation(&tcb[id]);
+    tcb[id].state = DORMANT;
+    if(tcb[id].actcnt > 0)
+    {
+        tcb[id].actcnt--;
+        start(id);
+    }
+    return E_OK;
+}
+
+void ext_tsk(void) {
+    TCB *t = &tcb[running];
+
+    close_activation(t);
+    t->state = DORMANT;
+    if(t->actcnt > 0)                           // 起動要求があれば再起動(現在のスタックはスケジューラに戻ってから再利用される)
+    {
+        t->actcnt--;
+        start(running);
+    }
+    setcontext(&scheduler);
+}
+
+ER sus_tsk(ID id) {
+    if(id == TSK_SELF)
+        id = running;
+    if(tcb[id].state == DORMANT)
+        return E_OBJ;
+    tcb[id].suspended = true;
+    if(id == running)
+        dispatch();
+    return E_OK;
+}
+
+ER rsm_tsk(ID id) {
+    if(!tcb[id].suspended)
+        return E_OBJ;
+    tcb[id].suspended = false;
+    preempt(id);
+    return E_OK;
+}
+
+ER slp_tsk(void) {
+    return tslp_tsk(TMO_FEVR);
+}
+
+ER tslp_tsk(TMO tmout) {
+    TCB *t = &tcb[running];
+
+    if(t->wupcnt > 0)
+    {
+        t->wupcnt--;
+        return E_OK;
+    }
+    if(tmout == 0)
+        return E_TMOUT;
+    return wait_task(tmout == TMO_FEVR ? TIME_INFINITE : now + (RELTIM)tmout, true);
+}
+
+ER wup_tsk(ID id) {
+    if(id == TSK_SELF)
+        id = running;
+    if(tcb[id].state == DORMANT)
+        return E_OBJ;
+    if(tcb[id].state == WAITING && tcb[id].wakeable)
+    {
+        release(id, E_OK);
+        preempt(id);
+        return E_OK;
+    }
+    if(tcb[id].wupcnt > 0)
+        return E_QOVR;
+    tcb[id].wupcnt++;
+    return E_OK;
+}
+
+ER dly_tsk(RELTIM dlytim) {
+    wait_task(now + dlytim, false);
+    return E_OK;
+}
+
+ER sta_cyc(ID id) {
+    if(id < 1 || id > TNUM_CYCID)
+        return E_ID;
+    if(!cyccb[id].started)
+    {
+        cyccb[id].started = true;
+        cyccb[id].next = now + kernel_cyc_cfg[id].phase;  // 位相0の場合は呼び出したタスクが待ちに入った時点で起動する
+    }
+    return E_OK;
+}
+
+ER stp_cyc(ID id) {
+    if(id < 1 || id > TNUM_CYCID)
+        return E_ID;
+    cyccb[id].started = false;
+    return E_OK;
+}
+
+ER get_tim(SYSTIM *p_systim) {
+    *p_systim = now;
+    return E_OK;
+}
+
+HRTCNT fch_hrt(void) {
+    return (HRTCNT)now;
+}
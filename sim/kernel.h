@@ -0,0 +1,47 @@
+#ifndef _KERNEL_H_
+#define _KERNEL_H_
+
+#include "ev3api.h"
+#include "kernel_cfg.h"
+
+/* タスクの生成情報(app.cfgのCRE_TSKに相当) */
+typedef struct {
+    const char  *name;          // タスク名(統計の表示用)
+    void        (*task)(intptr_t);
+    intptr_t    exinf;
+    PRI         pri;            // 優先度(小さいほど高い)
+    bool_t      act;            // TA_ACT(起動時に実行可能状態にする)
+} KERNEL_TSK_CFG;
+
+/* 周期ハンドラの生成情報(app.cfgのCRE_CYCにTNFY_ACTTSKを指定した場合に相当) */
+typedef struct {
+    ID          tskid;          // 周期ごとに起動するタスク
+    RELTIM      period;         // 周期[us]
+    RELTIM      phase;          // 初回起動までの時間[us]
+} KERNEL_CYC_CFG;
+
+/* タスクごとの実行統計(ホストのCPU時間) */
+typedef struct {
+    uint32_t    activations;    // 実行を終了した回数(周期起動タスクなら周期数)
+    uint64_t    total_ns;       // 実行時間の合計[ns]
+    uint64_t    max_ns;         // 1回の起動あたりの最大実行時間[ns]
+} KERNEL_STATS;
+
+/* 生成情報(sim_cfg.cで定義、添字はID) */
+extern const KERNEL_TSK_CFG kernel_tsk_cfg[TNUM_TSKID + 1];
+extern const KERNEL_CYC_CFG kernel_cyc_cfg[TNUM_CYCID + 1];
+
+/* 時間経過の通知(fromからtoまで仮想時間が進む際に呼ばれる、falseを返すとシミュレーションを終了する) */
+typedef bool_t (*KERNEL_ADVANCE)(SYSTIM from, SYSTIM to);
+
+/* タスクを実行し、仮想時間がlimit[us]に達するかadvanceがfalseを返すまで続ける
+ * タスクは処理中に時間を消費しない(待ちに入ったときだけ仮想時間が進む)ため、結果は実行するホストによらない */
+void Kernel_run(SYSTIM limit, KERNEL_ADVANCE advance);
+
+/* 現在の仮想時間[us]を取得 */
+SYSTIM Kernel_getTime();
+
+/* タスクの実行統計を取得 */
+void Kernel_getStats(ID tskid, KERNEL_STATS *stats);
+
+#endif
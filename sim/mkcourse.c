@@ -0,0 +1,95 @@
+// シミュレータ用の周回コース(楕円形のライン)を生成する
+//
+// 使い方 : mkcourse 出力.ppm
+// 直線3000mm・半円の半径1200mmの周回ラインで、上側の直線の中央に青ラインがある
+// 周回の内側には色の判定のテスト(test_color)用に、ブロック区間の黄色・赤の色見本を置く(走行体は通らない)
+// 下側の直線からラインの中心に合わせて右向き(方位0度)にスタートする
+// Line_taskは指定の走行距離以降に検知した青ラインで区間を終えるため、完走の判定はsim側で区間の切り替わりを見て行う
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "course.h"
+
+/* マクロ定義 */
+#define SCALE           4.0     // 1画素の大きさ[mm]
+#define STRAIGHT        3000.0  // 直線の長さ[mm]
+#define RADIUS          1200.0   // 半円の半径[mm]
+#define MARGIN          300.0   // コースの余白[mm]
+#define LINE_WIDTH      20.0    // ラインの幅[mm]
+#define BLUE_LENGTH     40.0    // 青ラインの長さ(進行方向)[mm]
+#define BLUE_WIDTH      60.0    // 青ラインの幅[mm]
+#define SENSOR_OFFSET   60.0    // 車軸からカラーセンサーまでの距離[mm](sim/plant.hと合わせる)
+#define PATCH_SIZE      120.0   // 色見本の一辺[mm]
+#define PATCH_OFFSET    600.0   // コースの中心から色見本の中心までの距離(左右)[mm]
+
+/* 周回ラインの中心線までの距離(内側が負) */
+static double track_distance(double x, double y, double cx, double cy) {
+    double dx = fabs(x - cx) - STRAIGHT / 2.0;
+
+    if(dx < 0)
+        dx = 0;
+    return sqrt(dx * dx + (y - cy) * (y - cy)) - RADIUS;
+}
+
+int main(int argc, char *argv[]) {
+    static const unsigned char white[3] = { 255, 255, 255 };
+    static const unsigned char black[3] = { 20, 20, 20 };
+    static const unsigned char blue[3] = { 20, 40, 255 };
+    static const unsigned char yellow[3] = { 255, 255, 0 };
+    static const unsigned char red[3] = { 255, 0, 0 };
+    COURSE course = { 0 };
+    double cx, cy, x, y, d;
+    const unsigned char *color;
+    unsigned char *p;
+    int px, py, result;
+
+    if(argc != 2)
+    {
+        printf("usage: %s out.ppm\n", argv[0]);
+        return 2;
+    }
+
+    course.scale = SCALE;
+    course.width = (int)((STRAIGHT + 2 * RADIUS + 2 * MARGIN) / SCALE);
+    course.height = (int)((2 * RADIUS + 2 * MARGIN) / SCALE);
+    course.pixels = malloc((size_t)course.width * course.height * 3);
+    if(course.pixels == NULL)
+        return 2;
+
+    cx = course.width * SCALE / 2.0;
+    cy = course.height * SCALE / 2.0;
+
+    for(py = 0; py < course.height; py++)
+    {
+        for(px = 0; px < course.width; px++)
+        {
+            x = (px + 0.5) * SCALE;
+            y = (py + 0.5) * SCALE;
+            d = track_distance(x, y, cx, cy);
+
+            color = white;
+            if(fabs(d) <= LINE_WIDTH / 2.0)
+                color = black;
+            if(y < cy && fabs(x - cx) <= BLUE_LENGTH / 2.0 && fabs(d) <= BLUE_WIDTH / 2.0)
+                color = blue;
+            if(fabs(y - cy) <= PATCH_SIZE / 2.0 && fabs(x - (cx - PATCH_OFFSET)) <= PATCH_SIZE / 2.0)
+                color = yellow;
+            if(fabs(y - cy) <= PATCH_SIZE / 2.0 && fabs(x - (cx + PATCH_OFFSET)) <= PATCH_SIZE / 2.0)
+                color = red;
+
+            p = &course.pixels[((size_t)py * course.width + px) * 3];
+            p[0] = color[0];
+            p[1] = color[1];
+            p[2] = color[2];
+        }
+    }
+
+    course.start_x = cx - STRAIGHT / 3.0 - SENSOR_OFFSET;  // 下側の直線、センサーがラインの中心
+    course.start_y = cy + RADIUS;
+    course.start_heading = 0.0;
+
+    result = Course_save(&course, argv[1]);
+    Course_free(&course);
+    return result == 0 ? 0 : 2;
+}
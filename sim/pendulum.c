@@ -0,0 +1,665 @@
+// gyroboyの倒立振子シミュレータ(ホスト用)
+//
+// gyroboyのバランス制御(../gyroboy/balance_float.c, balance_fixed.c, balance_lqr.c)を、二輪倒立振子の物理モデルと閉ループで動かす
+// 全ての実装が倒れずに立ち続けること、浮動小数点版と固定小数点版の応答が一致することを確かめ、1周期の処理時間を比べる
+// 状態フィードバック版(balance_lqr.c)は、手で調整したゲインの実装と傾きの振れ・出力の飽和を比べる
+// 8の字のシナリオは速度・旋回の指令(../gyroboy/drive_cmd.c)で走り、指令から求めた経路と実際の位置のずれを比べる
+// 転倒の予測(../gyroboy/fall_sup.c)はapp.cと同じく全ての走行で動かし、最後に予測の早さ・誤検出をまとめる
+// 最初にジャイロのキャリブレーション(../gyroboy/gyro_calib.c)の起動時間とオフセットの誤差を、以前の200回の平均と比べる
+//
+// 物理モデルは二輪倒立振子の非線形運動方程式(NXTway-GSのモデル、山本 2008)に、
+// EV3 Lモーター(出力100で電池電圧を印加)と、整数に丸めたジャイロセンサー・エンコーダーを組み合わせたもの
+// 乱数は固定のシードを使うため、毎回同じ結果になる
+//
+// 使い方 : pendulum [-s シナリオ名] [-o 軌跡.csv] [-v]
+// 終了コード : 0 全て合格, 1 転倒・応答の不一致, 2 引数の誤り
+
+#include <unistd.h>
+#include <time.h>
+#include "ev3api.h"
+#include "balance.h"
+#include "gyro_calib.h"
+#include "drive_cmd.h"
+#include "fall_sup.h"
+
+/* 物理モデルのパラメータ(SI単位) */
+#define G           9.81
+#define WHEEL_M     0.03        // タイヤ1個の質量[kg]
+#define WHEEL_R     (WHEEL_DIAMETER / 200.0)    // タイヤ半径[m] (balance.hのWHEEL_DIAMETER[cm])
+#define BODY_M      0.80        // 車体の質量[kg](インテリジェントブロックを含む)
+#define BODY_L      0.12        // 車軸から車体の重心までの距離[m]
+#define BODY_W      (TREAD_WIDTH / 100.0)       // トレッド幅[m] (drive_cmd.hのTREAD_WIDTH[cm])
+#define BODY_D      0.06        // 車体の奥行き[m]
+#define MOTOR_JM    1e-5        // モーターの慣性モーメント[kgm^2]
+#define MOTOR_RM    6.69        // モーターの抵抗[ohm]
+#define MOTOR_KB    0.468       // 逆起電力定数[Vs/rad]
+#define MOTOR_KT    0.317       // トルク定数[Nm/A]
+#define MOTOR_FM    0.0022      // 車体とモーターの間の摩擦係数
+#define BATTERY     8.0         // 電池電圧[V] (出力100でこの電圧を印加する)
+
+/* センサー */
+#define GYRO_BIAS   1.3         // ジャイロセンサーのオフセット[deg/s]
+#define GYRO_NOISE  0.5         // ジャイロセンサーの雑音の標準偏差[deg/s]
+#define GYRO_MAX    440         // ジャイロセンサーの測定範囲[deg/s]
+
+/* シミュレーション */
+#define SUBSTEP     10          // 制御周期あたりの物理モデルの積分回数
+#define FALL_ANGLE  45.0        // 転倒とみなす車体の傾き[deg]
+#define OLD_CALIB_NUM   200     // 以前のapp.cのキャリブレーションのサンプル数(4ms毎)
+#define CALIB_TRIALS    1000    // キャリブレーションの比較の試行回数
+#define FALL_TIME_MS    1000    // 出力が飽和し続けたら転倒とみなす時間[ms](app.cと合わせる)
+#define MATCH_ANGLE 0.5         // 両実装の車体の傾きの差の許容値[deg]
+#define BENCH_LOOPS 2000000     // 処理時間の計測の繰り返し回数
+#define FALL_SEEDS      10      // fall_supの評価で乱数の列を変える回数
+#define FALL_PUSH_MIN   0.02    // fall_supの評価で押す力積[Nms]
+#define FALL_PUSH_MAX   0.10
+#define FALL_PUSH_STEP  0.01
+
+#define DT          (BALANCE_PERIOD_MS / 1000.0)
+#define DEG(x)      ((x) * 180.0 / M_PI)
+#define RAD(x)      ((x) * M_PI / 180.0)
+
+/* 物理モデルの状態 */
+typedef struct {
+    double  theta, theta_dot;   // 左右タイヤの平均回転角度[rad](床に対する角度)
+    double  psi, psi_dot;       // 車体の傾き[rad](前に倒れる向きが正)
+    double  phi, phi_dot;       // 方位[rad](右タイヤが前に進む向きが正)
+    double  x;                  // 走行距離[m]
+    double  px, py;             // 床の上の位置[m](初期の向きがx軸)
+} PENDULUM;
+
+/* 外乱・指令の時刻表(シナリオの1行) */
+typedef struct {
+    double  time;               // 開始時刻[s]
+    int     drive;              // balance_input_tのdrive
+    int     steer;              // balance_input_tのsteer
+    double  push;               // 車体を押す力積[Nms](この時刻に1回)
+    double  speed;              // 速度の指令[mm/s](commandが0でないシナリオ)
+    double  yaw;                // 旋回の角速度の指令[deg/s](同上)
+} EVENT;
+
+/* 指令の与え方 */
+enum {
+    CMD_RAW,                    // drive・steerをそのまま与える
+    CMD_RAMP,                   // speed・yawをdrive_cmdの傾斜で与える(app.cと同じ)
+    CMD_STEP,                   // speed・yawを傾斜なしで換算して与える(比較用)
+};
+
+/* シナリオ */
+typedef struct {
+    const char  *name;
+    const char  *description;
+    double      duration;       // 時間[s]
+    double      init_angle;     // 車体の初期の傾き[deg]
+    EVENT       event[8];       // 時刻の順に並べ、timeが負の要素で終端
+    int         command;        // 指令の与え方(CMD_*)
+} SCENARIO;
+
+/* 制御器(両方の実装を同じ形で呼ぶ) */
+typedef struct {
+    const char  *name;
+    void        (*init)(float gyro_offset);
+    void        (*update)(const balance_input_t *in, int loop, balance_output_t *out);
+    float       (*get_angle)(void);
+    float       (*get_offset)(void);
+} CONTROLLER;
+
+/* 1回の走行の結果 */
+typedef struct {
+    bool_t  fell;               // 転倒した(車体の傾き、または出力の飽和の継続)
+    double  fell_time;          // 転倒した時刻[s]
+    double  max_angle;          // 車体の傾きの最大値[deg]
+    double  rms_angle;          // 車体の傾きの二乗平均平方根[deg]
+    double  saturation;         // 出力が飽和した周期の割合
+    double  distance;           // 終了時の走行距離[mm]
+    double  track_max;          // 指令の経路からの位置のずれの最大値[mm]
+    double  track_end;          // 終了時の位置のずれ[mm]
+    double  predict_time;       // fall_supが最初に転倒を予測した時刻[s](予測なしは負)
+    double  old_detect_time;    // 以前のapp.cの判定(出力の飽和がFALL_TIME_MS続く)が転倒とする時刻[s]
+    int     predictions;        // fall_supが転倒を予測した回数
+    int     loops;              // 制御周期の数
+    float   *angle;             // 周期ごとの車体の傾き[deg](比較用)
+    balance_input_t *input;     // 周期ごとの入力(比較・処理時間の計測用)
+} RESULT;
+
+static const SCENARIO scenarios[] = {
+    { "stand", "傾けて置いて立ち続け、3秒と6秒で前後に押す", 10.0, 3.0,
+        { { 3.0, 0, 0, 0.02 }, { 6.0, 0, 0, -0.02 }, { -1 } } },
+    { "drive", "前進・停止・後退", 12.0, 0.0,
+        { { 2.0, 150, 0, 0 }, { 5.0, 0, 0, 0 }, { 7.0, -150, 0, 0 }, { 10.0, 0, 0, 0 }, { -1 } } },
+    { "fast", "高速で前進・停止・後退", 12.0, 0.0,
+        { { 2.0, 1400, 0, 0 }, { 5.0, 0, 0, 0 }, { 7.0, -1400, 0, 0 }, { 10.0, 0, 0, 0 }, { -1 } } },
+    { "eight", "250mm/s・120deg/sで左右に1周ずつ旋回して8の字を描く(drive_cmdの傾斜あり)", 9.0, 0.0,
+        { { 1.0, 0, 0, 0, 250, 120 }, { 4.0, 0, 0, 0, 250, -120 }, { 7.0, 0, 0, 0, 0, 0 }, { -1 } }, CMD_RAMP },
+    { "eight-s", "同じ8の字を傾斜なしの指令で走る", 9.0, 0.0,
+        { { 1.0, 0, 0, 0, 250, 120 }, { 4.0, 0, 0, 0, 250, -120 }, { 7.0, 0, 0, 0, 0, 0 }, { -1 } }, CMD_STEP },
+};
+#define SCENARIO_NUM    (int)(sizeof(scenarios) / sizeof(scenarios[0]))
+
+static balance_float_t state_float;
+static balance_fixed_t state_fixed;
+static balance_lqr_t state_lqr;
+static unsigned int seed;
+static unsigned int run_seed = 1;           // run()の乱数のシード
+static bool_t observe = false;              // 転倒を予測してもモーターを止めずに走らせ続ける(予測の評価用)
+static FILE *trace = NULL;
+static bool_t verbose = false;
+
+/* 正規分布の乱数(Box-Muller) */
+static double gauss(void) {
+    double u1 = (rand_r(&seed) + 1.0) / (RAND_MAX + 2.0);
+    double u2 = (rand_r(&seed) + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/* 浮動小数点版 : シミュレーションでは周期が揺らがないので、正確な周期を渡す */
+static void float_init(float gyro_offset) {
+    balance_float_init(&state_float, gyro_offset);
+}
+
+static void float_update(const balance_input_t *in, int loop, balance_output_t *out) {
+    float interval_time = DT;
+
+    balance_float_update(&state_float, in, interval_time, out);
+}
+
+static float float_get_angle(void) {
+    return balance_float_get_angle(&state_float);
+}
+
+static float float_get_offset(void) {
+    return balance_float_get_offset(&state_float);
+}
+
+/* 固定小数点版 */
+static void fixed_init(float gyro_offset) {
+    balance_fixed_init(&state_fixed, gyro_offset);
+}
+
+static void fixed_update(const balance_input_t *in, int loop, balance_output_t *out) {
+    balance_fixed_update(&state_fixed, in, out);
+}
+
+static float fixed_get_angle(void) {
+    return balance_fixed_get_angle(&state_fixed);
+}
+
+static float fixed_get_offset(void) {
+    return balance_fixed_get_offset(&state_fixed);
+}
+
+/* 状態フィードバック版 */
+static void lqr_init(float gyro_offset) {
+    balance_lqr_init(&state_lqr, gyro_offset);
+}
+
+static void lqr_update(const balance_input_t *in, int loop, balance_output_t *out) {
+    balance_lqr_update(&state_lqr, in, out);
+}
+
+static float lqr_get_angle(void) {
+    return balance_lqr_get_angle(&state_lqr);
+}
+
+static float lqr_get_offset(void) {
+    return balance_lqr_get_offset(&state_lqr);
+}
+
+/* 先頭の2つ(浮動小数点版・固定小数点版)は応答が一致することを確かめる */
+static const CONTROLLER controllers[] = {
+    { "float", float_init, float_update, float_get_angle, float_get_offset },
+    { "fixed", fixed_init, fixed_update, fixed_get_angle, fixed_get_offset },
+    { "lqr",   lqr_init,   lqr_update,   lqr_get_angle,   lqr_get_offset },
+};
+#define CONTROLLER_NUM  (int)(sizeof(controllers) / sizeof(controllers[0]))
+
+/* 物理モデルを1ステップ進める(左右のモーターの出力は-100~100) */
+static void pendulum_step(PENDULUM *p, int left_power, int right_power, double dt) {
+    const double n2jm = 2 * MOTOR_JM;
+    const double jw = WHEEL_M * WHEEL_R * WHEEL_R / 2;
+    const double jpsi = BODY_M * BODY_L * BODY_L / 3;
+    const double jphi = BODY_M * (BODY_W * BODY_W + BODY_D * BODY_D) / 12;
+    const double alpha = MOTOR_KT / MOTOR_RM;
+    const double beta = MOTOR_KT * MOTOR_KB / MOTOR_RM + MOTOR_FM;
+    double vl = left_power / 100.0 * BATTERY;
+    double vr = right_power / 100.0 * BATTERY;
+    double s = sin(p->psi), c = cos(p->psi);
+
+    /* 前後・傾きの運動方程式 [a11 a12; a12 a22] [theta'' psi''] = [f1 f2] */
+    double a11 = (2 * WHEEL_M + BODY_M) * WHEEL_R * WHEEL_R + 2 * jw + n2jm;
+    double a12 = BODY_M * BODY_L * WHEEL_R * c - n2jm;
+    double a22 = BODY_M * BODY_L * BODY_L + jpsi + n2jm;
+    double f1 = alpha * (vl + vr) - 2 * beta * p->theta_dot + 2 * beta * p->psi_dot
+              + BODY_M * BODY_L * WHEEL_R * p->psi_dot * p->psi_dot * s;
+    double f2 = -alpha * (vl + vr) + 2 * beta * p->theta_dot - 2 * beta * p->psi_dot
+              + BODY_M * G * BODY_L * s + BODY_M * BODY_L * BODY_L * p->phi_dot * p->phi_dot * s * c;
+    double det = a11 * a22 - a12 * a12;
+    double theta_acc = (a22 * f1 - a12 * f2) / det;
+    double psi_acc = (a11 * f2 - a12 * f1) / det;
+
+    /* 旋回の運動方程式 */
+    double k = BODY_W / (2 * WHEEL_R);
+    double i3 = WHEEL_M * BODY_W * BODY_W / 2 + jphi + k * k * 2 * (jw + MOTOR_JM) + BODY_M * BODY_L * BODY_L * s * s;
+    double f3 = k * alpha * (vr - vl) - k * k * 2 * beta * p->phi_dot
+              - 2 * BODY_M * BODY_L * BODY_L * p->psi_dot * p->phi_dot * s * c;
+    double phi_acc = f3 / i3;
+
+    /* 半陰的オイラー法 */
+    p->theta_dot += theta_acc * dt;
+    p->psi_dot += psi_acc * dt;
+    p->phi_dot += phi_acc * dt;
+    p->theta += p->theta_dot * dt;
+    p->psi += p->psi_dot * dt;
+    p->phi += p->phi_dot * dt;
+    p->x += p->theta_dot * WHEEL_R * dt;
+    p->px += p->theta_dot * WHEEL_R * cos(p->phi) * dt;
+    p->py += p->theta_dot * WHEEL_R * sin(p->phi) * dt;
+}
+
+/* センサー値を読む(ジャイロは整数[deg/s]、エンコーダーは車体に対するタイヤの角度の整数[deg]) */
+static void read_sensors(const PENDULUM *p, balance_input_t *in) {
+    double k = BODY_W / (2 * WHEEL_R);
+    double rate = DEG(p->psi_dot) + GYRO_BIAS + GYRO_NOISE * gauss();
+
+    in->gyro_rate = (int)lround(fmin(fmax(rate, -GYRO_MAX), GYRO_MAX));
+    in->left_cnt = (int32_t)floor(DEG(p->theta - k * p->phi - p->psi));
+    in->right_cnt = (int32_t)floor(DEG(p->theta + k * p->phi - p->psi));
+}
+
+/* 静止状態でキャリブレーションを行い、オフセットを返す(app.cと同じく制御周期毎に1サンプルをgyro_calibに与える) */
+static float calibrate_with(bool_t warm, float saved, int *samples, bool_t *warm_used) {
+    PENDULUM p = { 0 };
+    balance_input_t in;
+    gyro_calib_t calib;
+    int n = 0;
+
+    gyro_calib_init(&calib, warm, saved);
+    do
+    {
+        read_sensors(&p, &in);
+        n++;
+    } while(gyro_calib_add(&calib, in.gyro_rate) != GYRO_CALIB_DONE);
+
+    if(samples != NULL)
+        *samples = n;
+    if(warm_used != NULL)
+        *warm_used = calib.warm_used;
+    return gyro_calib_get_offset(&calib);
+}
+
+/* 初回起動(保存したオフセットなし)のキャリブレーション */
+static float calibrate(void) {
+    return calibrate_with(false, 0, NULL, NULL);
+}
+
+/* 以前のapp.cのキャリブレーション(OLD_CALIB_NUM回の単純平均) */
+static float calibrate_old(void) {
+    PENDULUM p = { 0 };
+    balance_input_t in;
+    int i, sum = 0;
+
+    for(i = 0; i < OLD_CALIB_NUM; i++)
+    {
+        read_sensors(&p, &in);
+        sum += in.gyro_rate;
+    }
+    return sum / (float)OLD_CALIB_NUM;
+}
+
+/* キャリブレーションの方法毎に、起動時間(サンプル数×周期)とオフセットの誤差を乱数の列を変えて比べる */
+static void calib_report(void) {
+    static const struct {
+        const char  *name;
+        int         mode;           // 0 以前の方法, 1 初回起動, 2 保存したオフセットあり
+        float       saved_error;    // 保存したオフセットの真の値からのずれ[deg/s]
+        int         period_ms;      // 1サンプルの周期[ms]
+    } methods[] = {
+        { "old",   0, 0,    4 },
+        { "cold",  1, 0,    BALANCE_PERIOD_MS },
+        { "warm",  2, 0.05, BALANCE_PERIOD_MS },
+        { "stale", 2, 2.0,  BALANCE_PERIOD_MS },    // 温度などでオフセットが変わった場合
+    };
+    int m, i, n, samples, max_samples, warm_count;
+    bool_t warm_used;
+    double offset, err, sum2, max_err;
+
+    for(m = 0; m < (int)(sizeof(methods) / sizeof(methods[0])); m++)
+    {
+        samples = max_samples = warm_count = 0;
+        sum2 = max_err = 0;
+        for(i = 0; i < CALIB_TRIALS; i++)
+        {
+            seed = 1000 + i;
+            n = OLD_CALIB_NUM;
+            warm_used = false;
+            if(methods[m].mode == 0)
+                offset = calibrate_old();
+            else
+                offset = calibrate_with(methods[m].mode == 2, GYRO_BIAS + methods[m].saved_error, &n, &warm_used);
+            err = offset - GYRO_BIAS;
+            sum2 += err * err;
+            max_err = fmax(max_err, fabs(err));
+            samples += n;
+            if(n > max_samples)
+                max_samples = n;
+            if(warm_used)
+                warm_count++;
+        }
+        printf("calib    %-6s start %4d ms (max %4d ms), offset error rms %.3f max %.3f deg/s, saved offset used %d/%d\n",
+               methods[m].name, samples * methods[m].period_ms / CALIB_TRIALS, max_samples * methods[m].period_ms,
+               sqrt(sum2 / CALIB_TRIALS), max_err, warm_count, CALIB_TRIALS);
+    }
+}
+
+/* シナリオを1つの制御器で走らせる */
+static void run(const SCENARIO *sc, const CONTROLLER *ctrl, RESULT *r) {
+    PENDULUM p = { 0 };
+    balance_input_t in;
+    balance_output_t out;
+    const EVENT *ev = sc->event;
+    drive_cmd_t cmd;
+    int drive = 0, steer = 0;
+    fall_sup_t sup;
+    fall_sup_state_t state;
+    int loop, i, saturated = 0, ok_loop = 0;
+    double t, angle, sum2 = 0;
+    double speed = 0, yaw = 0, rx = 0, ry = 0, rphi = 0, track;     // 指令とその経路(理想的な二輪車)
+
+    seed = run_seed;                            // 両方の実装に同じ雑音を与える
+    memset(r, 0, sizeof(*r));
+    r->predict_time = -1;
+    r->loops = (int)(sc->duration / DT);
+    r->angle = calloc(r->loops, sizeof(float));
+    r->input = calloc(r->loops, sizeof(balance_input_t));
+
+    ctrl->init(calibrate());
+    drive_cmd_init(&cmd);
+    fall_sup_init(&sup);
+    p.psi = RAD(sc->init_angle);
+
+    for(loop = 0; loop < r->loops; loop++)
+    {
+        t = loop * DT;
+        for(; ev->time >= 0 && ev->time <= t; ev++)     // 指令の変更と外乱
+        {
+            drive = ev->drive;
+            steer = ev->steer;
+            speed = ev->speed;
+            yaw = ev->yaw;
+            drive_cmd_set(&cmd, speed, yaw);
+            p.psi_dot += ev->push / (BODY_M * BODY_L * BODY_L);
+        }
+
+        read_sensors(&p, &in);
+        in.drive = drive;
+        in.steer = steer;
+        if(sc->command == CMD_RAMP)
+        {
+            drive_cmd_update(&cmd, &in);
+            speed = drive_cmd_get_speed(&cmd);
+            yaw = drive_cmd_get_yaw(&cmd);
+        }
+        else if(sc->command == CMD_STEP)
+        {
+            in.drive = (int)lround(DRIVE_CMD_DRIVE(speed));
+            in.steer = (int)lround(DRIVE_CMD_STEER(yaw));
+        }
+        r->input[loop] = in;
+        ctrl->update(&in, loop, &out);
+
+        /* app.cと同じ転倒の予測(予測するとFALL_SUP_FALLENになり、app.cはモーターを止める) */
+        state = fall_sup_update(&sup, ctrl->get_angle(), in.gyro_rate - ctrl->get_offset(), out.power);
+        if(sup.predictions > 0 && r->predict_time < 0)
+            r->predict_time = t;
+
+        if(out.power > -100 && out.power < 100)     // 以前のapp.cの転倒判定
+            ok_loop = loop;
+        else
+            saturated++;
+        angle = DEG(p.psi);
+        r->angle[loop] = angle;
+        sum2 += angle * angle;
+        if(fabs(angle) > r->max_angle)
+            r->max_angle = fabs(angle);
+        if(trace != NULL)
+            fprintf(trace, "%s,%s,%.3f,%.3f,%.1f,%d,%d,%d\n", sc->name, ctrl->name, t, angle, p.x * 1000, out.power, out.left_power, out.right_power);
+
+        if(fabs(angle) > FALL_ANGLE || (state == FALL_SUP_FALLEN && !observe))
+        {
+            r->fell = true;
+            r->fell_time = t;
+            r->old_detect_time = (ok_loop + 1) * DT + FALL_TIME_MS / 1000.0;   // 倒れた後も出力は飽和し続ける
+            r->loops = loop + 1;
+            break;
+        }
+
+        for(i = 0; i < SUBSTEP; i++)
+            pendulum_step(&p, out.left_power, out.right_power, DT / SUBSTEP);
+
+        /* 指令の経路を同じ周期で積分し、位置のずれを求める */
+        rx += speed / 1000 * cos(rphi) * DT;
+        ry += speed / 1000 * sin(rphi) * DT;
+        rphi += RAD(yaw) * DT;
+        track = hypot(p.px - rx, p.py - ry) * 1000;
+        r->track_max = fmax(r->track_max, track);
+        r->track_end = track;
+    }
+
+    r->predictions = sup.predictions;
+    r->rms_angle = sqrt(sum2 / r->loops);
+    r->saturation = (double)saturated / r->loops;
+    r->distance = p.x * 1000;
+}
+
+/* 同じ入力の列を両方の実装に与え、出力が一致しない周期を数える(閉ループの影響を除いた比較) */
+static int compare_open_loop(const RESULT *r, int *max_diff) {
+    balance_output_t a, b;
+    int loop, diff, mismatch = 0;
+
+    *max_diff = 0;
+    seed = 1;                                   // run()と同じオフセットから始める
+    controllers[0].init(calibrate());
+    seed = 1;
+    controllers[1].init(calibrate());
+    for(loop = 0; loop < r->loops; loop++)
+    {
+        controllers[0].update(&r->input[loop], loop, &a);
+        controllers[1].update(&r->input[loop], loop, &b);
+        diff = abs(a.left_power - b.left_power) + abs(a.right_power - b.right_power);
+        if(diff != 0)
+            mismatch++;
+        if(diff > *max_diff)
+            *max_diff = diff;
+    }
+    return mismatch;
+}
+
+/* 立っている車体を1回押すシナリオ */
+static void push_scenario(SCENARIO *sc, double push) {
+    memset(sc, 0, sizeof(*sc));
+    sc->name = "push";
+    sc->description = "1秒で押す";
+    sc->duration = 4.0;
+    sc->event[0].time = 1.0;
+    sc->event[0].push = push;
+    sc->event[1].time = -1;
+}
+
+/*
+ * fall_supの評価(予測してもバランス制御を続け、車体の傾きがFALL_ANGLEを超えたときを転倒とする)
+ *  - 検出 : 倒れるまで押したときに、転倒の何ms前に予測したか、以前の判定は何ms後か
+ *  - 誤検出 : 全てのシナリオを乱数の列を変えて走らせ、倒れなかった走行での予測の回数
+ * 立て直しの動作は行わない(予測した時点で出力は飽和しており、モーターはそれ以上の力を出せない)
+ */
+static void fall_report(void) {
+    SCENARIO sc;
+    RESULT r;
+    int c, s, i, falls, missed, pushes, false_pushes, runs, false_runs, false_count;
+    double push, lead, lead_sum, lead_min, lag_sum, minutes;
+    FILE *saved_trace = trace;
+
+    trace = NULL;                               // 軌跡はシナリオの走行だけを書く
+    observe = true;
+
+    for(c = 0; c < CONTROLLER_NUM; c++)
+    {
+        falls = missed = pushes = false_pushes = 0;
+        lead_sum = lag_sum = 0;
+        lead_min = 1e9;
+        for(i = 0; i < FALL_SEEDS; i++)
+            for(push = FALL_PUSH_MIN; push <= FALL_PUSH_MAX + 1e-9; push += FALL_PUSH_STEP)
+            {
+                run_seed = 1 + i;
+                push_scenario(&sc, push);
+                run(&sc, &controllers[c], &r);
+                free(r.angle);
+                free(r.input);
+                if(!r.fell)
+                {
+                    pushes++;
+                    if(r.predictions > 0)
+                        false_pushes++;
+                    continue;
+                }
+                falls++;
+                if(r.predict_time < 0 || r.predict_time > r.fell_time)
+                {
+                    missed++;
+                    continue;
+                }
+                lead = (r.fell_time - r.predict_time) * 1000;
+                lead_sum += lead;
+                lead_min = fmin(lead_min, lead);
+                lag_sum += (r.old_detect_time - r.fell_time) * 1000;
+            }
+        printf("fall     detect %-6s %d falls, missed %d, predicted %.0f ms (min %.0f ms) before %.0f deg, old check %.0f ms after\n",
+               controllers[c].name, falls, missed, lead_sum / (falls - missed), lead_min, FALL_ANGLE, lag_sum / (falls - missed));
+        printf("fall     false  %-6s predicted in %d/%d pushes without a fall\n", controllers[c].name, false_pushes, pushes);
+
+        runs = false_runs = false_count = 0;
+        minutes = 0;
+        for(i = 0; i < FALL_SEEDS; i++)
+            for(s = 0; s < SCENARIO_NUM; s++)
+            {
+                run_seed = 1 + i;
+                run(&scenarios[s], &controllers[c], &r);
+                free(r.angle);
+                free(r.input);
+                if(r.fell)
+                    continue;
+                runs++;
+                minutes += r.loops * DT / 60;
+                false_count += r.predictions;
+                if(r.predictions > 0)
+                    false_runs++;
+            }
+        printf("fall     false  %-6s %d predictions in %d/%d runs without a fall (%.2f /min)\n",
+               controllers[c].name, false_count, false_runs, runs, false_count / minutes);
+    }
+    observe = false;
+    run_seed = 1;
+    trace = saved_trace;
+}
+
+/* 1周期の処理時間[ns]を計測する */
+static double bench(const CONTROLLER *ctrl, const RESULT *r) {
+    struct timespec t0, t1;
+    balance_output_t out;
+    volatile int sink = 0;
+    int i;
+
+    ctrl->init(0.0);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(i = 0; i < BENCH_LOOPS; i++)
+    {
+        ctrl->update(&r->input[i % r->loops], i, &out);
+        sink += out.left_power;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / BENCH_LOOPS;
+}
+
+int main(int argc, char *argv[]) {
+    const char *only = NULL;
+    RESULT result[CONTROLLER_NUM];
+    double max_diff_angle;
+    int opt, s, c, loop, loops, mismatch, max_diff;
+    int failed = 0;
+
+    while((opt = getopt(argc, argv, "s:o:v")) != -1)
+    {
+        switch(opt)
+        {
+            case 's': only = optarg; break;
+            case 'o':
+                if((trace = fopen(optarg, "w")) == NULL)
+                {
+                    fprintf(stderr, "cannot open %s\n", optarg);
+                    return 2;
+                }
+                fprintf(trace, "scenario,controller,time,angle,distance,power,left,right\n");
+                break;
+            case 'v': verbose = true; break;
+            default:
+                fprintf(stderr, "usage: pendulum [-s scenario] [-o trace.csv] [-v]\n");
+                return 2;
+        }
+    }
+
+    calib_report();
+    printf("%-8s %-6s %8s %9s %9s %7s %11s\n", "scenario", "ctrl", "result", "max[deg]", "rms[deg]", "sat[%]", "dist[mm]");
+    for(s = 0; s < SCENARIO_NUM; s++)
+    {
+        if(only != NULL && strcmp(only, scenarios[s].name) != 0)
+            continue;
+        if(verbose)
+            printf("# %s : %s\n", scenarios[s].name, scenarios[s].description);
+
+        for(c = 0; c < CONTROLLER_NUM; c++)
+        {
+            run(&scenarios[s], &controllers[c], &result[c]);
+            printf("%-8s %-6s %8s %9.2f %9.3f %7.1f %11.1f\n", scenarios[s].name, controllers[c].name,
+                   result[c].fell ? "FELL" : "UPRIGHT", result[c].max_angle, result[c].rms_angle,
+                   result[c].saturation * 100, result[c].distance);
+            if(scenarios[s].command != CMD_RAW)
+                printf("%-8s track  %-6s max %.1f mm, end %.1f mm\n", scenarios[s].name, controllers[c].name,
+                       result[c].track_max, result[c].track_end);
+            if(result[c].fell)
+            {
+                printf("         %-6s fell at %.3f s\n", controllers[c].name, result[c].fell_time);
+                failed = 1;
+            }
+        }
+
+        /* 閉ループの応答の比較 */
+        loops = result[0].loops < result[1].loops ? result[0].loops : result[1].loops;
+        max_diff_angle = 0;
+        for(loop = 0; loop < loops; loop++)
+            max_diff_angle = fmax(max_diff_angle, fabs(result[0].angle[loop] - result[1].angle[loop]));
+        mismatch = compare_open_loop(&result[0], &max_diff);
+        printf("%-8s match  angle diff max %.3f deg, open-loop power mismatch %d/%d loops (max %d)%s\n",
+               scenarios[s].name, max_diff_angle, mismatch, result[0].loops, max_diff,
+               max_diff_angle > MATCH_ANGLE ? "  NG" : "");
+        if(max_diff_angle > MATCH_ANGLE)
+            failed = 1;
+
+        for(c = 0; c < CONTROLLER_NUM; c++)
+            printf("%-8s bench  %-6s %.1f ns/loop\n", scenarios[s].name, controllers[c].name, bench(&controllers[c], &result[0]));
+
+        for(c = 0; c < CONTROLLER_NUM; c++)
+        {
+            free(result[c].angle);
+            free(result[c].input);
+        }
+    }
+
+    if(only == NULL)
+        fall_report();
+
+    if(trace != NULL)
+        fclose(trace);
+
+    return failed;
+}
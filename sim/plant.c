@@ -0,0 +1,194 @@
+// 二輪差動型走行体の物理モデル
+// モーターは出力に比例した目標速度への1次遅れ、車体は左右タイヤの速度から位置と方位を積分する
+// 乱数を使わないため、同じコース・同じプログラムなら毎回同じ結果になる
+
+#include "plant.h"
+
+/* モーターの状態 */
+typedef struct {
+    motor_type_t    type;       // モーターの種類
+    int             power;      // 設定された出力
+    bool_t          stopped;    // 停止指示中かどうか
+    bool_t          brake;      // ブレーキ停止かどうか
+    double          speed;      // 回転速度[deg/s]
+    double          angle;      // 回転角度[deg]
+    double          offset;     // 回転角度のリセット位置[deg]
+} MOTOR;
+
+/* グローバル変数 */
+static const motor_port_t
+    left_motor      = EV3_PORT_C,
+    right_motor     = EV3_PORT_B,
+    arm_motor       = EV3_PORT_A;
+
+static const COURSE *course = NULL;
+static float battery = 1.0;
+static MOTOR motor[TNUM_MOTOR_PORT];
+static PLANT_STATE state;
+static double gyro_angle = 0.0;                 // ジャイロセンサーの角度[deg]
+
+/* 度をラジアンに変換 */
+static double rad(double deg) {
+    return deg * M_PI / 180.0;
+}
+
+/* モーターを1ステップ進める */
+static void motor_step(MOTOR *m, double dt) {
+    double max_speed = m->type == MEDIUM_MOTOR ? PLANT_MEDIUM_SPEED : PLANT_LARGE_SPEED;
+    double target = m->stopped ? 0.0 : m->power / 100.0 * max_speed * battery;
+    double tau = !m->stopped ? PLANT_MOTOR_TAU : (m->brake ? PLANT_BRAKE_TAU : PLANT_COAST_TAU);
+
+    m->speed += (target - m->speed) * (dt / (tau + dt));
+    m->angle += m->speed * dt;
+}
+
+/* 初期化関数 */
+void Plant_init(const COURSE *c, float b) {
+    int i;
+
+    course = c;
+    battery = b;
+    memset(motor, 0, sizeof(motor));
+    for(i = 0; i < TNUM_MOTOR_PORT; i++)
+    {
+        motor[i].type = LARGE_MOTOR;
+        motor[i].stopped = true;
+    }
+    motor[arm_motor].angle = -56.0;             // アームの初期角度(Run.cのコメント参照)
+
+    memset(&state, 0, sizeof(state));
+    state.x = course->start_x;
+    state.y = course->start_y;
+    state.heading = course->start_heading;
+    gyro_angle = 0.0;
+}
+
+/* 物理モデルを1ステップ進める */
+void Plant_step() {
+    double dt = PLANT_STEP / 1000000.0;
+    double wl, wr, mid;
+    int i;
+
+    for(i = 0; i < TNUM_MOTOR_PORT; i++)
+        motor_step(&motor[i], dt);
+
+    wl = motor[left_motor].speed * M_PI * PLANT_TIRE_DIAMETER / 360.0;     // タイヤの速度[mm/s]
+    wr = motor[right_motor].speed * M_PI * PLANT_TIRE_DIAMETER / 360.0;
+    state.speed = (wl + wr) / 2.0;
+    state.yaw_rate = (wl - wr) / PLANT_TREAD * 180.0 / M_PI;
+
+    mid = rad(state.heading + state.yaw_rate * dt / 2.0);                 // 中間の方位で積分
+    state.x += state.speed * cos(mid) * dt;
+    state.y += state.speed * sin(mid) * dt;
+    state.heading += state.yaw_rate * dt;
+    gyro_angle += state.yaw_rate * dt;
+}
+
+/* 走行体の状態を取得 */
+void Plant_getState(PLANT_STATE *s) {
+    *s = state;
+}
+
+/* モーターの種類を設定 */
+void Plant_setMotorType(motor_port_t port, motor_type_t type) {
+    motor[port].type = type;
+}
+
+/* モーターの出力を設定 */
+void Plant_setMotorPower(motor_port_t port, int power) {
+    if(power > 100)
+        power = 100;
+    else if(power < -100)
+        power = -100;
+    motor[port].power = power;
+    motor[port].stopped = false;
+}
+
+/* モーターの出力を取得 */
+int Plant_getMotorPower(motor_port_t port) {
+    return motor[port].stopped ? 0 : motor[port].power;
+}
+
+/* モーターを停止 */
+void Plant_stopMotor(motor_port_t port, bool_t brake) {
+    motor[port].power = 0;
+    motor[port].stopped = true;
+    motor[port].brake = brake;
+}
+
+/* モーターの回転角度を取得 */
+int32_t Plant_getMotorCounts(motor_port_t port) {
+    return (int32_t)floor(motor[port].angle - motor[port].offset);
+}
+
+/* モーターの回転角度をリセット */
+void Plant_resetMotorCounts(motor_port_t port) {
+    motor[port].offset = motor[port].angle;
+}
+
+/* カラーセンサーのRGB値を取得(検出範囲内の色の平均をPLANT_RGB_GAINで換算する) */
+void Plant_getRGB(rgb_raw_t *rgb) {
+    static const float ring[][2] = {    // 検出範囲内の標本点(半径に対する割合)
+        { 0.0, 0.0 }, { 1.0, 0.0 }, { -1.0, 0.0 }, { 0.0, 1.0 }, { 0.0, -1.0 },
+        { 0.5, 0.5 }, { -0.5, 0.5 }, { 0.5, -0.5 }, { -0.5, -0.5 }
+    };
+    const int n = sizeof(ring) / sizeof(ring[0]);
+    double c = cos(rad(state.heading));
+    double s = sin(rad(state.heading));
+    double sx = state.x + PLANT_SENSOR_OFFSET * c;
+    double sy = state.y + PLANT_SENSOR_OFFSET * s;
+    float sum[3] = { 0, 0, 0 };
+    float sample[3];
+    int i;
+
+    for(i = 0; i < n; i++)
+    {
+        Course_sample(course, sx + ring[i][0] * PLANT_SENSOR_RADIUS, sy + ring[i][1] * PLANT_SENSOR_RADIUS, sample);
+        sum[0] += sample[0];
+        sum[1] += sample[1];
+        sum[2] += sample[2];
+    }
+    rgb->r = (uint16_t)(sum[0] / n * PLANT_RGB_GAIN + 0.5);
+    rgb->g = (uint16_t)(sum[1] / n * PLANT_RGB_GAIN + 0.5);
+    rgb->b = (uint16_t)(sum[2] / n * PLANT_RGB_GAIN + 0.5);
+}
+
+/* ジャイロセンサーの角度を取得 */
+int16_t Plant_getGyroAngle() {
+    return (int16_t)lround(gyro_angle);
+}
+
+/* ジャイロセンサーの角速度を取得 */
+int16_t Plant_getGyroRate() {
+    return (int16_t)lround(state.yaw_rate);
+}
+
+/* ジャイロセンサーをリセット */
+void Plant_resetGyro() {
+    gyro_angle = 0.0;
+}
+
+/* 超音波センサーの距離[cm]を取得(前方の障害物までの距離、検知できない場合は255) */
+int16_t Plant_getSonar() {
+    double c = cos(rad(state.heading));
+    double s = sin(rad(state.heading));
+    double ox = state.x + PLANT_SONAR_OFFSET * c;
+    double oy = state.y + PLANT_SONAR_OFFSET * s;
+    double nearest = 2550.0;
+    double dx, dy, along, across2, hit;
+    int i;
+
+    for(i = 0; i < course->obstacle_num; i++)   // 前方への半直線と円の交点
+    {
+        dx = course->obstacle[i].x - ox;
+        dy = course->obstacle[i].y - oy;
+        along = dx * c + dy * s;
+        across2 = dx * dx + dy * dy - along * along;
+        if(along <= 0 || across2 > course->obstacle[i].radius * course->obstacle[i].radius)
+            continue;
+        hit = along - sqrt(course->obstacle[i].radius * course->obstacle[i].radius - across2);
+        if(hit >= 0 && hit < nearest)
+            nearest = hit;
+    }
+    return (int16_t)(nearest / 10.0);
+}
@@ -0,0 +1,58 @@
+#ifndef _PLANT_H_
+#define _PLANT_H_
+
+#include "ev3api.h"
+#include "course.h"
+
+/* 走行体の寸法(Distance.h, Direction.hの値と合わせる) */
+#define PLANT_TIRE_DIAMETER     90.0    // タイヤ直径[mm]
+#define PLANT_TREAD             150.0   // 車体トレッド幅[mm]
+#define PLANT_SENSOR_OFFSET     60.0    // 車軸からカラーセンサーまでの前方距離[mm]
+#define PLANT_SENSOR_RADIUS     8.0     // カラーセンサーの検出範囲の半径[mm]
+#define PLANT_RGB_GAIN          0.7     // コースの画素値(0~255)からRGB生値への換算係数(白が約180になる)
+#define PLANT_SONAR_OFFSET      80.0    // 車軸から超音波センサーまでの前方距離[mm]
+
+/* モーター(出力100、電池電圧100%のときの無負荷回転速度と時定数) */
+#define PLANT_LARGE_SPEED       900.0   // Lモーターの回転速度[deg/s]
+#define PLANT_MEDIUM_SPEED      1500.0  // Mモーターの回転速度[deg/s]
+#define PLANT_MOTOR_TAU         0.08    // 出力変化に対する時定数[s]
+#define PLANT_BRAKE_TAU         0.02    // ブレーキ停止の時定数[s]
+#define PLANT_COAST_TAU         0.30    // 惰性停止の時定数[s]
+
+/* 物理モデルの積分周期[us] */
+#define PLANT_STEP              1000
+
+/* 走行体の状態 */
+typedef struct {
+    float   x;          // 車軸中心のx座標[mm]
+    float   y;          // 車軸中心のy座標[mm]
+    float   heading;    // 方位[deg](時計回りが正)
+    float   speed;      // 前進速度[mm/s]
+    float   yaw_rate;   // 旋回速度[deg/s]
+} PLANT_STATE;
+
+/* 初期化関数(コースのスタート位置に置く、batteryは電池電圧の割合でモーターの速度に掛かる) */
+void Plant_init(const COURSE *course, float battery);
+
+/* 物理モデルをPLANT_STEPだけ進める */
+void Plant_step();
+
+/* 走行体の状態を取得 */
+void Plant_getState(PLANT_STATE *state);
+
+/* モーター */
+void    Plant_setMotorType(motor_port_t port, motor_type_t type);
+void    Plant_setMotorPower(motor_port_t port, int power);
+int     Plant_getMotorPower(motor_port_t port);
+void    Plant_stopMotor(motor_port_t port, bool_t brake);
+int32_t Plant_getMotorCounts(motor_port_t port);
+void    Plant_resetMotorCounts(motor_port_t port);
+
+/* センサー */
+void    Plant_getRGB(rgb_raw_t *rgb);
+int16_t Plant_getGyroAngle();
+int16_t Plant_getGyroRate();
+void    Plant_resetGyro();
+int16_t Plant_getSonar();
+
+#endif
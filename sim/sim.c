@@ -0,0 +1,201 @@
+// ホスト用シミュレータのメイン
+//
+// アプリ(hamapolyの全ソース)をこのディレクトリのev3api・カーネルとリンクし、
+// コースのビットマップ上で走行体の物理モデルを動かしてラップタイムと制御ループの処理コストを計測する
+//
+// 区間の切り替わりはアプリがログファイル(Log_*.bin)を開いたことで知る(fopenをリンク時に差し替える)
+// 既定ではLine_taskが終わり、Log_Slalom.binを開いた時点を完走とする
+//
+// 使い方 : sim [-c コース.ppm] [-e 完走とするログファイル名] [-t 制限時間s] [-b 電池電圧の割合] [-o ログ出力先] [-p 軌跡.csv] [-v]
+// 終了コード : 0 完走, 1 時間切れ・コースアウト, 2 引数・コースの誤り
+
+#include <unistd.h>
+#include <time.h>
+#include "sim.h"
+#include "kernel.h"
+#include "plant.h"
+
+/* マクロ定義 */
+#define DEFAULT_COURSE      "build/oval.ppm"
+#define DEFAULT_END_FILE    "Log_Slalom.bin"
+#define DEFAULT_LIMIT       120             // 制限時間[s]
+#define TRACE_PERIOD        (10 * 1000)     // 軌跡の記録周期[us]
+
+/* シミュレーションの結果 */
+typedef enum {
+    RESULT_RUNNING,
+    RESULT_GOAL,        // 完走
+    RESULT_TIMEOUT,     // 時間切れ
+    RESULT_OUT          // コースの外に出た
+} RESULT;
+
+/* グローバル変数 */
+static COURSE course;
+static const char *end_file = DEFAULT_END_FILE; // 開いたら完走とするログファイル名
+static bool_t verbose = false;
+static FILE *trace = NULL;                  // 軌跡の出力先
+static SYSTIM plant_time = 0;               // 物理モデルの時刻[us]
+static SYSTIM start_time = 0;               // スタートの合図を受け取った時刻[us]
+static bool_t started = false;
+static SYSTIM goal_time = 0;                // 完走した時刻[us]
+static bool_t in_goal = false;              // ゴールの範囲内にいるかどうか
+static int goal_count = 0;                  // ゴールに入った回数
+static RESULT result = RESULT_RUNNING;
+
+/* 詳細表示をするかどうか */
+bool_t Sim_isVerbose() {
+    return verbose;
+}
+
+/* スタートの合図を受け取った */
+void Sim_notifyStart() {
+    if(!started)
+    {
+        started = true;
+        start_time = Kernel_getTime();
+    }
+}
+
+/* アプリのfopen(リンク時に-Wl,--wrap=fopenで差し替える) */
+FILE *__real_fopen(const char *path, const char *mode);
+
+FILE *__wrap_fopen(const char *path, const char *mode) {
+    SYSTIM now = Kernel_getTime();
+
+    if(strncmp(path, "Log_", 4) == 0 && started)    // 区間の開始ごとに経過時間を表示する
+    {
+        printf("split          %-16s %8.3f s\n", path, (now - start_time) / 1e6);
+        if(strcmp(path, end_file) == 0 && result == RESULT_RUNNING)
+        {
+            goal_time = now;
+            result = RESULT_GOAL;
+        }
+    }
+    return __real_fopen(path, mode);
+}
+
+/* ゴールとコースの外に出たかを判定する */
+static void judge(const PLANT_STATE *state) {
+    float dx = state->x - course.goal_x;
+    float dy = state->y - course.goal_y;
+    bool_t inside = course.goal_radius > 0 && dx * dx + dy * dy <= course.goal_radius * course.goal_radius;
+
+    if(inside && !in_goal && started)       // ゴールに入った瞬間を数える
+    {
+        goal_count++;
+        if(goal_count >= course.goal_count)
+        {
+            goal_time = plant_time;
+            result = RESULT_GOAL;
+        }
+    }
+    in_goal = inside;
+
+    if(state->x < 0 || state->y < 0
+        || state->x > course.width * course.scale || state->y > course.height * course.scale)
+        result = RESULT_OUT;
+}
+
+/* 仮想時間が進む間に物理モデルを計算する */
+static bool_t advance(SYSTIM from, SYSTIM to) {
+    PLANT_STATE state;
+
+    while(plant_time + PLANT_STEP <= to && result == RESULT_RUNNING)
+    {
+        Plant_step();
+        plant_time += PLANT_STEP;
+        Plant_getState(&state);
+        judge(&state);
+
+        if(trace != NULL && plant_time % TRACE_PERIOD == 0)
+            fprintf(trace, "%.3f,%.1f,%.1f,%.2f,%.1f\n", plant_time / 1000000.0, state.x, state.y, state.heading, state.speed);
+    }
+    return result == RESULT_RUNNING;
+}
+
+/* タスクの実行統計を表示する */
+static void print_stats() {
+    KERNEL_STATS stats;
+    ID id;
+
+    printf("%-14s %10s %12s %10s %10s\n", "task", "runs", "cpu[ms]", "mean[us]", "max[us]");
+    for(id = 1; id <= TNUM_TSKID; id++)
+    {
+        Kernel_getStats(id, &stats);
+        printf("%-14s %10u %12.3f %10.2f %10.2f\n", kernel_tsk_cfg[id].name, stats.activations,
+            stats.total_ns / 1e6,
+            stats.activations > 0 ? stats.total_ns / 1e3 / stats.activations : 0.0,
+            stats.max_ns / 1e3);
+    }
+}
+
+/* 使い方を表示する */
+static void usage(const char *name) {
+    printf("usage: %s [-c course.ppm] [-e end_log_file] [-t limit_s] [-b battery] [-o log_dir] [-p trace.csv] [-v]\n", name);
+}
+
+int main(int argc, char *argv[]) {
+    const char *course_path = DEFAULT_COURSE;
+    const char *log_dir = NULL;
+    const char *trace_path = NULL;
+    float limit = DEFAULT_LIMIT;
+    float battery = 1.0;
+    struct timespec wall_begin, wall_end;
+    double wall, virtual;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:e:t:b:o:p:vh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'c': course_path = optarg;         break;
+            case 'e': end_file = optarg;            break;
+            case 't': limit = atof(optarg);         break;
+            case 'b': battery = atof(optarg);       break;
+            case 'o': log_dir = optarg;             break;
+            case 'p': trace_path = optarg;          break;
+            case 'v': verbose = true;               break;
+            default:  usage(argv[0]);               return 2;
+        }
+    }
+
+    if(Course_load(&course, course_path) != 0)
+        return 2;
+    if(trace_path != NULL)
+    {
+        trace = fopen(trace_path, "w");
+        if(trace == NULL)
+        {
+            printf("cannot open %s\n", trace_path);
+            return 2;
+        }
+        fprintf(trace, "time,x,y,heading,speed\n");
+    }
+    if(log_dir != NULL && chdir(log_dir) != 0)  // アプリのログファイルは作業ディレクトリに出力される
+    {
+        printf("cannot change directory to %s\n", log_dir);
+        return 2;
+    }
+
+    Plant_init(&course, battery);
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_begin);
+    Kernel_run((SYSTIM)(limit * 1000000.0), advance);
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+
+    if(result == RESULT_RUNNING)
+        result = RESULT_TIMEOUT;
+    if(trace != NULL)
+        fclose(trace);
+
+    wall = (wall_end.tv_sec - wall_begin.tv_sec) + (wall_end.tv_nsec - wall_begin.tv_nsec) / 1e9;
+    virtual = plant_time / 1e6;
+    printf("result         %s\n", result == RESULT_GOAL ? "GOAL" : result == RESULT_OUT ? "COURSE OUT" : "TIMEOUT");
+    if(result == RESULT_GOAL)
+        printf("lap time       %.3f s\n", (goal_time - start_time) / 1e6);
+    printf("simulated      %.3f s in %.3f s wall (x%.1f)\n", virtual, wall, wall > 0 ? virtual / wall : 0.0);
+    print_stats();
+
+    Course_free(&course);
+    return result == RESULT_GOAL ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include "ev3api.h"
+
+/* スタートの合図(タッチセンサーを押す)までの仮想時間[us] */
+#define SIM_TOUCH_DELAY     (500 * 1000)
+
+/* 詳細表示(LCD・syslog・LEDの出力)をするかどうか */
+bool_t Sim_isVerbose();
+
+/* スタートの合図をアプリが受け取ったことを通知する(ラップタイムの計測開始) */
+void Sim_notifyStart();
+
+#endif
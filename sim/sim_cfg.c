@@ -0,0 +1,17 @@
+// app.cfgのタスク・周期ハンドラの定義(hamapolyの全コースで共通)
+// app.cfgを変更した場合はこちらも合わせること
+
+#include "kernel.h"
+#include "app.h"
+
+const KERNEL_TSK_CFG kernel_tsk_cfg[TNUM_TSKID + 1] = {
+    [MAIN_TASK]     = { "main_task",    main_task,      0, TMIN_APP_TPRI + 1, true  },
+    [BT_TASK]       = { "bt_task",      bt_task,        0, TMIN_APP_TPRI + 2, false },
+    [LOGFILE_TASK]  = { "logfile_task", logfile_task,   0, TMIN_APP_TPRI + 3, false },
+    [MEASURE_TSK]   = { "measure_task", measure_task,   0, TMIN_APP_TPRI,     false },
+    [TELEMETRY_TASK]= { "telemetry_task", telemetry_task, 0, TMIN_APP_TPRI + 4, false },
+};
+
+const KERNEL_CYC_CFG kernel_cyc_cfg[TNUM_CYCID + 1] = {
+    [CYC_MEASURE_TSK] = { MEASURE_TSK, MEASURE_PERIOD, 0U },
+};
@@ -0,0 +1,351 @@
+// ColorClassifierのテスト・ベンチマーク(ホスト用)
+//
+// ../hamapoly/ColorClassifier.c のテーブル参照による判定を、置き換える前の各区間の判定式(baselineのif文)と比べる
+//  - 一致 : R,G,Bの全ての組み合わせ(0~299、255を超える値はテーブルでは255として扱う)で、色ごとに判定式と一致すること
+//  - 精度 : 正解の色を付けたRGB値のログ(ラベル付きログ)で、色ごとの検知率・誤検知率を求める
+//           既定ではシミュレータのコース(build/oval.ppm)を、plant.cのカラーセンサーと同じく検出範囲の平均で読み取ったものを使う
+//           検出範囲が1色の上にある点だけを正解付きとし、ラインの縁にかかる点は数だけを表示する
+//           コースの正解付きの点は全て正しく判定されること(誤りがあれば不合格)、-lで与えたログは検知率を表示するだけとする
+//           コースには周回ラインの黒・青に加え、内側にブロック区間の黄色・赤の色見本があり(mkcourse.c)、
+//           全ての色(黒はRun_setStop_Line・ブロック・スラロームの各閾値)について正解付きの点が1つ以上あることも確かめる
+//  - 速度 : 判定1回あたりの時間を、判定式を順に評価する場合(区間のif文と同じ)と比べる
+//
+// ラベル付きログ(-l)はlogdecodeのTSVの先頭にLabel列(none, black, blue, yellow, red)を加えたもの
+// R,G,B,Labelの列を項目名で探すため、他の列はあってもよい
+//
+// 使い方 : test_color [-c コース.ppm] [-l ラベル付きログ.tsv] [-v]
+// 終了コード : 0 合格, 1 判定式との不一致・誤判定, 2 引数・ファイルの誤り
+
+#include "test_util.h"
+#include "ColorClassifier.h"
+#include "course.h"
+#include "plant.h"
+
+/* マクロ定義 */
+#define DEFAULT_COURSE  "build/oval.ppm"
+#define SWEEP_MAX       300             // 一致を確かめるRGB値の範囲(0~SWEEP_MAX-1)
+#define SAMPLE_STEP     2.0             // コースを読み取る間隔[mm]
+#define BENCH_SAMPLES   (1 << 16)       // ベンチマークの標本数
+#define BENCH_LOOPS     200
+#define LINE_MAX        1024
+
+/* 置き換える前の各区間の判定式(baselineのapp_Line.c, app_Slalom.c, app_Block.c, Run.cのif文) */
+static bool_t if_blue(const rgb_raw_t *c)         { return c->r < 75 && c->g < 95 && c->b > 120; }
+static bool_t if_yellow(const rgb_raw_t *c)       { return c->r > 90 && c->g > 90 && c->b < 30; }
+static bool_t if_red(const rgb_raw_t *c)          { return c->r > 75 && c->g < 40 && c->b < 50; }
+static bool_t if_black(const rgb_raw_t *c)        { return c->r < 60 && c->g < 90 && c->b < 90; }     // Run_setStop_Line
+static bool_t if_black_block(const rgb_raw_t *c)  { return c->r < 60 && c->g < 60 && c->b < 60; }     // Block CURVE, RETURN
+static bool_t if_black_slalom(const rgb_raw_t *c) { return c->r < 65 && c->g < 75 && c->b < 95; }     // Slalom LINETRACE
+
+static bool_t (* const if_chain[TNUM_COLOR_CLASS])(const rgb_raw_t *) = {
+    if_blue, if_yellow, if_red, if_black, if_black_block, if_black_slalom
+};
+
+static const char *class_name[TNUM_COLOR_CLASS] = {
+    "blue", "yellow", "red", "black", "black_block", "black_slalom"
+};
+
+/* ラベル(正解の色) */
+typedef enum {
+    LABEL_NONE,     // どの色でもない(白・灰色など)
+    LABEL_BLACK,
+    LABEL_BLUE,
+    LABEL_YELLOW,
+    LABEL_RED,
+    LABEL_NUM
+} LABEL;
+
+static const char *label_name[LABEL_NUM] = { "none", "black", "blue", "yellow", "red" };
+
+/* 色ごとの正解のラベル */
+static const LABEL class_label[TNUM_COLOR_CLASS] = {
+    LABEL_BLUE, LABEL_YELLOW, LABEL_RED, LABEL_BLACK, LABEL_BLACK, LABEL_BLACK
+};
+
+/* 色ごとの判定結果の集計 */
+typedef struct {
+    uint32_t    positive;       // 正解がその色の標本数
+    uint32_t    detected;       // そのうち検知した数
+    uint32_t    negative;       // 正解がその色でない標本数
+    uint32_t    false_alarm;    // そのうち検知した数
+} SCORE;
+
+/* 全ての組み合わせで判定式と一致するか */
+static void test_sweep() {
+    uint32_t mismatch[TNUM_COLOR_CLASS] = { 0 };
+    uint32_t total = 0;
+    rgb_raw_t c;
+    COLOR_SET set;
+    int i;
+
+    for(c.r = 0; c.r < SWEEP_MAX; c.r++)
+        for(c.g = 0; c.g < SWEEP_MAX; c.g++)
+            for(c.b = 0; c.b < SWEEP_MAX; c.b++)
+            {
+                set = ColorClassifier_get(&c);
+                for(i = 0; i < TNUM_COLOR_CLASS; i++)
+                {
+                    if(COLOR_IN(set, i) != if_chain[i](&c))
+                    {
+                        if(mismatch[i]++ == 0 || verbose)
+                            printf("sweep     %-12s mismatch at (%u, %u, %u)\n", class_name[i], c.r, c.g, c.b);
+                    }
+                }
+            }
+
+    for(i = 0; i < TNUM_COLOR_CLASS; i++)
+        total += mismatch[i];
+    check("sweep", total == 0, "%d^3 RGB values, %u mismatches with the if-chains", SWEEP_MAX, total);
+}
+
+/* 1標本を集計する */
+static void score(SCORE *scores, const rgb_raw_t *c, LABEL label) {
+    COLOR_SET set = ColorClassifier_get(c);
+    int i;
+
+    for(i = 0; i < TNUM_COLOR_CLASS; i++)
+    {
+        if(class_label[i] == label)
+        {
+            scores[i].positive++;
+            scores[i].detected += COLOR_IN(set, i);
+        }
+        else
+        {
+            scores[i].negative++;
+            scores[i].false_alarm += COLOR_IN(set, i);
+        }
+    }
+}
+
+/* コースの画素の色からラベルを付ける(どれでもなければ-1) */
+static int pixel_label(const float rgb[3]) {
+    static const float colors[][3] = {      // mkcourse.cの色
+        { 255, 255, 255 }, { 20, 20, 20 }, { 20, 40, 255 }, { 255, 255, 0 }, { 255, 0, 0 }
+    };
+    static const LABEL labels[] = { LABEL_NONE, LABEL_BLACK, LABEL_BLUE, LABEL_YELLOW, LABEL_RED };
+    int i;
+
+    for(i = 0; i < (int)(sizeof(labels) / sizeof(labels[0])); i++)
+        if(fabsf(rgb[0] - colors[i][0]) < 1 && fabsf(rgb[1] - colors[i][1]) < 1 && fabsf(rgb[2] - colors[i][2]) < 1)
+            return labels[i];
+    return -1;
+}
+
+/* コースをカラーセンサーの検出範囲(plant.cのPlant_getRGBと同じ標本点)で読み取ってラベル付きの標本を作る
+ * 返り値 : ラベルを付けられなかった(ラインの縁にかかる)点の数/-1(コースを読めない) */
+static int label_course(const char *path, SCORE *scores, uint32_t *samples) {
+    static const float ring[][2] = {
+        { 0.0, 0.0 }, { 1.0, 0.0 }, { -1.0, 0.0 }, { 0.0, 1.0 }, { 0.0, -1.0 },
+        { 0.5, 0.5 }, { -0.5, 0.5 }, { 0.5, -0.5 }, { -0.5, -0.5 }
+    };
+    const int n = sizeof(ring) / sizeof(ring[0]);
+    COURSE course;
+    float x, y, sum[3], sample[3];
+    rgb_raw_t c;
+    int i, label, edge = 0;
+
+    if(Course_load(&course, path) != 0)
+        return -1;
+
+    for(y = PLANT_SENSOR_RADIUS; y < course.height * course.scale - PLANT_SENSOR_RADIUS; y += SAMPLE_STEP)
+        for(x = PLANT_SENSOR_RADIUS; x < course.width * course.scale - PLANT_SENSOR_RADIUS; x += SAMPLE_STEP)
+        {
+            sum[0] = sum[1] = sum[2] = 0;
+            label = -2;
+            for(i = 0; i < n; i++)
+            {
+                Course_sample(&course, x + ring[i][0] * PLANT_SENSOR_RADIUS, y + ring[i][1] * PLANT_SENSOR_RADIUS, sample);
+                sum[0] += sample[0];
+                sum[1] += sample[1];
+                sum[2] += sample[2];
+                if(label == -2)
+                    label = pixel_label(sample);
+                else if(label != pixel_label(sample))
+                    label = -1;
+            }
+            if(label < 0)
+            {
+                edge++;
+                continue;
+            }
+            c.r = (uint16_t)(sum[0] / n * PLANT_RGB_GAIN + 0.5);
+            c.g = (uint16_t)(sum[1] / n * PLANT_RGB_GAIN + 0.5);
+            c.b = (uint16_t)(sum[2] / n * PLANT_RGB_GAIN + 0.5);
+            score(scores, &c, label);
+            (*samples)++;
+        }
+
+    Course_free(&course);
+    return edge;
+}
+
+/* ラベル付きログ(TSV)を読み込む 返り値 : 0(成功)/-1(読めない) */
+static int label_log(const char *path, SCORE *scores, uint32_t *samples) {
+    char line[LINE_MAX];
+    char *token, *save;
+    int column[4] = { -1, -1, -1, -1 };     // R, G, B, Labelの列
+    long value[4];
+    rgb_raw_t c;
+    int i, col, line_no = 1;
+    FILE *fp;
+
+    if((fp = fopen(path, "r")) == NULL || fgets(line, sizeof(line), fp) == NULL)
+        return -1;
+    for(col = 0, token = strtok_r(line, "\t\r\n", &save); token != NULL; col++, token = strtok_r(NULL, "\t\r\n", &save))
+    {
+        static const char *names[4] = { "R", "G", "B", "Label" };
+
+        for(i = 0; i < 4; i++)
+            if(strcmp(token, names[i]) == 0)
+                column[i] = col;
+    }
+    for(i = 0; i < 4; i++)
+    {
+        if(column[i] < 0)
+        {
+            fprintf(stderr, "%s: R, G, B and Label columns are required\n", path);
+            fclose(fp);
+            return -1;
+        }
+    }
+
+    while(fgets(line, sizeof(line), fp) != NULL)
+    {
+        line_no++;
+        for(i = 0; i < 4; i++)
+            value[i] = -1;
+        for(col = 0, token = strtok_r(line, "\t\r\n", &save); token != NULL; col++, token = strtok_r(NULL, "\t\r\n", &save))
+        {
+            for(i = 0; i < 3; i++)
+                if(col == column[i])
+                    value[i] = strtol(token, NULL, 10);
+            if(col == column[3])
+                for(i = 0; i < LABEL_NUM; i++)
+                    if(strcmp(token, label_name[i]) == 0)
+                        value[3] = i;
+        }
+        if(value[0] < 0 || value[1] < 0 || value[2] < 0 || value[3] < 0)  // log_stampの行・ラベルの無い行
+        {
+            if(verbose)
+                printf("#        %s:%d skipped\n", path, line_no);
+            continue;
+        }
+        c.r = value[0];
+        c.g = value[1];
+        c.b = value[2];
+        score(scores, &c, (LABEL)value[3]);
+        (*samples)++;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/* 集計を表示する(strictの場合は誤判定があれば不合格にする) */
+static void report_scores(const char *name, const SCORE *scores, uint32_t samples, bool_t strict) {
+    int i;
+
+    printf("%-9s %u labelled samples\n", name, samples);
+    for(i = 0; i < TNUM_COLOR_CLASS; i++)
+    {
+        const SCORE *s = &scores[i];
+        uint32_t missed = s->positive - s->detected;
+
+        check(class_name[i], !strict || (s->positive > 0 && missed + s->false_alarm == 0),
+              "detected %u/%u (%.1f%%), false alarms %u/%u", s->detected, s->positive,
+              s->positive > 0 ? 100.0 * s->detected / s->positive : 0.0, s->false_alarm, s->negative);
+    }
+}
+
+/* 判定1回あたりの時間を比べる(区間のif文と同じく、青・黄・赤・黒の判定式を順に評価する) */
+static void bench() {
+    static rgb_raw_t samples[BENCH_SAMPLES];
+    struct timespec t0, t1;
+    volatile uint32_t sink = 0;
+    uint32_t acc;
+    int i, j;
+
+    srand(1);
+    for(i = 0; i < BENCH_SAMPLES; i++)      // 白・黒・青・ラインの縁を混ぜた値
+    {
+        samples[i].r = rand() % 200;
+        samples[i].g = rand() % 200;
+        samples[i].b = rand() % 200;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(j = 0, acc = 0; j < BENCH_LOOPS; j++)
+        for(i = 0; i < BENCH_SAMPLES; i++)
+        {
+            const rgb_raw_t *c = &samples[i];
+
+            if(c->r < 75 && c->g < 95 && c->b > 120)
+                acc += 1;
+            else if(c->r > 90 && c->g > 90 && c->b < 30)
+                acc += 2;
+            else if(c->r > 75 && c->g < 40 && c->b < 50)
+                acc += 4;
+            else if(c->r < 60 && c->g < 90 && c->b < 90)
+                acc += 8;
+            if(c->r < 60 && c->g < 60 && c->b < 60)
+                acc += 16;
+            if(c->r < 65 && c->g < 75 && c->b < 95)
+                acc += 32;
+        }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    sink += acc;
+    printf("bench     if-chains %.2f ns/sample", elapsed_ns(&t0, &t1) / BENCH_LOOPS / BENCH_SAMPLES);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(j = 0, acc = 0; j < BENCH_LOOPS; j++)
+        for(i = 0; i < BENCH_SAMPLES; i++)
+            acc += ColorClassifier_get(&samples[i]);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    sink += acc;
+    printf(", table %.2f ns/sample\n", elapsed_ns(&t0, &t1) / BENCH_LOOPS / BENCH_SAMPLES);
+}
+
+int main(int argc, char *argv[]) {
+    const char *course = DEFAULT_COURSE;
+    const char *log = NULL;
+    SCORE scores[TNUM_COLOR_CLASS];
+    uint32_t samples = 0;
+    int opt, edge;
+
+    while((opt = test_getopt(argc, argv, "c:l:v", "test_color [-c course.ppm] [-l labelled.tsv] [-v]")) != -1)
+    {
+        switch(opt)
+        {
+            case 'c': course = optarg; break;
+            case 'l': log = optarg; break;
+        }
+    }
+
+    ColorClassifier_init();
+    test_sweep();
+
+    memset(scores, 0, sizeof(scores));
+    if(log != NULL)
+    {
+        if(label_log(log, scores, &samples) != 0)
+        {
+            fprintf(stderr, "cannot read %s\n", log);
+            return TEST_USAGE;
+        }
+        report_scores("log", scores, samples, false);
+    }
+    else
+    {
+        if((edge = label_course(course, scores, &samples)) < 0)
+        {
+            fprintf(stderr, "cannot open %s\n", course);
+            return TEST_USAGE;
+        }
+        report_scores("course", scores, samples, true);
+        printf("course    %d samples on line edges (not labelled)\n", edge);
+    }
+
+    bench();
+    return failed;
+}
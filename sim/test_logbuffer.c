@@ -0,0 +1,241 @@
+// LogBufferのテスト(ホスト用)
+//
+// ../hamapoly/LogBuffer.c に数百万件のレコードを通し、次を確かめる
+//  - 書き込めたレコードが欠落・重複・順序の入れ替わりなく読み出されること
+//  - 書き込めなかったレコードが全てLogBuffer_getOverflowに数えられること(書き込み件数 = 読み出し件数 + 破棄件数)
+//  - 読み出し中のレコードが書き込み側に上書きされないこと(各フィールドを通し番号から作り、読み出し側で照合する)
+//  - 書き込み側(measure_task)の処理時間がバッファの状態によらず一定の範囲に収まること
+//
+// 前半は1スレッドで書き込みと読み出しを乱数の長さで交互に行い、満杯・空・添字の折り返しを何度も通す
+// 後半は書き込みと読み出しを別スレッドで同時に動かす(EV3と同じくLOG_BARRIERはコンパイラの並べ替え防止のみのため、
+// ストア同士・ロード同士の順序が保たれるx86で動かすこと)
+//
+// 使い方 : test_logbuffer [-n 件数] [-v]
+// 終了コード : 0 合格, 1 欠落・破損・処理時間の超過, 2 引数の誤り
+
+#include <pthread.h>
+#include "test_util.h"
+#include "LogBuffer.h"
+
+/* マクロ定義 */
+#define DEFAULT_RECORDS     4000000     // 各試験で書き込むレコード数
+#define PUSH_LIMIT_NS       2000        // 書き込み1回の処理時間の上限[ns](99.9パーセンタイルで判定)
+#define HIST_BINS           64          // 処理時間のヒストグラムの区間数(2のべき乗[ns]ごと)
+
+/* グローバル変数 */
+static uint32_t records = DEFAULT_RECORDS;
+static const char stamp[] = "stamp";
+
+/* 通し番号から作るレコード(読み出し側で照合する) */
+static void make_record(LOG_RECORD *record, uint32_t seq) {
+    record->distance = (float)(seq & 0xffff);
+    record->direction = (float)(seq >> 16);
+    record->time = seq;
+    record->r = (uint16_t)seq;
+    record->g = (uint16_t)(seq >> 16);
+    record->b = (uint16_t)~seq;
+    record->angle = (int16_t)(seq * 3);
+    record->turn = (int16_t)(seq * 5);
+    record->power = (int8_t)(seq * 7);
+    record->stamp = (seq % 100 == 0) ? stamp : NULL;
+}
+
+/* 読み出したレコードが通し番号どおりか 返り値 : true(一致)/false(破損) */
+static bool_t check_record(const LOG_RECORD *record, uint32_t seq) {
+    LOG_RECORD expect;
+
+    make_record(&expect, seq);
+    return record->distance == expect.distance && record->direction == expect.direction
+        && record->time == expect.time && record->r == expect.r && record->g == expect.g && record->b == expect.b
+        && record->angle == expect.angle && record->turn == expect.turn && record->power == expect.power
+        && record->stamp == expect.stamp;
+}
+
+/* 読み出し側の結果 */
+typedef struct {
+    uint32_t    received;   // 読み出したレコード数
+    uint32_t    next;       // 次に期待する通し番号の下限(破棄されたレコードは飛ばされる)
+    uint32_t    disorder;   // 通し番号が戻った・重複した回数
+    uint32_t    corrupt;    // フィールドが通し番号と一致しなかった回数
+} READER;
+
+/* バッファが空になるか最大max件まで読み出す */
+static void drain(READER *reader, uint32_t max) {
+    const LOG_RECORD *record;
+
+    while(max-- > 0 && (record = LogBuffer_front()) != NULL)
+    {
+        uint32_t seq = record->time;
+
+        if(seq < reader->next)
+            reader->disorder++;
+        else if(!check_record(record, seq))
+            reader->corrupt++;
+        else
+            reader->next = seq + 1;
+        reader->received++;
+        LogBuffer_release();
+    }
+}
+
+static uint64_t now_ns() {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + t.tv_nsec;
+}
+
+/* 書き込み1回の処理時間を記録するヒストグラム(区間iは[2^i, 2^(i+1))ns) */
+typedef struct {
+    uint32_t    count[HIST_BINS];
+    uint64_t    total_ns;
+    uint64_t    max_ns;
+} HIST;
+
+static void hist_add(HIST *h, uint64_t ns) {
+    int bin = 0;
+
+    while(bin < HIST_BINS - 1 && (ns >> (bin + 1)) != 0)
+        bin++;
+    h->count[bin]++;
+    h->total_ns += ns;
+    if(ns > h->max_ns)
+        h->max_ns = ns;
+}
+
+/* 割合pの件数が収まる区間の上端[ns] */
+static uint64_t hist_percentile(const HIST *h, double p) {
+    uint64_t n = 0, total = 0;
+    int bin;
+
+    for(bin = 0; bin < HIST_BINS; bin++)
+        total += h->count[bin];
+    for(bin = 0; bin < HIST_BINS; bin++)
+    {
+        n += h->count[bin];
+        if(n >= total * p)
+            break;
+    }
+    return (uint64_t)1 << (bin + 1);
+}
+
+/* 結果を表示して判定する */
+static void report(const char *name, const READER *reader, uint32_t pushed, const HIST *h) {
+    uint32_t overflow = LogBuffer_getOverflow();
+    bool_t lost = reader->received + overflow != records || reader->received != pushed;
+
+    check(name, !lost && reader->disorder == 0 && reader->corrupt == 0,
+          "records %u, received %u, overflow %u, disorder %u, corrupt %u%s",
+          records, reader->received, overflow, reader->disorder, reader->corrupt, lost ? "  LOST" : "");
+    if(h != NULL)
+    {
+        uint64_t p999 = hist_percentile(h, 0.999);
+
+        check(name, p999 <= PUSH_LIMIT_NS, "push   avg %.1f ns, 99%% < %llu ns, 99.9%% < %llu ns, max %llu ns",
+              (double)h->total_ns / records, (unsigned long long)hist_percentile(h, 0.99),
+              (unsigned long long)p999, (unsigned long long)h->max_ns);
+    }
+}
+
+/* 1スレッドで書き込みと読み出しを乱数の長さで交互に行う */
+static void test_interleave() {
+    READER reader = {0};
+    LOG_RECORD record;
+    uint32_t seq = 0, pushed = 0, n;
+
+    LogBuffer_init();
+    srand(1);
+    while(seq < records)
+    {
+        // バッファの容量を超える長さも混ぜ、満杯での破棄を起こす
+        for(n = rand() % (LOG_BUFFER_SIZE * 2); n > 0 && seq < records; n--, seq++)
+        {
+            make_record(&record, seq);
+            if(LogBuffer_push(&record))
+                pushed++;
+        }
+        drain(&reader, rand() % (LOG_BUFFER_SIZE * 2));
+    }
+    drain(&reader, records);
+
+    report("single", &reader, pushed, NULL);
+}
+
+/* 別スレッドの読み出し側(logfile_task相当) */
+static volatile bool_t producing;
+static READER thread_reader;
+
+static void *consumer(void *arg) {
+    while(producing || !LogBuffer_isEmpty())
+    {
+        drain(&thread_reader, LOG_BUFFER_SIZE / 4);
+        if(LogBuffer_isEmpty())
+            sched_yield();
+    }
+    return NULL;
+}
+
+/* 書き込み側と読み出し側を別スレッドで同時に動かし、書き込み1回の処理時間を計測する */
+static void test_threads() {
+    static HIST hist;
+    pthread_t thread;
+    LOG_RECORD record;
+    uint32_t seq, pushed = 0, burst = 0;
+    uint64_t t0, t1;
+
+    LogBuffer_init();
+    memset(&thread_reader, 0, sizeof(thread_reader));
+    memset(&hist, 0, sizeof(hist));
+    producing = true;
+    if(pthread_create(&thread, NULL, consumer, NULL) != 0)
+    {
+        fprintf(stderr, "cannot create the consumer thread\n");
+        failed = TEST_FAIL;
+        return;
+    }
+
+    srand(2);
+    for(seq = 0; seq < records; seq++)
+    {
+        // measure_taskは周期ごとに待ちに入るため、乱数の件数ごとにCPUを譲る(容量を超える長さも混ぜる)
+        if(burst-- == 0)
+        {
+            sched_yield();
+            burst = rand() % (LOG_BUFFER_SIZE * 3 / 2);
+        }
+        make_record(&record, seq);
+        t0 = now_ns();
+        if(LogBuffer_push(&record))
+            pushed++;
+        t1 = now_ns();
+        hist_add(&hist, t1 - t0);
+    }
+    producing = false;
+    pthread_join(thread, NULL);
+
+    if(verbose)
+    {
+        int bin;
+
+        for(bin = 0; bin < HIST_BINS; bin++)
+            if(hist.count[bin] != 0)
+                printf("#        %8llu - %8llu ns : %u\n", (unsigned long long)1 << bin,
+                       (unsigned long long)1 << (bin + 1), hist.count[bin]);
+    }
+    report("threads", &thread_reader, pushed, &hist);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+
+    while((opt = test_getopt(argc, argv, "n:v", "test_logbuffer [-n records] [-v]")) != -1)
+    {
+        if(opt == 'n')
+            records = (uint32_t)strtoul(optarg, NULL, 0);
+    }
+
+    test_interleave();
+    test_threads();
+
+    return failed;
+}
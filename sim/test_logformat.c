@@ -0,0 +1,216 @@
+// LogFormatのテスト・ベンチマーク(ホスト用)
+//
+// 走行中を模した計測値のレコードを、従来のテキストログ(baselineのmeasure_taskと同じfprintfの書式)と
+// ../hamapoly/LogFormat.c のバイナリログの両方に書き出し、次を確かめる
+//  - バイナリログを ../tools/logdecode.c でTSVに戻すと、テキストログと同じ行になること
+//    (fprintfは0に丸めた負の値を"-0.0"と書くが、バイナリログには符号が残らないため、文字列が異なる行は数値として比べる)
+//  - 1レコードあたりのバイト数と書式化・符号化のCPU時間を、fprintfと比べる
+//
+// 使い方 : test_logformat [-n レコード数] [-d logdecodeのパス] [-o 出力先のファイル名(拡張子なし)] [-v]
+// 終了コード : 0 合格, 1 変換結果の不一致, 2 引数・ファイルの誤り
+
+#include "test_util.h"
+#include "LogFormat.h"
+
+/* マクロ定義 */
+#define DEFAULT_RECORDS     200000              // レコード数(5ms周期で約17分)
+#define DEFAULT_DECODER     "build/logdecode"
+#define DEFAULT_OUTPUT      "build/test_logformat"
+#define STAMP_INTERVAL      4000                // log_stampを挟む間隔[レコード]
+#define LINE_MAX            512
+
+/* グローバル変数 */
+static int records = DEFAULT_RECORDS;
+static const char *decoder = DEFAULT_DECODER;
+static const char *output = DEFAULT_OUTPUT;
+static LOG_RECORD *data;
+
+/* 走行中を模したレコードを作る(固定のシードの乱数で、毎回同じ値になる) */
+static void make_records() {
+    static const char *stamps[] = { "\n---- CURVE ----\n", "\n---- STRAIGHT ----\n" };
+    float distance = 0, direction = 0;
+    int r = 60, g = 80, b = 70, angle = 0, turn = 0;
+    int i;
+
+    srand(1);
+    for(i = 0; i < records; i++)
+    {
+        // RGBはライン上と白の間をゆっくり行き来し、旋回値はそれに追従する
+        r += rand() % 7 - 3; r = r < 0 ? 0 : r > 255 ? 255 : r;
+        g += rand() % 7 - 3; g = g < 0 ? 0 : g > 255 ? 255 : g;
+        b += rand() % 7 - 3; b = b < 0 ? 0 : b > 255 ? 255 : b;
+        turn += rand() % 5 - 2; turn = turn < -100 ? -100 : turn > 100 ? 100 : turn;
+        angle += rand() % 3 - 1;
+        distance += 0.05f + (rand() % 100) * 0.001f;    // [cm]
+        direction += turn * 0.002f;                     // [deg]
+
+        data[i].r = r;
+        data[i].g = g;
+        data[i].b = b;
+        data[i].distance = distance;
+        data[i].direction = direction;
+        data[i].angle = angle;
+        data[i].power = 70;
+        data[i].turn = turn;
+        data[i].time = i;
+        data[i].stamp = (i % STAMP_INTERVAL == STAMP_INTERVAL - 1) ? stamps[i / STAMP_INTERVAL % 2] : NULL;
+    }
+}
+
+/* 従来のテキストログを書き込む(baselineのlog_open・log_stamp・measure_taskと同じ書式) */
+static void write_text(FILE *out) {
+    int i;
+
+    fprintf(out, "R\tG\tB\tDistance\tDirection\tAngle\tPower\tTurn\tTime\n");
+    for(i = 0; i < records; i++)
+    {
+        if(data[i].stamp != NULL)
+            fputs(data[i].stamp, out);
+        fprintf(out, "%d\t%d\t%d\t%8.3f\t%9.1f\t%4d\t%4d\t%4d\t%6dms\n",
+                data[i].r, data[i].g, data[i].b, data[i].distance, data[i].direction,
+                data[i].angle, data[i].power, data[i].turn, (int)data[i].time * 5);
+    }
+}
+
+/* バイナリログを書き込む(app.cのlog_open・logfile_task・log_closeと同じ手順) */
+static void write_binary(FILE *out) {
+    uint8_t buf[LOG_FORMAT_RECORD_MAX > LOG_FORMAT_HEADER_MAX ? LOG_FORMAT_RECORD_MAX : LOG_FORMAT_HEADER_MAX];
+    int i;
+
+    fwrite(buf, 1, LogFormat_header(buf), out);
+    for(i = 0; i < records; i++)
+        fwrite(buf, 1, LogFormat_encode(&data[i], buf), out);
+    fwrite(buf, 1, LogFormat_end(0, buf), out);
+}
+
+/* 書き込み1回分のCPU時間[ns/レコード]を計測する(出力先は/dev/null) */
+static double bench(void (*write)(FILE *)) {
+    struct timespec t0, t1;
+    FILE *null;
+
+    if((null = fopen("/dev/null", "w")) == NULL)
+        return 0;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t0);
+    write(null);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t1);
+    fclose(null);
+
+    return elapsed_ns(&t0, &t1) / records;
+}
+
+/* 数値の列と単位が一致するか("-0.0"と"0.0"を同じとみなす) */
+static bool_t near_line(const char *a, const char *b) {
+    double va[9], vb[9];
+    char ua[8], ub[8];
+    int i;
+
+    if(sscanf(a, "%lf %lf %lf %lf %lf %lf %lf %lf %lf%7s", &va[0], &va[1], &va[2], &va[3], &va[4], &va[5], &va[6], &va[7], &va[8], ua) != 10
+    || sscanf(b, "%lf %lf %lf %lf %lf %lf %lf %lf %lf%7s", &vb[0], &vb[1], &vb[2], &vb[3], &vb[4], &vb[5], &vb[6], &vb[7], &vb[8], ub) != 10
+    || strcmp(ua, ub) != 0)
+        return false;
+
+    for(i = 0; i < 9; i++)
+        if(va[i] != vb[i])
+            return false;
+    return true;
+}
+
+/* デコードした結果をテキストログと1行ずつ比べる 返り値 : 一致しなかった行数/-1(実行できない) */
+static int compare(const char *text_name, const char *bin_name, int *near) {
+    char command[LINE_MAX], expect[LINE_MAX], actual[LINE_MAX];
+    FILE *text, *decoded;
+    int line = 0, mismatch = 0;
+
+    if(snprintf(command, sizeof(command), "%s %s 2>/dev/null", decoder, bin_name) >= (int)sizeof(command))
+        return -1;
+    if((text = fopen(text_name, "r")) == NULL || (decoded = popen(command, "r")) == NULL)
+        return -1;
+
+    *near = 0;
+    while(fgets(expect, sizeof(expect), text) != NULL)
+    {
+        line++;
+        if(fgets(actual, sizeof(actual), decoded) == NULL)
+        {
+            printf("decode    decoded log ends at line %d\n", line);
+            mismatch++;
+            break;
+        }
+        if(strcmp(expect, actual) == 0)
+            continue;
+        if(near_line(expect, actual))
+        {
+            (*near)++;
+            continue;
+        }
+        if(mismatch++ < 5 || verbose)
+            printf("decode    line %d\n  text    : %s  decoded : %s", line, expect, actual);
+    }
+    if(fgets(actual, sizeof(actual), decoded) != NULL)
+    {
+        printf("decode    decoded log has extra lines\n");
+        mismatch++;
+    }
+
+    fclose(text);
+    if(pclose(decoded) != 0)
+        return -1;
+    return mismatch;
+}
+
+static long file_size(const char *name) {
+    FILE *file = fopen(name, "rb");
+    long size;
+
+    if(file == NULL)
+        return -1;
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+int main(int argc, char *argv[]) {
+    char text_name[LINE_MAX], bin_name[LINE_MAX];
+    FILE *text, *bin;
+    int opt, mismatch, near;
+
+    while((opt = test_getopt(argc, argv, "n:d:o:v", "test_logformat [-n records] [-d logdecode] [-o output] [-v]")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': records = atoi(optarg); break;
+            case 'd': decoder = optarg; break;
+            case 'o': output = optarg; break;
+        }
+    }
+    if(records <= 0 || (data = malloc(sizeof(LOG_RECORD) * records)) == NULL)
+        return TEST_USAGE;
+    make_records();
+
+    snprintf(text_name, sizeof(text_name), "%s.txt", output);
+    snprintf(bin_name, sizeof(bin_name), "%s.bin", output);
+    if((text = fopen(text_name, "w")) == NULL || (bin = fopen(bin_name, "wb")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", output);
+        return TEST_USAGE;
+    }
+    write_text(text);
+    write_binary(bin);
+    fclose(text);
+    fclose(bin);
+
+    printf("size      text %.1f byte/record, binary %.1f byte/record\n",
+           (double)file_size(text_name) / records, (double)file_size(bin_name) / records);
+    printf("bench     fprintf %.1f ns/record, encode %.1f ns/record\n", bench(write_text), bench(write_binary));
+
+    if((mismatch = compare(text_name, bin_name, &near)) < 0)
+    {
+        fprintf(stderr, "cannot run %s\n", decoder);
+        return TEST_USAGE;
+    }
+    check("decode", mismatch == 0, "%d records, %d lines differ only in the sign of zero, %d mismatches", records, near, mismatch);
+
+    free(data);
+    return failed;
+}
@@ -0,0 +1,527 @@
+// Motionのテスト(ホスト用)
+//
+// ../hamapoly/Motion.c の動作キューを、plant.cと同じ一次遅れのモーターを持つ走行体のモデルにつないでmeasure_taskの周期で動かし、
+// baselineのRun_setDistance・Run_setDirection・arm_downの4ms周期のループ(motor_ctrl_alt(..., 0.1)・出力を1ずつ増減)と比べる
+//  - 加減速 : 1秒あたりの出力の変化がbaselineと同じであること(同じ時刻の出力の差が1以内)
+//  - 距離・方位 : 停止した位置・方位がbaselineと許容値以内で一致すること(終了条件の判定は5ms周期になる)
+//  - アーム : 出力の増減と停止までの時間がbaselineと同じであること
+//  - 速度プロファイル : 終点で止まり、行き過ぎがモーターの遅れの分以内でbaselineの距離指定より小さいこと
+//  - blend : 次の動作に移るときに減速しないこと
+//  - 取り消し : 完了時の関数からMotion_cancelを呼んでも戻り、残りの動作がその周期のうちに取り消されること
+//  - 区間のタスクの変数 : measure_taskから区間のタスクの関数(motor_ctrl等)を呼ばないこと
+//
+// 使い方 : test_motion [-v]
+// 終了コード : 0 合格, 1 許容値の超過, 2 引数の誤り
+
+#include "test_util.h"
+#include "Run.h"
+
+/* マクロ定義 */
+#define STEP_US         1000        // モデルの積分周期[us]
+#define MEASURE_US      (WHEEL_SPEED_PERIOD * 1000) // measure_taskの周期[us]
+#define SECTION_US      4000        // baselineの区間のループの周期[us]
+#define MM_PER_DEG      (PI * TIRE_DIAMETER / 360.0)
+#define LARGE_SPEED     900.0       // Lモーターの回転速度[deg/s](plant.hのPLANT_LARGE_SPEED *plant.hはsim/course.hと見出しが重なるため読み込まない)
+#define MEDIUM_SPEED    1500.0      // Mモーターの回転速度[deg/s](PLANT_MEDIUM_SPEED)
+#define MOTOR_TAU       0.08        // 出力変化に対する時定数[s](PLANT_MOTOR_TAU)
+#define BRAKE_TAU       0.02        // ブレーキ停止の時定数[s](PLANT_BRAKE_TAU)
+#define TIMEOUT_US      (20 * 1000000)
+#define POWER_TOLERANCE 1           // 同じ時刻の出力の差の許容値
+#define DISTANCE_LIMIT  3.0         // 停止位置の差の許容値[mm]
+#define DIRECTION_LIMIT 1.0         // 停止方位の差の許容値[deg]
+#define PROFILE_WAIT    0.55        // 速度プロファイルの終了から停止までの時間の許容値[s](Motion.cのPROFILE_TIMEOUTと停止の減速)
+#define PROFILE_OVERRUN 15.0        // 速度プロファイルの終点の行き過ぎの許容値[mm](速度制御の無いモデルでは速度*MOTOR_TAU程度遅れる)
+#define ARM_LIMIT_US    5000        // アームの停止までの時間の差の許容値[us](measure_taskの1周期)
+#define TRACE_MAX       8192        // 記録する出力の数
+
+/* 走行体のモデル */
+typedef struct {
+    double  speed[2];       // 左右タイヤの回転速度[deg/s]
+    int     power[2];       // 左右モーターの出力
+    double  distance;       // 走行距離[mm]
+    double  direction;      // 方位[deg](Direction.cと同じく左右の走行距離の差から求める)
+    double  arm_speed;      // アームの回転速度[deg/s]
+    double  arm_angle;      // アームの角度[deg]
+    int     arm_power;      // アームの出力
+    bool_t  arm_stopped;
+} BODY;
+
+/* 出力の記録(時刻はSTEP_US単位) */
+typedef struct {
+    int     n;
+    int     power[TRACE_MAX];
+    long    time[TRACE_MAX];
+} TRACE;
+
+/* グローバル変数 */
+static BODY body;
+static long now_us;                     // モデルの時刻[us]
+static int8_t section_power = 0;        // 区間のタスクの計測用の出力(Run_getPower)
+static int16_t section_turn = 0;
+static bool_t in_update = false;        // Motion_updateの実行中か
+static int section_calls = 0;           // Motion_updateの実行中に区間のタスクの関数が呼ばれた回数
+
+/* Motion.cが使う関数(Run・Distance・Direction・Sonar・WheelSpeed・ev3api)の代わり */
+static void set_wheels(int8_t power, int16_t turn) {
+    turn = turn * COURSE_TURN_SIGN;                 // motor_ctrlと同じ換算
+    if(power != 0 && turn == 0)
+        body.power[0] = body.power[1] = power;
+    else if(turn > 0)
+    {
+        body.power[0] = power;
+        body.power[1] = power - (turn * power / 100);
+    }
+    else if(turn < 0)
+    {
+        body.power[0] = power + (turn * power / 100);
+        body.power[1] = power;
+    }
+    else
+        body.power[0] = body.power[1] = 0;
+}
+
+void motor_ctrl_output(int8_t power, int16_t turn) {
+    set_wheels(power, turn);
+}
+
+void motor_ctrl(int8_t power, int16_t turn) {
+    if(in_update)
+        section_calls++;
+    section_power = power;
+    section_turn = turn * COURSE_TURN_SIGN;
+    set_wheels(power, turn);
+}
+
+int8_t Run_getPower() {
+    return section_power;
+}
+
+int16_t Run_getTurn() {
+    return section_turn;
+}
+
+float math_limit(float n, float min, float max) {
+    return n > max ? max : n < min ? min : n;
+}
+
+void WheelSpeed_setTarget(int16_t left, int16_t right) {
+    body.power[0] = left * 100 / WHEEL_SPEED_MAX;   // 速度制御は行わず、フィードフォワード分の出力だけを与える
+    body.power[1] = right * 100 / WHEEL_SPEED_MAX;
+}
+
+float Distance_getDistance() {
+    return body.distance;
+}
+
+float Direction_getDirection() {
+    return body.direction;
+}
+
+void Sonar_setThreshold(int16_t threshold) {
+}
+
+bool_t Sonar_isDetected() {
+    return false;
+}
+
+int32_t ev3_motor_get_counts(motor_port_t port) {
+    return (int32_t)body.arm_angle;
+}
+
+int ev3_motor_get_power(motor_port_t port) {
+    return body.arm_power;
+}
+
+ER ev3_motor_set_power(motor_port_t port, int power) {
+    body.arm_power = power;
+    body.arm_stopped = false;
+    return E_OK;
+}
+
+ER ev3_motor_stop(motor_port_t port, bool_t brake) {
+    body.arm_power = 0;
+    body.arm_stopped = true;
+    return E_OK;
+}
+
+/* モデルを1ステップ進める(plant.cのmotor_stepと同じ一次遅れ) */
+static void step() {
+    double dt = STEP_US / 1000000.0;
+    double k = dt / (MOTOR_TAU + dt);
+    double dl, dr;
+    int j;
+
+    for(j = 0; j < 2; j++)
+        body.speed[j] += (body.power[j] / 100.0 * LARGE_SPEED - body.speed[j]) * k;
+    dl = body.speed[0] * dt * MM_PER_DEG;
+    dr = body.speed[1] * dt * MM_PER_DEG;
+    body.distance += (dl + dr) / 2.0;
+    body.direction += (360.0 / (2.0 * PI * TREAD)) * (dl - dr);
+
+    body.arm_speed += ((body.arm_stopped ? 0.0 : body.arm_power / 100.0 * MEDIUM_SPEED) - body.arm_speed)
+                    * (dt / ((body.arm_stopped ? BRAKE_TAU : MOTOR_TAU) + dt));
+    body.arm_angle += body.arm_speed * dt;
+    now_us += STEP_US;
+}
+
+/* measure_taskを1周期分動かす */
+static void measure_tick() {
+    int i;
+
+    for(i = 0; i < MEASURE_US / STEP_US; i++)
+        step();
+    in_update = true;
+    Motion_update();
+    in_update = false;
+}
+
+/* 区間のタスクの待機の代わり(待っている間にmeasure_taskを動かす) */
+ER tslp_tsk(TMO tmout) {
+    measure_tick();
+    return E_OK;
+}
+
+static void reset() {
+    memset(&body, 0, sizeof(body));
+    body.arm_stopped = true;
+    now_us = 0;
+    section_power = 0;
+    section_turn = 0;
+    section_calls = 0;
+    Motion_init();
+}
+
+static void record(TRACE *trace, int power) {
+    if(trace != NULL && trace->n < TRACE_MAX)
+    {
+        trace->power[trace->n] = power;
+        trace->time[trace->n] = now_us;
+        trace->n++;
+    }
+    if(verbose)
+        printf("#%7.3f %4d %8.2f %7.2f %6.1f\n", now_us / 1e6, power, body.distance, body.direction, body.arm_angle);
+}
+
+/* 時刻tの出力(記録の時刻のうちt以前で最も新しいもの) */
+static int trace_at(const TRACE *trace, long t) {
+    int i, power = 0;
+
+    for(i = 0; i < trace->n && trace->time[i] <= t; i++)
+        power = trace->power[i];
+    return power;
+}
+
+/* 2つの記録の出力の差の最大値(遅い方の周期の各時刻で比べる) */
+static int trace_diff(const TRACE *a, const TRACE *b) {
+    int i, d, max = 0;
+
+    for(i = 0; i < a->n; i++)
+    {
+        d = abs(a->power[i] - trace_at(b, a->time[i]));
+        if(d > max)
+            max = d;
+    }
+    return max;
+}
+
+/* baselineのRun_getPower_change(4msあたりchange_rateずつ増減、状態は関数内のstatic) */
+static float base_ramp_power;
+
+static int8_t base_power_change(int8_t current_power, int8_t target_power, float change_rate) {
+    if(current_power < target_power)
+    {
+        if(floorf(base_ramp_power) != current_power)
+            base_ramp_power = current_power;
+        base_ramp_power += change_rate;
+        return floorf(base_ramp_power);
+    }
+    else if(current_power > target_power)
+    {
+        if(ceilf(base_ramp_power) != current_power)
+            base_ramp_power = current_power;
+        base_ramp_power -= change_rate;
+        return ceilf(base_ramp_power);
+    }
+    return current_power;
+}
+
+/* baselineの区間のループを1周期分動かす(motor_ctrl_altと同じ) */
+static int8_t base_power;
+
+static void base_tick(int8_t power, int16_t turn, TRACE *trace) {
+    int i;
+
+    base_power = base_power_change(base_power, power, 0.1);
+    set_wheels(base_power, turn);
+    record(trace, base_power);
+    for(i = 0; i < SECTION_US / STEP_US; i++)
+        step();
+}
+
+/* baselineのRun_setDistance(前進) */
+static void base_distance(int8_t power, int16_t turn, float distance, TRACE *trace) {
+    float ref = body.distance;
+
+    base_power = 0;
+    base_ramp_power = 0;
+    while(now_us < TIMEOUT_US)
+    {
+        if(body.distance >= ref + distance)
+        {
+            base_tick(0, turn, trace);
+            if(base_power == 0)
+                return;
+        }
+        else
+            base_tick(power, turn, trace);
+    }
+}
+
+/* baselineのRun_setDirection(turn > 0で方位が増える向き、MOTION_DIRECTION_SIGNで符号を合わせる) */
+static void base_direction(int8_t power, int16_t turn, float direction, TRACE *trace) {
+    float ref = body.direction;
+
+    direction *= MOTION_DIRECTION_SIGN;
+    base_power = 0;
+    base_ramp_power = 0;
+    while(now_us < TIMEOUT_US)
+    {
+        if(direction < 0 ? body.direction <= ref + direction : body.direction >= ref + direction)
+        {
+            base_tick(0, turn, trace);
+            if(base_power == 0)
+                return;
+        }
+        else
+            base_tick(power, turn, trace);
+    }
+}
+
+/* baselineのarm_down(loop = true) */
+static void base_arm_down(uint8_t power, int32_t angle, TRACE *trace) {
+    int32_t cur_angle = ev3_motor_get_counts(EV3_PORT_A);
+    int8_t cur_power = ev3_motor_get_power(EV3_PORT_A);
+    int i;
+
+    while(now_us < TIMEOUT_US)
+    {
+        if(cur_angle > angle)
+        {
+            if(cur_power > power * -1)
+                --cur_power;
+        }
+        else
+        {
+            if(cur_power < 0)
+                ++cur_power;
+            else
+            {
+                ev3_motor_stop(EV3_PORT_A, true);
+                return;
+            }
+        }
+        ev3_motor_set_power(EV3_PORT_A, cur_power);
+        record(trace, cur_power);
+
+        for(i = 0; i < SECTION_US / STEP_US; i++)
+            step();
+        cur_angle = ev3_motor_get_counts(EV3_PORT_A);
+        cur_power = ev3_motor_get_power(EV3_PORT_A);
+    }
+}
+
+/* 走行動作が完了するまでmeasure_taskを動かし、出力を記録する */
+static void run_drive(TRACE *trace) {
+    while(Motion_isDriveBusy() && now_us < TIMEOUT_US)
+    {
+        measure_tick();
+        if(Motion_isDriveBusy())
+            record(trace, Motion_getPower());
+    }
+    record(trace, 0);
+}
+
+static void run_attachment(TRACE *trace) {
+    while(Motion_isAttachmentBusy() && now_us < TIMEOUT_US)
+    {
+        measure_tick();
+        record(trace, body.arm_power);
+    }
+}
+
+/* 距離指定の走行 : 加減速と停止位置 */
+static void test_distance() {
+    static TRACE base, motion;
+    double base_end, motion_end;
+    long base_time, motion_time;
+    int diff;
+
+    memset(&base, 0, sizeof(base));
+    memset(&motion, 0, sizeof(motion));
+
+    reset();
+    base_distance(30, 0, 300, &base);
+    base_end = body.distance;
+    base_time = now_us;
+
+    reset();
+    Motion_driveDistance(30, 0, 300, false, NULL, 0);
+    run_drive(&motion);
+    motion_end = body.distance;
+    motion_time = now_us;
+
+    diff = trace_diff(&motion, &base);
+    check("distance", diff <= POWER_TOLERANCE && fabs(motion_end - base_end) <= DISTANCE_LIMIT && section_calls == 0,
+          "power diff %d, stop at %.1f mm (baseline %.1f mm) in %.3f s (baseline %.3f s)",
+          diff, motion_end, base_end, motion_time / 1e6, base_time / 1e6);
+}
+
+/* 方位指定の旋回 */
+static void test_direction() {
+    static TRACE base, motion;
+    double base_end, motion_end;
+    int diff;
+
+    memset(&base, 0, sizeof(base));
+    memset(&motion, 0, sizeof(motion));
+
+    reset();
+    base_direction(20, 200, 90, &base);
+    base_end = body.direction;
+
+    reset();
+    Motion_turnDirection(20, 200, 90, false, NULL, 0);
+    run_drive(&motion);
+    motion_end = body.direction;
+
+    diff = trace_diff(&motion, &base);
+    check("direction", diff <= POWER_TOLERANCE && fabs(motion_end - base_end) <= DIRECTION_LIMIT && section_calls == 0,
+          "power diff %d, stop at %.2f deg (baseline %.2f deg)", diff, motion_end, base_end);
+}
+
+/* アーム : 出力の増減と停止までの時間 */
+static void test_arm() {
+    static TRACE base, motion;
+    long base_time, motion_time;
+    int diff;
+
+    memset(&base, 0, sizeof(base));
+    memset(&motion, 0, sizeof(motion));
+
+    reset();
+    base_arm_down(30, -47, &base);
+    base_time = now_us;
+
+    reset();
+    Motion_moveArm(30, -47, NULL, 0);
+    run_attachment(&motion);
+    motion_time = now_us;
+
+    diff = trace_diff(&motion, &base);
+    check("arm", diff <= POWER_TOLERANCE && labs(motion_time - base_time) <= ARM_LIMIT_US,
+          "power diff %d, stopped in %.3f s (baseline %.3f s)", diff, motion_time / 1e6, base_time / 1e6);
+}
+
+/* 速度プロファイル : 終点の手前から減速し、baselineの距離指定(終点を過ぎてから減速)より行き過ぎずに止まる */
+static void test_profile() {
+    PROFILE profile;
+    double base_end, motion_end, peak = 0;
+    long limit_us;
+    float speed = 30 * WHEEL_SPEED_MAX / 100 * MM_PER_DEG;   // 出力30相当の速度[mm/s]
+
+    reset();
+    base_distance(30, 0, 300, NULL);
+    base_end = body.distance;
+
+    reset();
+    Profile_init(&profile, 300, speed, 800, 8000);
+    limit_us = (Profile_getTime(&profile) + PROFILE_WAIT) * 1e6;
+    Motion_driveProfile(300, speed, 800, 8000, false, NULL, 0);
+    while(Motion_isDriveBusy() && now_us < TIMEOUT_US)
+    {
+        measure_tick();
+        if(body.distance > peak)
+            peak = body.distance;
+    }
+    motion_end = body.distance;
+
+    check("profile", fabs(motion_end - 300) <= DISTANCE_LIMIT && peak - 300 <= PROFILE_OVERRUN && peak < base_end
+                     && now_us <= limit_us && section_calls == 0,
+          "stop at %.1f mm (peak %.1f mm, baseline %.1f mm) in %.3f s (profile %.3f s)",
+          motion_end, peak, base_end, now_us / 1e6, Profile_getTime(&profile));
+}
+
+/* blend : 前の動作の終了条件を満たしても減速せずに次の動作に移る */
+static void test_blend() {
+    static TRACE motion;
+    int i, drop = -1;
+    bool_t reached = false, slowed = false;
+
+    memset(&motion, 0, sizeof(motion));
+    reset();
+    Motion_driveDistance(30, 0, 300, true, NULL, 0);
+    Motion_driveDistance(30, 0, 300, false, NULL, 0);
+    run_drive(&motion);
+
+    for(i = 0; i < motion.n; i++)                   // 30に達した後は、減速を始めたら再び加速しないこと(受け渡しで減速していない)
+    {
+        if(motion.power[i] == 30 && drop < 0)
+            reached = true;
+        else if(reached && drop < 0 && motion.power[i] < 30)
+            drop = i;
+        else if(drop >= 0 && motion.power[i] > motion.power[i - 1])
+            slowed = true;
+    }
+    check("blend", reached && !slowed && body.distance >= 600,
+          "distance %.1f mm, %s", body.distance, slowed ? "slowed down at the hand-off" : "no slowdown at the hand-off");
+}
+
+/* 取り消し : 完了時の関数からMotion_cancelを呼ぶ */
+static int callback_calls;
+
+static void cancel_callback(intptr_t arg) {
+    callback_calls++;
+    Motion_cancel();                                // measure_taskで待機せずに戻ること
+}
+
+static void test_cancel() {
+    int ticks = 0;
+
+    reset();
+    callback_calls = 0;
+    Motion_driveDistance(30, 0, 100, true, cancel_callback, 0);
+    Motion_driveDistance(30, 0, 100, true, NULL, 0);
+    Motion_driveDistance(30, 0, 100, false, NULL, 0);
+    Motion_moveArm(30, -47, NULL, 0);
+
+    while(callback_calls == 0 && ticks++ < TIMEOUT_US / MEASURE_US)
+        measure_tick();
+
+    check("cancel", callback_calls == 1 && !Motion_isDriveBusy() && !Motion_isAttachmentBusy()
+                    && body.power[0] == 0 && body.power[1] == 0 && body.arm_stopped,
+          "callback %d, drive %s, attachment %s, wheels %d/%d", callback_calls,
+          Motion_isDriveBusy() ? "busy" : "empty", Motion_isAttachmentBusy() ? "busy" : "empty", body.power[0], body.power[1]);
+
+    reset();                                        // 区間のタスクから呼んだ場合は反映されるまで待ち、計測用の変数も停止する
+    section_power = 30;
+    Motion_driveDistance(30, 0, 1000, false, NULL, 0);
+    for(ticks = 0; ticks < 100; ticks++)
+        measure_tick();
+    Motion_cancel();
+    check("cancel", !Motion_isDriveBusy() && section_power == 0 && body.power[0] == 0,
+          "from the section task: drive %s, Run_getPower %d", Motion_isDriveBusy() ? "busy" : "empty", section_power);
+}
+
+int main(int argc, char *argv[]) {
+    while(test_getopt(argc, argv, "v", "test_motion [-v]") != -1)
+        ;
+
+    test_distance();
+    test_direction();
+    test_profile();
+    test_arm();
+    test_blend();
+    test_cancel();
+
+    return failed;
+}
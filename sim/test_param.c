@@ -0,0 +1,265 @@
+// Paramのテスト(ホスト用)
+//
+// ../hamapoly/Param.c のチューニングファイルの読み込みと、走行中の変更の反映(ダブルバッファ)を確かめる
+//  - チェックサム : Fletcher-16の既知の値と一致する計算で付けたファイルを読み込めること
+//                   ../tools/paramsum.c で付けたファイルも読み込めること
+//                   checksum行より前の1バイトを変えたファイル・checksum行の無いファイル・キーがchecksumで始まるだけの行は、
+//                   ファイル全体を使わずに既定値のままになること
+//  - 行の解析 : 空白・コメント・16進数・小数を読み、範囲外・不明なキー・'='の無い行・数値でない値はその行だけ無視すること
+//  - 反映 : Param_writeの値はParam_commitまでParam_getに現れず、反映後も以前のポインタの値は書き換えられないこと
+//           bt_taskの書き込み途中にmeasure_task(タイマーのシグナルハンドラで模す)が反映しても、組で書いた値が食い違わないこと
+//
+// 使い方 : test_param [-s paramsumのパス] [-v]
+// 終了コード : 0 合格, 1 不一致, 2 引数・ファイルの誤り
+
+#include <signal.h>
+#include <sys/time.h>
+#include "test_util.h"
+#include "Param.h"
+
+/* マクロ定義 */
+#define DEFAULT_PARAMSUM    "build/paramsum"
+#define FILE_NAME           "build/test_param.txt"
+#define PUBLISH_COMMITS     20000       // 反映の試験でParam_commitを呼ぶ回数
+#define PUBLISH_PERIOD      50          // 反映の試験でmeasure_taskを割り込ませる間隔[us]
+
+/* グローバル変数 */
+static const char *paramsum = DEFAULT_PARAMSUM;
+static bool_t in_commit_wait = false;   // Param_commitの待機中にmeasure_taskを動かすか
+
+/* Param.cが使う関数(カーネル)の代わり */
+ER tslp_tsk(TMO tmout) {
+    if(in_commit_wait)
+        Param_update();                 // 待っている間にmeasure_taskが反映する
+    else
+        usleep(tmout / 20);             // シグナルハンドラが割り込む時間を作る
+    return E_OK;
+}
+
+/* Fletcher-16(Param.cと同じ定義で、既知の値で確かめてから使う) */
+static uint16_t fletcher16(const char *data, size_t size) {
+    uint16_t a = 0, b = 0;
+    size_t i;
+
+    for(i = 0; i < size; i++)
+    {
+        a = (a + (uint8_t)data[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return (b << 8) | a;
+}
+
+/* bodyの後にchecksum行を付けてファイルに書き、読み込む 返り値 : Param_loadの返り値 */
+static int load(const char *body, const char *checksum_line) {
+    char line[64];
+    FILE *fp;
+
+    if((fp = fopen(FILE_NAME, "w")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", FILE_NAME);
+        exit(TEST_USAGE);
+    }
+    fputs(body, fp);
+    if(checksum_line == NULL)
+    {
+        snprintf(line, sizeof(line), "checksum = 0x%04x\n", fletcher16(body, strlen(body)));
+        checksum_line = line;
+    }
+    fputs(checksum_line, fp);
+    fclose(fp);
+
+    Param_init();
+    return Param_load(FILE_NAME);
+}
+
+static int param_id(const char *key) {
+    const char *name;
+    PARAM_TYPE type;
+    int id;
+
+    for(id = 0; id < Param_getNum(); id++)
+        if(Param_getInfo(id, &name, &type) == 0 && strcmp(name, key) == 0)
+            return id;
+    return -1;
+}
+
+static uint32_t int_bits(int32_t value) {
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static uint32_t float_bits(float value) {
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/* チェックサム */
+static void test_checksum() {
+    static const char body[] = "line.power = 55\n";
+    char text[64], command[256];
+    int result;
+
+    check("fletcher", fletcher16("abcde", 5) == 0xc8f0 && fletcher16("abcdef", 6) == 0x2057,
+          "abcde 0x%04x (expect 0xc8f0), abcdef 0x%04x (expect 0x2057)", fletcher16("abcde", 5), fletcher16("abcdef", 6));
+
+    result = load(body, NULL);
+    check("checksum", result == 1 && Param_get()->line_power == 55, "valid file: %d values, line.power %d", result, Param_get()->line_power);
+
+    snprintf(text, sizeof(text), "checksum = 0x%04x\n", fletcher16(body, strlen(body)));
+    result = load("line.power = 56\n", text);             // 値を1文字変えた(checksumは元の本体のもの)
+    check("checksum", result == -1 && Param_get()->line_power == 100,
+          "corrupted line: %d, line.power %d (default)", result, Param_get()->line_power);
+
+    result = load(body, "");
+    check("checksum", result == -1 && Param_get()->line_power == 100, "no checksum line: %d", result);
+
+    snprintf(text, sizeof(text), "checksums = 0x%04x\n", fletcher16(body, strlen(body)));
+    result = load(body, text);                              // キーがchecksumで始まるだけの行はchecksum行ではない
+    check("checksum", result == -1, "key \"checksums\": %d", result);
+
+    snprintf(text, sizeof(text), "checksum\t= 0x%04x\n", fletcher16(body, strlen(body)));
+    result = load(body, text);
+    check("checksum", result == 1, "key followed by a tab: %d", result);
+
+    /* paramsumで付けたファイル(既存のchecksum行は付け直される) */
+    load("line.power = 57\nline.kp = 0.5\n", "checksum = 0x0000\n");
+    snprintf(command, sizeof(command), "%s %s > /dev/null", paramsum, FILE_NAME);
+    if(system(command) != 0)
+    {
+        fprintf(stderr, "cannot run %s\n", paramsum);
+        exit(TEST_USAGE);
+    }
+    Param_init();
+    result = Param_load(FILE_NAME);
+    check("paramsum", result == 2 && Param_get()->line_power == 57, "%d values, line.power %d", result, Param_get()->line_power);
+}
+
+/* 行の解析 */
+static void test_parse() {
+    const PARAM *p;
+    int result;
+
+    result = load("# コメント行\n"
+                  "\n"
+                  "  line.power   =  90   # 前後の空白とコメント\n"
+                  "line.target = 0x40\r\n"
+                  "line.kp = 1.25\n"
+                  "line.kd=-0\n"
+                  "slalom.shift = 1001\n"       // 範囲外(0~1000)
+                  "line.ki = 11\n"              // 範囲外(0~10)
+                  "line.kd = nan\n"             // NaNは範囲外
+                  "block.move = 12x\n"          // 数値でない
+                  "block.return\n"              // '='が無い
+                  "no.such.key = 1\n"
+                  "line.power_curve = \n",      // 値が空
+                  NULL);
+    p = Param_get();
+    check("parse", result == 4 && p->line_power == 90 && p->line_target == 0x40 && p->line_kp == 1.25f && p->line_kd == 0.0f,
+          "%d values loaded (expect 4), line.power %d, line.target %d, line.kp %.2f, line.kd %.2f",
+          result, p->line_power, p->line_target, p->line_kp, p->line_kd);
+    check("parse", p->slalom_shift == 105 && p->line_ki == (float)COURSE_KI && p->block_move == 1000 && p->block_return == 2500
+                   && p->line_power_curve == 70,
+          "ignored lines keep the defaults: slalom.shift %d, line.ki %.2f, block.move %d, block.return %d, line.power_curve %d",
+          p->slalom_shift, p->line_ki, p->block_move, p->block_return, p->line_power_curve);
+}
+
+/* 反映 : 書き込んだ値がParam_commitまで現れない */
+static void test_commit() {
+    const PARAM *before;
+    uint32_t version, value;
+    int power = param_id("line.power"), kp = param_id("line.kp");
+    int w1, w2;
+
+    Param_init();
+    before = Param_get();
+    version = Param_getVersion();
+    Param_write(power, int_bits(60));
+    Param_write(kp, float_bits(0.75f));
+    Param_update();                                         // 要求が無いので反映しない
+    Param_read(power, &value);
+    check("commit", Param_get()->line_power == 100 && Param_getVersion() == version && value == int_bits(60),
+          "before commit: line.power %d, pending %d, version %u", Param_get()->line_power, (int32_t)value, Param_getVersion());
+
+    in_commit_wait = true;
+    Param_commit();
+    in_commit_wait = false;
+    check("commit", Param_get()->line_power == 60 && Param_get()->line_kp == 0.75f && Param_getVersion() == version + 1
+                    && before->line_power == 100,
+          "after commit: line.power %d, line.kp %.2f, version %u, previous buffer line.power %d",
+          Param_get()->line_power, Param_get()->line_kp, Param_getVersion(), before->line_power);
+
+    w1 = Param_write(power, int_bits(101));
+    w2 = Param_write(Param_getNum(), int_bits(1));
+    check("write", w1 == -2 && w2 == -1, "out of range value %d (expect -2), unknown id %d (expect -1)", w1, w2);
+}
+
+/* 反映 : 書き込み途中に割り込まれても組が食い違わない */
+static volatile int ticks;
+static volatile int mismatch;
+
+static void tick(int sig) {
+    const PARAM *p;
+
+    Param_update();
+    p = Param_get();
+    if(p->line_power != p->line_power_curve)
+        mismatch++;
+    ticks++;
+}
+
+static void test_publish() {
+    struct sigaction action;
+    struct itimerval timer = { { 0, PUBLISH_PERIOD }, { 0, PUBLISH_PERIOD } };
+    struct itimerval off = { { 0, 0 }, { 0, 0 } };
+    int power = param_id("line.power"), curve = param_id("line.power_curve");
+    uint32_t start;
+    int i;
+
+    Param_init();
+    Param_write(curve, int_bits(100));                      // 既定値(100, 70)を組にそろえる
+    Param_commit();
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = tick;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &action, NULL);
+
+    ticks = 0;
+    mismatch = 0;
+    start = Param_getVersion();
+    setitimer(ITIMER_REAL, &timer, NULL);
+    for(i = 0; i < PUBLISH_COMMITS; i++)                    // bt_task相当 : 2つの値を同じ値にそろえて書き、反映を要求する
+    {
+        Param_write(power, int_bits(i % 101));
+        Param_write(curve, int_bits(i % 101));
+        Param_commit();
+    }
+    setitimer(ITIMER_REAL, &off, NULL);
+
+    check("publish", mismatch == 0 && Param_getVersion() - start == PUBLISH_COMMITS,
+          "%d updates during %d commits (%u applied), %d updates with line.power != line.power_curve",
+          ticks, PUBLISH_COMMITS, Param_getVersion() - start, mismatch);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+
+    while((opt = test_getopt(argc, argv, "s:v", "test_param [-s paramsum] [-v]")) != -1)
+    {
+        if(opt == 's')
+            paramsum = optarg;
+    }
+
+    test_checksum();
+    test_parse();
+    test_commit();
+    test_publish();
+
+    remove(FILE_NAME);
+    return failed;
+}
@@ -0,0 +1,327 @@
+// PIDのテスト・ベンチマーク(ホスト用)
+//
+// ../hamapoly/PID.c のQ16.16固定小数点のPID制御器を、同じ式を浮動小数点で計算するもの(pidf_*)と比べる
+//  - 丸め : Q16_TO_INTがbaselineのroundfと同じく0.5を0から遠い方へ丸めること
+//  - ステップ応答 : 比例・積分・微分の各項、微分のフィルタ、出力の飽和とアンチワインドアップ、実測のdtについて、
+//                   偏差のステップに対する出力が浮動小数点の計算と1以内で一致すること
+//  - 閉ループ : 各コースのゲイン(Course.h)でライン位置のモデルを目標値のステップに追従させ、
+//               浮動小数点の計算・baselineのRun_getTurn_sensorPID(アンチワインドアップ無し)と応答を比べる
+//  - 速度 : 1回の計算時間を浮動小数点の計算と比べる(ホストはFPUを持つため、FPUの無いEV3より浮動小数点が有利になる)
+//
+// 使い方 : test_pid [-v]
+// 終了コード : 0 合格, 1 不一致, 2 引数の誤り
+
+#include "test_util.h"
+#include "PID.h"
+
+/* マクロ定義 */
+#define DT              0.004f      // 処理周期[s](Run.cのDELTA_T)
+#define STEP_LOOPS      2500        // ステップ応答の周期数(10s)
+#define CLOSED_LOOPS    7500        // 閉ループの周期数(30s)
+#define LINE_GAIN       1.5f        // ライン位置のモデル : 旋回値1あたりのセンサー値の変化の速さ[1/s]
+#define BENCH_LOOPS     10000000
+#define TOLERANCE       1           // 浮動小数点の計算との出力の差の許容値
+#define TRACK_TOLERANCE 2.0f        // 閉ループの偏差の軌跡の差の許容値
+#define SETTLE_ERROR    2.0f        // 閉ループの整定とみなす偏差
+
+/* 浮動小数点のPID制御器(PID.cと同じ式) */
+typedef struct {
+    float   kp, ki, kd, dt;
+    float   integral_max;
+    float   out_min, out_max;
+    float   d_alpha;
+    float   prev_error;
+    float   integral;
+    float   d_filtered;
+} PID_FLOAT;
+
+static void pidf_init(PID_FLOAT *pid, float kp, float ki, float kd, float dt) {
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->dt = dt;
+    pid->out_min = -200;
+    pid->out_max = 200;
+    pid->integral_max = ki > 0 ? 200 / ki : 0;
+    pid->d_alpha = 1;
+    pid->prev_error = 0;
+    pid->integral = 0;
+    pid->d_filtered = 0;
+}
+
+static int32_t pidf_updateDt(PID_FLOAT *pid, int32_t error, float dt) {
+    float d, out;
+
+    pid->integral += (error + pid->prev_error) / 2.0f * dt;
+    if(pid->integral > pid->integral_max)
+        pid->integral = pid->integral_max;
+    else if(pid->integral < -pid->integral_max)
+        pid->integral = -pid->integral_max;
+
+    d = pid->kd * (error - pid->prev_error) / dt;
+    pid->d_filtered += pid->d_alpha * (d - pid->d_filtered);
+    pid->prev_error = error;
+
+    out = pid->kp * error + pid->ki * pid->integral + pid->d_filtered;
+    if(out > pid->out_max)
+        out = pid->out_max;
+    else if(out < pid->out_min)
+        out = pid->out_min;
+
+    return (int32_t)roundf(out);
+}
+
+static int32_t pidf_update(PID_FLOAT *pid, int32_t error) {
+    return pidf_updateDt(pid, error, pid->dt);
+}
+
+/* baselineのRun_getTurn_sensorPID(積分の上限が無い) */
+typedef struct {
+    float   kp, ki, kd;
+    int32_t diff[2];
+    float   integral;
+} PID_BASELINE;
+
+static int32_t baseline_update(PID_BASELINE *pid, int32_t error) {
+    float p, i, d, out;
+
+    pid->diff[0] = pid->diff[1];
+    pid->diff[1] = error;
+    pid->integral += (pid->diff[1] + pid->diff[0]) / 2.0 * DT;
+
+    p = pid->kp * pid->diff[1];
+    i = pid->ki * pid->integral;
+    d = pid->kd * (pid->diff[1] - pid->diff[0]) / DT;
+
+    out = p + i + d;
+    return roundf(out > 200 ? 200 : out < -200 ? -200 : out);
+}
+
+/* 丸め : Q16_TO_INTとroundfを-250~250の0.25刻みで比べる(0.5ちょうどを含む) */
+static void test_round() {
+    int k, mismatch = 0;
+
+    for(k = -1000; k <= 1000; k++)
+    {
+        float x = k * 0.25f;
+
+        if(Q16_TO_INT(Q16_FROM_FLOAT(x)) != (int32_t)roundf(x))
+        {
+            if(mismatch++ == 0 || verbose)
+                printf("#        %.2f -> %d, roundf %d\n", x, Q16_TO_INT(Q16_FROM_FLOAT(x)), (int32_t)roundf(x));
+        }
+    }
+    check("round", mismatch == 0, "%d mismatches with roundf in -250..250", mismatch);
+}
+
+/* 偏差の列に対する出力を浮動小数点の計算と比べる 返り値 : 出力の差の最大値 */
+static int32_t compare(PID_CTRL *pid, PID_FLOAT *ref, const int32_t *error, const float *dt, int loops, int32_t *out) {
+    int32_t q, f, diff, max_diff = 0;
+    int k;
+
+    for(k = 0; k < loops; k++)
+    {
+        q = dt != NULL ? PID_updateDt(pid, error[k], Q16_FROM_FLOAT(dt[k])) : PID_update(pid, error[k]);
+        f = dt != NULL ? pidf_updateDt(ref, error[k], dt[k]) : pidf_update(ref, error[k]);
+        diff = abs(q - f);
+        if(diff > max_diff)
+            max_diff = diff;
+        if(out != NULL)
+            out[k] = q;
+        if(verbose && diff > TOLERANCE)
+            printf("#        loop %d error %d : q16 %d float %d\n", k, error[k], q, f);
+    }
+    return max_diff;
+}
+
+/* 偏差のステップ(0からstepへ)に対する応答 */
+static int32_t step_response(float kp, float ki, float kd, float alpha, int32_t step, int32_t *out) {
+    static int32_t error[STEP_LOOPS];
+    PID_CTRL pid;
+    PID_FLOAT ref;
+    int k;
+
+    for(k = 0; k < STEP_LOOPS; k++)
+        error[k] = k == 0 ? 0 : step;
+    PID_init(&pid, kp, ki, kd, DT);
+    pidf_init(&ref, kp, ki, kd, DT);
+    PID_setFilter(&pid, alpha);
+    ref.d_alpha = alpha;
+
+    return compare(&pid, &ref, error, NULL, STEP_LOOPS, out);
+}
+
+/* 各項のステップ応答 */
+static void test_step() {
+    static int32_t out[STEP_LOOPS];
+    int32_t diff, expect;
+    int k, saturated;
+
+    /* 比例項 : 出力は kp * 偏差 */
+    diff = step_response(0.88f, 0, 0, 1, 37, out);
+    check("p", diff <= TOLERANCE && out[1] == (int32_t)roundf(0.88f * 37), "out %d (expect %d), max diff %d", out[1], (int32_t)roundf(0.88f * 37), diff);
+
+    /* 積分項 : 台形近似で ki * 偏差 * (t - dt/2) */
+    diff = step_response(0, 0.51f, 0, 1, 40, out);
+    expect = (int32_t)roundf(0.51f * 40 * (1000 - 0.5f) * DT);
+    check("i", diff <= TOLERANCE && abs(out[1000] - expect) <= TOLERANCE, "out at 4 s %d (expect %d), max diff %d", out[1000], expect, diff);
+
+    /* 微分項 : ステップの直後だけ kd * 偏差 / dt */
+    diff = step_response(0, 0, 0.006f, 1, 50, out);
+    expect = (int32_t)roundf(0.006f * 50 / DT);
+    check("d", diff <= TOLERANCE && out[1] == expect && out[2] == 0, "kick %d (expect %d) then %d, max diff %d", out[1], expect, out[2], diff);
+
+    /* 微分のフィルタ : 1周期ごとに (1 - alpha) 倍で減衰する */
+    diff = step_response(0, 0, 0.006f, 0.4f, 50, out);
+    check("d filter", diff <= TOLERANCE && out[1] == (int32_t)roundf(0.4f * expect) && out[2] < out[1] && out[20] == 0,
+          "%d, %d, %d ... %d, max diff %d", out[1], out[2], out[3], out[20], diff);
+
+    /* 飽和 : 出力は±200に制限し、積分値は積分項だけで出力範囲を超えない値で止める */
+    diff = step_response(1.5f, 0.51f, 0, 1, 300, out);
+    for(k = 1, saturated = 0; k < STEP_LOOPS; k++)
+        saturated += out[k] == 200;
+    check("saturate", diff <= TOLERANCE && saturated == STEP_LOOPS - 1, "%d/%d loops at 200, max diff %d", saturated, STEP_LOOPS - 1, diff);
+}
+
+/* アンチワインドアップ : 長く飽和させた後に偏差の符号を反転し、出力の符号が変わるまでの周期数を比べる */
+static void test_windup() {
+    PID_CTRL pid;
+    PID_FLOAT ref;
+    PID_BASELINE base = { 0.88f, 0.16f, 0, { 0, 0 }, 0 };
+    int32_t q, f, b, max_diff = 0;
+    int k, q_exit = -1, b_exit = -1;
+
+    PID_init(&pid, 0.88f, 0.16f, 0, DT);
+    pidf_init(&ref, 0.88f, 0.16f, 0, DT);
+    for(k = 0; k < 4 * STEP_LOOPS; k++)
+    {
+        int32_t error = k < STEP_LOOPS ? 250 : -150;    // 10s飽和させた後、反対側に外れる
+
+        q = PID_update(&pid, error);
+        f = pidf_update(&ref, error);
+        b = baseline_update(&base, error);
+        if(abs(q - f) > max_diff)
+            max_diff = abs(q - f);
+        if(k >= STEP_LOOPS && q_exit < 0 && q < 0)
+            q_exit = k - STEP_LOOPS;
+        if(k >= STEP_LOOPS && b_exit < 0 && b < 0)
+            b_exit = k - STEP_LOOPS;
+    }
+    check("windup", max_diff <= TOLERANCE && q_exit >= 0 && (b_exit < 0 || q_exit < b_exit),
+          "output turns after %d loops (baseline without the limit %d), max diff %d", q_exit, b_exit, max_diff);
+}
+
+/* 実測のdt : 処理周期どおりならPID_updateと同じ結果、周期がずれた場合は浮動小数点の計算と比べる */
+static void test_dt() {
+    static int32_t error[STEP_LOOPS];
+    static float dt[STEP_LOOPS];
+    PID_CTRL a, b;
+    PID_FLOAT ref;
+    int32_t diff;
+    int k, mismatch = 0;
+
+    srand(1);
+    for(k = 0; k < STEP_LOOPS; k++)
+    {
+        error[k] = (int32_t)(60 * sinf(k * 0.01f)) + rand() % 7 - 3;
+        dt[k] = DT * (0.75f + (rand() % 100) * 0.01f);  // 3~7ms
+    }
+
+    PID_init(&a, 0.88f, 0.16f, 0.0053f, DT);
+    PID_init(&b, 0.88f, 0.16f, 0.0053f, DT);
+    for(k = 0; k < STEP_LOOPS; k++)
+        mismatch += PID_update(&a, error[k]) != PID_updateDt(&b, error[k], Q16_FROM_FLOAT(DT));
+    check("dt nominal", mismatch == 0, "%d mismatches between PID_update and PID_updateDt(DELTA_T)", mismatch);
+
+    PID_init(&a, 0.88f, 0.16f, 0.0053f, DT);
+    pidf_init(&ref, 0.88f, 0.16f, 0.0053f, DT);
+    diff = compare(&a, &ref, error, dt, STEP_LOOPS, NULL);
+    check("dt jitter", diff <= TOLERANCE, "max diff %d with dt in 3..7 ms", diff);
+}
+
+/* 閉ループ : センサー値の偏差が旋回値に比例した速さで変化するモデルで、目標値のステップ(偏差40)に追従させる
+ * センサー値は整数に丸めるため、出力は微分項を通して丸めの差で大きく振れる(周期ごとの出力ではなく偏差の軌跡を比べる) */
+static void test_closed_loop() {
+    static const struct {
+        const char  *name;
+        float       kp, ki, kd;
+    } gains[] = {       // Course.hのCOURSE_KP/KI/KD
+        { "R",  0.30f, 0.20f, 0.00f },
+        { "L",  1.50f, 0.51f, 0.30f },
+        { "LL", 0.88f, 0.16f, 0.53f },
+    };
+    int g, k;
+
+    for(g = 0; g < (int)(sizeof(gains) / sizeof(gains[0])); g++)
+    {
+        PID_CTRL pid;
+        PID_FLOAT ref;
+        PID_BASELINE base = { gains[g].kp, gains[g].ki, gains[g].kd, { 0, 0 }, 0 };
+        float yq = 40, yf = 40, yb = 40;    // センサー値の偏差
+        float dev_float = 0, dev_base = 0;  // 偏差の軌跡の差の最大値
+        int settle = -1;
+
+        PID_init(&pid, gains[g].kp, gains[g].ki, gains[g].kd, DT);
+        pidf_init(&ref, gains[g].kp, gains[g].ki, gains[g].kd, DT);
+        for(k = 0; k < CLOSED_LOOPS; k++)
+        {
+            yq -= LINE_GAIN * PID_update(&pid, (int32_t)lroundf(yq)) * DT;
+            yf -= LINE_GAIN * pidf_update(&ref, (int32_t)lroundf(yf)) * DT;
+            yb -= LINE_GAIN * baseline_update(&base, (int32_t)lroundf(yb)) * DT;
+
+            dev_float = fmaxf(dev_float, fabsf(yq - yf));
+            dev_base = fmaxf(dev_base, fabsf(yq - yb));
+            if(fabsf(yq) >= SETTLE_ERROR)
+                settle = -1;
+            else if(settle < 0)
+                settle = k;
+        }
+        check(gains[g].name, settle >= 0 && dev_float <= TRACK_TOLERANCE && dev_base <= TRACK_TOLERANCE,
+              "settles in %.2f s, max deviation %.2f vs float, %.2f vs baseline", settle * DT, dev_float, dev_base);
+    }
+}
+
+/* 1回の計算時間を比べる */
+static void bench() {
+    static int32_t error[1024];
+    struct timespec t0, t1;
+    PID_CTRL pid;
+    PID_FLOAT ref;
+    volatile int32_t sink = 0;
+    int32_t acc;
+    int k;
+
+    srand(1);
+    for(k = 0; k < 1024; k++)
+        error[k] = rand() % 121 - 60;
+
+    PID_init(&pid, 0.88f, 0.16f, 0.0053f, DT);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(k = 0, acc = 0; k < BENCH_LOOPS; k++)
+        acc += PID_update(&pid, error[k & 1023]);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    sink += acc;
+    printf("bench     q16 %.2f ns/update", elapsed_ns(&t0, &t1) / BENCH_LOOPS);
+
+    pidf_init(&ref, 0.88f, 0.16f, 0.0053f, DT);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(k = 0, acc = 0; k < BENCH_LOOPS; k++)
+        acc += pidf_update(&ref, error[k & 1023]);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    sink += acc;
+    printf(", float %.2f ns/update\n", elapsed_ns(&t0, &t1) / BENCH_LOOPS);
+}
+
+int main(int argc, char *argv[]) {
+    while(test_getopt(argc, argv, "v", "test_pid [-v]") != -1)
+        ;
+
+    test_round();
+    test_step();
+    test_windup();
+    test_dt();
+    test_closed_loop();
+    bench();
+
+    return failed;
+}
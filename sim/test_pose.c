@@ -0,0 +1,185 @@
+// Poseのテスト(ホスト用)
+//
+// ../hamapoly/Pose.c に、真の軌跡から作ったエンコーダ値(1deg単位に量子化)とジャイロの角速度(±1deg/sの雑音を加えて1deg/s単位に量子化)を与え、
+// 推定した自己位置が軌跡の終点と一致すること(位置は2mm + 走行距離の0.5%以内、方位は1deg以内)を確かめる
+//  - 直進 : 方位0のまま前方へ進む
+//  - 円弧 : 半径一定で右に1周し、原点・方位0に戻る(左旋回も同様)
+//  - 超信地旋回 : その場で1回転し、位置が動かない
+//  - 滑り : 直進中に片方のタイヤが空転し、エンコーダだけが旋回を示す(ジャイロを優先して方位がずれないこと)
+//  - バイアス : 停止中にジャイロのバイアスを学習し、走行中の方位がずれないこと
+//
+// 使い方 : test_pose [-v]
+// 終了コード : 0 合格, 1 許容値の超過, 2 引数の誤り
+
+#include <math.h>
+#include "test_util.h"
+#include "Pose.h"
+#include "Direction.h"
+#include "WheelSpeed.h"
+
+/* マクロ定義 */
+#define DT              (WHEEL_SPEED_PERIOD / 1000.0)   // measure_taskの周期[s]
+#define MM_PER_DEG      (PI * TIRE_DIAMETER / 360.0)    // タイヤの回転角度1degあたりの走行距離[mm]
+#define POS_LIMIT       2.0         // 位置の誤差の許容値[mm](エンコーダの量子化分)
+#define POS_RATIO       0.005       // 走行距離に比例して加える位置の誤差の許容値
+#define HEADING_LIMIT   1.0         // 方位の誤差の許容値[deg]
+#define GYRO_NOISE      1.0         // ジャイロの雑音の幅[deg/s](一様分布 *雑音が無いと量子化の誤差が一方向に溜まる)
+
+/* 真の状態とセンサー値 */
+static double true_x, true_y, true_heading;     // 真の位置[mm]・方位[deg]
+static double true_path;                        // 真の走行距離[mm]
+static double wheel_left, wheel_right;          // 真のタイヤの回転角度[deg]
+static int32_t count_left, count_right;         // エンコーダ値[deg](前周期)
+static float dist_left, dist_right;             // 1周期分の走行距離[mm](Distance_getDistance4ms*の値)
+static int16_t gyro_rate;                       // ジャイロの角速度[deg/s]
+static double gyro_bias;                        // ジャイロのバイアス[deg/s]
+
+/* Pose.cが使う関数(SensorHub・Distance)の代わり */
+void SensorHub_get(SENSOR_SNAPSHOT *out) {
+    memset(out, 0, sizeof(*out));
+    out->gyro_rate = gyro_rate;
+    out->count_left = count_left;
+    out->count_right = count_right;
+}
+
+float Distance_getDistance4msLeft() {
+    return dist_left;
+}
+
+float Distance_getDistance4msRight() {
+    return dist_right;
+}
+
+static void reset() {
+    true_x = true_y = true_heading = 0.0;
+    true_path = 0.0;
+    wheel_left = wheel_right = 0.0;
+    count_left = count_right = 0;
+    gyro_bias = 0.0;
+    srand(1);
+    Pose_init();
+}
+
+/* 1周期進める(vは車体の速度[mm/s]、yawは旋回速度[deg/s]、slipは左タイヤの空転分の速度[mm/s]) */
+static void step(double v, double yaw, double slip) {
+    double w = yaw * PI / 180.0;
+    double vl = v + w * TREAD / 2.0 + slip;
+    double vr = v - w * TREAD / 2.0;
+    double mid = (true_heading + yaw * DT / 2.0) * PI / 180.0;
+    int32_t cl, cr;
+
+    true_x += v * DT * cos(mid);
+    true_y += v * DT * sin(mid);
+    true_heading += yaw * DT;
+    true_path += fabs(v) * DT;
+
+    wheel_left += vl * DT / MM_PER_DEG;
+    wheel_right += vr * DT / MM_PER_DEG;
+    cl = (int32_t)floor(wheel_left);
+    cr = (int32_t)floor(wheel_right);
+    dist_left = MM_PER_DEG * (cl - count_left);     // Distance_updateと同じ換算
+    dist_right = MM_PER_DEG * (cr - count_right);
+    count_left = cl;
+    count_right = cr;
+    gyro_rate = (int16_t)lround(yaw + gyro_bias + GYRO_NOISE * (2.0 * rand() / RAND_MAX - 1.0));
+
+    Pose_update();
+}
+
+/* 方位の差を-180 ~ +180に収める */
+static double heading_error(double a, double b) {
+    return remainder(a - b, 360.0);
+}
+
+/* 推定値を真の値と比べる(extraは位置の誤差の許容値に加える値[mm]) */
+static void check_pose(const char *name, double extra) {
+    POSE p;
+    double pos, head;
+    double pos_limit = POS_LIMIT + POS_RATIO * true_path + extra;
+
+    Pose_get(&p);
+    pos = hypot(p.x - true_x, p.y - true_y);
+    head = heading_error(p.heading, true_heading);
+    check(name, pos <= pos_limit && fabs(head) <= HEADING_LIMIT,
+          "true (%7.1f, %7.1f, %6.1f) pose (%7.1f, %7.1f, %6.1f) error %5.2f mm (< %4.1f) %+5.2f deg, sigma %5.1f mm %4.2f deg",
+          true_x, true_y, remainder(true_heading, 360.0), p.x, p.y, p.heading, pos, pos_limit, head,
+          sqrt(p.cov[0][0] + p.cov[1][1]), sqrt(p.cov[2][2]));
+}
+
+static void drive(double v, double yaw, double slip, double duration) {
+    double t;
+
+    for(t = 0; t < duration - DT / 2; t += DT)
+    {
+        step(v, yaw, slip);
+        if(verbose)
+        {
+            POSE p;
+
+            Pose_get(&p);
+            printf("#%7.3f %8.2f %8.2f %7.2f  %8.2f %8.2f %7.2f\n", t, true_x, true_y, true_heading, p.x, p.y, p.heading);
+        }
+    }
+}
+
+static void test_straight() {
+    reset();
+    drive(300.0, 0.0, 0.0, 4.0);
+    check_pose("straight", 0.0);
+}
+
+/* 半径500mmの円を速度300mm/sで1周する */
+static void test_arc() {
+    double r = 500.0, v = 300.0;
+    double yaw = v / r * 180.0 / PI;
+
+    reset();
+    drive(v, yaw, 0.0, 2.0 * PI * r / v);
+    check_pose("arc R", 0.0);
+
+    reset();
+    drive(v, -yaw, 0.0, 2.0 * PI * r / v);
+    check_pose("arc L", 0.0);
+
+    reset();                                        // 4分の1周の点(x = r, y = r, 方位90)
+    drive(v, yaw, 0.0, PI * r / 2.0 / v);
+    check_pose("quarter", 0.0);
+}
+
+static void test_spin() {
+    reset();
+    drive(0.0, 90.0, 0.0, 4.0);
+    check_pose("spin", 0.0);
+}
+
+/* 左タイヤが0.5sの間、車体の速度の20%分空転する(エンコーダだけで求めた方位は約11.5deg右にずれる)
+   空転した距離の半分(15mm)は車体の移動距離としてエンコーダに現れるため、位置の許容値に加える */
+static void test_slip() {
+    reset();
+    drive(300.0, 0.0, 0.0, 1.0);
+    drive(300.0, 0.0, 60.0, 0.5);
+    drive(300.0, 0.0, 0.0, 1.0);
+    check_pose("slip", 60.0 * 0.5 / 2.0);
+}
+
+/* 停止中に2deg/sのバイアスを学習してから直進する */
+static void test_bias() {
+    reset();
+    gyro_bias = 2.0;
+    drive(0.0, 0.0, 0.0, 2.0);
+    drive(300.0, 0.0, 0.0, 4.0);
+    check_pose("bias", 0.0);
+}
+
+int main(int argc, char *argv[]) {
+    while(test_getopt(argc, argv, "v", "test_pose [-v]") != -1)
+        ;
+
+    test_straight();
+    test_arc();
+    test_spin();
+    test_slip();
+    test_bias();
+
+    return failed;
+}
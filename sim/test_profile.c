@@ -0,0 +1,144 @@
+// Profileのテスト(ホスト用)
+//
+// ../hamapoly/Profile.c の速度プロファイルを細かい時刻で評価し、次を確かめる
+//  - 終点 : 終了時刻に移動距離ちょうどで速度0になり、終了後も終点に留まること(後退も同様)
+//  - 制限 : 速度・加速度(速度の差分)が最高速度・最大加速度を、各区間の加加速度がジャークを超えないこと
+//           位置・速度が途中で飛ばず、S字では区間の境目で加速度がつながること、位置が行き過ぎて戻らないこと
+//           (加加速度は差分がfloatの時刻・速度の丸め誤差に埋もれるため、PROFILEの区間の値で確かめる)
+//  - 時間 : 最高速度と最大加速度に届く場合の移動時間が d/V + V/A (+ A/J) に一致すること
+//  - 短い移動 : 最高速度(S字では最大加速度も)に届かない場合に、速度を下げて距離ちょうどで止まること
+//  - 台形 : ジャークが0の場合に加速度が 0 と ±A だけになること
+//
+// 使い方 : test_profile [-v]
+// 終了コード : 0 合格, 1 許容値の超過, 2 引数の誤り
+
+#include <math.h>
+#include "test_util.h"
+#include "Profile.h"
+
+/* マクロ定義 */
+#define SAMPLE_DT       1e-3        // 評価する時刻の間隔[s](短いと差分がfloatの丸め誤差に埋もれる)
+#define POS_TOLERANCE   1e-3        // 終点の位置の許容誤差[mm]
+#define LIMIT_MARGIN    1.01        // 制限値に対する許容比(差分による近似と丸め誤差の分)
+#define TIME_TOLERANCE  1e-3        // 移動時間の許容誤差[s]
+
+/* 評価の結果 */
+typedef struct {
+    float   time;           // 移動時間[s]
+    float   end_pos;        // 終了時刻の位置[mm]
+    float   end_vel;        // 終了時刻の速度[mm/s]
+    float   after_pos;      // 終了後の位置[mm]
+    double  max_vel;        // 速度の絶対値の最大[mm/s]
+    double  max_acc;        // 加速度の絶対値の最大[mm/s^2]
+    double  max_jerk;       // 区間の加加速度の絶対値の最大[mm/s^3]
+    double  acc_gap;        // 区間の境目での加速度の食い違いの最大[mm/s^2](台形では不連続)
+    double  max_step;       // 1サンプルでの位置の変化の最大[mm]
+    bool_t  backtrack;      // 位置が進行方向と逆に戻ったか
+    int     acc_levels;     // 加速度が 0, ±A 以外の値をとったサンプル数(台形の確認用)
+} RESULT;
+
+/* プロファイルを評価する */
+static RESULT evaluate(float distance, float speed, float accel, float jerk) {
+    PROFILE p;
+    RESULT r = { 0 };
+    float pos, vel, prev_pos = 0, prev_vel = 0;
+    double acc, t, dt;
+    int n, i;
+
+    Profile_init(&p, distance, speed, accel, jerk);
+    r.time = Profile_getTime(&p);
+
+    for(i = 0; i < PROFILE_SEGMENT_NUM; i++)
+    {
+        dt = p.time[i + 1] - p.time[i];
+        if(fabs(p.jerk[i]) > r.max_jerk)
+            r.max_jerk = fabs(p.jerk[i]);
+        if(fabs(p.acc[i] + p.jerk[i] * dt - p.acc[i + 1]) > r.acc_gap)
+            r.acc_gap = fabs(p.acc[i] + p.jerk[i] * dt - p.acc[i + 1]);
+    }
+
+    for(n = 0, t = 0; t <= r.time; n++, t = n * SAMPLE_DT)
+    {
+        Profile_get(&p, t, &pos, &vel);
+        acc = n > 0 ? (vel - prev_vel) / SAMPLE_DT : 0;
+
+        if(fabs(vel) > r.max_vel)
+            r.max_vel = fabs(vel);
+        if(fabs(acc) > r.max_acc)
+            r.max_acc = fabs(acc);
+        if(n > 0 && fabs(pos - prev_pos) > r.max_step)
+            r.max_step = fabs(pos - prev_pos);
+        if(n > 0 && (pos - prev_pos) * (distance < 0 ? -1 : 1) < -1e-4)
+            r.backtrack = true;
+        if(n > 0 && fabs(acc) > accel * 0.01 && fabs(fabs(acc) - accel) > accel * 0.01)
+            r.acc_levels++;
+
+        prev_pos = pos;
+        prev_vel = vel;
+        if(verbose)
+            printf("#%8.4f %9.3f %8.3f %9.1f\n", t, pos, vel, acc);
+    }
+
+    Profile_get(&p, r.time, &r.end_pos, &r.end_vel);
+    Profile_get(&p, r.time + 1.0, &r.after_pos, &vel);
+    return r;
+}
+
+/* 終点と制限を確かめる 返り値 : 評価の結果 */
+static RESULT check_profile(const char *name, float distance, float speed, float accel, float jerk) {
+    RESULT r = evaluate(distance, speed, accel, jerk);
+    bool_t ended = fabs(r.end_pos - distance) < POS_TOLERANCE && r.end_vel == 0 && r.after_pos == r.end_pos;
+    bool_t limited = r.max_vel <= speed * LIMIT_MARGIN && r.max_acc <= accel * LIMIT_MARGIN && r.max_jerk <= jerk * LIMIT_MARGIN;
+    bool_t smooth = r.max_step <= speed * LIMIT_MARGIN * SAMPLE_DT && !r.backtrack
+                    && (jerk == 0 || r.acc_gap < accel * 1e-3);
+
+    check(name, ended && limited && smooth,
+          "d %6.1f: end %8.3f mm %.3f mm/s in %.3f s, max v %5.1f/%.0f a %5.1f/%.0f j %.0f/%.0f%s",
+          distance, r.end_pos, r.end_vel, r.time, r.max_vel, speed, r.max_acc, accel, r.max_jerk, jerk,
+          smooth ? "" : " (not smooth)");
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    RESULT r;
+    float t, v, a;
+
+    while(test_getopt(argc, argv, "v", "test_profile [-v]") != -1)
+        ;
+
+    /* S字 : 最高速度と最大加速度に届く */
+    r = check_profile("s-curve", 1000, 400, 800, 8000);
+    t = 1000 / 400.0 + 400 / 800.0 + 800 / 8000.0;
+    check("s-curve", fabs(r.time - t) < TIME_TOLERANCE, "time %.4f s (expect d/V + V/A + A/J = %.4f s)", r.time, t);
+    check_profile("s-curve", -1000, 400, 800, 8000);
+
+    /* S字の短い移動 : 最高速度に届かない(等加速あり)、最大加速度にも届かない */
+    r = check_profile("short", 200, 400, 800, 8000);
+    check("short", r.max_vel < 400 * 0.99 && r.max_acc > 800 * 0.99, "peak v %.1f (< 400), peak a %.1f (800)", r.max_vel, r.max_acc);
+    r = check_profile("short", 10, 400, 800, 8000);
+    v = powf(0.5 * 10 * sqrtf(8000), 2.0 / 3.0);            // 2 * v * sqrt(v / J) = d
+    a = sqrtf(v * 8000);
+    check("short", fabs(r.max_vel - v) < v * 0.01 && fabs(r.max_acc - a) < a * 0.02,
+          "peak v %.2f (expect %.2f), peak a %.1f (expect %.1f)", r.max_vel, v, r.max_acc, a);
+    check_profile("short", 0.5, 400, 800, 8000);
+
+    /* S字 : 最大加速度に届く前に最高速度に達する */
+    check_profile("low v", 1000, 50, 800, 8000);
+
+    /* 台形(ジャーク0) */
+    r = check_profile("trapezoid", 1000, 400, 800, 0);
+    t = 1000 / 400.0 + 400 / 800.0;
+    check("trapezoid", fabs(r.time - t) < TIME_TOLERANCE && r.acc_levels <= 4 && r.acc_gap >= 800 * 0.99,
+          "time %.4f s (expect d/V + V/A = %.4f s), %d samples with a not in {0, +-A}, a steps by %.0f",
+          r.time, t, r.acc_levels, r.acc_gap);
+    r = check_profile("trapezoid", 50, 400, 800, 0);       // 三角形 : v = sqrt(A * d)
+    v = sqrtf(800 * 50);
+    check("trapezoid", fabs(r.max_vel - v) < v * 0.01, "triangle peak v %.2f (expect %.2f)", r.max_vel, v);
+    check_profile("trapezoid", -300, 100, 800, 0);
+
+    /* 移動しない */
+    r = evaluate(0, 400, 800, 8000);
+    check("zero", r.time == 0 && r.end_pos == 0 && r.after_pos == 0, "time %.3f s, end %.3f mm", r.time, r.end_pos);
+
+    return failed;
+}
@@ -0,0 +1,259 @@
+// Scriptのテスト(ホスト用)
+//
+// ../tools/coursec.c で変換したスクリプトを ../hamapoly/Script.c で読み込んで実行し、読み込み時の検証を確かめる
+//  - 変換と実行 : テキストのスクリプトを変換して読み込み、ルーチンが書いた順に走行動作の関数を呼ぶこと
+//                 $キー名のオペランドが実行時の(反映済みの)走行パラメータの値になること、左右反転するコースで左右を入れ替えること
+//  - 組み込み : ScriptDefault.txt を変換した結果が ScriptDefault.c の配列と一致すること
+//  - 検証 : CRCの誤り・サイズの誤り(表の数が大きすぎるヘッダを含む)・不明な命令・範囲外や命令の途中への分岐・
+//           オペランドの数を超える参照ビット・分岐命令の参照ビット・範囲外のパラメータ番号・不明な$キー名・
+//           end/jumpで終わらないコードを読み込まずに、組み込みのスクリプトのまま動くこと
+//
+// 使い方 : test_script [-c coursecのパス] [-v]
+// 終了コード : 0 合格, 1 不一致, 2 引数・ファイルの誤り
+
+#include "test_util.h"
+#include "Run.h"
+
+/* マクロ定義 */
+#define DEFAULT_COURSEC     "build/coursec"
+#define SOURCE_FILE         "build/test_script.txt"
+#define BINARY_FILE         "build/test_script.bin"
+#define BROKEN_FILE         "build/test_script_broken.bin"
+#define DEFAULT_SOURCE      "../hamapoly/ScriptDefault.txt"
+#define DEFAULT_BINARY      "build/test_script_default.bin"
+#define TRACE_MAX           1024
+
+/* 変換するスクリプト(命令の位置はtest_validateで使う) */
+static const char source[] =
+    "routine t\n"
+    "    move 10 0 $slalom.shift     # 0\n"
+    "    turn 5 200 -30              # 8\n"
+    "    side_turn right 5 40 -40    # 16\n"
+    "    side_turn left 5 35 -33     # 26\n"
+    "    detect 10 0 3 155           # 36\n"
+    "    wait 200                    # 46\n"
+    "    profile 300 250             # 50\n"
+    "    sample_sonic                # 56\n"
+    "    jump_if skip                # 58\n"
+    "    end 1                       # 62\n"
+    "skip:\n"
+    "    arm_up 30                   # 66\n"
+    "    jump done                   # 70\n"
+    "done:\n"
+    "    end_side 7                  # 74\n"
+    "routine u\n"
+    "    end $slalom.cross           # 78\n";
+
+#define PC_MOVE     0
+#define PC_JUMP_IF  58
+#define PC_END      62
+#define PC_JUMP     70
+
+/* グローバル変数 */
+static const char *coursec = DEFAULT_COURSEC;
+static char trace[TRACE_MAX];               // 呼ばれた走行動作の関数
+static uint8_t binary[SCRIPT_FILE_MAX];     // 変換したスクリプト
+static size_t binary_size;
+
+/* Script.cが使う関数の代わり(呼ばれた順にtraceに記録する) */
+static void record(const char *format, ...) {
+    size_t n = strlen(trace);
+    va_list ap;
+
+    va_start(ap, format);
+    vsnprintf(&trace[n], sizeof(trace) - n, format, ap);
+    va_end(ap);
+}
+
+void motor_ctrl(int8_t power, int16_t turn) { record("drive %d %d;", power, turn); }
+void Run_setDistance(int8_t power, int16_t turn, float distance) { record("move %d %d %g;", power, turn, distance); }
+void Run_setDirection(int8_t power, int16_t turn, float direction) { record("turn %d %d %g;", power, turn, direction); }
+void Run_setDetection(int8_t power, int16_t turn, int16_t detection, float distance) {
+    record("detect %d %d %d %g;", power, turn, detection, distance);
+}
+void Run_setProfile(float distance, float speed) { record("profile %g %g;", distance, speed); }
+void arm_up(uint8_t power, bool_t loop) { record("arm_up %d;", power); }
+void arm_down(uint8_t power, bool_t loop) { record("arm_down %d;", power); }
+void tale_open(uint8_t power, bool_t loop) { record("tail_open %d;", power); }
+void tale_close(uint8_t power, bool_t loop) { record("tail_close %d;", power); }
+int8_t sampling_sonic(void) { record("sample_sonic;"); return 1; }
+ER tslp_tsk(TMO tmout) { record("wait %u;", (unsigned int)(tmout / 1000)); return E_OK; }
+void SensorHub_get(SENSOR_SNAPSHOT *s) { memset(s, 0, sizeof(*s)); }
+void SensorHub_resetGyro() { }
+COLOR_SET ColorClassifier_get(const rgb_raw_t *rgb) { return 0; }
+
+/* CRC-16/CCITT(Script.cと同じ) */
+static uint16_t crc16(const uint8_t *data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    size_t i;
+    int bit;
+
+    for(i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+/* ファイルを読む 返り値 : サイズ */
+static size_t read_file(const char *filename, uint8_t *data, size_t size) {
+    FILE *fp = fopen(filename, "rb");
+
+    if(fp == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", filename);
+        exit(TEST_USAGE);
+    }
+    size = fread(data, 1, size, fp);
+    fclose(fp);
+    return size;
+}
+
+/* coursecでテキストをバイトコードに変換する */
+static void compile(const char *text_file, const char *binary_file) {
+    char command[256];
+
+    snprintf(command, sizeof(command), "%s %s %s > /dev/null", coursec, text_file, binary_file);
+    if(system(command) != 0)
+    {
+        fprintf(stderr, "cannot run %s\n", coursec);
+        exit(TEST_USAGE);
+    }
+}
+
+/* ルーチンを実行し、呼ばれた関数と返り値をtraceに残す */
+static int16_t run(const char *name) {
+    trace[0] = '\0';
+    return Script_run(name);
+}
+
+/* 変換と実行 */
+static void test_run() {
+    static uint8_t default_binary[SCRIPT_FILE_MAX];
+    extern const uint8_t script_default[];
+    extern const uint32_t script_default_size;
+    char expect[TRACE_MAX];
+    const char *name;
+    PARAM_TYPE type;
+    size_t size;
+    FILE *fp;
+    int16_t result;
+    int id;
+
+    if((fp = fopen(SOURCE_FILE, "w")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", SOURCE_FILE);
+        exit(TEST_USAGE);
+    }
+    fputs(source, fp);
+    fclose(fp);
+    compile(SOURCE_FILE, BINARY_FILE);
+    binary_size = read_file(BINARY_FILE, binary, sizeof(binary));
+
+    Param_init();
+    Script_init();
+    check("load", Script_load(BINARY_FILE) == 0, "%s: %zu bytes", BINARY_FILE, binary_size);
+
+    snprintf(expect, sizeof(expect),
+             "move 10 0 105;turn 5 200 -30;turn 5 %s;turn 5 %s;detect 10 0 3 155;wait 200;profile 300 250;"
+             "sample_sonic;arm_up 30;",
+             COURSE_SLALOM_MIRROR ? "-200 -40" : "200 40", COURSE_SLALOM_MIRROR ? "200 35" : "-200 -33");
+    result = run("t");
+    check("run", strcmp(trace, expect) == 0 && result == (COURSE_SLALOM_MIRROR ? -7 : 7), "t returned %d: %s", result, trace);
+    if(verbose && strcmp(trace, expect) != 0)
+        printf("          expect %s\n", expect);
+
+    result = run("u");
+    check("param", result == 175, "u returned %d (slalom.cross 175)", result);
+
+    for(id = 0; id < Param_getNum(); id++)                  // 走行中の変更は反映後に使われる
+        if(Param_getInfo(id, &name, &type) == 0 && strcmp(name, "slalom.shift") == 0)
+            Param_write(id, 200);
+    run("t");
+    check("param", strncmp(trace, "move 10 0 105;", 14) == 0, "written, not committed: %.14s", trace);
+    Param_commit();
+    run("t");
+    check("param", strncmp(trace, "move 10 0 200;", 14) == 0, "committed: %.14s", trace);
+    Param_init();
+
+    compile(DEFAULT_SOURCE, DEFAULT_BINARY);
+    size = read_file(DEFAULT_BINARY, default_binary, sizeof(default_binary));
+    check("default", size == script_default_size && memcmp(default_binary, script_default, size) == 0,
+          "%s: %zu bytes, ScriptDefault.c %u bytes", DEFAULT_SOURCE, size, (unsigned int)script_default_size);
+}
+
+/* 検証 : 変換したスクリプトを1か所変えて読み込む(fix_crcが真ならCRCを付け直す) 返り値 : Script_loadの返り値 */
+static int load_broken(const char *name, size_t pos, uint8_t value, size_t size, bool_t fix_crc) {
+    uint8_t data[SCRIPT_FILE_MAX];
+    uint16_t crc;
+    FILE *fp;
+    int result;
+
+    memcpy(data, binary, binary_size);
+    if(pos < size)
+        data[pos] = value;
+    if(fix_crc)
+    {
+        crc = crc16(&data[SCRIPT_HEADER_SIZE], size - SCRIPT_HEADER_SIZE);
+        data[8] = crc;
+        data[9] = crc >> 8;
+    }
+    if((fp = fopen(BROKEN_FILE, "wb")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", BROKEN_FILE);
+        exit(TEST_USAGE);
+    }
+    fwrite(data, 1, size, fp);
+    fclose(fp);
+
+    Script_init();
+    result = Script_load(BROKEN_FILE);
+    run("shift");                                           // 組み込みのスクリプトのまま動く
+    check(name, result == -1 && strncmp(trace, "turn", 4) == 0, "%s", result == -1 ? "rejected" : "loaded");
+    return result;
+}
+
+static void test_validate() {
+    size_t code = SCRIPT_HEADER_SIZE + binary[3] * (SCRIPT_NAME_MAX + 2) + binary[4] * SCRIPT_PARAM_NAME_MAX;
+    size_t params = SCRIPT_HEADER_SIZE + binary[3] * (SCRIPT_NAME_MAX + 2);
+
+    if(binary_size == 0 || code + PC_MOVE >= binary_size || binary[code + PC_JUMP_IF] != SCRIPT_OP_JUMP_IF)
+    {
+        fprintf(stderr, "unexpected layout of %s\n", BINARY_FILE);
+        exit(TEST_USAGE);
+    }
+
+    load_broken("crc",      code + PC_MOVE + 2, 11, binary_size, false);                    // move 11 ... (CRCはそのまま)
+    load_broken("size",     0, 'C', binary_size - 1, true);                                 // 末尾の1byteが無い
+    load_broken("size",     3, 0xFF, binary_size, true);                                    // ルーチン数255(表がファイルより大きい)
+    load_broken("size",     4, SCRIPT_PARAM_REF_MAX + 1, binary_size, true);
+    load_broken("opcode",   code + PC_END, SCRIPT_OP_NUM, binary_size, true);
+    load_broken("jump",     code + PC_JUMP_IF + 2, binary_size - code, binary_size, true);  // コードの外
+    load_broken("jump",     code + PC_JUMP + 2, PC_MOVE + 2, binary_size, true);            // 命令の途中
+    load_broken("mask",     code + PC_MOVE + 1, 0x0C, binary_size, true);                   // moveのオペランドは3つ
+    load_broken("mask",     code + PC_JUMP_IF + 1, 0x01, binary_size, true);                // 分岐先はパラメータにできない
+    load_broken("param",    code + PC_MOVE + 6, 2, binary_size, true);                      // パラメータ表は2つ
+    load_broken("param",    params + 7, 'X', binary_size, true);                            // slalom.Xhift
+    load_broken("end",      binary_size - 4, SCRIPT_OP_WAIT, binary_size, true);            // 最後のendをwaitに
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+
+    while((opt = test_getopt(argc, argv, "c:v", "test_script [-c coursec] [-v]")) != -1)
+    {
+        if(opt == 'c')
+            coursec = optarg;
+    }
+
+    test_run();
+    test_validate();
+
+    remove(SOURCE_FILE);
+    remove(BINARY_FILE);
+    remove(BROKEN_FILE);
+    remove(DEFAULT_BINARY);
+    return failed;
+}
@@ -0,0 +1,317 @@
+// TelemetryとBtCommandのテスト(ホスト用)
+//
+// ../hamapoly/Telemetry.c のフレームの符号化・送信と、../hamapoly/BtCommand.c のコマンドの組み立て・応答を確かめる
+// (BtCommandの応答はTelemetry_queueを通して送信されるため、Telemetry_sendの出力を読んで確かめる)
+//  - フレーム : 長さが71byte(TELEMETRY_FRAME_MAX以下)で、各値がTelemetry.hの順にリトルエンディアンで並び、CRCが一致すること
+//  - 間引き : telemetry.decimationの周期ごとに1回だけサンプルを積むこと
+//  - 破棄 : バッファが満杯の間は破棄した数を数え、次に積むサンプルにその数が入ること
+//  - 送信キュー : 途中までしか入らないバイト列は何も積まないこと
+//  - コマンド : I/R/W/Cの応答、'W'の値が'C'まで反映されないこと
+//               不明なコマンド・長さの誤り・長すぎるフレーム・チェックサムの誤りに実行せずに応答し、
+//               途中で切れたフレームの後も次の次のフレームから受け付けること
+//
+// 使い方 : test_telemetry [-v]
+// 終了コード : 0 合格, 1 不一致, 2 引数の誤り
+
+#include "test_util.h"
+#include "Run.h"
+#include "BtCommand.h"
+
+/* マクロ定義 */
+#define FRAME_SIZE      71          // サンプルのフレームの長さ[byte](SYNC 種類 長さ データ66 CRC2)
+#define OUTPUT_MAX      8192        // Telemetry_sendの出力を受け取るバッファ[byte]
+
+/* グローバル変数 */
+static SENSOR_SNAPSHOT snapshot;        // SensorHub_getが返す値
+static uint8_t output[OUTPUT_MAX];      // Telemetry_sendの出力
+static size_t output_size;
+
+/* Telemetry.c, BtCommand.c, Param.cが使う関数の代わり */
+void SensorHub_get(SENSOR_SNAPSHOT *s) { *s = snapshot; }
+float Pose_getX() { return 123.5f; }
+float Pose_getY() { return -45.25f; }
+float Pose_getHeading() { return 1.5f; }
+int8_t Motion_getPower() { return -80; }
+int16_t Motion_getTurn() { return -300; }
+void Run_PID_getTerms(int32_t *error, q16_t *p, q16_t *i, q16_t *d) {
+    *error = -12;
+    *p = 0x00018000;
+    *i = -0x00004000;
+    *d = 0x7fffffff;
+}
+ER tslp_tsk(TMO tmout) { return E_OK; }  // measure_taskは動いていない(Param_commitが自分で反映する)
+
+/* Telemetry_sendの出力をoutputに受け取る */
+static void send() {
+    FILE *fp = tmpfile();
+
+    Telemetry_send(fp);
+    rewind(fp);
+    output_size = fread(output, 1, sizeof(output), fp);
+    fclose(fp);
+}
+
+/* CRC-16/CCITT(初期値0xFFFF、Telemetry.cと同じ定義で、既知の値で確かめてから使う) */
+static uint16_t crc16(const uint8_t *data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    size_t i;
+    int bit;
+
+    for(i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+static uint32_t get_u16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t get_u32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static float get_float(const uint8_t *p) {
+    uint32_t bits = get_u32(p);
+    float value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* 走行パラメータを1つ書き込んで反映する */
+static void set_param(const char *key, int32_t value) {
+    const char *name;
+    PARAM_TYPE type;
+    uint32_t bits;
+    int id;
+
+    memcpy(&bits, &value, sizeof(bits));
+    for(id = 0; id < Param_getNum(); id++)
+        if(Param_getInfo(id, &name, &type) == 0 && strcmp(name, key) == 0)
+            Param_write(id, bits);
+    Param_commit();
+}
+
+/* サンプルを積む回数だけTelemetry_updateを呼ぶ(間引きは1) */
+static void push(int n) {
+    while(n-- > 0)
+    {
+        snapshot.tick++;
+        Telemetry_update();
+    }
+}
+
+/* フレームの符号化 */
+static void test_frame() {
+    const uint8_t *f = output, *d = &output[4];
+    bool_t ok;
+
+    check("crc", crc16((const uint8_t *)"123456789", 9) == 0x29b1, "\"123456789\" 0x%04x (expect 0x29b1)",
+          crc16((const uint8_t *)"123456789", 9));
+
+    Param_init();
+    set_param("telemetry.decimation", 1);
+    Telemetry_init();
+    Telemetry_setState(TELEMETRY_SECTION_SLALOM, 7);
+    snapshot = (SENSOR_SNAPSHOT){ .time = 0x12345678, .tick = 0xa0b0c0d0 - 1, .rgb = { 300, 200, 100 }, .sonar = 25,
+                                  .gyro_angle = -90, .gyro_rate = 400, .count_left = -100000, .count_right = 100000 };
+    push(1);
+    send();
+
+    check("frame", output_size == FRAME_SIZE && FRAME_SIZE <= TELEMETRY_FRAME_MAX, "%zu bytes (expect %d, max %d)",
+          output_size, FRAME_SIZE, TELEMETRY_FRAME_MAX);
+    if(output_size != FRAME_SIZE)
+        return;
+    check("frame", f[0] == 0xA5 && f[1] == TELEMETRY_FRAME_TYPE && f[2] == FRAME_SIZE - 5 && f[3] == TELEMETRY_VERSION,
+          "sync 0x%02x type 0x%02x length %d version %d", f[0], f[1], f[2], f[3]);
+    check("frame", get_u16(&f[FRAME_SIZE - 2]) == crc16(&f[1], FRAME_SIZE - 3), "crc 0x%04x (expect 0x%04x)",
+          get_u16(&f[FRAME_SIZE - 2]), crc16(&f[1], FRAME_SIZE - 3));
+
+    ok = get_u32(&d[0]) == 0xa0b0c0d0 && get_u32(&d[4]) == 0x12345678
+         && get_u16(&d[8]) == 300 && get_u16(&d[10]) == 200 && get_u16(&d[12]) == 100 && get_u16(&d[14]) == 25
+         && (int16_t)get_u16(&d[16]) == -90 && (int16_t)get_u16(&d[18]) == 400
+         && (int32_t)get_u32(&d[20]) == -100000 && (int32_t)get_u32(&d[24]) == 100000
+         && get_float(&d[28]) == 123.5f && get_float(&d[32]) == -45.25f && get_float(&d[36]) == 1.5f
+         && (int32_t)get_u32(&d[40]) == -12 && get_u32(&d[44]) == 0x00018000 && (int32_t)get_u32(&d[48]) == -0x00004000
+         && get_u32(&d[52]) == 0x7fffffff && (int8_t)d[56] == -80 && (int16_t)get_u16(&d[57]) == -300
+         && d[59] == TELEMETRY_SECTION_SLALOM && d[60] == 7 && get_u32(&d[61]) == 0;
+    check("fields", ok, "tick 0x%08x time 0x%08x rgb %u %u %u sonar %u gyro %d %d count %d %d pose %.2f %.2f %.2f",
+          get_u32(&d[0]), get_u32(&d[4]), get_u16(&d[8]), get_u16(&d[10]), get_u16(&d[12]), get_u16(&d[14]),
+          (int16_t)get_u16(&d[16]), (int16_t)get_u16(&d[18]), (int32_t)get_u32(&d[20]), (int32_t)get_u32(&d[24]),
+          get_float(&d[28]), get_float(&d[32]), get_float(&d[36]));
+}
+
+/* 間引き・破棄・送信キュー */
+static void test_buffer() {
+    static uint8_t bytes[TELEMETRY_QUEUE_SIZE + 1];
+    size_t total = 0;
+    bool_t full, over, after;
+    int i;
+
+    Param_init();
+    set_param("telemetry.decimation", 10);
+    Telemetry_init();
+    for(i = 0; i < 25; i++)
+        Telemetry_update();
+    send();
+    check("decimate", output_size == 2 * FRAME_SIZE, "25 periods at decimation 10: %zu frames (expect 2)", output_size / FRAME_SIZE);
+
+    set_param("telemetry.decimation", 1);
+    Telemetry_init();
+    push(TELEMETRY_BUFFER_SIZE + 5);
+    send();
+    check("drop", Telemetry_getDropped() == 5 && output_size == 8 * FRAME_SIZE,
+          "%d samples into %d: dropped %u (expect 5), first send %zu frames (expect 8)",
+          TELEMETRY_BUFFER_SIZE + 5, TELEMETRY_BUFFER_SIZE, Telemetry_getDropped(), output_size / FRAME_SIZE);
+    for(total = output_size; output_size > 0; total += output_size)
+        send();
+    push(1);
+    send();
+    check("drop", total == TELEMETRY_BUFFER_SIZE * FRAME_SIZE && output_size == FRAME_SIZE && get_u32(&output[4 + 61]) == 5,
+          "%zu frames sent, next frame carries dropped %u (expect 5)", total / FRAME_SIZE, get_u32(&output[4 + 61]));
+
+    Telemetry_init();
+    over = Telemetry_queue(bytes, TELEMETRY_QUEUE_SIZE + 1);
+    full = Telemetry_queue(bytes, TELEMETRY_QUEUE_SIZE);
+    after = Telemetry_queue(bytes, 1);
+    send();
+    check("queue", !over && full && !after && output_size == TELEMETRY_QUEUE_SIZE,
+          "%d bytes %s, %d bytes %s, then 1 byte %s, %zu bytes sent", TELEMETRY_QUEUE_SIZE + 1, over ? "queued" : "refused",
+          TELEMETRY_QUEUE_SIZE, full ? "queued" : "refused", after ? "queued" : "refused", output_size);
+}
+
+/* コマンドを送る(チェックサムにbad_sumを足す、cutが0より大きい場合は先頭のcut byteだけ送る) 返り値 : コマンドとして処理したバイト数 */
+static int command(uint8_t cmd, const uint8_t *data, int len, int bad_sum, int cut) {
+    uint8_t frame[BT_COMMAND_DATA_MAX + 8];
+    uint8_t sum = cmd + len;
+    int i, n = 0, size = len + 4;
+
+    frame[0] = BT_COMMAND_SYNC;
+    frame[1] = cmd;
+    frame[2] = len;
+    for(i = 0; i < len; i++)
+        sum += frame[3 + i] = data[i];
+    frame[3 + len] = sum + bad_sum;
+    if(cut > 0)
+        size = cut;
+
+    for(i = 0; i < size; i++)
+        n += BtCommand_put(frame[i]);
+    return n;
+}
+
+/* 応答を1つ読む 返り値 : 結果(BT_STATUS_*)、応答が無い・形式の誤りは-1 */
+static int reply(size_t *pos, uint8_t cmd, const uint8_t **data, int *len) {
+    const uint8_t *r = &output[*pos];
+    uint8_t sum = 0;
+    int i;
+
+    if(*pos + 4 > output_size || r[0] != BT_COMMAND_SYNC || r[1] != (cmd | 0x80) || *pos + r[2] + 4 > output_size)
+        return -1;
+    for(i = 1; i < r[2] + 3; i++)
+        sum += r[i];
+    if(sum != r[r[2] + 3])
+        return -1;
+
+    *data = &r[3];
+    *len = r[2];
+    *pos += r[2] + 4;
+    return r[3];
+}
+
+/* コマンドを送り、応答を1つ読む */
+static int transact(uint8_t cmd, const uint8_t *data, int len, const uint8_t **out, int *out_len) {
+    size_t pos = 0;
+
+    command(cmd, data, len, 0, 0);
+    send();
+    return reply(&pos, cmd, out, out_len);
+}
+
+static void test_command() {
+    static const uint8_t long_data[BT_COMMAND_DATA_MAX + 1];
+    const uint8_t *r;
+    uint8_t w[5] = { 0, 60, 0, 0, 0 };
+    uint8_t id = 0;
+    size_t pos;
+    uint32_t value, version;
+    int status, len, n;
+
+    Param_init();
+    Telemetry_init();
+    BtCommand_init();
+
+    n = BtCommand_put('1');
+    check("sync", n == 0, "'1' outside a frame: %s", n ? "taken as a command" : "passed through");
+
+    status = transact('I', &id, 1, &r, &len);
+    check("info", status == BT_STATUS_OK && len == 3 + 10 && r[1] == 0 && r[2] == PARAM_INT && memcmp(&r[3], "line.power", 10) == 0,
+          "id 0: status %d, %d bytes, type %d", status, len, status >= 0 ? r[2] : -1);
+
+    status = transact('R', &id, 1, &r, &len);
+    check("read", status == BT_STATUS_OK && len == 6 && get_u32(&r[2]) == 100, "id 0: status %d, value %d",
+          status, status >= 0 ? (int32_t)get_u32(&r[2]) : -1);
+
+    version = Param_getVersion();
+    status = transact('W', w, 5, &r, &len);
+    Param_read(0, &value);
+    check("write", status == BT_STATUS_OK && len == 2 && value == 60 && Param_get()->line_power == 100,
+          "id 0 = 60: status %d, pending %d, applied %d", status, (int32_t)value, Param_get()->line_power);
+
+    status = transact('C', NULL, 0, &r, &len);
+    check("commit", status == BT_STATUS_OK && len == 5 && get_u32(&r[1]) == version + 1 && Param_get()->line_power == 60,
+          "status %d, version %u, applied %d", status, status >= 0 ? get_u32(&r[1]) : 0, Param_get()->line_power);
+
+    /* 不正なコマンド(値は変わらず、応答の結果で知らせる) */
+    w[0] = Param_getNum();
+    status = transact('W', w, 5, &r, &len);
+    check("bad id", status == BT_STATUS_BAD_ID, "write id %d: status %d", w[0], status);
+    w[0] = 0;
+    w[1] = 101;
+    status = transact('W', w, 5, &r, &len);
+    check("bad value", status == BT_STATUS_BAD_VALUE, "write 101 to line.power: status %d", status);
+    status = transact('R', w, 2, &r, &len);
+    check("bad len", status == BT_STATUS_BAD_CMD, "read with 2 bytes: status %d", status);
+    status = transact('X', &id, 1, &r, &len);
+    check("bad cmd", status == BT_STATUS_BAD_CMD && len == 1, "unknown command: status %d", status);
+
+    pos = 0;
+    command('W', w, 5, 1, 0);
+    send();
+    status = reply(&pos, 'W', &r, &len);
+    Param_read(0, &value);
+    check("bad sum", status == BT_STATUS_BAD_SUM && value == 60, "write with a wrong checksum: status %d, pending %d",
+          status, (int32_t)value);
+
+    pos = 0;
+    command('R', long_data, BT_COMMAND_DATA_MAX + 1, 0, 3);             // 長さを受け取った時点で捨てる
+    command('R', &id, 1, 0, 0);
+    send();
+    status = reply(&pos, 'R', &r, &len);
+    check("too long", status == BT_STATUS_BAD_CMD && reply(&pos, 'R', &r, &len) == BT_STATUS_OK && pos == output_size,
+          "length %d: status %d, next frame answered", BT_COMMAND_DATA_MAX + 1, status);
+
+    /* 途中で切れたフレーム : 次のフレームはデータとして読まれてチェックサムの誤りになり、次の次から受け付ける */
+    pos = 0;
+    w[1] = 50;
+    command('W', w, 5, 0, 5);
+    command('R', &id, 1, 0, 0);
+    command('R', &id, 1, 0, 0);
+    send();
+    status = reply(&pos, 'W', &r, &len);
+    Param_read(0, &value);
+    check("truncate", status == BT_STATUS_BAD_SUM && value == 60, "write cut after 5 bytes: status %d, pending %d",
+          status, (int32_t)value);
+    status = reply(&pos, 'R', &r, &len);
+    check("truncate", status == BT_STATUS_OK && pos == output_size, "third frame: status %d", status);
+}
+
+int main(int argc, char *argv[]) {
+    while(test_getopt(argc, argv, "v", "test_telemetry [-v]") != -1)
+        ;
+
+    test_frame();
+    test_buffer();
+    test_command();
+
+    return failed;
+}
@@ -0,0 +1,58 @@
+#ifndef _TEST_UTIL_H_
+#define _TEST_UTIL_H_
+
+// モジュール単体のテスト(test_*.c)で共通に使う変数・関数
+//
+// 各テストは1つのソースファイルと対象のモジュールだけをリンクするため、ヘッダーにstaticで定義する
+// 結果は1項目1行で "項目名 内容" を表示し、許容値を超えた項目は末尾に "  NG" を付けて終了コードを1にする
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <time.h>
+#include "ev3api.h"
+
+/* 終了コード */
+#define TEST_PASS       0           // 合格
+#define TEST_FAIL       1           // 許容値の超過・不一致
+#define TEST_USAGE      2           // 引数・ファイルの誤り
+
+/* グローバル変数 */
+static bool_t verbose = false;      // -v : 途中経過を表示する
+static int failed = TEST_PASS;      // mainの返り値(checkで不合格になると TEST_FAIL)
+
+/* 結果を1行表示する(okがfalseの場合は "  NG" を付け、不合格にする) */
+static void check(const char *name, bool_t ok, const char *format, ...) {
+    va_list ap;
+
+    printf("%-9s ", name);
+    va_start(ap, format);
+    vprintf(format, ap);
+    va_end(ap);
+    printf("%s\n", ok ? "" : "  NG");
+    if(!ok)
+        failed = TEST_FAIL;
+}
+
+/* 2つの時刻の差[ns] */
+static double elapsed_ns(const struct timespec *t0, const struct timespec *t1) {
+    return (t1->tv_sec - t0->tv_sec) * 1e9 + (t1->tv_nsec - t0->tv_nsec);
+}
+
+/* getoptと同じく次のオプションを返す(-vはここで処理し、不明なオプションは使い方を表示して終了する)
+   optstringには"v"を含めること、usageはテスト名以降の使い方 */
+static int test_getopt(int argc, char *argv[], const char *optstring, const char *usage) {
+    int opt;
+
+    while((opt = getopt(argc, argv, optstring)) == 'v')
+        verbose = true;
+    if(opt == '?' || opt == ':')
+    {
+        fprintf(stderr, "usage: %s\n", usage);
+        exit(TEST_USAGE);
+    }
+    return opt;
+}
+
+#endif
@@ -0,0 +1,310 @@
+// WheelSpeedのテスト(ホスト用)
+//
+// ../hamapoly/WheelSpeed.c の速度制御を、plant.cと同じ一次遅れのモーターモデル(plant.hの定数)につないで動かし、次を確かめる
+//  - ステップ応答 : 目標速度に立ち上がり、行き過ぎ・定常偏差が許容値に収まること
+//  - 電池電圧・負荷 : 電圧が下がったり負荷が掛かったりしても、積分項で目標速度に戻ること
+//                     (比較のため、フィードフォワードのみの場合の速度も表示する)
+//  - 反転・旋回・停止 : 目標速度の符号の反転、左右で異なる目標速度、停止指示(ブレーキ)に従うこと
+//  - 目標速度の受け渡し : 区間のタスクが目標速度を設定している途中でmeasure_taskが割り込んでも、
+//                         左右の組が食い違わないこと(measure_taskをタイマーのシグナルハンドラで模す)
+//
+// 使い方 : test_wheelspeed [-v]
+// 終了コード : 0 合格, 1 許容値の超過・組の食い違い, 2 引数の誤り
+
+#include <signal.h>
+#include <sys/time.h>
+#include "test_util.h"
+#include "WheelSpeed.h"
+#include "plant.h"
+
+/* マクロ定義 */
+#define STEP_DT         (PLANT_STEP / 1000000.0)    // モーターモデルの積分周期[s]
+#define STEPS_PER_LOOP  (WHEEL_SPEED_PERIOD * 1000 / PLANT_STEP)
+#define SETTLE_TIME     0.5         // 定常偏差を求める区間(各試験の最後)[s]
+#define ERROR_LIMIT     0.02        // 定常偏差の許容値(目標速度に対する割合)
+#define OVERSHOOT_LIMIT 0.25        // 行き過ぎの許容値(目標速度に対する割合 *フィードフォワードに積分項が加わるため15~20%程度になる)
+#define RISE_LIMIT      0.30        // 10%から90%までの立ち上がり時間の許容値[s]
+#define STOP_LIMIT      0.20        // 停止指示から回転速度が5deg/s未満になるまでの時間の許容値[s]
+#define PUBLISH_TICKS   20000       // 受け渡しの試験でmeasure_taskを割り込ませる回数
+#define PUBLISH_PERIOD  100         // 受け渡しの試験で割り込ませる間隔[us]
+
+/* モーター(plant.cのmotor_stepと同じ一次遅れ) */
+typedef struct {
+    double  speed;          // 回転速度[deg/s]
+    double  angle;          // 回転角度[deg]
+    int32_t count;          // 前周期のエンコーダ値[deg]
+    int     power;          // 出力
+    bool_t  stopped;        // 停止中か
+    bool_t  brake;          // ブレーキで停止したか
+} MOTOR;
+
+/* グローバル変数 */
+static MOTOR motor[2];          // [0]左(EV3_PORT_C), [1]右(EV3_PORT_B)
+static double battery = 1.0;    // 電池電圧の割合
+static double load = 0.0;       // 負荷(回転を妨げる向きの出力換算)
+static int16_t angle_loop[2];   // 1周期分の回転角度(Distance_getAngle4ms*の値)
+
+/* WheelSpeed.cが使う関数(ev3api・Distance)の代わり */
+static MOTOR *port_motor(motor_port_t port) {
+    return &motor[port == EV3_PORT_C ? 0 : 1];
+}
+
+ER ev3_motor_set_power(motor_port_t port, int power) {
+    MOTOR *m = port_motor(port);
+
+    m->power = power;
+    m->stopped = false;
+    return E_OK;
+}
+
+ER ev3_motor_stop(motor_port_t port, bool_t brake) {
+    MOTOR *m = port_motor(port);
+
+    m->power = 0;
+    m->stopped = true;
+    m->brake = brake;
+    return E_OK;
+}
+
+int Distance_getAngle4msLeft() {
+    return angle_loop[0];
+}
+
+int Distance_getAngle4msRight() {
+    return angle_loop[1];
+}
+
+/* モーターを1ステップ進める */
+static void motor_step(MOTOR *m) {
+    double power = m->power - (m->speed > 0 ? load : m->speed < 0 ? -load : 0);
+    double target = m->stopped ? 0.0 : power / 100.0 * PLANT_LARGE_SPEED * battery;
+    double tau = !m->stopped ? PLANT_MOTOR_TAU : (m->brake ? PLANT_BRAKE_TAU : PLANT_COAST_TAU);
+
+    m->speed += (target - m->speed) * (STEP_DT / (tau + STEP_DT));
+    m->angle += m->speed * STEP_DT;
+}
+
+/* モーターモデルを1周期進めてから速度制御を行う(measure_task相当) */
+static void loop() {
+    int i, j;
+
+    for(i = 0; i < STEPS_PER_LOOP; i++)
+        for(j = 0; j < 2; j++)
+            motor_step(&motor[j]);
+    for(j = 0; j < 2; j++)
+    {
+        int32_t count = (int32_t)motor[j].angle;
+
+        angle_loop[j] = count - motor[j].count;
+        motor[j].count = count;
+    }
+    WheelSpeed_update();
+}
+
+static void reset(double b) {
+    memset(motor, 0, sizeof(motor));
+    motor[0].stopped = motor[1].stopped = true;
+    battery = b;
+    load = 0.0;
+    WheelSpeed_init();
+}
+
+/* 応答の記録 */
+typedef struct {
+    double  target;         // 目標速度[deg/s]
+    double  start;          // 目標速度を設定したときの速度[deg/s]
+    double  t10, t90;       // 変化量の10%・90%に達した時刻[s](-1は未到達)
+    double  peak;           // 目標速度の向きに最も行き過ぎた速度[deg/s]
+    double  sum;            // 最後のSETTLE_TIMEの速度の合計
+    int     n;
+} RESPONSE;
+
+static void response_start(RESPONSE *r, double target, double speed) {
+    memset(r, 0, sizeof(*r));
+    r->target = target;
+    r->start = speed;
+    r->t10 = r->t90 = -1;
+    r->peak = speed;
+}
+
+static void response_add(RESPONSE *r, double t, double duration, double speed) {
+    double ratio = (speed - r->start) / (r->target - r->start);
+
+    if(r->t10 < 0 && ratio >= 0.1)
+        r->t10 = t;
+    if(r->t90 < 0 && ratio >= 0.9)
+        r->t90 = t;
+    if(r->target > r->start ? speed > r->peak : speed < r->peak)
+        r->peak = speed;
+    if(t >= duration - SETTLE_TIME)
+    {
+        r->sum += speed;
+        r->n++;
+    }
+}
+
+/* 結果を表示して判定する */
+static void response_check(const char *name, const char *side, const RESPONSE *r) {
+    double span = fabs(r->target - r->start);
+    double error = (r->sum / r->n - r->target) / fabs(r->target);
+    double overshoot = (r->target > r->start ? r->peak - r->target : r->target - r->peak) / span;
+    double rise = r->t10 < 0 || r->t90 < 0 ? -1 : r->t90 - r->t10;
+    bool_t ng = fabs(error) > ERROR_LIMIT || overshoot > OVERSHOOT_LIMIT || rise < 0 || rise > RISE_LIMIT;
+
+    check(name, !ng, "%-5s target %5.0f, steady %6.1f (%+5.1f%%), overshoot %4.1f%%, rise %.3f s",
+          side, r->target, r->sum / r->n, error * 100, overshoot * 100, rise);
+}
+
+/* 目標速度を設定してduration[s]動かし、左右の応答を判定する */
+static void run(const char *name, int16_t left, int16_t right, double duration) {
+    RESPONSE r[2];
+    double t;
+    int j;
+
+    WheelSpeed_setTarget(left, right);
+    response_start(&r[0], left, motor[0].speed);
+    response_start(&r[1], right, motor[1].speed);
+    for(t = 0; t < duration; t += WHEEL_SPEED_PERIOD / 1000.0)
+    {
+        loop();
+        for(j = 0; j < 2; j++)
+            response_add(&r[j], t, duration, motor[j].speed);
+        if(verbose)
+            printf("#%-8s %6.3f %7.1f %7.1f %4d %4d\n", name, t, motor[0].speed, motor[1].speed, motor[0].power, motor[1].power);
+    }
+    response_check(name, "left", &r[0]);
+    if(right != left)
+        response_check(name, "right", &r[1]);
+}
+
+/* フィードフォワード項のみの場合の速度[deg/s](WheelSpeed.cのcontrolと同じ換算) */
+static double open_loop(int16_t target) {
+    int32_t power = (int32_t)target * 100 / WHEEL_SPEED_MAX + 3;
+
+    return power / 100.0 * PLANT_LARGE_SPEED * battery;
+}
+
+static void test_step() {
+    reset(1.0);
+    run("step", 400, 400, 1.5);
+}
+
+static void test_battery() {
+    reset(0.75);
+    printf("battery   open loop (feedforward only) %.0f deg/s at battery 75%%\n", open_loop(400));
+    run("battery", 400, 400, 1.5);
+}
+
+/* 一定速度で走行中に負荷を掛ける(立ち上がりは判定済みのため、負荷を掛けた後の定常偏差だけを見る) */
+static void test_load() {
+    RESPONSE r;
+    double t, dip;
+
+    reset(1.0);
+    WheelSpeed_setTarget(300, 300);
+    for(t = 0; t < 1.0; t += WHEEL_SPEED_PERIOD / 1000.0)
+        loop();
+    response_start(&r, 300, motor[0].speed);
+    dip = motor[0].speed;
+    load = 15;
+    for(t = 0; t < 1.0; t += WHEEL_SPEED_PERIOD / 1000.0)
+    {
+        loop();
+        if(motor[0].speed < dip)
+            dip = motor[0].speed;
+        if(t >= 1.0 - SETTLE_TIME)
+        {
+            r.sum += motor[0].speed;
+            r.n++;
+        }
+    }
+    {
+        double error = (r.sum / r.n - r.target) / r.target;
+        bool_t ng = fabs(error) > ERROR_LIMIT;
+
+        check("load", !ng, "left  target %5.0f, steady %6.1f (%+5.1f%%), dip to %.1f under load 15 (open loop %.0f)",
+              r.target, r.sum / r.n, error * 100, dip, open_loop(300) - 15 / 100.0 * PLANT_LARGE_SPEED);
+    }
+}
+
+static void test_reverse() {
+    reset(1.0);
+    run("forward", 400, 400, 1.5);
+    run("reverse", -400, -400, 1.5);
+}
+
+static void test_turn() {
+    reset(1.0);
+    run("turn", 500, 200, 1.5);
+}
+
+/* 停止指示でブレーキを掛け、回転が止まること */
+static void test_stop() {
+    double t;
+    bool_t ng;
+
+    reset(1.0);
+    WheelSpeed_setTarget(400, 400);
+    for(t = 0; t < 1.0; t += WHEEL_SPEED_PERIOD / 1000.0)
+        loop();
+    WheelSpeed_setTarget(0, 0);
+    for(t = 0; t < 1.0 && (fabs(motor[0].speed) >= 5 || fabs(motor[1].speed) >= 5); t += WHEEL_SPEED_PERIOD / 1000.0)
+        loop();
+
+    ng = t > STOP_LIMIT || !motor[0].stopped || !motor[1].stopped || !motor[0].brake || !motor[1].brake;
+    check("stop", !ng, "stopped in %.3f s, brake %s", t, motor[0].brake && motor[1].brake ? "on" : "off");
+}
+
+/* 目標速度の受け渡し : 左右に同じ目標速度を設定し続け、割り込んだmeasure_taskの出力が左右で一致するか */
+static volatile int ticks;
+static volatile int mismatch;
+
+static void tick(int sig) {
+    loop();
+    if(motor[0].power != motor[1].power)
+        mismatch++;
+    ticks++;
+}
+
+static void test_publish() {
+    struct sigaction action;
+    struct itimerval timer = { { 0, PUBLISH_PERIOD }, { 0, PUBLISH_PERIOD } };
+    struct itimerval off = { { 0, 0 }, { 0, 0 } };
+    uint32_t sets = 0;
+
+    reset(1.0);
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = tick;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &action, NULL);
+
+    ticks = 0;
+    mismatch = 0;
+    setitimer(ITIMER_REAL, &timer, NULL);
+    while(ticks < PUBLISH_TICKS)                    // 区間のタスク相当 : 周期を待たずに目標速度を変え続ける
+    {
+        int16_t v = 200 + sets % 400;
+
+        WheelSpeed_setTarget(v, v);
+        sets++;
+    }
+    setitimer(ITIMER_REAL, &off, NULL);
+
+    check("publish", mismatch == 0, "%d updates during %u target changes, %d updates with left != right", ticks, sets, mismatch);
+}
+
+int main(int argc, char *argv[]) {
+    while(test_getopt(argc, argv, "v", "test_wheelspeed [-v]") != -1)
+        ;
+
+    test_step();
+    test_battery();
+    test_load();
+    test_reverse();
+    test_turn();
+    test_stop();
+    test_publish();
+
+    return failed;
+}
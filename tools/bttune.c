@@ -0,0 +1,287 @@
+/**
+ ******************************************************************************
+ ** ファイル名 : bttune.c
+ **
+ ** 概要 : Bluetooth(シリアルポート)経由で走行中の走行体の走行パラメータを読み書きするホスト(PC)用ツール
+ **
+ ** 注記 : ビルド   gcc -O2 -o bttune bttune.c
+ **        使用方法 bttune /dev/rfcomm0 list                       全パラメータの値を表示
+ **                 bttune /dev/rfcomm0 get line.kp ...             指定したパラメータの値を表示
+ **                 bttune /dev/rfcomm0 set line.kp=0.35 ...        書き込んで、まとめて同じ周期に反映する
+ **        コマンド形式は各走行体アプリの BtCommand.h を参照
+ ******************************************************************************
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+
+#define BT_COMMAND_SYNC     0xA5
+#define BT_COMMAND_DATA_MAX 32
+#define BT_STATUS_OK        0
+
+#define PARAM_MAX           64
+#define TIMEOUT_MS          2000
+
+typedef struct {
+    char    key[BT_COMMAND_DATA_MAX];
+    int     type;   // 0:int32 1:float
+} PARAM_INFO;
+
+static const char *status_name[] = { "ok", "unknown id", "out of range", "checksum error", "bad command" };
+
+static int fd;
+static PARAM_INFO params[PARAM_MAX];
+static int param_num = 0;
+
+/* 1バイト受信する 返り値 : 受信したバイト/-1(タイムアウト) */
+static int get_byte(void)
+{
+    fd_set set;
+    struct timeval tv = { TIMEOUT_MS / 1000, (TIMEOUT_MS % 1000) * 1000 };
+    uint8_t c;
+
+    FD_ZERO(&set);
+    FD_SET(fd, &set);
+    if(select(fd + 1, &set, NULL, NULL, &tv) <= 0 || read(fd, &c, 1) != 1)
+        return -1;
+
+    return c;
+}
+
+/* コマンドを送って応答を待つ 返り値 : 応答のデータ長/-1(失敗) */
+static int transact(uint8_t cmd, const uint8_t *data, uint8_t len, uint8_t *out)
+{
+    uint8_t frame[BT_COMMAND_DATA_MAX + 4];
+    uint8_t sum = cmd + len;
+    int c, i, rlen;
+
+    frame[0] = BT_COMMAND_SYNC;
+    frame[1] = cmd;
+    frame[2] = len;
+    for(i = 0; i < len; i++)
+    {
+        frame[3 + i] = data[i];
+        sum += data[i];
+    }
+    frame[3 + len] = sum;
+    if(write(fd, frame, len + 4) != len + 4)
+        return -1;
+
+    /* 応答のSYNCまで読み飛ばす(エコーバックなど) */
+    while((c = get_byte()) != BT_COMMAND_SYNC)
+    {
+        if(c < 0)
+            return -1;
+    }
+    if((c = get_byte()) != (cmd | 0x80) || (rlen = get_byte()) < 0 || rlen > BT_COMMAND_DATA_MAX)
+        return -1;
+    sum = c + rlen;
+    for(i = 0; i < rlen; i++)
+    {
+        if((c = get_byte()) < 0)
+            return -1;
+        out[i] = c;
+        sum += c;
+    }
+    if(get_byte() != sum)
+        return -1;
+
+    return rlen;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+static const char *status_str(uint8_t status)
+{
+    return status < sizeof(status_name) / sizeof(status_name[0]) ? status_name[status] : "error";
+}
+
+/* パラメータの一覧を取得する */
+static int load_info(void)
+{
+    uint8_t id, out[BT_COMMAND_DATA_MAX];
+    int len;
+
+    for(id = 0; id < PARAM_MAX; id++)
+    {
+        if((len = transact('I', &id, 1, out)) < 1)
+            return -1;
+        if(out[0] != BT_STATUS_OK)
+            break;
+        params[id].type = out[2];
+        memcpy(params[id].key, &out[3], len - 3);
+        params[id].key[len - 3] = '\0';
+    }
+    param_num = id;
+
+    return 0;
+}
+
+static int find(const char *key)
+{
+    int i;
+
+    for(i = 0; i < param_num; i++)
+    {
+        if(strcmp(params[i].key, key) == 0)
+            return i;
+    }
+    fprintf(stderr, "unknown key %s\n", key);
+    return -1;
+}
+
+/* 値を表示する */
+static int show(int id)
+{
+    uint8_t data = id, out[BT_COMMAND_DATA_MAX];
+    uint32_t raw;
+    int32_t i_value;
+    float f_value;
+
+    if(transact('R', &data, 1, out) < 6 || out[0] != BT_STATUS_OK)
+    {
+        fprintf(stderr, "cannot read %s\n", params[id].key);
+        return -1;
+    }
+    raw = get_u32(&out[2]);
+    if(params[id].type == 0)
+    {
+        memcpy(&i_value, &raw, sizeof(i_value));
+        printf("%s = %d\n", params[id].key, (int)i_value);
+    }
+    else
+    {
+        memcpy(&f_value, &raw, sizeof(f_value));
+        printf("%s = %g\n", params[id].key, f_value);
+    }
+
+    return 0;
+}
+
+/* key=value を書き込む(反映はしない) */
+static int set(char *arg)
+{
+    uint8_t data[5], out[BT_COMMAND_DATA_MAX];
+    char *value = strchr(arg, '=');
+    int32_t i_value;
+    float f_value;
+    uint32_t raw;
+    int id;
+
+    if(value == NULL)
+    {
+        fprintf(stderr, "usage: key=value (%s)\n", arg);
+        return -1;
+    }
+    *value++ = '\0';
+    if((id = find(arg)) < 0)
+        return -1;
+
+    data[0] = id;
+    if(params[id].type == 0)
+    {
+        i_value = strtol(value, NULL, 0);
+        memcpy(&raw, &i_value, sizeof(raw));
+    }
+    else
+    {
+        f_value = strtof(value, NULL);
+        memcpy(&raw, &f_value, sizeof(raw));
+    }
+    put_u32(&data[1], raw);
+
+    if(transact('W', data, 5, out) < 1)
+    {
+        fprintf(stderr, "cannot write %s: no response\n", arg);
+        return -1;
+    }
+    if(out[0] != BT_STATUS_OK)
+    {
+        fprintf(stderr, "cannot write %s: %s\n", arg, status_str(out[0]));
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct termios tio;
+    uint8_t out[BT_COMMAND_DATA_MAX];
+    int i, result = 0;
+
+    if(argc < 3 || (strcmp(argv[2], "list") != 0 && argc < 4))
+    {
+        fprintf(stderr, "usage: %s port list|get key...|set key=value...\n", argv[0]);
+        return 1;
+    }
+
+    if((fd = open(argv[1], O_RDWR | O_NOCTTY)) < 0)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    if(tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    if(load_info() != 0)
+    {
+        fprintf(stderr, "no response\n");
+        return 1;
+    }
+
+    if(strcmp(argv[2], "list") == 0)
+    {
+        for(i = 0; i < param_num; i++)
+            result |= show(i);
+    }
+    else if(strcmp(argv[2], "get") == 0)
+    {
+        for(i = 3; i < argc; i++)
+            result |= (find(argv[i]) < 0) ? -1 : show(find(argv[i]));
+    }
+    else if(strcmp(argv[2], "set") == 0)
+    {
+        for(i = 3; i < argc && result == 0; i++)
+            result |= set(argv[i]);
+
+        if(result == 0)     // 全て書き込めた場合だけ反映する
+        {
+            if(transact('C', NULL, 0, out) < 5 || out[0] != BT_STATUS_OK)
+            {
+                fprintf(stderr, "cannot commit\n");
+                return 1;
+            }
+            printf("committed (version %u)\n", (unsigned)get_u32(&out[1]));
+        }
+    }
+    else
+    {
+        fprintf(stderr, "unknown command %s\n", argv[2]);
+        return 1;
+    }
+
+    close(fd);
+
+    return result ? 1 : 0;
+}
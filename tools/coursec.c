@@ -0,0 +1,541 @@
+/**
+ ******************************************************************************
+ ** ファイル名 : coursec.c
+ **
+ ** 概要 : コーススクリプト(テキスト)を走行体のバイトコード(Script_*.bin)に変換するホスト(PC)用ツール
+ **
+ ** 注記 : ビルド   gcc -O2 -o coursec coursec.c -lm
+ **        使用方法 coursec Script.txt Script_R.bin          (SDカードに置くファイルを出力)
+ **                 coursec -c Script.txt ScriptDefault.c    (走行体に組み込むスクリプトをC言語の配列で出力)
+ **        ファイル形式は各走行体アプリの Script.h を参照
+ **
+ ** 書式 : 1行に1命令、'#'以降はコメント
+ **        routine 名前         ルーチンの開始(Script_runで名前を指定して実行する)
+ **        ラベル:              分岐先(ファイル全体で一意の名前)
+ **        命令 オペランド...   数値の代わりに $キー名 と書くと、実行時に走行パラメータの値を使う
+ **
+ **        end 値                           ルーチンを終了して値を返す
+ **        end_side 値                      左右反転するコース(COURSE_SLALOM_MIRROR)では符号を反転して返す
+ **        drive 出力 旋回量                motor_ctrl(走行を続けたまま次の命令へ進む)
+ **        move 出力 旋回量 距離            Run_setDistance
+ **        turn 出力 旋回量 方位            Run_setDirection
+ **        side_turn right|left 出力 右旋回の方位 左旋回の方位
+ **                                         Rコース基準の左右で旋回する(反転するコースでは左右を入れ替える)
+ **        detect 出力 旋回量 検知距離 距離 Run_setDetection
+ **        wait 時間[ms]                    待機
+ **        until_color 色                   指定の色を検知するまで走行を続けて停止する(black blue green yellow red white)
+ **        until_tilt 出力 旋回量 閾値[deg] ジャイロをリセットし、傾きが閾値以上になるまで走行する(0.1deg単位)
+ **        arm_up 出力 / arm_down 出力 / tail_open 出力 / tail_close 出力
+ **        sample_sonic                     sampling_sonicの結果を条件フラグに設定する
+ **        jump_if ラベル                   条件フラグが立っていれば分岐する
+ **        jump ラベル                      分岐する
+ **        profile 距離 最高速度[mm/s]      Run_setProfile(終点の手前から減速して停止する)
+ **
+ **        出力・旋回量・距離などの範囲、ラベル、ルーチンの終端(end/jumpで終わること)は変換時に検証する
+ ******************************************************************************
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+/* Script.hと合わせる */
+#define SCRIPT_VERSION          1
+#define SCRIPT_FILE_MAX         2048
+#define SCRIPT_HEADER_SIZE      10
+#define SCRIPT_NAME_MAX         12
+#define SCRIPT_PARAM_NAME_MAX   24
+#define SCRIPT_PARAM_REF_MAX    16
+#define SCRIPT_OPERAND_MAX      4
+
+#define ROUTINE_MAX     32
+#define LABEL_MAX       128
+#define LABEL_NAME_MAX  32
+#define LINE_MAX_LEN    256
+
+/* オペランドの種類 */
+typedef enum {
+    ARG_NONE,
+    ARG_VALUE,      // 範囲付きの整数(またはパラメータ参照)
+    ARG_SIDE,       // right/left
+    ARG_COLOR,      // 色の名前
+    ARG_TILT,       // 角度[deg](0.1deg単位に変換)
+    ARG_LABEL       // 分岐先
+} ARG_KIND;
+
+typedef struct {
+    ARG_KIND    kind;
+    int32_t     min;
+    int32_t     max;
+} ARG;
+
+/* 命令(Script.hのSCRIPT_OP_*の順) */
+typedef struct {
+    const char  *name;
+    int         terminal;       // 1 : 次の命令へ進まない
+    ARG         arg[SCRIPT_OPERAND_MAX];
+} OP;
+
+#define VALUE(lo, hi)   { .kind = ARG_VALUE, .min = (lo), .max = (hi) }
+#define POWER           VALUE(-100, 100)
+#define TURN            VALUE(-200, 200)
+#define ANY             VALUE(-32768, 32767)
+#define DIRECTION       VALUE(-720, 720)
+#define SIDE            { .kind = ARG_SIDE }
+#define COLOR           { .kind = ARG_COLOR }
+#define TILT            { .kind = ARG_TILT, .min = 1, .max = 900 }
+#define TARGET          { .kind = ARG_LABEL }
+
+static const OP ops[] = {
+    { "end",          1, { ANY } },
+    { "end_side",     1, { ANY } },
+    { "drive",        0, { POWER, TURN } },
+    { "move",         0, { POWER, TURN, VALUE(-10000, 10000) } },
+    { "turn",         0, { POWER, TURN, DIRECTION } },
+    { "side_turn",    0, { SIDE, POWER, DIRECTION, DIRECTION } },
+    { "detect",       0, { POWER, TURN, VALUE(0, 255), VALUE(0, 10000) } },
+    { "wait",         0, { VALUE(0, 30000) } },
+    { "until_color",  0, { COLOR } },
+    { "until_tilt",   0, { POWER, TURN, TILT } },
+    { "arm_up",       0, { VALUE(0, 100) } },
+    { "arm_down",     0, { VALUE(0, 100) } },
+    { "tail_open",    0, { VALUE(0, 100) } },
+    { "tail_close",   0, { VALUE(0, 100) } },
+    { "sample_sonic", 0, { { .kind = ARG_NONE } } },
+    { "jump_if",      0, { TARGET } },
+    { "jump",         1, { TARGET } },
+    { "profile",      0, { VALUE(-10000, 10000), VALUE(1, 700) } },
+};
+#define OP_NUM  ((int)(sizeof(ops) / sizeof(ops[0])))
+
+/* 色(ev3api.hのcolorid_tと合わせる) */
+static const char *colors[] = { "none", "black", "blue", "green", "yellow", "red", "white", "brown" };
+#define COLOR_NUM   ((int)(sizeof(colors) / sizeof(colors[0])))
+
+/* ルーチン */
+typedef struct {
+    char        name[SCRIPT_NAME_MAX + 1];
+    uint16_t    offset;
+} ROUTINE;
+
+/* ラベル(定義と参照) */
+typedef struct {
+    char        name[LABEL_NAME_MAX];
+    int32_t     offset;         // 定義の位置(-1 : 未定義)
+    int         line;
+} LABEL;
+
+/* 分岐先の参照(全て読み終えてから埋める) */
+typedef struct {
+    int         label;
+    uint16_t    pos;            // オペランドの位置
+    int         line;
+} FIXUP;
+
+static ROUTINE routines[ROUTINE_MAX];
+static int routine_num = 0;
+static char params[SCRIPT_PARAM_REF_MAX][SCRIPT_PARAM_NAME_MAX + 1];
+static int param_num = 0;
+static LABEL labels[LABEL_MAX];
+static int label_num = 0;
+static FIXUP fixups[LABEL_MAX];
+static int fixup_num = 0;
+
+static uint8_t code[SCRIPT_FILE_MAX];
+static uint32_t code_size = 0;
+
+static const char *source;
+static int errors = 0;
+
+static void error(int line, const char *message, const char *detail)
+{
+    fprintf(stderr, "%s:%d: error: %s%s%s\n", source, line, message, detail ? " : " : "", detail ? detail : "");
+    ++errors;
+}
+
+static void warning(int line, const char *message)
+{
+    fprintf(stderr, "%s:%d: warning: %s\n", source, line, message);
+}
+
+/* CRC-16/CCITT(Script.cと同じ) */
+static uint16_t crc16(const uint8_t *data, uint32_t size)
+{
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+    int bit;
+
+    for(i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+static void put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+}
+
+/* ラベルを探す(無ければ未定義として追加) 返り値 : 番号/-1(多すぎる) */
+static int find_label(const char *name, int line)
+{
+    int i;
+
+    for(i = 0; i < label_num; i++)
+    {
+        if(strcmp(labels[i].name, name) == 0)
+            return i;
+    }
+    if(label_num == LABEL_MAX || strlen(name) >= LABEL_NAME_MAX)
+    {
+        error(line, "too many labels or label too long", name);
+        return -1;
+    }
+    strcpy(labels[label_num].name, name);
+    labels[label_num].offset = -1;
+    labels[label_num].line = line;
+
+    return label_num++;
+}
+
+/* パラメータ表の番号を取得(無ければ追加) 返り値 : 番号/-1(多すぎる) */
+static int find_param(const char *key, int line)
+{
+    int i;
+
+    for(i = 0; i < param_num; i++)
+    {
+        if(strcmp(params[i], key) == 0)
+            return i;
+    }
+    if(param_num == SCRIPT_PARAM_REF_MAX || strlen(key) > SCRIPT_PARAM_NAME_MAX)
+    {
+        error(line, "too many parameters or key too long", key);
+        return -1;
+    }
+    strcpy(params[param_num], key);
+
+    return param_num++;
+}
+
+/* オペランドを1つ変換する 返り値 : 0(成功)/-1(エラー) */
+static int operand(const ARG *arg, const char *text, int line, int16_t *value, int *is_param)
+{
+    char *end;
+    long n;
+    double deg;
+    int i;
+
+    *is_param = 0;
+
+    switch(arg->kind)
+    {
+        case ARG_VALUE:
+            if(text[0] == '$')                  // 走行パラメータの参照(範囲は走行体のParam.cで検証済み)
+            {
+                if((i = find_param(text + 1, line)) < 0)
+                    return -1;
+                *value = i;
+                *is_param = 1;
+                return 0;
+            }
+            n = strtol(text, &end, 0);
+            if(*end != '\0')
+            {
+                error(line, "not a number", text);
+                return -1;
+            }
+            if(n < arg->min || n > arg->max)
+            {
+                error(line, "out of range", text);
+                return -1;
+            }
+            *value = n;
+            return 0;
+
+        case ARG_SIDE:
+            if(strcmp(text, "right") == 0)
+                *value = 1;
+            else if(strcmp(text, "left") == 0)
+                *value = 0;
+            else
+            {
+                error(line, "expected right or left", text);
+                return -1;
+            }
+            return 0;
+
+        case ARG_COLOR:
+            for(i = 1; i < COLOR_NUM; i++)
+            {
+                if(strcmp(text, colors[i]) == 0)
+                {
+                    *value = i;
+                    return 0;
+                }
+            }
+            error(line, "unknown color", text);
+            return -1;
+
+        case ARG_TILT:                          // 走行体で割り算をしないように0.1deg単位の整数にする
+            deg = strtod(text, &end);
+            n = lround(deg * 10);
+            if(*end != '\0' || n < arg->min || n > arg->max)
+            {
+                error(line, "bad angle", text);
+                return -1;
+            }
+            *value = n;
+            return 0;
+
+        case ARG_LABEL:
+            if((i = find_label(text, line)) < 0)
+                return -1;
+            if(fixup_num == LABEL_MAX)
+            {
+                error(line, "too many jumps", NULL);
+                return -1;
+            }
+            fixups[fixup_num].label = i;
+            fixups[fixup_num].pos = code_size + 2;  // 唯一のオペランド
+            fixups[fixup_num].line = line;
+            ++fixup_num;
+            *value = 0;
+            return 0;
+
+        default:
+            return -1;
+    }
+}
+
+/* 1命令を変換する */
+static void instruction(char **token, int count, int line, int *terminal, int *reachable)
+{
+    const OP *op;
+    uint8_t buf[2 + 2 * SCRIPT_OPERAND_MAX];
+    int16_t value;
+    int n, i, is_param;
+
+    for(i = 0; i < OP_NUM && strcmp(ops[i].name, token[0]) != 0; i++)
+        ;
+    if(i == OP_NUM)
+    {
+        error(line, "unknown instruction", token[0]);
+        return;
+    }
+    op = &ops[i];
+
+    for(n = 0; n < SCRIPT_OPERAND_MAX && op->arg[n].kind != ARG_NONE; n++)
+        ;
+    if(count - 1 != n)
+    {
+        error(line, "wrong number of operands for", op->name);
+        return;
+    }
+    if(!*reachable)
+        warning(line, "unreachable instruction");
+    if(code_size + 2 + 2 * n > SCRIPT_FILE_MAX)
+    {
+        error(line, "script too large", NULL);
+        return;
+    }
+
+    buf[0] = i;
+    buf[1] = 0;
+    for(i = 0; i < n; i++)
+    {
+        if(operand(&op->arg[i], token[1 + i], line, &value, &is_param) != 0)
+            return;
+        put_u16(&buf[2 + 2 * i], value);
+        buf[1] |= is_param << i;
+    }
+
+    memcpy(&code[code_size], buf, 2 + 2 * n);
+    code_size += 2 + 2 * n;
+    *terminal = op->terminal;
+    *reachable = !op->terminal;
+}
+
+/* スクリプトを読み込んで変換する */
+static void compile(FILE *in)
+{
+    char text[LINE_MAX_LEN];
+    char *token[1 + SCRIPT_OPERAND_MAX + 1];
+    char *p;
+    int line = 0, count, i;
+    int terminal = 1;       // 直前の命令が次へ進まない(ルーチンの終端として正しい)
+    int reachable = 0;      // 次の命令に到達できる
+    int routine_line = 0;
+
+    while(fgets(text, sizeof(text), in) != NULL)
+    {
+        ++line;
+        if((p = strchr(text, '#')) != NULL)
+            *p = '\0';
+
+        count = 0;
+        for(p = strtok(text, " \t\r\n"); p != NULL && count < (int)(sizeof(token) / sizeof(token[0])); p = strtok(NULL, " \t\r\n"))
+            token[count++] = p;
+        if(count == 0)
+            continue;
+
+        if(strcmp(token[0], "routine") == 0)                    // ルーチンの開始
+        {
+            if(!terminal)
+                error(routine_line, "routine falls through into the next routine", routines[routine_num - 1].name);
+            if(count != 2 || strlen(token[1]) > SCRIPT_NAME_MAX)
+            {
+                error(line, "bad routine name", count > 1 ? token[1] : NULL);
+                continue;
+            }
+            for(i = 0; i < routine_num; i++)
+            {
+                if(strcmp(routines[i].name, token[1]) == 0)
+                    error(line, "duplicate routine", token[1]);
+            }
+            if(routine_num == ROUTINE_MAX)
+            {
+                error(line, "too many routines", NULL);
+                continue;
+            }
+            strcpy(routines[routine_num].name, token[1]);
+            routines[routine_num].offset = code_size;
+            ++routine_num;
+            routine_line = line;
+            terminal = 0;
+            reachable = 1;
+        }
+        else if(count == 1 && token[0][strlen(token[0]) - 1] == ':')    // ラベル
+        {
+            token[0][strlen(token[0]) - 1] = '\0';
+            if((i = find_label(token[0], line)) < 0)
+                continue;
+            if(labels[i].offset >= 0)
+                error(line, "duplicate label", token[0]);
+            labels[i].offset = code_size;
+            labels[i].line = line;
+            reachable = 1;
+        }
+        else if(routine_num == 0)
+            error(line, "instruction outside a routine", token[0]);
+        else
+            instruction(token, count, line, &terminal, &reachable);
+    }
+
+    if(routine_num == 0)
+        error(line, "no routine", NULL);
+    else if(!terminal)
+        error(routine_line, "routine does not end with end/jump", routines[routine_num - 1].name);
+
+    for(i = 0; i < fixup_num; i++)                              // 分岐先を埋める
+    {
+        if(labels[fixups[i].label].offset < 0 || labels[fixups[i].label].offset >= (int32_t)code_size)
+            error(fixups[i].line, "undefined label or label at the end", labels[fixups[i].label].name);
+        else
+            put_u16(&code[fixups[i].pos], labels[fixups[i].label].offset);
+    }
+}
+
+/* ファイルの内容を組み立てる 返り値 : 長さ */
+static uint32_t build(uint8_t *out)
+{
+    uint8_t *p = out + SCRIPT_HEADER_SIZE;
+    uint32_t size;
+    int i;
+
+    for(i = 0; i < routine_num; i++)
+    {
+        memset(p, 0, SCRIPT_NAME_MAX);
+        memcpy(p, routines[i].name, strlen(routines[i].name));
+        put_u16(p + SCRIPT_NAME_MAX, routines[i].offset);
+        p += SCRIPT_NAME_MAX + 2;
+    }
+    for(i = 0; i < param_num; i++)
+    {
+        memset(p, 0, SCRIPT_PARAM_NAME_MAX);
+        memcpy(p, params[i], strlen(params[i]));
+        p += SCRIPT_PARAM_NAME_MAX;
+    }
+    memcpy(p, code, code_size);
+    size = p + code_size - out;
+
+    out[0] = 'C';
+    out[1] = 'S';
+    out[2] = SCRIPT_VERSION;
+    out[3] = routine_num;
+    out[4] = param_num;
+    out[5] = 0;
+    put_u16(&out[6], code_size);
+    put_u16(&out[8], crc16(out + SCRIPT_HEADER_SIZE, size - SCRIPT_HEADER_SIZE));
+
+    return size;
+}
+
+int main(int argc, char *argv[])
+{
+    static uint8_t out[SCRIPT_HEADER_SIZE + ROUTINE_MAX * (SCRIPT_NAME_MAX + 2)
+                       + SCRIPT_PARAM_REF_MAX * SCRIPT_PARAM_NAME_MAX + SCRIPT_FILE_MAX];
+    FILE *in, *fp;
+    uint32_t size, i;
+    int as_c = 0;
+
+    if(argc > 1 && strcmp(argv[1], "-c") == 0)
+    {
+        as_c = 1;
+        argv++;
+        argc--;
+    }
+    if(argc != 3)
+    {
+        fprintf(stderr, "usage: coursec [-c] script.txt output\n");
+        return 1;
+    }
+
+    source = argv[1];
+    if((in = fopen(source, "r")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", source);
+        return 1;
+    }
+    compile(in);
+    fclose(in);
+    if(errors > 0)
+        return 1;
+
+    size = build(out);
+    if(size > SCRIPT_FILE_MAX)
+    {
+        fprintf(stderr, "%s: script is %u bytes (max %d)\n", source, (unsigned)size, SCRIPT_FILE_MAX);
+        return 1;
+    }
+
+    if((fp = fopen(argv[2], as_c ? "w" : "wb")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[2]);
+        return 1;
+    }
+    if(as_c)
+    {
+        fprintf(fp, "// 組み込みのコーススクリプト(%s から tools/coursec -c で生成、直接編集しないこと)\n\n", source);
+        fprintf(fp, "#include \"Script.h\"\n\n");
+        fprintf(fp, "const uint8_t script_default[] = {");
+        for(i = 0; i < size; i++)
+            fprintf(fp, "%s0x%02X,", (i % 16 == 0) ? "\n    " : " ", out[i]);
+        fprintf(fp, "\n};\n\nconst uint32_t script_default_size = sizeof(script_default);\n");
+    }
+    else
+        fwrite(out, 1, size, fp);
+    fclose(fp);
+
+    fprintf(stderr, "%s: %d routines, %d parameters, %u bytes\n", argv[2], routine_num, param_num, (unsigned)size);
+
+    return 0;
+}
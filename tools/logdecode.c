@@ -0,0 +1,258 @@
+/**
+ ******************************************************************************
+ ** ファイル名 : logdecode.c
+ **
+ ** 概要 : 走行体が出力したバイナリログ(Log_*.bin)を、従来のテキストログと同じ列の
+ **        TSV/CSVに変換するホスト(PC)用ツール
+ **
+ ** 注記 : ビルド   gcc -O2 -o logdecode logdecode.c
+ **        使用方法 logdecode [-c] Log_Line.bin [出力ファイル]   (-c でCSV出力、出力ファイル省略時は標準出力)
+ **        TSVは従来のテキストログと同じ桁揃え・単位(Timeの"ms")で出力し、CSVは数値のみを出力する
+ **        バイナリログ形式は各走行体アプリの LogFormat.h を参照
+ ******************************************************************************
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LOG_FORMAT_VERSION  1
+
+#define LOG_KIND_SAMPLE     0
+#define LOG_KIND_STAMP      1
+#define LOG_KIND_END        2
+
+#define FIELD_MAX   32
+#define NAME_MAX    32
+
+typedef struct {
+    char    name[NAME_MAX];
+    int     decimals;
+    int     scale;
+    int32_t value;
+    int         width;      // 出力幅(0は幅指定なし)
+    const char  *unit;      // 値の後に付ける単位
+} FIELD;
+
+/* 従来のテキストログ(fprintf)の書式 TSV出力で項目名が一致する項目に適用する */
+typedef struct {
+    const char  *name;
+    int         width;
+    const char  *unit;
+} TEXT_FORMAT;
+
+static const TEXT_FORMAT text_formats[] = {
+    { "Distance",   8, ""   },
+    { "Direction",  9, ""   },
+    { "Angle",      4, ""   },
+    { "Power",      4, ""   },
+    { "Turn",       4, ""   },
+    { "Time",       6, "ms" },
+};
+
+static FIELD fields[FIELD_MAX];
+static int field_num = 0;
+
+/* varintを読み込む 返り値 : 0(成功)/-1(ファイル終端) */
+static int get_varint(FILE *in, uint32_t *value)
+{
+    int c;
+    int shift = 0;
+
+    *value = 0;
+    do
+    {
+        if((c = fgetc(in)) == EOF || shift > 28)
+            return -1;
+        *value |= (uint32_t)(c & 0x7f) << shift;
+        shift += 7;
+    }
+    while(c & 0x80);
+
+    return 0;
+}
+
+/* zigzag符号化を元に戻す */
+static int32_t unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/* ヘッダを読み込む(textが真なら従来のテキストログの書式を適用する) 返り値 : 0(成功)/-1(失敗) */
+static int read_header(FILE *in, int text)
+{
+    char magic[4];
+    int version, i, j, k, c;
+
+    if(fread(magic, 1, 4, in) != 4 || memcmp(magic, "HLOG", 4) != 0)
+    {
+        fprintf(stderr, "not a binary log file\n");
+        return -1;
+    }
+
+    version = fgetc(in);
+    field_num = fgetc(in);
+    if(version != LOG_FORMAT_VERSION)
+    {
+        fprintf(stderr, "unsupported version %d\n", version);
+        return -1;
+    }
+    if(field_num <= 0 || field_num > FIELD_MAX)
+    {
+        fprintf(stderr, "broken header\n");
+        return -1;
+    }
+
+    for(i = 0; i < field_num; i++)
+    {
+        for(j = 0; (c = fgetc(in)) > 0; j++)
+        {
+            if(j < NAME_MAX - 1)
+                fields[i].name[j] = (char)c;
+        }
+        fields[i].name[j < NAME_MAX ? j : NAME_MAX - 1] = '\0';
+        fields[i].decimals = fgetc(in);
+        fields[i].scale = fgetc(in);
+        fields[i].value = 0;
+        fields[i].width = 0;
+        fields[i].unit = "";
+
+        for(k = 0; text && k < (int)(sizeof(text_formats) / sizeof(text_formats[0])); k++)
+        {
+            if(strcmp(fields[i].name, text_formats[k].name) == 0)
+            {
+                fields[i].width = text_formats[k].width;
+                fields[i].unit = text_formats[k].unit;
+            }
+        }
+
+        if(c < 0 || fields[i].decimals < 0 || fields[i].scale < 0)
+        {
+            fprintf(stderr, "broken header\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* 1項目を表示値に変換して出力する(小数は整数演算で桁を区切り、浮動小数点の除算による誤差を出さない) */
+static void print_field(FILE *out, const FIELD *field)
+{
+    long long value = (long long)field->value * field->scale;
+    long long unit = 1;
+    char text[32];
+    int i;
+
+    if(field->decimals == 0)
+    {
+        fprintf(out, "%*lld%s", field->width, value, field->unit);
+    }
+    else
+    {
+        for(i = 0; i < field->decimals; i++)
+            unit *= 10;
+        snprintf(text, sizeof(text), "%s%lld.%0*lld", value < 0 ? "-" : "",
+                 llabs(value) / unit, field->decimals, llabs(value) % unit);
+        fprintf(out, "%*s%s", field->width, text, field->unit);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *in, *out = stdout;
+    char sep = '\t';
+    char stamp[256];
+    uint32_t v, len;
+    long records = 0;
+    int kind, i, argi = 1;
+
+    if(argi < argc && strcmp(argv[argi], "-c") == 0)
+    {
+        sep = ',';
+        argi++;
+    }
+    if(argi >= argc)
+    {
+        fprintf(stderr, "usage: %s [-c] input.bin [output]\n", argv[0]);
+        return 1;
+    }
+
+    if((in = fopen(argv[argi], "rb")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[argi]);
+        return 1;
+    }
+    if(argi + 1 < argc && (out = fopen(argv[argi + 1], "w")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[argi + 1]);
+        return 1;
+    }
+
+    if(read_header(in, sep == '\t') != 0)
+        return 1;
+
+    for(i = 0; i < field_num; i++)      // 項目名を出力
+        fprintf(out, "%s%c", fields[i].name, i + 1 < field_num ? sep : '\n');
+
+    while(get_varint(in, &v) == 0)
+    {
+        kind = v & 3;
+        if(kind == LOG_KIND_END)        // ファイル終端
+        {
+            if(get_varint(in, &v) == 0 && v > 0)
+                fprintf(stderr, "Log overflow : %lu records\n", (unsigned long)v);
+            break;
+        }
+
+        fields[0].value += unzigzag(v >> 2);
+        for(i = 1; i < field_num; i++)
+        {
+            if(get_varint(in, &v) != 0)
+            {
+                fprintf(stderr, "truncated record\n");
+                goto end;
+            }
+            fields[i].value = (int32_t)((uint32_t)fields[i].value + (uint32_t)unzigzag(v));
+        }
+
+        if(kind == LOG_KIND_STAMP)      // log_stampの文字列は計測値の前に出力
+        {
+            if(get_varint(in, &len) != 0 || len >= sizeof(stamp) || fread(stamp, 1, len, in) != (size_t)len)
+            {
+                fprintf(stderr, "truncated record\n");
+                goto end;
+            }
+            stamp[len] = '\0';
+
+            if(sep == '\t')                        // TSVでは従来のテキストログと同じくそのまま出力
+            {
+                fputs(stamp, out);
+            }
+            else                                    // CSVでは前後の改行・タブを除いてコメント行として出力
+            {
+                while(len > 0 && (stamp[len - 1] == '\n' || stamp[len - 1] == '\t'))
+                    stamp[--len] = '\0';
+                for(i = 0; stamp[i] == '\n' || stamp[i] == '\t'; i++)
+                    ;
+                fprintf(out, "# %s\n", &stamp[i]);
+            }
+        }
+
+        for(i = 0; i < field_num; i++)
+        {
+            print_field(out, &fields[i]);
+            fputc(i + 1 < field_num ? sep : '\n', out);
+        }
+        records++;
+    }
+
+end:
+    fprintf(stderr, "%ld records\n", records);
+    fclose(in);
+    if(out != stdout)
+        fclose(out);
+
+    return 0;
+}
@@ -0,0 +1,543 @@
+/**
+ ******************************************************************************
+ ** ファイル名 : lqrgain.c
+ **
+ ** 概要 : gyroboyの状態フィードバック制御(balance_lqr.c)のゲインを計算し、ヘッダファイル(balance_gain.h)を出力するホスト(PC)用ツール
+ **
+ ** 注記 : ビルド   gcc -O2 -o lqrgain lqrgain.c -lm
+ **        使用方法 lqrgain [オプション] [出力ファイル]   (出力ファイル省略時は標準出力)
+ **                 -d 直径    タイヤの直径[cm]            (既定 5.6、balance.hのWHEEL_DIAMETER)
+ **                 -m 質量    車体の質量[kg]              (既定 0.80)
+ **                 -l 距離    車軸から車体の重心までの距離[m] (既定 0.12、車体の高さのおよそ半分)
+ **                 -b 電圧    電池電圧[V]                 (既定 8.0)
+ **                 -p 周期    制御周期[ms]                (既定 5、balance.hのBALANCE_PERIOD_MS)
+ **                 -q q1,q2,q3,q4,q5  状態の重み(タイヤの角度, 車体の傾き, それぞれの角速度, タイヤの角度の積分)
+ **                 -r 重み    入力(モーターの電圧)の重み
+ **                 -w w1,w2   1周期あたりの外乱の標準偏差(タイヤの角速度, 車体の角速度)[deg/s]
+ **                 -v v1,v2,v3 観測の雑音の標準偏差(エンコーダーの平均[deg], ジャイロの積分[deg], ジャイロ[deg/s])
+ **
+ **        二輪倒立振子の運動方程式(NXTway-GSのモデル、山本 2008)を直立の状態で線形化し、制御周期で離散化(0次ホールド)したモデルについて
+ **         - 最適レギュレータ(LQR)のゲイン
+ **         - 状態を推定するオブザーバ(定常カルマンフィルタ)のゲイン
+ **        を離散時間リカッチ方程式から求める
+ **        状態 : タイヤの角度(床に対する角度), 車体の傾き, それぞれの角速度, タイヤの角度と目標の差の積分
+ **        目標の速度で走るための出力(逆起電力と摩擦を打ち消すフィードフォワード)も出力する
+ **        エンコーダーの速度を数周期の差分で求めると遅れで制御が振動するため、速度はオブザーバで推定する
+ **        モデルの既定値は sim/pendulum.c の物理モデルと合わせてある
+ ******************************************************************************
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#define N           5           // LQRの状態の数(積分を含む)
+#define NX          4           // 物理モデル・オブザーバの状態の数
+#define NY          3           // 観測の数
+#define NMAX        (N + 1)     // 行列の大きさの上限
+
+/* 物理モデルのパラメータ(sim/pendulum.cと合わせる) */
+#define G           9.81
+#define WHEEL_M     0.03        // タイヤ1個の質量[kg]
+#define MOTOR_JM    1e-5        // モーターの慣性モーメント[kgm^2]
+#define MOTOR_RM    6.69        // モーターの抵抗[ohm]
+#define MOTOR_KB    0.468       // 逆起電力定数[Vs/rad]
+#define MOTOR_KT    0.317       // トルク定数[Nm/A]
+#define MOTOR_FM    0.0022      // 車体とモーターの間の摩擦係数
+
+#define RICCATI_MAX 200000      // リカッチ方程式の反復の上限
+#define RICCATI_EPS 1e-10       // 収束の判定(Pの要素の相対変化)
+
+static const char *state_name[N] = { "THETA", "PSI", "THETA_DOT", "PSI_DOT", "THETA_INT" };
+static const char *state_desc[N] = {
+    "wheel angle error (deg)", "body angle (deg)", "wheel speed (deg/s)",
+    "body angular velocity (deg/s)", "integral of the wheel angle error (deg s)" };
+
+/* 観測 y = C x (エンコーダーの平均 = タイヤの角度 - 車体の傾き、ジャイロの積分、ジャイロ) */
+static const double c_obs[NY * NX] = {
+    1.0, -1.0, 0.0, 0.0,
+    0.0,  1.0, 0.0, 0.0,
+    0.0,  0.0, 0.0, 1.0,
+};
+
+/* 行列の積 c = a * b (a : n x m, b : m x l) */
+static void mul(int n, int m, int l, const double *a, const double *b, double *c)
+{
+    int i, j, k;
+
+    for(i = 0; i < n; i++)
+        for(j = 0; j < l; j++)
+        {
+            c[i * l + j] = 0.0;
+            for(k = 0; k < m; k++)
+                c[i * l + j] += a[i * m + k] * b[k * l + j];
+        }
+}
+
+/* 転置 t = a' (a : n x m) */
+static void transpose(int n, int m, const double *a, double *t)
+{
+    int i, j;
+
+    for(i = 0; i < n; i++)
+        for(j = 0; j < m; j++)
+            t[j * n + i] = a[i * m + j];
+}
+
+/* 逆行列 (n x n、ピボット選択付きのガウス・ジョルダン法) 返り値 : 0/-1(正則でない) */
+static int inverse(int n, const double *a, double *inv)
+{
+    double w[NMAX * NMAX], f;
+    int i, j, k, p;
+
+    memcpy(w, a, sizeof(double) * n * n);
+    for(i = 0; i < n * n; i++)
+        inv[i] = (i % (n + 1) == 0) ? 1.0 : 0.0;
+
+    for(k = 0; k < n; k++)
+    {
+        for(p = k, i = k + 1; i < n; i++)
+            if(fabs(w[i * n + k]) > fabs(w[p * n + k]))
+                p = i;
+        if(w[p * n + k] == 0.0)
+            return -1;
+        for(j = 0; j < n; j++)
+        {
+            f = w[k * n + j]; w[k * n + j] = w[p * n + j]; w[p * n + j] = f;
+            f = inv[k * n + j]; inv[k * n + j] = inv[p * n + j]; inv[p * n + j] = f;
+        }
+        f = w[k * n + k];
+        for(j = 0; j < n; j++)
+        {
+            w[k * n + j] /= f;
+            inv[k * n + j] /= f;
+        }
+        for(i = 0; i < n; i++)
+        {
+            if(i == k)
+                continue;
+            f = w[i * n + k];
+            for(j = 0; j < n; j++)
+            {
+                w[i * n + j] -= f * w[k * n + j];
+                inv[i * n + j] -= f * inv[k * n + j];
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* 行列の指数関数 e = exp(a) (n x n、スケーリングと2乗を組み合わせたテイラー展開) */
+static void expm(int n, const double *a, double *e)
+{
+    double s[NMAX * NMAX], term[NMAX * NMAX], tmp[NMAX * NMAX], norm = 0.0, scale = 1.0;
+    int i, k, squaring = 0;
+
+    for(i = 0; i < n * n; i++)
+        norm = fmax(norm, fabs(a[i]) * n);
+    while(norm * scale > 0.5)
+    {
+        scale /= 2;
+        squaring++;
+    }
+
+    for(i = 0; i < n * n; i++)
+    {
+        s[i] = a[i] * scale;
+        e[i] = term[i] = (i % (n + 1) == 0) ? 1.0 : 0.0;
+    }
+    for(k = 1; k <= 20; k++)
+    {
+        mul(n, n, n, term, s, tmp);
+        for(i = 0; i < n * n; i++)
+        {
+            term[i] = tmp[i] / k;
+            e[i] += term[i];
+        }
+    }
+    while(squaring-- > 0)
+    {
+        mul(n, n, n, e, e, tmp);
+        memcpy(e, tmp, sizeof(double) * n * n);
+    }
+}
+
+/* 連続時間のモデル dx/dt = A x + B u を作る(N x N、uは左右のモーターに同じく加える電圧[V]) */
+static void model(double wheel_r, double body_m, double body_l, double *a, double *b)
+{
+    const double n2jm = 2 * MOTOR_JM;
+    const double jw = WHEEL_M * wheel_r * wheel_r / 2;
+    const double jpsi = body_m * body_l * body_l / 3;
+    const double alpha = MOTOR_KT / MOTOR_RM;
+    const double beta = MOTOR_KT * MOTOR_KB / MOTOR_RM + MOTOR_FM;
+
+    /* E [theta'' psi''] + F [theta' psi'] + G [theta psi] = H u */
+    double e11 = (2 * WHEEL_M + body_m) * wheel_r * wheel_r + 2 * jw + n2jm;
+    double e12 = body_m * body_l * wheel_r - n2jm;
+    double e22 = body_m * body_l * body_l + jpsi + n2jm;
+    double det = e11 * e22 - e12 * e12;
+    double ei[2][2] = { { e22 / det, -e12 / det }, { -e12 / det, e11 / det } };
+    double f[2][2] = { { 2 * beta, -2 * beta }, { -2 * beta, 2 * beta } };
+    double g22 = -body_m * G * body_l;
+    double h[2] = { 2 * alpha, -2 * alpha };
+    int i, j;
+
+    memset(a, 0, sizeof(double) * N * N);
+    memset(b, 0, sizeof(double) * N);
+    a[0 * N + 2] = 1.0;
+    a[1 * N + 3] = 1.0;
+    for(i = 0; i < 2; i++)
+    {
+        a[(i + 2) * N + 1] = -ei[i][1] * g22;
+        for(j = 0; j < 2; j++)
+            a[(i + 2) * N + 2 + j] = -(ei[i][0] * f[0][j] + ei[i][1] * f[1][j]);
+        b[i + 2] = ei[i][0] * h[0] + ei[i][1] * h[1];
+    }
+    a[4 * N + 0] = 1.0;                             // タイヤの角度の積分
+}
+
+/* 0次ホールドで離散化する(exp([A B; 0 0] T) の左上がΦ、右上がΓ) */
+static void discretize(const double *a, const double *b, double period, double *phi, double *gamma)
+{
+    double m[NMAX * NMAX] = { 0 }, e[NMAX * NMAX];
+    int i, j;
+
+    for(i = 0; i < N; i++)
+    {
+        for(j = 0; j < N; j++)
+            m[i * NMAX + j] = a[i * N + j] * period;
+        m[i * NMAX + N] = b[i] * period;
+    }
+    expm(NMAX, m, e);
+    for(i = 0; i < N; i++)
+    {
+        for(j = 0; j < N; j++)
+            phi[i * N + j] = e[i * NMAX + j];
+        gamma[i] = e[i * NMAX + N];
+    }
+}
+
+/**
+ * 離散時間リカッチ方程式 P = Q + A'PA - A'PB (R + B'PB)^-1 B'PA を反復で解く
+ * (A : n x n, B : n x m, Q : n x n, R : m x m) 返り値 : 反復回数/-1(収束しない)
+ */
+static int dare(int n, int m, const double *a, const double *b, const double *q, const double *r, double *p)
+{
+    double pa[NMAX * NMAX], pb[NMAX * NMAX], bpa[NMAX * NMAX], s[NMAX * NMAX], si[NMAX * NMAX];
+    double k[NMAX * NMAX], at[NMAX * NMAX], bt[NMAX * NMAX], pn[NMAX * NMAX], tmp[NMAX * NMAX];
+    double diff, scale;
+    int it, i, j;
+
+    transpose(n, n, a, at);
+    transpose(n, m, b, bt);
+    memcpy(p, q, sizeof(double) * n * n);
+
+    for(it = 1; it <= RICCATI_MAX; it++)
+    {
+        mul(n, n, n, p, a, pa);                     // P A
+        mul(n, n, m, p, b, pb);                     // P B
+        mul(m, n, n, bt, pa, bpa);                  // B' P A
+        mul(m, n, m, bt, pb, s);                    // R + B' P B
+        for(i = 0; i < m * m; i++)
+            s[i] += r[i];
+        if(inverse(m, s, si) != 0)
+            return -1;
+        mul(m, m, n, si, bpa, k);                   // (R + B' P B)^-1 B' P A
+
+        mul(n, n, n, at, pa, pn);                   // P = Q + A' P A - (B' P A)' K
+        for(i = 0; i < n; i++)
+            for(j = 0; j < n; j++)
+            {
+                int l;
+
+                tmp[i * n + j] = 0.0;
+                for(l = 0; l < m; l++)
+                    tmp[i * n + j] += bpa[l * n + i] * k[l * n + j];
+                pn[i * n + j] += q[i * n + j] - tmp[i * n + j];
+            }
+        for(i = 0; i < n; i++)                      // 丸め誤差で非対称になると発散するので対称にする
+            for(j = 0; j < i; j++)
+                pn[i * n + j] = pn[j * n + i] = (pn[i * n + j] + pn[j * n + i]) / 2;
+
+        diff = 0.0;
+        scale = 0.0;
+        for(i = 0; i < n * n; i++)
+        {
+            diff = fmax(diff, fabs(pn[i] - p[i]));
+            scale = fmax(scale, fabs(pn[i]));
+        }
+        memcpy(p, pn, sizeof(double) * n * n);
+        if(!isfinite(scale))
+            return -1;
+        if(diff <= RICCATI_EPS * scale)
+            return it;
+    }
+
+    return -1;
+}
+
+/**
+ * 行列のスペクトル半径を、べき乗のノルムの増え方から見積もる
+ * (固有値が1に近いと最初の過渡的な増加が残るので、後半の増え方だけを使う)
+ */
+static double spectral_radius(int n, const double *c)
+{
+    double x[NMAX * NMAX], tmp[NMAX * NMAX], norm, log_sum = 0.0;
+    int i, j, count = 40000;
+
+    memcpy(x, c, sizeof(double) * n * n);
+    for(i = 0; i < count; i++)                      // x = c^count を正規化しながら計算する
+    {
+        norm = 0.0;
+        for(j = 0; j < n * n; j++)
+            norm = fmax(norm, fabs(x[j]));
+        if(norm == 0.0)
+            return 0.0;
+        for(j = 0; j < n * n; j++)
+            x[j] /= norm;
+        if(i >= count / 2)
+            log_sum += log(norm);
+        mul(n, n, n, x, c, tmp);
+        memcpy(x, tmp, sizeof(double) * n * n);
+    }
+
+    return exp(log_sum / (count - count / 2));
+}
+
+/* LQRのゲインKを求める(u = -K x) 返り値 : 反復回数/-1 */
+static int lqr(const double *phi, const double *gamma, const double *q, double r, double *k)
+{
+    double qm[N * N] = { 0 }, p[N * N], pg[N], s = r;
+    int it, i, j;
+
+    for(i = 0; i < N; i++)
+        qm[i * N + i] = q[i];
+    if((it = dare(N, 1, phi, gamma, qm, &r, p)) < 0)
+        return -1;
+
+    mul(N, N, 1, p, gamma, pg);
+    for(i = 0; i < N; i++)
+        s += gamma[i] * pg[i];
+    for(j = 0; j < N; j++)
+    {
+        k[j] = 0.0;                                 // (R + Γ'PΓ)^-1 Γ'PΦ
+        for(i = 0; i < N; i++)
+            k[j] += pg[i] * phi[i * N + j];
+        k[j] /= s;
+    }
+
+    return it;
+}
+
+/**
+ * 定常カルマンフィルタのゲインLを求める(x = x- + L (y - C x-)、x-は1周期前の推定値から予測した状態)
+ * 双対のリカッチ方程式の解が予測の誤差の共分散P、L = P C' (C P C' + V)^-1 返り値 : 反復回数/-1
+ */
+static int kalman(const double *phi, const double *w, const double *v, double *l)
+{
+    double phix[NX * NX], phit[NX * NX], ct[NX * NY], wm[NX * NX] = { 0 }, vm[NY * NY] = { 0 };
+    double p[NX * NX], pct[NX * NY], s[NY * NY], si[NY * NY];
+    int it, i, j;
+
+    for(i = 0; i < NX; i++)
+        for(j = 0; j < NX; j++)
+            phix[i * NX + j] = phi[i * N + j];
+    transpose(NX, NX, phix, phit);
+    transpose(NY, NX, c_obs, ct);
+    wm[2 * NX + 2] = w[0] * w[0];
+    wm[3 * NX + 3] = w[1] * w[1];
+    for(i = 0; i < NY; i++)
+        vm[i * NY + i] = v[i] * v[i];
+
+    if((it = dare(NX, NY, phit, ct, wm, vm, p)) < 0)
+        return -1;
+
+    mul(NX, NX, NY, p, ct, pct);
+    mul(NY, NX, NY, c_obs, pct, s);
+    for(i = 0; i < NY * NY; i++)
+        s[i] += vm[i];
+    if(inverse(NY, s, si) != 0)
+        return -1;
+    mul(NX, NY, NY, pct, si, l);
+
+    return it;
+}
+
+static int parse_list(const char *s, double *v, int n)
+{
+    char *end;
+    int i;
+
+    for(i = 0; i < n; i++)
+    {
+        v[i] = strtod(s, &end);
+        if(end == s || v[i] < 0)
+            return -1;
+        s = end;
+        if(i < n - 1)
+        {
+            if(*s != ',')
+                return -1;
+            s++;
+        }
+    }
+
+    return *s == '\0' ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    double diameter = 5.6, body_m = 0.80, body_l = 0.12, battery = 8.0;
+    int period_ms = 5;
+    double q[N] = { 1.0, 1e3, 10.0, 1.0, 1.0 }, r = 100.0;
+    double w[2] = { 2.0, 2.0 }, v[NY] = { 0.3, 0.5, 0.6 };
+    double a[N * N], b[N], phi[N * N], gamma[N], k[N], l[NX * NY], cl[N * N], ob[NX * NX], lc[NX * NX];
+    double unit, rho_lqr, rho_obs;
+    FILE *out = stdout;
+    int opt, it_lqr, it_obs, i, j;
+
+    while((opt = getopt(argc, argv, "d:m:l:b:p:q:r:w:v:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'd': diameter = atof(optarg); break;
+            case 'm': body_m = atof(optarg); break;
+            case 'l': body_l = atof(optarg); break;
+            case 'b': battery = atof(optarg); break;
+            case 'p': period_ms = atoi(optarg); break;
+            case 'q':
+                if(parse_list(optarg, q, N) != 0)
+                {
+                    fprintf(stderr, "-q needs %d non-negative weights separated by ','\n", N);
+                    return 1;
+                }
+                break;
+            case 'r': r = atof(optarg); break;
+            case 'w':
+                if(parse_list(optarg, w, 2) != 0)
+                {
+                    fprintf(stderr, "-w needs 2 non-negative deviations separated by ','\n");
+                    return 1;
+                }
+                break;
+            case 'v':
+                if(parse_list(optarg, v, NY) != 0 || v[0] <= 0 || v[1] <= 0 || v[2] <= 0)
+                {
+                    fprintf(stderr, "-v needs %d positive deviations separated by ','\n", NY);
+                    return 1;
+                }
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-d diameter_cm] [-m mass_kg] [-l cog_m] [-b battery_v] [-p period_ms] "
+                                "[-q q1,q2,q3,q4,q5] [-r r] [-w w1,w2] [-v v1,v2,v3] [balance_gain.h]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(diameter <= 0 || body_m <= 0 || body_l <= 0 || battery <= 0 || period_ms <= 0 || 1000 % period_ms != 0 || r <= 0)
+    {
+        fprintf(stderr, "invalid parameter (the period must divide 1000 ms)\n");
+        return 1;
+    }
+
+    model(diameter / 200.0, body_m, body_l, a, b);
+    discretize(a, b, period_ms / 1000.0, phi, gamma);
+
+    /* レギュレータ : 閉ループ Φ - Γ K が安定であることを確かめる */
+    if((it_lqr = lqr(phi, gamma, q, r, k)) < 0)
+    {
+        fprintf(stderr, "the Riccati equation of the regulator did not converge\n");
+        return 1;
+    }
+    for(i = 0; i < N; i++)
+        for(j = 0; j < N; j++)
+            cl[i * N + j] = phi[i * N + j] - gamma[i] * k[j];
+    rho_lqr = spectral_radius(N, cl);
+
+    /* オブザーバ : 推定誤差の遷移 (I - L C) Φ が安定であることを確かめる(角度の単位はdegで計算する) */
+    if((it_obs = kalman(phi, w, v, l)) < 0)
+    {
+        fprintf(stderr, "the Riccati equation of the observer did not converge\n");
+        return 1;
+    }
+    mul(NX, NY, NX, l, c_obs, lc);
+    for(i = 0; i < NX; i++)
+        for(j = 0; j < NX; j++)
+        {
+            int m;
+
+            ob[i * NX + j] = 0.0;
+            for(m = 0; m < NX; m++)
+                ob[i * NX + j] += ((i == m ? 1.0 : 0.0) - lc[i * NX + m]) * phi[m * N + j];
+        }
+    rho_obs = spectral_radius(NX, ob);
+
+    if(rho_lqr >= 1.0 || rho_obs >= 1.0)
+    {
+        fprintf(stderr, "unstable (spectral radius: regulator %.5f, observer %.5f)\n", rho_lqr, rho_obs);
+        return 1;
+    }
+
+    if(optind < argc && (out = fopen(argv[optind], "w")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[optind]);
+        return 1;
+    }
+
+    /* u = -K x [V, rad] を power = K' x [出力, deg] に直す */
+    unit = M_PI / 180.0 * 100.0 / battery;
+
+    fprintf(out, "/**\n");
+    fprintf(out, " * Gains of the state-space balance controller (balance_lqr.c).\n");
+    fprintf(out, " *\n");
+    fprintf(out, " * Generated by tools/lqrgain.c, do not edit by hand:\n");
+    fprintf(out, " *   lqrgain -d %g -m %g -l %g -b %g -p %d -q %g,%g,%g,%g,%g -r %g -w %g,%g -v %g,%g,%g\n",
+            diameter, body_m, body_l, battery, period_ms, q[0], q[1], q[2], q[3], q[4], r, w[0], w[1], v[0], v[1], v[2]);
+    fprintf(out, " * Spectral radius: regulator %.5f (%d iterations), observer %.5f (%d iterations).\n",
+            rho_lqr, it_lqr, rho_obs, it_obs);
+    fprintf(out, " *\n");
+    fprintf(out, " * x = [wheel angle against the floor (deg), body angle (deg), their speeds (deg/s)]\n");
+    fprintf(out, " * y = [average of the motor counts (deg), integral of the gyro rate (deg), gyro rate (deg/s)]\n");
+    fprintf(out, " * u = average power of both motors\n");
+    fprintf(out, " */\n\n");
+    fprintf(out, "#ifndef BALANCE_GAIN_H\n#define BALANCE_GAIN_H\n\n");
+    fprintf(out, "#define LQR_PERIOD_MS       %d\n\n", period_ms);
+
+    fprintf(out, "/* Regulator: power = sum of LQR_K_* x state */\n");
+    for(i = 0; i < N; i++)
+    {
+        char name[32];
+
+        snprintf(name, sizeof(name), "LQR_K_%s", state_name[i]);
+        fprintf(out, "#define %-19s %10.6ff  // x %s\n", name, -k[i] * unit, state_desc[i]);
+    }
+
+    /* 一定の速度で走るのに必要な出力(逆起電力と摩擦を打ち消す) : 定常状態で theta'' = 0 となる u */
+    fprintf(out, "\n/* Feedforward: power to keep the wheel speed of the reference (back EMF and friction) */\n");
+    fprintf(out, "#define %-19s %10.6ff  // x wheel speed of the reference (deg/s)\n", "LQR_K_DRIVE", -a[2 * N + 2] / b[2] * unit);
+
+    fprintf(out, "\n/* Model for the prediction of the observer: x = LQR_PHI x + LQR_GAMMA u */\n");
+    fprintf(out, "static const float LQR_PHI[4][4] = {\n");
+    for(i = 0; i < NX; i++)
+        fprintf(out, "    { %12.8ff, %12.8ff, %12.8ff, %12.8ff },\n",
+                phi[i * N + 0], phi[i * N + 1], phi[i * N + 2], phi[i * N + 3]);
+    fprintf(out, "};\n");
+    fprintf(out, "static const float LQR_GAMMA[4] = { %.8ff, %.8ff, %.8ff, %.8ff };\n",
+            gamma[0] / unit, gamma[1] / unit, gamma[2] / unit, gamma[3] / unit);
+
+    fprintf(out, "\n/* Gain of the observer: x = x + LQR_L (y - C x) */\n");
+    fprintf(out, "static const float LQR_L[4][3] = {\n");
+    for(i = 0; i < NX; i++)
+        fprintf(out, "    { %12.8ff, %12.8ff, %12.8ff },\n", l[i * NY + 0], l[i * NY + 1], l[i * NY + 2]);
+    fprintf(out, "};\n");
+    fprintf(out, "\n#endif\n");
+
+    if(out != stdout)
+        fclose(out);
+    fprintf(stderr, "K = [%g %g %g %g %g] (V/rad), spectral radius: regulator %.5f, observer %.5f\n",
+            k[0], k[1], k[2], k[3], k[4], rho_lqr, rho_obs);
+
+    return 0;
+}
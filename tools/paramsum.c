@@ -0,0 +1,112 @@
+/**
+ ******************************************************************************
+ ** ファイル名 : paramsum.c
+ **
+ ** 概要 : 走行体のチューニングファイル(Param_*.txt)にchecksum行を付け直すホスト(PC)用ツール
+ **
+ ** 注記 : ビルド   gcc -O2 -o paramsum paramsum.c
+ **        使用方法 paramsum Param_R.txt   (既存のchecksum行以降を取り除き、新しいchecksum行を末尾に付ける)
+ **        ファイル形式・チェックサムの計算方法は各走行体アプリの Param.c を参照
+ ******************************************************************************
+ **/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PARAM_FILE_MAX      2048    // Param.hと合わせる
+#define PARAM_CHECKSUM_KEY  "checksum"
+
+/* Fletcher-16チェックサム(Param.cと同じ) */
+static uint16_t checksum(const char *data, size_t size)
+{
+    uint16_t a = 0, b = 0;
+    size_t i;
+
+    for(i = 0; i < size; i++)
+    {
+        a = (a + (uint8_t)data[i]) % 255;
+        b = (b + a) % 255;
+    }
+
+    return (b << 8) | a;
+}
+
+/* checksum行か(キーが完全に一致し、空白の後に'='が続く行、Param.cと同じ) */
+static int is_checksum(const char *line)
+{
+    size_t n = strlen(PARAM_CHECKSUM_KEY);
+
+    if(strncmp(line, PARAM_CHECKSUM_KEY, n) != 0)
+        return 0;
+    for(line += n; *line == ' ' || *line == '\t'; line++)
+        ;
+
+    return *line == '=';
+}
+
+int main(int argc, char *argv[])
+{
+    static char buf[PARAM_FILE_MAX + 1];
+    FILE *fp;
+    size_t size, body;
+    char *line;
+    char sum_line[32];
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "usage: %s Param_R.txt\n", argv[0]);
+        return 1;
+    }
+
+    if((fp = fopen(argv[1], "rb")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    size = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+    if(size > PARAM_FILE_MAX)
+    {
+        fprintf(stderr, "%s is too large (max %d bytes)\n", argv[1], PARAM_FILE_MAX);
+        return 1;
+    }
+    buf[size] = '\0';
+
+    /* 既存のchecksum行の先頭までを本体とする */
+    body = size;
+    line = buf;
+    while(line != NULL)
+    {
+        if(is_checksum(line))
+        {
+            body = line - buf;
+            break;
+        }
+        line = strchr(line, '\n');
+        if(line != NULL)
+            line++;
+    }
+    if(body > 0 && buf[body - 1] != '\n')   // 最終行に改行が無い場合は付ける
+        buf[body++] = '\n';
+
+    snprintf(sum_line, sizeof(sum_line), PARAM_CHECKSUM_KEY " = 0x%04x\n", checksum(buf, body));
+    if(body + strlen(sum_line) > PARAM_FILE_MAX)
+    {
+        fprintf(stderr, "%s is too large (max %d bytes)\n", argv[1], PARAM_FILE_MAX);
+        return 1;
+    }
+
+    if((fp = fopen(argv[1], "wb")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    fwrite(buf, 1, body, fp);
+    fputs(sum_line, fp);
+    fclose(fp);
+
+    printf("%s", sum_line);
+
+    return 0;
+}
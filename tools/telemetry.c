@@ -0,0 +1,200 @@
+/**
+ ******************************************************************************
+ ** ファイル名 : telemetry.c
+ **
+ ** 概要 : 走行体がBluetoothで送信するテレメトリを受信してCSVに変換するホスト(PC)用ツール
+ **
+ ** 注記 : ビルド   gcc -O2 -o telemetry telemetry.c
+ **        使用方法 telemetry /dev/rfcomm0 [出力ファイル]   (出力ファイル省略時は標準出力、Ctrl+Cで終了)
+ **                 受信済みのバイト列を保存したファイルも入力にできる
+ **        フレーム形式は各走行体アプリの Telemetry.h を参照
+ ******************************************************************************
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#define SYNC                0xA5
+#define TELEMETRY_FRAME_TYPE ('T' | 0x80)
+#define TELEMETRY_VERSION   1
+#define TELEMETRY_DATA_LEN  66
+
+static volatile sig_atomic_t stop = 0;
+
+static int fd;
+static uint8_t rx_buf[4096];
+static int rx_len = 0, rx_pos = 0;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+/* 1バイト読む 返り値 : バイト/-1(終端) */
+static int get_byte(void)
+{
+    if(rx_pos == rx_len)
+    {
+        rx_len = read(fd, rx_buf, sizeof(rx_buf));
+        rx_pos = 0;
+        if(rx_len <= 0)
+            return -1;
+    }
+    return rx_buf[rx_pos++];
+}
+
+/* CRC-16/CCITT(Telemetry.cと同じ) */
+static uint16_t crc16(const uint8_t *data, uint32_t size)
+{
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+    int bit;
+
+    for(i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+static uint16_t get_u16(const uint8_t **p)
+{
+    uint16_t value = (*p)[0] | ((*p)[1] << 8);
+    *p += 2;
+    return value;
+}
+
+static uint32_t get_u32(const uint8_t **p)
+{
+    uint32_t value = (uint32_t)(*p)[0] | ((uint32_t)(*p)[1] << 8) | ((uint32_t)(*p)[2] << 16) | ((uint32_t)(*p)[3] << 24);
+    *p += 4;
+    return value;
+}
+
+static float get_float(const uint8_t **p)
+{
+    uint32_t bits = get_u32(p);
+    float value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* 1フレームのデータをCSVの1行に変換する 返り値 : 走行体が破棄したサンプル数 */
+static uint32_t print_sample(FILE *out, const uint8_t *data)
+{
+    const uint8_t *p = data + 1;    // 版数を飛ばす
+    uint32_t tick = get_u32(&p);
+    uint32_t time = get_u32(&p);
+    unsigned r = get_u16(&p), g = get_u16(&p), b = get_u16(&p);
+    int sonar = (int16_t)get_u16(&p);
+    int gyro_angle = (int16_t)get_u16(&p);
+    int gyro_rate = (int16_t)get_u16(&p);
+    int32_t count_left = get_u32(&p);
+    int32_t count_right = get_u32(&p);
+    float x = get_float(&p), y = get_float(&p), heading = get_float(&p);
+    int32_t error = get_u32(&p);
+    int32_t pt = get_u32(&p), it = get_u32(&p), dt = get_u32(&p);
+    int power = (int8_t)*p++;
+    int turn = (int16_t)get_u16(&p);
+    unsigned section = *p++;
+    unsigned state = *p++;
+    uint32_t dropped = get_u32(&p);
+
+    fprintf(out, "%u,%.3f,%u,%u,%u,%d,%d,%d,%d,%d,%.1f,%.1f,%.2f,%d,%.3f,%.3f,%.3f,%d,%d,%u,%u,%u\n",
+            (unsigned)tick, time / 1000000.0, r, g, b, sonar, gyro_angle, gyro_rate, (int)count_left, (int)count_right,
+            x, y, heading, (int)error, pt / 65536.0, it / 65536.0, dt / 65536.0, power, turn, section, state, (unsigned)dropped);
+
+    return dropped;
+}
+
+int main(int argc, char *argv[])
+{
+    struct termios tio;
+    struct sigaction sa;
+    FILE *out = stdout;
+    uint8_t frame[3 + 255 + 2];
+    uint32_t dropped, first_dropped = 0, last_dropped = 0;
+    long frames = 0, crc_errors = 0, other = 0;
+    int c, i, len;
+
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: %s port [output.csv]\n", argv[0]);
+        return 1;
+    }
+    if((fd = open(argv[1], O_RDONLY | O_NOCTTY)) < 0)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    if(tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    if(argc > 2 && (out = fopen(argv[2], "w")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[2]);
+        return 1;
+    }
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;                      // SA_RESTARTを付けず、受信待ちを中断させる
+    sigaction(SIGINT, &sa, NULL);
+
+    fprintf(out, "tick,time,r,g,b,sonar,gyro_angle,gyro_rate,count_left,count_right,x,y,heading,"
+                 "error,p,i,d,power,turn,section,state,dropped\n");
+
+    while(!stop && (c = get_byte()) >= 0)
+    {
+        if(c != SYNC)                               // エコーバックなど
+            continue;
+        if((c = get_byte()) < 0 || (len = get_byte()) < 0)
+            break;
+        frame[0] = SYNC;
+        frame[1] = c;
+        frame[2] = len;
+
+        if(c != TELEMETRY_FRAME_TYPE)               // コマンドの応答は読み飛ばす(データとチェックサム)
+        {
+            for(i = 0; i <= len && get_byte() >= 0; i++)
+                ;
+            ++other;
+            continue;
+        }
+
+        for(i = 0; i < len + 2 && (c = get_byte()) >= 0; i++)
+            frame[3 + i] = c;
+        if(i < len + 2)
+            break;
+
+        if(crc16(&frame[1], len + 2) != (frame[3 + len] | (frame[4 + len] << 8))
+           || len != TELEMETRY_DATA_LEN || frame[3] != TELEMETRY_VERSION)
+        {
+            ++crc_errors;                           // 同期がずれた場合は次のSYNCから探し直す
+            continue;
+        }
+
+        dropped = print_sample(out, &frame[3]);
+        if(frames == 0)
+            first_dropped = dropped;
+        last_dropped = dropped;
+        ++frames;
+    }
+
+    fflush(out);
+    fprintf(stderr, "%ld frames, %ld crc errors, %ld other frames, %u dropped on the robot\n",
+            frames, crc_errors, other, (unsigned)(last_dropped - first_dropped));
+
+    return 0;
+}